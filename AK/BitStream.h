@@ -7,7 +7,7 @@
 
 #pragma once
 
-#include <AK/Optional.h>
+#include <AK/Endian.h>
 #include <AK/Stream.h>
 
 namespace AK {
@@ -25,14 +25,11 @@ public:
         if (has_any_error())
             return 0;
 
+        // Bytes that were already buffered (even if some of their bits were read) are handed out first.
         size_t nread = 0;
-        if (bytes.size() >= 1) {
-            if (m_next_byte.has_value()) {
-                bytes[0] = m_next_byte.value();
-                m_next_byte.clear();
-
-                ++nread;
-            }
+        while (nread < bytes.size() && m_bit_count != 0) {
+            bytes[nread++] = static_cast<u8>(m_bit_buffer);
+            drop_current_byte();
         }
 
         return nread + m_stream.read(bytes.slice(nread));
@@ -48,15 +45,13 @@ public:
         return true;
     }
 
-    bool unreliable_eof() const override { return !m_next_byte.has_value() && m_stream.unreliable_eof(); }
+    bool unreliable_eof() const override { return m_bit_count == 0 && m_stream.unreliable_eof(); }
 
     bool discard_or_error(size_t count) override
     {
-        if (count >= 1) {
-            if (m_next_byte.has_value()) {
-                m_next_byte.clear();
-                --count;
-            }
+        while (count >= 1 && m_bit_count != 0) {
+            drop_current_byte();
+            --count;
         }
 
         return m_stream.discard_or_error(count);
@@ -64,28 +59,19 @@ public:
 
     u64 read_bits(size_t count)
     {
-        u64 result = 0;
-
-        size_t nread = 0;
-        while (nread < count) {
-            if (m_stream.has_any_error()) {
-                set_fatal_error();
-                return 0;
-            }
+        VERIFY(count <= 64);
 
-            if (m_next_byte.has_value()) {
-                const auto bit = (m_next_byte.value() >> m_bit_offset) & 1;
-                result |= bit << nread;
-                ++nread;
-
-                if (m_bit_offset++ == 7)
-                    m_next_byte.clear();
-            } else {
-                m_stream >> m_next_byte;
-                m_bit_offset = 0;
-            }
+        // The buffer can't always hold 64 bits that haven't been read yet, so larger reads are split up.
+        if (count > max_bits_per_read) {
+            auto low_bits = read_bits(32);
+            return low_bits | (read_bits(count - 32) << 32);
         }
 
+        if (!ensure_buffered_bits(count))
+            return 0;
+
+        auto result = peek_bits(count);
+        discard_bits(count);
         return result;
     }
 
@@ -95,30 +81,21 @@ public:
 
         size_t nread = 0;
         while (nread < count) {
-            if (m_stream.has_any_error()) {
-                set_fatal_error();
+            if (!ensure_buffered_bits(1))
                 return 0;
-            }
 
-            if (m_next_byte.has_value()) {
+            if (((count - nread) >= 8) && m_bit_offset == 0) {
                 // read an entire byte
-                if (((count - nread) >= 8) && m_bit_offset == 0) {
-                    // shift existing bytes over
-                    result <<= 8;
-                    result |= m_next_byte.value();
-                    nread += 8;
-                    m_next_byte.clear();
-                } else {
-                    const auto bit = (m_next_byte.value() >> (7 - m_bit_offset)) & 1;
-                    result <<= 1;
-                    result |= bit;
-                    ++nread;
-                    if (m_bit_offset++ == 7)
-                        m_next_byte.clear();
-                }
+                result <<= 8;
+                result |= m_bit_buffer & 0xff;
+                nread += 8;
+                drop_current_byte();
             } else {
-                m_stream >> m_next_byte;
-                m_bit_offset = 0;
+                const auto bit = (m_bit_buffer >> (7 - m_bit_offset)) & 1;
+                result <<= 1;
+                result |= bit;
+                ++nread;
+                discard_bits(1);
             }
         }
 
@@ -131,8 +108,48 @@ public:
 
     void align_to_byte_boundary()
     {
-        if (m_next_byte.has_value())
-            m_next_byte.clear();
+        if (m_bit_offset != 0)
+            drop_current_byte();
+    }
+
+    // The number of bits that can be peeked at without reading from the underlying stream.
+    size_t buffered_bit_count() const { return m_bit_count - m_bit_offset; }
+
+    // Returns the next bits in little endian order without consuming them. Bits that aren't buffered yet are zero.
+    u64 peek_bits(size_t count) const
+    {
+        VERIFY(count <= max_bits_per_read);
+        return (m_bit_buffer >> m_bit_offset) & ((1ull << count) - 1);
+    }
+
+    void discard_bits(size_t count)
+    {
+        VERIFY(count <= buffered_bit_count());
+        m_bit_offset += count;
+        auto whole_bytes = m_bit_offset / 8;
+        if (whole_bytes != 0) {
+            // Shifting a u64 by 64 is undefined, so a completely read buffer is cleared instead.
+            m_bit_buffer = whole_bytes == 8 ? 0 : m_bit_buffer >> (whole_bytes * 8);
+            m_bit_count -= whole_bytes * 8;
+            m_bit_offset %= 8;
+        }
+    }
+
+    // Reads whole bytes from the underlying stream until at least `count` bits are buffered.
+    // Nothing past those bytes is read, so data that follows the bit stream is left to its owner.
+    bool ensure_buffered_bits(size_t count)
+    {
+        VERIFY(count <= max_bits_per_read);
+        while (buffered_bit_count() < count) {
+            u8 byte;
+            if (m_stream.has_any_error() || !m_stream.read_or_error({ &byte, sizeof(byte) })) {
+                set_fatal_error();
+                return false;
+            }
+            m_bit_buffer |= static_cast<u64>(byte) << m_bit_count;
+            m_bit_count += 8;
+        }
+        return true;
     }
 
     bool handle_any_error() override
@@ -142,11 +159,27 @@ public:
     }
 
 private:
-    Optional<u8> m_next_byte;
+    // A partially read byte may still sit in the buffer, so this many bits are always guaranteed to fit.
+    static constexpr size_t max_bits_per_read = 56;
+
+    void drop_current_byte()
+    {
+        m_bit_buffer >>= 8;
+        m_bit_count -= 8;
+        m_bit_offset = 0;
+    }
+
+    // Buffered bytes, with the byte that is currently being read in the lowest bits.
+    u64 m_bit_buffer { 0 };
+    // The number of bits in the buffer, including the ones of the current byte that were already read.
+    size_t m_bit_count { 0 };
+    // The number of bits of the current byte that were already read.
     size_t m_bit_offset { 0 };
     InputStream& m_stream;
 };
 
+// Bits are collected in a buffer and written out 32 at a time, so the stream has to be aligned to a byte boundary
+// before anything else is written to the underlying stream.
 class OutputBitStream final : public OutputStream {
 public:
     explicit OutputBitStream(OutputStream& stream)
@@ -178,37 +211,18 @@ public:
     {
         VERIFY(count <= 32);
 
-        if (count == 32 && !m_next_byte.has_value()) { // fast path for aligned 32 bit writes
-            m_stream << bits;
+        m_bit_buffer |= (static_cast<u64>(bits) & ((1ull << count) - 1)) << m_bit_count;
+        m_bit_count += count;
+        if (m_bit_count < 32)
             return;
-        }
 
-        size_t n_written = 0;
-        while (n_written < count) {
-            if (m_stream.has_any_error()) {
-                set_fatal_error();
-                return;
-            }
-
-            if (m_next_byte.has_value()) {
-                m_next_byte.value() |= ((bits >> n_written) & 1) << m_bit_offset;
-                ++n_written;
-
-                if (m_bit_offset++ == 7) {
-                    m_stream << m_next_byte.value();
-                    m_next_byte.clear();
-                }
-            } else if (count - n_written >= 16) { // fast path for aligned 16 bit writes
-                m_stream << (u16)((bits >> n_written) & 0xFFFF);
-                n_written += 16;
-            } else if (count - n_written >= 8) { // fast path for aligned 8 bit writes
-                m_stream << (u8)((bits >> n_written) & 0xFF);
-                n_written += 8;
-            } else {
-                m_bit_offset = 0;
-                m_next_byte = 0;
-            }
+        LittleEndian<u32> word = static_cast<u32>(m_bit_buffer);
+        if (m_stream.has_any_error() || !m_stream.write_or_error({ &word, sizeof(word) })) {
+            set_fatal_error();
+            return;
         }
+        m_bit_buffer >>= 32;
+        m_bit_count -= 32;
     }
 
     void write_bit(bool bit)
@@ -216,24 +230,29 @@ public:
         write_bits(bit, 1);
     }
 
+    // Pads the current byte with zero bits, and writes out everything that was buffered.
     void align_to_byte_boundary()
     {
-        if (m_next_byte.has_value()) {
-            if (!m_stream.write_or_error(ReadonlyBytes { &m_next_byte.value(), 1 })) {
-                set_fatal_error();
-            }
-            m_next_byte.clear();
-        }
+        auto byte_count = (m_bit_count + 7) / 8;
+        if (byte_count == 0)
+            return;
+
+        LittleEndian<u64> bytes = m_bit_buffer;
+        if (!m_stream.write_or_error({ &bytes, byte_count }))
+            set_fatal_error();
+        m_bit_buffer = 0;
+        m_bit_count = 0;
     }
 
     size_t bit_offset() const
     {
-        return m_bit_offset;
+        return m_bit_count % 8;
     }
 
 private:
-    Optional<u8> m_next_byte;
-    size_t m_bit_offset { 0 };
+    // Bits that weren't written out yet, the first one in the lowest bit.
+    u64 m_bit_buffer { 0 };
+    size_t m_bit_count { 0 };
     OutputStream& m_stream;
 };
 
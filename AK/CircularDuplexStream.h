@@ -46,8 +46,12 @@ public:
 
         const auto nread = min(bytes.size(), m_queue.size());
 
-        for (size_t idx = 0; idx < nread; ++idx)
-            bytes[idx] = m_queue.dequeue();
+        // The queued bytes are at most split in two by the end of the storage, so they're copied in at most two chunks.
+        const auto first_chunk_size = min(nread, Capacity - m_queue.head_index());
+        __builtin_memcpy(bytes.data(), m_queue.m_storage + m_queue.head_index(), first_chunk_size);
+        __builtin_memcpy(bytes.data() + first_chunk_size, m_queue.m_storage, nread - first_chunk_size);
+        m_queue.m_head = (m_queue.head_index() + nread) % Capacity;
+        m_queue.m_size -= nread;
 
         return nread;
     }
@@ -69,6 +73,35 @@ public:
         return nread;
     }
 
+    // Appends `count` bytes that start `seekback` bytes before the end of the stream, like an LZ77 back reference.
+    // The copied bytes may overlap the ones being appended, in which case the overlapping part is repeated.
+    bool copy_from_seekback(size_t seekback, size_t count)
+    {
+        if (seekback == 0 || seekback > Capacity || seekback > m_total_written || count > Capacity - m_queue.size()) {
+            set_recoverable_error();
+            return false;
+        }
+
+        auto* storage = m_queue.m_storage;
+        auto write_index = (m_queue.head_index() + m_queue.size()) % Capacity;
+        auto read_index = (m_total_written - seekback) % Capacity;
+
+        if (seekback >= count && read_index + count <= Capacity && write_index + count <= Capacity) {
+            // Neither range wraps around, and every byte is read before it could be overwritten.
+            __builtin_memmove(storage + write_index, storage + read_index, count);
+        } else {
+            for (size_t idx = 0; idx < count; ++idx) {
+                storage[write_index] = storage[read_index];
+                write_index = (write_index + 1) % Capacity;
+                read_index = (read_index + 1) % Capacity;
+            }
+        }
+
+        m_queue.m_size += count;
+        m_total_written += count;
+        return true;
+    }
+
     bool read_or_error(Bytes bytes) override
     {
         if (m_queue.size() < bytes.size()) {
@@ -96,6 +129,8 @@ public:
     bool unreliable_eof() const override { return eof(); }
     bool eof() const { return m_queue.size() == 0; }
 
+    size_t remaining_space() const { return Capacity - m_queue.size(); }
+
     size_t remaining_contiguous_space() const
     {
         return min(Capacity - m_queue.size(), m_queue.capacity() - (m_queue.head_index() + m_queue.size()) % Capacity);
@@ -17,6 +17,7 @@
 constexpr int syscall_vector = 0x82;
 
 extern "C" {
+struct epoll_event;
 struct pollfd;
 struct timeval;
 struct timespec;
@@ -68,6 +69,9 @@ enum class NeedsBigProcessLock {
     S(dump_backtrace, NeedsBigProcessLock::No)              \
     S(dup2, NeedsBigProcessLock::Yes)                       \
     S(emuctl, NeedsBigProcessLock::Yes)                     \
+    S(epoll_create, NeedsBigProcessLock::Yes)               \
+    S(epoll_ctl, NeedsBigProcessLock::Yes)                  \
+    S(epoll_wait, NeedsBigProcessLock::No)                  \
     S(execve, NeedsBigProcessLock::Yes)                     \
     S(exit, NeedsBigProcessLock::Yes)                       \
     S(exit_thread, NeedsBigProcessLock::Yes)                \
@@ -152,6 +156,7 @@ enum class NeedsBigProcessLock {
     S(sched_getparam, NeedsBigProcessLock::Yes)             \
     S(sched_setparam, NeedsBigProcessLock::Yes)             \
     S(sendfd, NeedsBigProcessLock::Yes)                     \
+    S(sendfile, NeedsBigProcessLock::Yes)                   \
     S(sendmsg, NeedsBigProcessLock::Yes)                    \
     S(set_coredump_metadata, NeedsBigProcessLock::Yes)      \
     S(set_mmap_name, NeedsBigProcessLock::Yes)              \
@@ -179,6 +184,7 @@ enum class NeedsBigProcessLock {
     S(sigtimedwait, NeedsBigProcessLock::Yes)               \
     S(socket, NeedsBigProcessLock::Yes)                     \
     S(socketpair, NeedsBigProcessLock::Yes)                 \
+    S(splice, NeedsBigProcessLock::Yes)                     \
     S(stat, NeedsBigProcessLock::No)                        \
     S(statvfs, NeedsBigProcessLock::Yes)                    \
     S(symlink, NeedsBigProcessLock::Yes)                    \
@@ -271,6 +277,30 @@ struct SC_poll_params {
     const u32* sigmask;
 };
 
+struct SC_epoll_ctl_params {
+    int epfd;
+    int op;
+    int fd;
+    const struct epoll_event* event;
+};
+
+struct SC_epoll_wait_params {
+    int epfd;
+    struct epoll_event* events;
+    int max_events;
+    const struct timespec* timeout;
+    const u32* sigmask;
+};
+
+struct SC_splice_params {
+    int in_fd;
+    i64* in_offset;
+    int out_fd;
+    i64* out_offset;
+    size_t count;
+    unsigned flags;
+};
+
 struct SC_clock_nanosleep_params {
     int clock_id;
     int flags;
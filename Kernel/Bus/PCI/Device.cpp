@@ -7,6 +7,7 @@
 #include <AK/AnyOf.h>
 #include <Kernel/Bus/PCI/API.h>
 #include <Kernel/Bus/PCI/Device.h>
+#include <Kernel/Memory/TypedMapping.h>
 
 namespace Kernel {
 namespace PCI {
@@ -46,13 +47,88 @@ void Device::disable_message_signalled_interrupts()
 {
     TODO();
 }
+
+// PCI Local Bus Specification 3.0, 6.8.2 MSI-X Capability and Table Structure
+static constexpr u32 msix_message_control_offset = 2;
+static constexpr u32 msix_table_offset_offset = 4;
+static constexpr u16 msix_message_control_table_size_mask = 0x7ff;
+static constexpr u16 msix_message_control_function_mask = 1 << 14;
+static constexpr u16 msix_message_control_enable = 1 << 15;
+static constexpr u32 msix_vector_control_mask_bit = 1;
+static constexpr u32 msix_message_address_base = 0xfee00000;
+
+struct [[gnu::packed]] MSIXTableEntry {
+    u32 message_address_low;
+    u32 message_address_high;
+    u32 message_data;
+    u32 vector_control;
+};
+
+Optional<Capability> Device::extended_message_signalled_interrupt_capability() const
+{
+    for (auto const& capability : PCI::get_device_identifier(pci_address()).capabilities()) {
+        if (capability.id().value() == PCI::Capabilities::ID::MSIX)
+            return capability;
+    }
+    return {};
+}
+
 void Device::enable_extended_message_signalled_interrupts()
 {
-    TODO();
+    auto capability = extended_message_signalled_interrupt_capability();
+    VERIFY(capability.has_value());
+    auto message_control = capability->read16(msix_message_control_offset);
+    message_control |= msix_message_control_enable;
+    message_control &= ~msix_message_control_function_mask;
+    capability->write16(msix_message_control_offset, message_control);
 }
 void Device::disable_extended_message_signalled_interrupts()
 {
-    TODO();
+    auto capability = extended_message_signalled_interrupt_capability();
+    VERIFY(capability.has_value());
+    auto message_control = capability->read16(msix_message_control_offset);
+    capability->write16(msix_message_control_offset, message_control & ~msix_message_control_enable);
+}
+
+size_t Device::extended_message_signalled_interrupt_count() const
+{
+    auto capability = extended_message_signalled_interrupt_capability();
+    if (!capability.has_value())
+        return 0;
+    // The table size is encoded as N - 1.
+    return (capability->read16(msix_message_control_offset) & msix_message_control_table_size_mask) + 1;
+}
+
+ErrorOr<void> Device::configure_extended_message_signalled_interrupt(size_t index, u8 vector, u8 destination_apic_id)
+{
+    auto capability = extended_message_signalled_interrupt_capability();
+    VERIFY(capability.has_value());
+    VERIFY(index < extended_message_signalled_interrupt_count());
+
+    // The lower 3 bits select the BAR the table lives in, the rest is the offset into it.
+    auto table_offset_and_bar = capability->read32(msix_table_offset_offset);
+    u8 bar_index = table_offset_and_bar & 0x7;
+    if (bar_index > 5)
+        return EINVAL;
+    u32 bar = PCI::get_BAR(pci_address(), bar_index);
+    if (bar & 1)
+        return ENOTSUP; // The table has to be memory mapped.
+    u64 table_address = bar & 0xfffffff0;
+    if (((bar >> 1) & 0b11) == 0b10) {
+        if (bar_index == 5)
+            return EINVAL;
+        table_address |= static_cast<u64>(PCI::get_BAR(pci_address(), bar_index + 1)) << 32;
+    }
+    table_address += (table_offset_and_bar & ~0x7u) + index * sizeof(MSIXTableEntry);
+
+    auto entry = TRY(Memory::map_typed_writable<volatile MSIXTableEntry>(PhysicalAddress(table_address)));
+    entry->vector_control = entry->vector_control | msix_vector_control_mask_bit;
+    entry->message_address_low = msix_message_address_base | (static_cast<u32>(destination_apic_id) << 12);
+    entry->message_address_high = 0;
+    // Edge triggered, fixed delivery mode.
+    entry->message_data = vector;
+    entry->vector_control = entry->vector_control & ~msix_vector_control_mask_bit;
+    return {};
 }
 
 }
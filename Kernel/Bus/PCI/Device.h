@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <AK/Error.h>
+#include <AK/Optional.h>
 #include <AK/Types.h>
 #include <Kernel/Bus/PCI/Definitions.h>
 
@@ -29,10 +31,18 @@ public:
     void enable_extended_message_signalled_interrupts();
     void disable_extended_message_signalled_interrupts();
 
+    // Number of entries in the MSI-X table, or 0 if the device isn't MSI-X capable.
+    size_t extended_message_signalled_interrupt_count() const;
+
+    // Points the given MSI-X table entry at an interrupt vector of the local APIC with the given ID, and unmasks it.
+    ErrorOr<void> configure_extended_message_signalled_interrupt(size_t index, u8 vector, u8 destination_apic_id);
+
 protected:
     explicit Device(Address pci_address);
 
 private:
+    Optional<Capability> extended_message_signalled_interrupt_capability() const;
+
     Address m_pci_address;
 };
 
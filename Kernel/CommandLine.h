@@ -90,6 +90,7 @@ public:
     [[nodiscard]] NonnullOwnPtrVector<KString> userspace_init_args() const;
     [[nodiscard]] StringView root_device() const;
     [[nodiscard]] bool is_nvme_polling_enabled() const;
+    [[nodiscard]] bool is_nvme_hybrid_polling_enabled() const;
     [[nodiscard]] size_t switch_to_tty() const;
 
 private:
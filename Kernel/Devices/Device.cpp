@@ -154,12 +154,26 @@ ErrorOr<NonnullOwnPtr<KString>> Device::pseudo_path(const OpenFileDescription&)
 void Device::process_next_queued_request(Badge<AsyncDeviceRequest>, const AsyncDeviceRequest& completed_request)
 {
     SpinlockLocker lock(m_requests_lock);
-    VERIFY(!m_requests.is_empty());
-    VERIFY(m_requests.first().ptr() == &completed_request);
-    m_requests.remove(m_requests.begin());
-    if (!m_requests.is_empty()) {
-        auto* next_request = m_requests.first().ptr();
-        next_request->do_start(move(lock));
+    VERIFY(m_requests_in_flight > 0);
+
+    // Requests are started in order, so the ones in flight are always at the front of the
+    // queue, but they may complete in any order.
+    size_t index = 0;
+    auto it = m_requests.begin();
+    while (it != m_requests.end() && (*it).ptr() != &completed_request) {
+        ++it;
+        ++index;
+    }
+    VERIFY(index < m_requests_in_flight);
+    m_requests.remove(it);
+    --m_requests_in_flight;
+
+    auto next = m_requests.begin();
+    for (size_t i = 0; i < m_requests_in_flight && next != m_requests.end(); ++i)
+        ++next;
+    if (next != m_requests.end()) {
+        ++m_requests_in_flight;
+        (*next)->do_start(move(lock));
     }
 
     evaluate_block_conditions();
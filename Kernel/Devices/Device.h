@@ -50,15 +50,20 @@ public:
     virtual void after_inserting();
     void process_next_queued_request(Badge<AsyncDeviceRequest>, const AsyncDeviceRequest&);
 
+    // How many requests the device can work on at the same time. Any further requests
+    // are queued, and started in order as the ones in flight complete.
+    virtual size_t max_concurrent_requests() const { return 1; }
+
     template<typename AsyncRequestType, typename... Args>
     ErrorOr<NonnullRefPtr<AsyncRequestType>> try_make_request(Args&&... args)
     {
         auto request = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) AsyncRequestType(*this, forward<Args>(args)...)));
         SpinlockLocker lock(m_requests_lock);
-        bool was_empty = m_requests.is_empty();
         m_requests.append(request);
-        if (was_empty)
+        if (m_requests_in_flight < max_concurrent_requests()) {
+            ++m_requests_in_flight;
             request->do_start(move(lock));
+        }
         return request;
     }
 
@@ -77,6 +82,7 @@ private:
 
     Spinlock m_requests_lock;
     DoublyLinkedList<RefPtr<AsyncDeviceRequest>> m_requests;
+    size_t m_requests_in_flight { 0 };
     RefPtr<SysFSDeviceComponent> m_sysfs_component;
 };
 
@@ -49,6 +49,7 @@ ErrorOr<size_t> DoubleBuffer::write(const UserOrKernelBuffer& data, size_t size)
 {
     if (!size)
         return 0;
+    MutexLocker write_locker(m_write_lock);
     MutexLocker locker(m_lock);
     size_t bytes_to_write = min(size, m_space_for_writing);
     u8* write_ptr = m_write_buffer->data + m_write_buffer->size;
@@ -60,6 +61,70 @@ ErrorOr<size_t> DoubleBuffer::write(const UserOrKernelBuffer& data, size_t size)
     return bytes_to_write;
 }
 
+ErrorOr<size_t> DoubleBuffer::write_with(size_t size, Function<ErrorOr<size_t>(UserOrKernelBuffer&, size_t)> const& callback)
+{
+    if (!size)
+        return 0;
+    MutexLocker write_locker(m_write_lock);
+
+    InnerBuffer* buffer = nullptr;
+    size_t offset = 0;
+    size_t bytes_to_write = 0;
+    {
+        MutexLocker locker(m_lock);
+        bytes_to_write = min(size, m_space_for_writing);
+        if (!bytes_to_write)
+            return 0;
+        buffer = m_write_buffer;
+        offset = buffer->size;
+    }
+
+    // NOTE: A reader may flip the buffers in the meantime, but only writers append to them, so the
+    //       reserved space still follows the data in the same inner buffer, whichever side it is on now.
+    auto user_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer->data + offset);
+    size_t nwritten = TRY(callback(user_buffer, bytes_to_write));
+    VERIFY(nwritten <= bytes_to_write);
+
+    MutexLocker locker(m_lock);
+    VERIFY(buffer->size == offset);
+    buffer->size += nwritten;
+    compute_lockfree_metadata();
+    if (m_unblock_callback && !m_empty)
+        m_unblock_callback();
+    return nwritten;
+}
+
+ErrorOr<size_t> DoubleBuffer::read_with(size_t size, Function<ErrorOr<size_t>(UserOrKernelBuffer const&, size_t)> const& callback)
+{
+    if (!size)
+        return 0;
+    MutexLocker read_locker(m_read_lock);
+
+    u8* data = nullptr;
+    size_t bytes_to_read = 0;
+    {
+        MutexLocker locker(m_lock);
+        if (m_read_buffer_index >= m_read_buffer->size && m_write_buffer->size != 0)
+            flip();
+        if (m_read_buffer_index >= m_read_buffer->size)
+            return 0;
+        bytes_to_read = min(m_read_buffer->size - m_read_buffer_index, size);
+        data = m_read_buffer->data + m_read_buffer_index;
+    }
+
+    // NOTE: Only readers consume data or flip the buffers, so the data stays in place while we don't hold m_lock.
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(data);
+    size_t nread = TRY(callback(buffer, bytes_to_read));
+    VERIFY(nread <= bytes_to_read);
+
+    MutexLocker locker(m_lock);
+    m_read_buffer_index += nread;
+    compute_lockfree_metadata();
+    if (m_unblock_callback && m_space_for_writing > 0)
+        m_unblock_callback();
+    return nread;
+}
+
 ErrorOr<size_t> DoubleBuffer::read_impl(UserOrKernelBuffer& data, size_t size, MutexLocker&, bool advance_buffer_index)
 {
     if (size == 0)
@@ -80,12 +145,14 @@ ErrorOr<size_t> DoubleBuffer::read_impl(UserOrKernelBuffer& data, size_t size, M
 
 ErrorOr<size_t> DoubleBuffer::read(UserOrKernelBuffer& data, size_t size)
 {
+    MutexLocker read_locker(m_read_lock);
     MutexLocker locker(m_lock);
     return read_impl(data, size, locker, true);
 }
 
 ErrorOr<size_t> DoubleBuffer::peek(UserOrKernelBuffer& data, size_t size)
 {
+    MutexLocker read_locker(m_read_lock);
     MutexLocker locker(m_lock);
     return read_impl(data, size, locker, false);
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Function.h>
 #include <AK/Types.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/Locking/Mutex.h>
@@ -35,6 +36,13 @@ public:
         return peek(buffer, size);
     }
 
+    // These hand the callback a slice of the buffer's own storage, so data can be moved
+    // between the buffer and a file without an intermediate copy. The callback returns
+    // how many bytes it actually produced or consumed. Only other readers (or writers) wait
+    // for the callback, so it may go on to write to (or read from) another DoubleBuffer.
+    ErrorOr<size_t> write_with(size_t, Function<ErrorOr<size_t>(UserOrKernelBuffer&, size_t)> const&);
+    ErrorOr<size_t> read_with(size_t, Function<ErrorOr<size_t>(UserOrKernelBuffer const&, size_t)> const&);
+
     bool is_empty() const { return m_empty; }
 
     size_t space_for_writing() const { return m_space_for_writing; }
@@ -73,6 +81,10 @@ private:
     size_t m_space_for_writing { 0 };
     bool m_empty { true };
     mutable Mutex m_lock { "DoubleBuffer" };
+    // Readers and writers are each serialized by a lock of their own, which read_with() and write_with()
+    // keep holding while the callback works on the storage without m_lock.
+    Mutex m_read_lock { "DoubleBuffer read" };
+    Mutex m_write_lock { "DoubleBuffer write" };
 };
 
 }
@@ -5,52 +5,120 @@
  */
 
 #include <AK/IntrusiveList.h>
+#include <AK/QuickSort.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/Locking/MutexProtected.h>
+#include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Process.h>
 
 namespace Kernel {
 
 struct CacheEntry {
     IntrusiveListNode<CacheEntry> list_node;
+    IntrusiveListNode<CacheEntry> dirty_list_node;
     BlockBasedFileSystem::BlockIndex block_index { 0 };
     u8* data { nullptr };
     bool has_data { false };
+    bool in_use { false };
+    bool is_protected { false };
 };
 
-class DiskCache {
+// The unit by which a cache shard grows and shrinks.
+struct CacheChunk {
+    static constexpr size_t EntryCount = 64;
+
+    explicit CacheChunk(NonnullOwnPtr<KBuffer> block_data)
+        : block_data(move(block_data))
+    {
+    }
+
+    IntrusiveListNode<CacheChunk> list_node;
+    NonnullOwnPtr<KBuffer> block_data;
+    Array<CacheEntry, EntryCount> entries;
+};
+
+static bool has_plenty_of_free_memory()
+{
+    auto info = MM.get_system_memory_info();
+    auto unavailable_pages = info.user_physical_pages_used + info.user_physical_pages_committed;
+    if (unavailable_pages >= info.user_physical_pages)
+        return false;
+    return info.user_physical_pages - unavailable_pages > info.user_physical_pages / 4;
+}
+
+// The underlying device may split large transfers into several shorter ones, so keep going until everything is done.
+static ErrorOr<void> read_fully(OpenFileDescription& description, u64 offset, UserOrKernelBuffer buffer, size_t size)
+{
+    while (size > 0) {
+        auto nread = TRY(description.read(buffer, offset, size));
+        if (nread == 0)
+            return EIO;
+        buffer = buffer.offset(nread);
+        offset += nread;
+        size -= nread;
+    }
+    return {};
+}
+
+static ErrorOr<void> write_fully(OpenFileDescription& description, u64 offset, UserOrKernelBuffer buffer, size_t size)
+{
+    while (size > 0) {
+        auto nwritten = TRY(description.write(offset, buffer, size));
+        if (nwritten == 0)
+            return EIO;
+        buffer = buffer.offset(nwritten);
+        offset += nwritten;
+        size -= nwritten;
+    }
+    return {};
+}
+
+// A shard of the disk cache, holding the blocks of every DiskCache::ShardCount'th stripe.
+//
+// Entries are kept in a segmented LRU: newly cached blocks start out on the probationary
+// list and are only promoted to the protected list once they are hit again. Eviction always
+// prefers probationary entries, so a large one-shot scan can't push out the working set.
+class DiskCacheShard {
 public:
-    static constexpr size_t EntryCount = 10000;
-    explicit DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> cached_block_data, NonnullOwnPtr<KBuffer> entries_buffer)
-        : m_fs(fs)
-        , m_cached_block_data(move(cached_block_data))
-        , m_entries(move(entries_buffer))
+    static constexpr size_t MinimumChunkCount = 2;
+    static constexpr size_t MaximumChunkCount = 20;
+
+    // The most blocks moved to or from the disk with a single request (a read-ahead or a run of dirty blocks).
+    static constexpr size_t MaximumTransferBlocks = 33;
+
+    DiskCacheShard() = default;
+
+    ~DiskCacheShard()
     {
-        for (size_t i = 0; i < EntryCount; ++i) {
-            entries()[i].data = m_cached_block_data->data() + i * m_fs.block_size();
-            m_clean_list.append(entries()[i]);
-        }
+        m_free_list.clear();
+        m_probationary_list.clear();
+        m_protected_list.clear();
+        m_dirty_list.clear();
+        while (auto* chunk = m_chunks.take_first())
+            delete chunk;
     }
 
-    ~DiskCache() = default;
+    ErrorOr<void> initialize(BlockBasedFileSystem& fs)
+    {
+        m_fs = &fs;
+        for (size_t i = 0; i < MinimumChunkCount; ++i)
+            TRY(grow());
+        return {};
+    }
 
     bool is_dirty() const { return !m_dirty_list.is_empty(); }
-    bool entry_is_dirty(CacheEntry const& entry) const { return m_dirty_list.contains(entry); }
+    bool entry_is_dirty(CacheEntry const& entry) const { return entry.dirty_list_node.is_in_list(); }
 
     void mark_all_clean()
     {
-        while (auto* entry = m_dirty_list.first())
-            m_clean_list.prepend(*entry);
+        m_dirty_list.clear();
     }
 
     void mark_dirty(CacheEntry& entry)
     {
-        m_dirty_list.prepend(entry);
-    }
-
-    void mark_clean(CacheEntry& entry)
-    {
-        m_clean_list.prepend(entry);
+        if (!entry.dirty_list_node.is_in_list())
+            m_dirty_list.append(entry);
     }
 
     CacheEntry* get(BlockBasedFileSystem::BlockIndex block_index) const
@@ -58,39 +126,32 @@ public:
         auto it = m_hash.find(block_index);
         if (it == m_hash.end())
             return nullptr;
-        auto& entry = const_cast<CacheEntry&>(*it->value);
+        auto& entry = *it->value;
         VERIFY(entry.block_index == block_index);
         return &entry;
     }
 
-    ErrorOr<CacheEntry*> ensure(BlockBasedFileSystem::BlockIndex block_index) const
+    ErrorOr<CacheEntry*> ensure(BlockBasedFileSystem::BlockIndex block_index)
     {
-        if (auto* entry = get(block_index))
+        if (auto* entry = get(block_index)) {
+            promote(*entry);
             return entry;
+        }
 
-        if (m_clean_list.is_empty()) {
+        auto* new_entry = take_unused_entry();
+        if (!new_entry) {
             // Not a single clean entry! Flush writes and try again.
-            // NOTE: We want to make sure we only call FileBackedFileSystem flush here,
-            //       not some FileBackedFileSystem subclass flush!
-            m_fs.flush_writes_impl();
+            flush();
             return ensure(block_index);
         }
 
-        VERIFY(m_clean_list.last());
-        auto& new_entry = *m_clean_list.last();
-        m_clean_list.prepend(new_entry);
-
-        m_hash.remove(new_entry.block_index);
-        TRY(m_hash.try_set(block_index, &new_entry));
-
-        new_entry.block_index = block_index;
-        new_entry.has_data = false;
-
-        return &new_entry;
+        TRY(install(*new_entry, block_index));
+        return new_entry;
     }
 
-    const CacheEntry* entries() const { return (const CacheEntry*)m_entries->data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries->data(); }
+    // Fills a freshly ensured entry from disk. If read_ahead_count is non-zero, the following
+    // blocks in the same stripe are fetched with the same request and cached as well.
+    ErrorOr<void> read_from_disk(CacheEntry& entry, size_t read_ahead_count);
 
     template<typename Callback>
     void for_each_dirty_entry(Callback callback)
@@ -99,15 +160,297 @@ public:
             callback(entry);
     }
 
+    // Writes out every dirty block, merging runs of consecutive blocks into a single request.
+    void flush()
+    {
+        if (m_dirty_list.is_empty())
+            return;
+
+        Vector<CacheEntry*, 64> dirty_entries;
+        for (auto& entry : m_dirty_list) {
+            if (dirty_entries.try_append(&entry).is_error()) {
+                flush_one_by_one();
+                return;
+            }
+        }
+        if (ensure_transfer_buffer().is_error()) {
+            flush_one_by_one();
+            return;
+        }
+        quick_sort(dirty_entries, [](auto* a, auto* b) { return a->block_index.value() < b->block_index.value(); });
+
+        auto block_size = m_fs->block_size();
+        for (size_t i = 0; i < dirty_entries.size();) {
+            auto first_block = dirty_entries[i]->block_index.value();
+            size_t run_length = 1;
+            while (i + run_length < dirty_entries.size() && run_length < MaximumTransferBlocks && dirty_entries[i + run_length]->block_index.value() == first_block + run_length)
+                ++run_length;
+
+            if (run_length == 1) {
+                write_entry(*dirty_entries[i]);
+            } else {
+                for (size_t j = 0; j < run_length; ++j)
+                    memcpy(m_transfer_buffer->data() + j * block_size, dirty_entries[i + j]->data, block_size);
+                auto transfer_buffer = UserOrKernelBuffer::for_kernel_buffer(m_transfer_buffer->data());
+                (void)write_fully(m_fs->file_description(), first_block * block_size, transfer_buffer, run_length * block_size);
+                dbgln_if(BBFS_DEBUG, "DiskCache: Flushed {} consecutive blocks starting at block {}", run_length, first_block);
+            }
+            i += run_length;
+        }
+        mark_all_clean();
+    }
+
+    // Gives chunks beyond the minimum back to the system, as long as none of their blocks are dirty.
+    void shrink()
+    {
+        while (m_chunk_count > MinimumChunkCount) {
+            auto& chunk = *m_chunks.last();
+            for (auto& entry : chunk.entries) {
+                if (entry_is_dirty(entry))
+                    return;
+            }
+            for (auto& entry : chunk.entries) {
+                if (entry.in_use)
+                    evict(entry);
+                else
+                    m_free_list.remove(entry);
+            }
+            m_chunks.remove(chunk);
+            delete &chunk;
+            --m_chunk_count;
+        }
+    }
+
 private:
-    BlockBasedFileSystem& m_fs;
-    mutable HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
-    mutable IntrusiveList<&CacheEntry::list_node> m_clean_list;
-    mutable IntrusiveList<&CacheEntry::list_node> m_dirty_list;
-    NonnullOwnPtr<KBuffer> m_cached_block_data;
-    NonnullOwnPtr<KBuffer> m_entries;
+    void write_entry(CacheEntry& entry)
+    {
+        auto base_offset = entry.block_index.value() * m_fs->block_size();
+        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+        [[maybe_unused]] auto rc = m_fs->file_description().write(base_offset, entry_data_buffer, m_fs->block_size());
+    }
+
+    void flush_one_by_one()
+    {
+        for (auto& entry : m_dirty_list)
+            write_entry(entry);
+        mark_all_clean();
+    }
+
+    ErrorOr<void> ensure_transfer_buffer()
+    {
+        if (!m_transfer_buffer)
+            m_transfer_buffer = TRY(KBuffer::try_create_with_size(MaximumTransferBlocks * m_fs->block_size(), Memory::Region::Access::ReadWrite, "DiskCache transfer"));
+        return {};
+    }
+
+    ErrorOr<void> grow()
+    {
+        auto block_data = TRY(KBuffer::try_create_with_size(CacheChunk::EntryCount * m_fs->block_size(), Memory::Region::Access::ReadWrite, "DiskCache"));
+        auto* chunk = new (nothrow) CacheChunk(move(block_data));
+        if (!chunk)
+            return ENOMEM;
+        for (size_t i = 0; i < CacheChunk::EntryCount; ++i) {
+            chunk->entries[i].data = chunk->block_data->data() + i * m_fs->block_size();
+            m_free_list.append(chunk->entries[i]);
+        }
+        m_chunks.append(*chunk);
+        ++m_chunk_count;
+        return {};
+    }
+
+    size_t entry_count() const { return m_chunk_count * CacheChunk::EntryCount; }
+
+    ErrorOr<void> install(CacheEntry& entry, BlockBasedFileSystem::BlockIndex block_index)
+    {
+        if (auto result = m_hash.try_set(block_index, &entry); result.is_error()) {
+            m_free_list.prepend(entry);
+            return result.release_error();
+        }
+        entry.block_index = block_index;
+        entry.has_data = false;
+        entry.in_use = true;
+        entry.is_protected = false;
+        m_probationary_list.prepend(entry);
+        return {};
+    }
+
+    void promote(CacheEntry& entry)
+    {
+        if (!entry.is_protected) {
+            entry.is_protected = true;
+            ++m_protected_count;
+        }
+        m_protected_list.prepend(entry);
+
+        // Keep room on the probationary list so new blocks get a chance to prove themselves.
+        while (m_protected_count > entry_count() * 3 / 4) {
+            auto& demoted_entry = *m_protected_list.last();
+            demoted_entry.is_protected = false;
+            --m_protected_count;
+            m_probationary_list.prepend(demoted_entry);
+        }
+    }
+
+    void evict(CacheEntry& entry)
+    {
+        VERIFY(entry.in_use);
+        VERIFY(!entry_is_dirty(entry));
+        m_hash.remove(entry.block_index);
+        entry.list_node.remove();
+        if (entry.is_protected)
+            --m_protected_count;
+        entry.in_use = false;
+        entry.has_data = false;
+        entry.is_protected = false;
+    }
+
+    static CacheEntry* find_eviction_candidate(IntrusiveList<&CacheEntry::list_node>& list, CacheEntry const* entry_to_keep)
+    {
+        for (auto it = list.rbegin(); it != list.rend(); ++it) {
+            if (&*it != entry_to_keep && !it->dirty_list_node.is_in_list())
+                return &*it;
+        }
+        return nullptr;
+    }
+
+    CacheEntry* take_unused_entry(CacheEntry const* entry_to_keep = nullptr)
+    {
+        if (m_free_list.is_empty() && m_chunk_count < MaximumChunkCount && has_plenty_of_free_memory()) {
+            // If we can't grow right now, we'll just evict something instead.
+            (void)grow();
+        }
+        if (auto* entry = m_free_list.take_first())
+            return entry;
+
+        auto* victim = find_eviction_candidate(m_probationary_list, entry_to_keep);
+        if (!victim)
+            victim = find_eviction_candidate(m_protected_list, entry_to_keep);
+        if (!victim)
+            return nullptr;
+        evict(*victim);
+        return victim;
+    }
+
+    BlockBasedFileSystem* m_fs { nullptr };
+    HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
+    IntrusiveList<&CacheEntry::list_node> m_free_list;
+    IntrusiveList<&CacheEntry::list_node> m_probationary_list;
+    IntrusiveList<&CacheEntry::list_node> m_protected_list;
+    IntrusiveList<&CacheEntry::dirty_list_node> m_dirty_list;
+    IntrusiveList<&CacheChunk::list_node> m_chunks;
+    size_t m_chunk_count { 0 };
+    size_t m_protected_count { 0 };
+    OwnPtr<KBuffer> m_transfer_buffer;
+};
+
+class DiskCache {
+public:
+    static constexpr size_t ShardCount = 8;
+
+    // Consecutive blocks are grouped into stripes that live in the same shard, so that
+    // read-ahead never has to take more than one shard lock.
+    static constexpr u64 BlocksPerStripe = 64;
+
+    static constexpr size_t MaximumReadAheadBlocks = DiskCacheShard::MaximumTransferBlocks - 1;
+
+    static ErrorOr<NonnullOwnPtr<DiskCache>> try_create(BlockBasedFileSystem& fs)
+    {
+        auto cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache));
+        for (auto& shard : cache->m_shards)
+            TRY(shard.with_exclusive([&](auto& shard) { return shard.initialize(fs); }));
+        return cache;
+    }
+
+    MutexProtected<DiskCacheShard>& shard_for(BlockBasedFileSystem::BlockIndex block_index)
+    {
+        return m_shards[(block_index.value() / BlocksPerStripe) % ShardCount];
+    }
+
+    template<typename Callback>
+    void for_each_shard(Callback callback)
+    {
+        for (auto& shard : m_shards)
+            callback(shard);
+    }
+
+    static size_t blocks_left_in_stripe(BlockBasedFileSystem::BlockIndex block_index)
+    {
+        return BlocksPerStripe - 1 - (block_index.value() % BlocksPerStripe);
+    }
+
+    // Tracks the access pattern and returns how many blocks following the requested
+    // range should be read ahead if they aren't cached yet.
+    size_t note_read(BlockBasedFileSystem::BlockIndex block_index, size_t count = 1)
+    {
+        auto previous_block = m_last_read_block.exchange(block_index.value() + count - 1, AK::MemoryOrder::memory_order_relaxed);
+        if (block_index.value() == previous_block)
+            return m_read_ahead_blocks.load(AK::MemoryOrder::memory_order_relaxed);
+        if (block_index.value() != previous_block + 1) {
+            m_read_ahead_blocks.store(0, AK::MemoryOrder::memory_order_relaxed);
+            return 0;
+        }
+
+        // Sequential access: open up the read-ahead window, doubling it every time the pattern continues.
+        auto read_ahead_blocks = m_read_ahead_blocks.load(AK::MemoryOrder::memory_order_relaxed);
+        read_ahead_blocks = clamp<size_t>(read_ahead_blocks * 2, 4, MaximumReadAheadBlocks);
+        m_read_ahead_blocks.store(read_ahead_blocks, AK::MemoryOrder::memory_order_relaxed);
+        return read_ahead_blocks;
+    }
+
+private:
+    DiskCache() = default;
+
+    Array<MutexProtected<DiskCacheShard>, ShardCount> m_shards;
+    Atomic<u64> m_last_read_block { NumericLimits<u64>::max() - 1 };
+    Atomic<size_t> m_read_ahead_blocks { 0 };
 };
 
+ErrorOr<void> DiskCacheShard::read_from_disk(CacheEntry& entry, size_t read_ahead_count)
+{
+    VERIFY(!entry.has_data);
+    auto block_size = m_fs->block_size();
+    auto base_offset = entry.block_index.value() * block_size;
+
+    // Don't read past the end of this stripe (its successor lives in another shard),
+    // and don't let read-ahead churn through more than a quarter of the shard.
+    read_ahead_count = min(read_ahead_count, DiskCache::blocks_left_in_stripe(entry.block_index));
+    read_ahead_count = min(read_ahead_count, min(entry_count() / 4, MaximumTransferBlocks - 1));
+
+    if (read_ahead_count > 0 && ensure_transfer_buffer().is_error())
+        read_ahead_count = 0;
+
+    if (read_ahead_count == 0) {
+        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+        auto nread = TRY(m_fs->file_description().read(entry_data_buffer, base_offset, block_size));
+        VERIFY(nread == block_size);
+        entry.has_data = true;
+        return {};
+    }
+
+    auto transfer_buffer = UserOrKernelBuffer::for_kernel_buffer(m_transfer_buffer->data());
+    auto nread = TRY(m_fs->file_description().read(transfer_buffer, base_offset, (read_ahead_count + 1) * block_size));
+    VERIFY(nread >= block_size);
+    memcpy(entry.data, m_transfer_buffer->data(), block_size);
+    entry.has_data = true;
+
+    // NOTE: We hold this shard's lock, so none of these blocks can have been written to since we read them.
+    size_t blocks_read = nread / block_size;
+    for (size_t i = 1; i < blocks_read; ++i) {
+        BlockBasedFileSystem::BlockIndex block_index { entry.block_index.value() + i };
+        if (get(block_index))
+            continue;
+        auto* read_ahead_entry = take_unused_entry(&entry);
+        if (!read_ahead_entry)
+            break;
+        if (install(*read_ahead_entry, block_index).is_error())
+            break;
+        memcpy(read_ahead_entry->data, m_transfer_buffer->data() + i * block_size, block_size);
+        read_ahead_entry->has_data = true;
+    }
+    dbgln_if(BBFS_DEBUG, "DiskCache: Read {} blocks ahead of block {}", blocks_read - 1, entry.block_index);
+    return {};
+}
+
 BlockBasedFileSystem::BlockBasedFileSystem(OpenFileDescription& file_description)
     : FileBackedFileSystem(file_description)
 {
@@ -121,13 +464,7 @@ BlockBasedFileSystem::~BlockBasedFileSystem()
 ErrorOr<void> BlockBasedFileSystem::initialize()
 {
     VERIFY(block_size() != 0);
-    auto cached_block_data = TRY(KBuffer::try_create_with_size(DiskCache::EntryCount * block_size()));
-    auto entries_data = TRY(KBuffer::try_create_with_size(DiskCache::EntryCount * sizeof(CacheEntry)));
-    auto disk_cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(*this, move(cached_block_data), move(entries_data))));
-
-    m_cache.with_exclusive([&](auto& cache) {
-        cache = move(disk_cache);
-    });
+    m_cache = TRY(DiskCache::try_create(*this));
     return {};
 }
 
@@ -144,7 +481,7 @@ ErrorOr<void> BlockBasedFileSystem::write_block(BlockIndex index, const UserOrKe
 
     TRY(data.read(buffered_data.bytes()));
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
+    return m_cache->shard_for(index).with_exclusive([&](auto& shard) -> ErrorOr<void> {
         if (!allow_cache) {
             flush_specific_block_if_needed(index);
             u64 base_offset = index.value() * block_size() + offset;
@@ -153,14 +490,14 @@ ErrorOr<void> BlockBasedFileSystem::write_block(BlockIndex index, const UserOrKe
             return {};
         }
 
-        auto entry = TRY(cache->ensure(index));
-        if (count < block_size()) {
+        auto entry = TRY(shard.ensure(index));
+        if (count < block_size() && !entry->has_data) {
             // Fill the cache first.
-            TRY(read_block(index, nullptr, block_size()));
+            TRY(shard.read_from_disk(*entry, 0));
         }
         memcpy(entry->data + offset, buffered_data.data(), count);
 
-        cache->mark_dirty(*entry);
+        shard.mark_dirty(*entry);
         entry->has_data = true;
         return {};
     });
@@ -184,30 +521,47 @@ ErrorOr<void> BlockBasedFileSystem::raw_write(BlockIndex index, const UserOrKern
 
 ErrorOr<void> BlockBasedFileSystem::raw_read_blocks(BlockIndex index, size_t count, UserOrKernelBuffer& buffer)
 {
-    auto current = buffer;
-    for (auto block = index.value(); block < (index.value() + count); block++) {
-        TRY(raw_read(BlockIndex { block }, current));
-        current = current.offset(logical_block_size());
-    }
-    return {};
+    return read_fully(file_description(), index.value() * m_logical_block_size, buffer, count * m_logical_block_size);
 }
 
 ErrorOr<void> BlockBasedFileSystem::raw_write_blocks(BlockIndex index, size_t count, const UserOrKernelBuffer& buffer)
 {
-    auto current = buffer;
-    for (auto block = index.value(); block < (index.value() + count); block++) {
-        TRY(raw_write(block, current));
-        current = current.offset(logical_block_size());
-    }
-    return {};
+    return write_fully(file_description(), index.value() * m_logical_block_size, buffer, count * m_logical_block_size);
 }
 
 ErrorOr<void> BlockBasedFileSystem::write_blocks(BlockIndex index, unsigned count, const UserOrKernelBuffer& data, bool allow_cache)
 {
     VERIFY(m_logical_block_size);
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::write_blocks {}, count={}", index, count);
-    for (unsigned i = 0; i < count; ++i) {
-        TRY(write_block(BlockIndex { index.value() + i }, data.offset(i * block_size()), block_size(), 0, allow_cache));
+    if (count == 1)
+        return write_block(index, data, block_size(), 0, allow_cache);
+
+    if (!allow_cache) {
+        for (unsigned i = 0; i < count; ++i)
+            flush_specific_block_if_needed(BlockIndex { index.value() + i });
+        return write_fully(file_description(), index.value() * block_size(), data, count * block_size());
+    }
+
+    auto buffered_data = TRY(ByteBuffer::create_uninitialized(min<size_t>(count, DiskCache::BlocksPerStripe) * block_size()));
+
+    // Blocks in the same stripe share a shard, so each stripe only takes the shard lock once.
+    for (unsigned i = 0; i < count;) {
+        BlockIndex first_block { index.value() + i };
+        auto segment_length = min<size_t>(count - i, DiskCache::blocks_left_in_stripe(first_block) + 1);
+
+        // NOTE: As in write_block(), take any page faults on the source data before tying down the cache.
+        TRY(data.read(buffered_data.data(), i * block_size(), segment_length * block_size()));
+
+        TRY(m_cache->shard_for(first_block).with_exclusive([&](auto& shard) -> ErrorOr<void> {
+            for (size_t j = 0; j < segment_length; ++j) {
+                auto* entry = TRY(shard.ensure(BlockIndex { first_block.value() + j }));
+                memcpy(entry->data, buffered_data.data() + j * block_size(), block_size());
+                shard.mark_dirty(*entry);
+                entry->has_data = true;
+            }
+            return {};
+        }));
+        i += segment_length;
     }
     return {};
 }
@@ -218,7 +572,9 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
     VERIFY(offset + count <= block_size());
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}", index);
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
+    size_t read_ahead_count = allow_cache ? m_cache->note_read(index) : 0;
+
+    return m_cache->shard_for(index).with_exclusive([&](auto& shard) -> ErrorOr<void> {
         if (!allow_cache) {
             const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(index);
             u64 base_offset = index.value() * block_size() + offset;
@@ -227,14 +583,9 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
             return {};
         }
 
-        auto* entry = TRY(cache->ensure(index));
-        if (!entry->has_data) {
-            auto base_offset = index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
-            auto nread = TRY(file_description().read(entry_data_buffer, base_offset, block_size()));
-            VERIFY(nread == block_size());
-            entry->has_data = true;
-        }
+        auto* entry = TRY(shard.ensure(index));
+        if (!entry->has_data)
+            TRY(shard.read_from_disk(*entry, read_ahead_count));
         if (buffer)
             TRY(buffer->write(entry->data + offset, count));
         return {};
@@ -248,24 +599,43 @@ ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count
         return EINVAL;
     if (count == 1)
         return read_block(index, &buffer, block_size(), 0, allow_cache);
-    auto out = buffer;
-    for (unsigned i = 0; i < count; ++i) {
-        TRY(read_block(BlockIndex { index.value() + i }, &out, block_size(), 0, allow_cache));
-        out = out.offset(block_size());
+
+    if (!allow_cache) {
+        for (unsigned i = 0; i < count; ++i)
+            const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(BlockIndex { index.value() + i });
+        return read_fully(file_description(), index.value() * block_size(), buffer, count * block_size());
     }
 
+    size_t read_ahead_count = m_cache->note_read(index, count);
+
+    // Blocks in the same stripe share a shard, so each stripe only takes the shard lock once.
+    // On a miss, the rest of the request (plus any read-ahead) is fetched with a single disk read.
+    for (unsigned i = 0; i < count;) {
+        BlockIndex first_block { index.value() + i };
+        auto segment_length = min<size_t>(count - i, DiskCache::blocks_left_in_stripe(first_block) + 1);
+        TRY(m_cache->shard_for(first_block).with_exclusive([&](auto& shard) -> ErrorOr<void> {
+            for (size_t j = 0; j < segment_length; ++j) {
+                auto* entry = TRY(shard.ensure(BlockIndex { first_block.value() + j }));
+                if (!entry->has_data)
+                    TRY(shard.read_from_disk(*entry, (count - i - j - 1) + read_ahead_count));
+                TRY(buffer.write(entry->data, (i + j) * block_size(), block_size()));
+            }
+            return {};
+        }));
+        i += segment_length;
+    }
     return {};
 }
 
 void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
 {
-    m_cache.with_exclusive([&](auto& cache) {
-        if (!cache->is_dirty())
+    m_cache->shard_for(index).with_exclusive([&](auto& shard) {
+        if (!shard.is_dirty())
             return;
-        auto* entry = cache->get(index);
+        auto* entry = shard.get(index);
         if (!entry)
             return;
-        if (!cache->entry_is_dirty(*entry))
+        if (!shard.entry_is_dirty(*entry))
             return;
         size_t base_offset = entry->block_index.value() * block_size();
         auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
@@ -276,18 +646,17 @@ void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
 void BlockBasedFileSystem::flush_writes_impl()
 {
     size_t count = 0;
-    m_cache.with_exclusive([&](auto& cache) {
-        if (!cache->is_dirty())
-            return;
-        cache->for_each_dirty_entry([&](CacheEntry& entry) {
-            auto base_offset = entry.block_index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-            [[maybe_unused]] auto rc = file_description().write(base_offset, entry_data_buffer, block_size());
-            ++count;
+    bool should_shrink = !has_plenty_of_free_memory();
+    m_cache->for_each_shard([&](auto& locked_shard) {
+        locked_shard.with_exclusive([&](auto& shard) {
+            shard.for_each_dirty_entry([&](CacheEntry&) { ++count; });
+            shard.flush();
+            if (should_shrink)
+                shard.shrink();
         });
-        cache->mark_all_clean();
-        dbgln("{}: Flushed {} blocks to disk", class_name(), count);
     });
+    if (count > 0)
+        dbgln("{}: Flushed {} blocks to disk", class_name(), count);
 }
 
 void BlockBasedFileSystem::flush_writes()
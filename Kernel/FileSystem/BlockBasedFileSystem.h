@@ -7,7 +7,6 @@
 #pragma once
 
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
-#include <Kernel/Locking/MutexProtected.h>
 
 namespace Kernel {
 
@@ -41,10 +40,9 @@ protected:
     u64 m_logical_block_size { 512 };
 
 private:
-    DiskCache& cache() const;
     void flush_specific_block_if_needed(BlockIndex index);
 
-    mutable MutexProtected<OwnPtr<DiskCache>> m_cache;
+    mutable OwnPtr<DiskCache> m_cache;
 };
 
 }
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+static BlockFlags block_flags_for_events(u32 events)
+{
+    BlockFlags block_flags = BlockFlags::Exception;
+    if (events & EPOLLIN)
+        block_flags |= BlockFlags::Read;
+    if (events & EPOLLOUT)
+        block_flags |= BlockFlags::Write;
+    if (events & EPOLLPRI)
+        block_flags |= BlockFlags::ReadPriority;
+    return block_flags;
+}
+
+static u32 events_for_unblocked_flags(BlockFlags unblocked_flags)
+{
+    u32 events = 0;
+    if (has_flag(unblocked_flags, BlockFlags::Read))
+        events |= EPOLLIN;
+    if (has_flag(unblocked_flags, BlockFlags::ReadPriority))
+        events |= EPOLLPRI;
+    if (has_flag(unblocked_flags, BlockFlags::Write))
+        events |= EPOLLOUT;
+    if (has_flag(unblocked_flags, BlockFlags::ReadHangUp))
+        events |= EPOLLRDHUP;
+    if (has_flag(unblocked_flags, BlockFlags::WriteError))
+        events |= EPOLLERR;
+    if (has_flag(unblocked_flags, BlockFlags::WriteHangUp))
+        events |= EPOLLHUP;
+    return events;
+}
+
+ErrorOr<NonnullRefPtr<EPoll>> EPoll::try_create()
+{
+    return adopt_nonnull_ref_or_enomem(new (nothrow) EPoll);
+}
+
+EPoll::~EPoll()
+{
+    (void)close();
+}
+
+bool EPoll::can_read(const OpenFileDescription&, u64) const
+{
+    SpinlockLocker locker(m_lock);
+    return !m_ready_watches.is_empty();
+}
+
+ErrorOr<void> EPoll::close()
+{
+    // The files' watch lists have to be locked before our own lock, so we can't simply
+    // walk our watches. Instead, pick one at a time and unlink it from its file.
+    for (;;) {
+        RefPtr<File> file;
+        OpenFileDescription const* description = nullptr;
+        int fd = -1;
+        {
+            SpinlockLocker locker(m_lock);
+            if (m_watches.is_empty())
+                break;
+            auto& watch = *m_watches.begin()->value;
+            // NOTE: The description can't go away while we hold the lock, as it has to
+            //       unlink the watch first.
+            file = watch.description->file();
+            description = watch.description;
+            fd = watch.fd;
+        }
+        // If the description went away in the meantime, the watch is already gone.
+        (void)unlink_watch(fd, description, *file);
+    }
+    return {};
+}
+
+ErrorOr<NonnullOwnPtr<KString>> EPoll::pseudo_path(const OpenFileDescription&) const
+{
+    SpinlockLocker locker(m_lock);
+    return KString::formatted("EPoll:({})", m_watches.size());
+}
+
+ErrorOr<void> EPoll::add_watch(int fd, OpenFileDescription& description, epoll_event const& event)
+{
+    // FIXME: Support nesting EPoll instances. This needs to rule out cycles.
+    if (description.is_epoll())
+        return EINVAL;
+
+    auto watch = TRY(adopt_nonnull_own_or_enomem(new (nothrow) EPollWatch { *this, &description, fd, event.events, event.data.u64 }));
+    TRY(description.file().epoll_watches().with([&](auto& file_watches) -> ErrorOr<void> {
+        SpinlockLocker locker(m_lock);
+        EPollWatchKey key { fd, &description };
+        if (m_watches.contains(key))
+            return EEXIST;
+        auto& new_watch = *watch;
+        TRY(m_watches.try_set(key, move(watch)));
+        file_watches.append(new_watch);
+        // The description may already be ready, which we have to report even in edge-triggered mode.
+        m_ready_watches.append(new_watch);
+        return {};
+    }));
+    evaluate_block_conditions();
+    return {};
+}
+
+ErrorOr<void> EPoll::modify_watch(int fd, OpenFileDescription& description, epoll_event const& event)
+{
+    TRY(description.file().epoll_watches().with([&](auto&) -> ErrorOr<void> {
+        SpinlockLocker locker(m_lock);
+        auto it = m_watches.find(EPollWatchKey { fd, &description });
+        if (it == m_watches.end())
+            return ENOENT;
+        auto& watch = *it->value;
+        watch.events = event.events;
+        watch.data = event.data.u64;
+        watch.is_disabled = false;
+        if (!watch.ready_list_node.is_in_list())
+            m_ready_watches.append(watch);
+        return {};
+    }));
+    evaluate_block_conditions();
+    return {};
+}
+
+ErrorOr<void> EPoll::remove_watch(int fd, OpenFileDescription& description)
+{
+    if (!unlink_watch(fd, &description, description.file()))
+        return ENOENT;
+    return {};
+}
+
+bool EPoll::unlink_watch(int fd, OpenFileDescription const* description, File& file)
+{
+    return file.epoll_watches().with([&](auto& file_watches) {
+        SpinlockLocker locker(m_lock);
+        auto it = m_watches.find(EPollWatchKey { fd, description });
+        if (it == m_watches.end())
+            return false;
+        auto& watch = *it->value;
+        file_watches.remove(watch);
+        if (watch.ready_list_node.is_in_list())
+            m_ready_watches.remove(watch);
+        m_watches.remove(it);
+        return true;
+    });
+}
+
+void EPoll::forget_watch(Badge<File>, EPollWatch& watch)
+{
+    // NOTE: The watch's file holds the lock of its watch list.
+    SpinlockLocker locker(m_lock);
+    watch.file_list_node.remove();
+    if (watch.ready_list_node.is_in_list())
+        m_ready_watches.remove(watch);
+    m_watches.remove(EPollWatchKey { watch.fd, watch.description });
+}
+
+void EPoll::file_did_change_state(Badge<File>, EPollWatch& watch)
+{
+    {
+        SpinlockLocker locker(m_lock);
+        if (watch.is_disabled || watch.ready_list_node.is_in_list())
+            return;
+        m_ready_watches.append(watch);
+    }
+    evaluate_block_conditions();
+}
+
+size_t EPoll::collect_events(Span<epoll_event> events)
+{
+    SpinlockLocker locker(m_lock);
+
+    EPollWatch::ReadyList still_ready_watches;
+    size_t event_count = 0;
+    while (event_count < events.size()) {
+        auto* watch = m_ready_watches.take_first();
+        if (!watch)
+            break;
+
+        // Watches are queued whenever their file changes state, which doesn't mean that they
+        // are ready for the events we're interested in.
+        auto unblocked_flags = watch->description->should_unblock(block_flags_for_events(watch->events));
+        if (unblocked_flags == BlockFlags::None)
+            continue;
+
+        auto& event = events[event_count++];
+        event.events = events_for_unblocked_flags(unblocked_flags);
+        event.data.u64 = watch->data;
+
+        if (watch->events & EPOLLONESHOT)
+            watch->is_disabled = true;
+        else if (!(watch->events & EPOLLET))
+            still_ready_watches.append(*watch);
+    }
+
+    // Level-triggered watches are checked again on the next wait, after the ones we haven't
+    // gotten to yet.
+    while (auto* watch = still_ready_watches.take_first())
+        m_ready_watches.append(*watch);
+
+    return event_count;
+}
+
+}
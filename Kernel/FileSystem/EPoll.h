@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Span.h>
+#include <Kernel/API/POSIX/sys/epoll.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Forward.h>
+#include <Kernel/Locking/Spinlock.h>
+
+namespace Kernel {
+
+// Like Linux, we identify watches by both the fd and the description, so an fd that was
+// closed and reused for another description while the old one is still open elsewhere
+// (e.g. after a dup() or fork()) gets a watch of its own.
+struct EPollWatchKey {
+    int fd { -1 };
+    OpenFileDescription const* description { nullptr };
+
+    bool operator==(EPollWatchKey const&) const = default;
+};
+
+// An EPoll instance keeps a persistent set of file descriptions to watch for
+// readiness. Instead of scanning every watched description on each wait, it
+// is told by the watched files whenever their state changes and keeps a list
+// of watches that may have events to report.
+//
+// Watches are level-triggered by default, which means they keep being reported
+// for as long as the description is ready. Edge-triggered watches (EPOLLET)
+// are only reported again after the file has changed state.
+class EPoll final : public File {
+public:
+    static ErrorOr<NonnullRefPtr<EPoll>> try_create();
+    virtual ~EPoll() override;
+
+    virtual bool can_read(const OpenFileDescription&, u64) const override;
+    virtual ErrorOr<size_t> read(OpenFileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual bool can_write(const OpenFileDescription&, u64) const override { return true; }
+    virtual ErrorOr<size_t> write(OpenFileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual ErrorOr<void> close() override;
+
+    virtual ErrorOr<NonnullOwnPtr<KString>> pseudo_path(const OpenFileDescription&) const override;
+    virtual StringView class_name() const override { return "EPoll"sv; }
+    virtual bool is_epoll() const override { return true; }
+
+    ErrorOr<void> add_watch(int fd, OpenFileDescription&, epoll_event const&);
+    ErrorOr<void> modify_watch(int fd, OpenFileDescription&, epoll_event const&);
+    ErrorOr<void> remove_watch(int fd, OpenFileDescription&);
+
+    // Fills in events for watches that are currently ready and returns how many were filled in.
+    size_t collect_events(Span<epoll_event>);
+
+    void file_did_change_state(Badge<File>, EPollWatch&);
+    void forget_watch(Badge<File>, EPollWatch&);
+
+private:
+    EPoll() = default;
+
+    bool unlink_watch(int fd, OpenFileDescription const*, File&);
+
+    mutable Spinlock m_lock;
+    HashMap<EPollWatchKey, NonnullOwnPtr<EPollWatch>> m_watches;
+    EPollWatch::ReadyList m_ready_watches;
+};
+
+}
+
+namespace AK {
+
+template<>
+struct Traits<Kernel::EPollWatchKey> : public GenericTraits<Kernel::EPollWatchKey> {
+    static unsigned hash(Kernel::EPollWatchKey const& key) { return pair_int_hash(key.fd, ptr_hash(key.description)); }
+};
+
+}
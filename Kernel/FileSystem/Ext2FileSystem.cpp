@@ -127,6 +127,7 @@ ErrorOr<void> Ext2FS::initialize()
     m_cached_group_descriptor_table = TRY(KBuffer::try_create_with_size(block_size() * blocks_to_read, Memory::Region::Access::ReadWrite, "Ext2FS: Block group descriptors"));
     auto buffer = UserOrKernelBuffer::for_kernel_buffer(m_cached_group_descriptor_table->data());
     TRY(read_blocks(first_block_of_bgdt, blocks_to_read, buffer));
+    TRY(m_block_group_summaries.try_resize(m_block_group_count));
 
     if constexpr (EXT2_DEBUG) {
         for (unsigned i = 1; i <= m_block_group_count; ++i) {
@@ -614,6 +615,8 @@ ErrorOr<void> Ext2FS::free_inode(Ext2FSInode& inode)
     VERIFY(inode.m_raw_inode.i_links_count == 0);
     dbgln_if(EXT2_DEBUG, "Ext2FS[{}]::free_inode(): Inode {} has no more links, time to delete!", fsid(), inode.index());
 
+    TRY(discard_preallocation_window(inode.index()));
+
     // Mark all blocks used by this inode as free.
     {
         auto blocks = TRY(inode.compute_block_list_with_meta_blocks());
@@ -697,6 +700,17 @@ void Ext2FS::flush_writes()
 
             return cached_inode->ref_count() == 1 && !cached_inode->has_watchers();
         });
+
+        // Inodes that were uncached aren't open anywhere, so they won't grow into their preallocation windows anytime soon.
+        Vector<InodeIndex> inodes_with_unused_windows;
+        for (auto& it : m_preallocation_windows) {
+            if (!m_inode_cache.contains(it.key) && inodes_with_unused_windows.try_append(it.key).is_error())
+                break;
+        }
+        for (auto inode_index : inodes_with_unused_windows) {
+            if (auto result = discard_preallocation_window(inode_index); result.is_error())
+                dbgln("Ext2FS[{}]::flush_writes(): Failed to discard preallocated blocks of inode {}: {}", fsid(), inode_index, result.error());
+        }
     }
 
     BlockBasedFileSystem::flush_writes();
@@ -800,6 +814,21 @@ ErrorOr<NonnullRefPtr<Inode>> Ext2FS::get_inode(InodeIdentifier inode) const
     return new_inode;
 }
 
+// Returns how many whole blocks starting at first_logical_index are laid out back to back on disk,
+// so that they can be transferred with a single read_blocks() or write_blocks() call.
+size_t Ext2FSInode::contiguous_block_run_length(BlockBasedFileSystem::BlockIndex first_logical_index, BlockBasedFileSystem::BlockIndex last_logical_index, size_t offset_into_block, u64 remaining_count) const
+{
+    if (offset_into_block != 0)
+        return 1;
+    auto first_block = m_block_list[first_logical_index.value()].value();
+    size_t run_length = 1;
+    while (first_logical_index.value() + run_length <= last_logical_index.value()
+        && (run_length + 1) * fs().block_size() <= remaining_count
+        && m_block_list[first_logical_index.value() + run_length].value() == first_block + run_length)
+        ++run_length;
+    return run_length;
+}
+
 ErrorOr<size_t> Ext2FSInode::read_bytes(off_t offset, size_t count, UserOrKernelBuffer& buffer, OpenFileDescription* description) const
 {
     MutexLocker inode_locker(m_inode_lock);
@@ -851,6 +880,13 @@ ErrorOr<size_t> Ext2FSInode::read_bytes(off_t offset, size_t count, UserOrKernel
         if (block_index.value() == 0) {
             // This is a hole, act as if it's filled with zeroes.
             TRY(buffer_offset.memset(0, num_bytes_to_copy));
+        } else if (auto run_length = contiguous_block_run_length(bi, last_block_logical_index, offset_into_block, remaining_count); run_length > 1) {
+            num_bytes_to_copy = run_length * block_size;
+            if (auto result = fs().read_blocks(block_index, run_length, buffer_offset, allow_cache); result.is_error()) {
+                dmesgln("Ext2FSInode[{}]::read_bytes(): Failed to read {} blocks starting at block {} (index {})", identifier(), run_length, block_index.value(), bi);
+                return result.release_error();
+            }
+            bi = bi.value() + run_length - 1;
         } else {
             if (auto result = fs().read_block(block_index, &buffer_offset, num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
                 dmesgln("Ext2FSInode[{}]::read_bytes(): Failed to read block {} (index {})", identifier(), block_index.value(), bi);
@@ -884,7 +920,7 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
 
     if (blocks_needed_after > blocks_needed_before) {
         auto additional_blocks_needed = blocks_needed_after - blocks_needed_before;
-        if (additional_blocks_needed > fs().super_block().s_free_blocks_count)
+        if (additional_blocks_needed > fs().free_block_count())
             return ENOSPC;
     }
 
@@ -892,7 +928,7 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
         m_block_list = TRY(compute_block_list());
 
     if (blocks_needed_after > blocks_needed_before) {
-        auto blocks = TRY(fs().allocate_blocks(fs().group_index_from_inode(index()), blocks_needed_after - blocks_needed_before));
+        auto blocks = TRY(fs().allocate_data_blocks(*this, blocks_needed_after - blocks_needed_before));
         TRY(m_block_list.try_extend(move(blocks)));
     } else if (blocks_needed_after < blocks_needed_before) {
         if constexpr (EXT2_VERY_DEBUG) {
@@ -901,6 +937,7 @@ ErrorOr<void> Ext2FSInode::resize(u64 new_size)
                 dbgln("    # {}", block_index);
             }
         }
+        TRY(fs().discard_preallocation_window(index()));
         while (m_block_list.size() != blocks_needed_after) {
             auto block_index = m_block_list.take_last();
             if (block_index.value()) {
@@ -991,7 +1028,14 @@ ErrorOr<size_t> Ext2FSInode::write_bytes(off_t offset, size_t count, const UserO
         size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
         size_t num_bytes_to_copy = min((size_t)block_size - offset_into_block, (size_t)remaining_count);
         dbgln_if(EXT2_DEBUG, "Ext2FSInode[{}]::write_bytes(): Writing block {} (offset_into_block: {})", identifier(), m_block_list[bi.value()], offset_into_block);
-        if (auto result = fs().write_block(m_block_list[bi.value()], data.offset(nwritten), num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
+        if (auto run_length = contiguous_block_run_length(bi, last_block_logical_index, offset_into_block, remaining_count); run_length > 1) {
+            num_bytes_to_copy = run_length * block_size;
+            if (auto result = fs().write_blocks(m_block_list[bi.value()], run_length, data.offset(nwritten), allow_cache); result.is_error()) {
+                dbgln("Ext2FSInode[{}]::write_bytes(): Failed to write {} blocks starting at block {} (index {})", identifier(), run_length, m_block_list[bi.value()], bi);
+                return result.release_error();
+            }
+            bi = bi.value() + run_length - 1;
+        } else if (auto result = fs().write_block(m_block_list[bi.value()], data.offset(nwritten), num_bytes_to_copy, offset_into_block, allow_cache); result.is_error()) {
             dbgln("Ext2FSInode[{}]::write_bytes(): Failed to write block {} (index {})", identifier(), m_block_list[bi.value()], bi);
             return result.release_error();
         }
@@ -1225,9 +1269,89 @@ ErrorOr<void> Ext2FS::write_ext2_inode(InodeIndex inode, ext2_inode const& e2ino
     return write_block(block_index, buffer, inode_size(), offset);
 }
 
-auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) -> ErrorOr<Vector<BlockIndex>>
+Ext2FS::BlockIndex Ext2FS::first_block_in_group(GroupIndex group_index) const
 {
-    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {})", preferred_group_index, count);
+    return (group_index.value() - 1) * blocks_per_group() + first_block_index().value();
+}
+
+u64 Ext2FS::blocks_in_group(GroupIndex group_index) const
+{
+    return min(blocks_per_group(), super_block().s_blocks_count - first_block_in_group(group_index).value());
+}
+
+// Counts the free blocks starting at the given one, up to max_count. The run never extends past the end of the block's group.
+ErrorOr<size_t> Ext2FS::count_free_blocks_at(BlockIndex block_index, size_t max_count)
+{
+    if (block_index < first_block_index() || block_index >= super_block().s_blocks_count)
+        return 0;
+
+    auto group_index = group_index_from_block_index(block_index);
+    auto const& bgd = group_descriptor(group_index);
+    if (bgd.bg_free_blocks_count == 0)
+        return 0;
+
+    auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
+    auto block_bitmap = cached_bitmap->bitmap(blocks_in_group(group_index));
+    size_t bit_index = block_index.value() - first_block_in_group(group_index).value();
+    max_count = min(max_count, block_bitmap.size() - bit_index);
+
+    // Look at single bits until we're aligned to a word, then at whole words until we find one with a block in use.
+    constexpr size_t bits_per_word = 8 * sizeof(FlatPtr);
+    size_t free_count = 0;
+    while (free_count < max_count && (bit_index + free_count) % bits_per_word != 0) {
+        if (block_bitmap.get(bit_index + free_count))
+            return free_count;
+        ++free_count;
+    }
+    auto const* words = reinterpret_cast<FlatPtr const*>(block_bitmap.data());
+    while (free_count + bits_per_word <= max_count) {
+        auto word = words[(bit_index + free_count) / bits_per_word];
+        if (word != 0)
+            return free_count + count_trailing_zeroes(word);
+        free_count += bits_per_word;
+    }
+    while (free_count < max_count && !block_bitmap.get(bit_index + free_count))
+        ++free_count;
+    return free_count;
+}
+
+// Finds the first run of at least `count` free blocks in the group, clamped to `count` blocks.
+// If there is no run that long and accept_shorter_run is set, the longest run in the group is returned instead.
+ErrorOr<Optional<Ext2FS::BlockRun>> Ext2FS::find_free_block_run(GroupIndex group_index, size_t count, bool accept_shorter_run)
+{
+    auto const& bgd = group_descriptor(group_index);
+    auto& summary = m_block_group_summaries[group_index.value() - 1];
+    if (bgd.bg_free_blocks_count == 0)
+        return Optional<BlockRun> {};
+    bool may_contain_run = bgd.bg_free_blocks_count >= count && (!summary.longest_free_run.has_value() || *summary.longest_free_run >= count);
+    if (!may_contain_run && !accept_shorter_run)
+        return Optional<BlockRun> {};
+
+    auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
+    auto block_bitmap = cached_bitmap->bitmap(blocks_in_group(group_index));
+    auto first_block = first_block_in_group(group_index);
+
+    // The bitmap is searched a word at a time, so whole words of blocks in use are skipped at once.
+    if (may_contain_run && summary.first_free_block_hint < block_bitmap.size()) {
+        size_t start = summary.first_free_block_hint;
+        if (auto length = block_bitmap.find_next_range_of_unset_bits(start, count, count); length.has_value())
+            return BlockRun { first_block.value() + start, length.value() };
+        summary.longest_free_run = count - 1;
+    }
+    if (!accept_shorter_run)
+        return Optional<BlockRun> {};
+
+    size_t longest_run_length = 0;
+    auto longest_run_start = block_bitmap.find_longest_range_of_unset_bits(count, longest_run_length);
+    if (!longest_run_start.has_value() || longest_run_length == 0)
+        return Optional<BlockRun> {};
+    summary.longest_free_run = longest_run_length;
+    return BlockRun { first_block.value() + longest_run_start.value(), longest_run_length };
+}
+
+auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal) -> ErrorOr<Vector<BlockIndex>>
+{
+    dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_blocks(preferred group: {}, count {}, goal: {})", preferred_group_index, count, goal);
     if (count == 0)
         return Vector<BlockIndex> {};
 
@@ -1235,52 +1359,156 @@ auto Ext2FS::allocate_blocks(GroupIndex preferred_group_index, size_t count) ->
     TRY(blocks.try_ensure_capacity(count));
 
     MutexLocker locker(m_lock);
-    auto group_index = preferred_group_index;
 
-    if (!group_descriptor(preferred_group_index).bg_free_blocks_count) {
-        group_index = 1;
-    }
+    // Blocks that are reserved for other inodes are given up before we give up ourselves.
+    if (super_block().s_free_blocks_count < count)
+        TRY(discard_all_preallocation_windows());
+    if (super_block().s_free_blocks_count < count)
+        return ENOSPC;
 
     while (blocks.size() < count) {
-        bool found_a_group = false;
-        if (group_descriptor(group_index).bg_free_blocks_count) {
-            found_a_group = true;
-        } else {
-            if (group_index == preferred_group_index)
-                group_index = 1;
-            for (; group_index <= m_block_group_count; group_index = GroupIndex { group_index.value() + 1 }) {
-                if (group_descriptor(group_index).bg_free_blocks_count) {
-                    found_a_group = true;
-                    break;
-                }
+        auto remaining_count = count - blocks.size();
+        Optional<BlockRun> run;
+
+        // Continuing right where the previous blocks end keeps the data contiguous on disk.
+        if (goal.value() != 0) {
+            if (auto free_count = TRY(count_free_blocks_at(goal, remaining_count)); free_count != 0)
+                run = BlockRun { goal, free_count };
+        }
+
+        // Otherwise, look for a run that fits all the remaining blocks, starting with the preferred group.
+        if (!run.has_value()) {
+            for (u64 i = 0; i < m_block_group_count && !run.has_value(); ++i) {
+                GroupIndex group_index = (preferred_group_index.value() - 1 + i) % m_block_group_count + 1;
+                run = TRY(find_free_block_run(group_index, remaining_count, false));
             }
         }
 
-        VERIFY(found_a_group);
-        auto const& bgd = group_descriptor(group_index);
+        // The free space is too fragmented for that, so settle for the longest run we can find.
+        if (!run.has_value()) {
+            for (u64 i = 0; i < m_block_group_count && !run.has_value(); ++i) {
+                GroupIndex group_index = (preferred_group_index.value() - 1 + i) % m_block_group_count + 1;
+                run = TRY(find_free_block_run(group_index, remaining_count, true));
+            }
+        }
 
-        auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
+        if (!run.has_value()) {
+            dmesgln("Ext2FS: allocate_blocks found no free blocks, despite the superblock claiming there are {}", super_block().s_free_blocks_count);
+            for (auto block_index : blocks)
+                (void)set_block_allocation_state(block_index, false);
+            return EIO;
+        }
 
-        int blocks_in_group = min(blocks_per_group(), super_block().s_blocks_count);
-        auto block_bitmap = cached_bitmap->bitmap(blocks_in_group);
+        dbgln_if(EXT2_DEBUG, "Ext2FS: allocating free region of size: {} at {}", run->count, run->first_block);
+        TRY(set_block_run_allocation_state(run->first_block, run->count, true));
+        for (size_t i = 0; i < run->count; ++i)
+            blocks.unchecked_append(run->first_block.value() + i);
+        goal = run->first_block.value() + run->count;
+    }
 
-        BlockIndex first_block_in_group = (group_index.value() - 1) * blocks_per_group() + first_block_index().value();
-        size_t free_region_size = 0;
-        auto first_unset_bit_index = block_bitmap.find_longest_range_of_unset_bits(count - blocks.size(), free_region_size);
-        VERIFY(first_unset_bit_index.has_value());
-        dbgln_if(EXT2_DEBUG, "Ext2FS: allocating free region of size: {} [{}]", free_region_size, group_index);
-        for (size_t i = 0; i < free_region_size; ++i) {
-            BlockIndex block_index = (first_unset_bit_index.value() + i) + first_block_in_group.value();
-            TRY(set_block_allocation_state(block_index, true));
-            blocks.unchecked_append(block_index);
-            dbgln_if(EXT2_DEBUG, "  allocated > {}", block_index);
+    VERIFY(blocks.size() == count);
+    return blocks;
+}
+
+// Allocates blocks to append to the inode's data, taking them from its preallocation window first.
+// New windows are placed right after the blocks allocated for the inode, and grow as long as the inode keeps using them up.
+ErrorOr<Vector<Ext2FS::BlockIndex>> Ext2FS::allocate_data_blocks(Ext2FSInode& inode, size_t count)
+{
+    static constexpr size_t min_preallocation_window_size = 8;
+    static constexpr size_t max_preallocation_window_size = 256;
+
+    if (count == 0)
+        return Vector<BlockIndex> {};
+
+    MutexLocker locker(m_lock);
+
+    BlockIndex goal = 0;
+    if (!inode.m_block_list.is_empty() && inode.m_block_list.last().value() != 0)
+        goal = inode.m_block_list.last().value() + 1;
+
+    auto window = m_preallocation_windows.get(inode.index()).value_or({});
+    if (window.block_count != 0 && window.first_block != goal) {
+        // The inode didn't grow into its window, so it's of no use for keeping the inode contiguous.
+        TRY(discard_preallocation_window(inode.index()));
+        window = {};
+    }
+    // The window is put back once we're done, so that it can't be discarded while we're taking blocks from it.
+    m_preallocation_windows.remove(inode.index());
+    if (window.next_window_size == 0)
+        window.next_window_size = min_preallocation_window_size;
+
+    Vector<BlockIndex> blocks;
+    TRY(blocks.try_ensure_capacity(count));
+    while (blocks.size() < count && window.block_count != 0) {
+        blocks.unchecked_append(window.first_block);
+        window.first_block = window.first_block.value() + 1;
+        --window.block_count;
+        --m_preallocated_block_count;
+    }
+    if (blocks.size() < count) {
+        // The inode used up its whole window, so it's likely to keep growing.
+        if (window.first_block.value() != 0)
+            window.next_window_size = min(window.next_window_size * 2, max_preallocation_window_size);
+        if (!blocks.is_empty())
+            goal = blocks.last().value() + 1;
+
+        auto remaining_count = count - blocks.size();
+        if (super_block().s_free_blocks_count < remaining_count)
+            TRY(discard_all_preallocation_windows());
+        auto window_size = min(window.next_window_size, super_block().s_free_blocks_count - min(super_block().s_free_blocks_count, remaining_count));
+
+        auto new_blocks_or_error = allocate_blocks(group_index_from_inode(inode.index()), remaining_count + window_size, goal);
+        if (new_blocks_or_error.is_error()) {
+            for (auto block_index : blocks)
+                (void)set_block_allocation_state(block_index, false);
+            return new_blocks_or_error.release_error();
+        }
+        auto new_blocks = new_blocks_or_error.release_value();
+        for (size_t i = 0; i < remaining_count; ++i)
+            blocks.unchecked_append(new_blocks[i]);
+
+        // Only the blocks that continue right after the inode's data are worth keeping in its window.
+        // The window has to stay within one group, as its blocks are given back as a single run of the group's bitmap.
+        window.first_block = blocks.last().value() + 1;
+        window.block_count = 0;
+        auto window_group_index = group_index_from_block_index(window.first_block);
+        for (size_t i = remaining_count; i < new_blocks.size(); ++i) {
+            if (window.block_count == i - remaining_count && new_blocks[i].value() == window.first_block.value() + window.block_count
+                && group_index_from_block_index(new_blocks[i]) == window_group_index) {
+                ++window.block_count;
+                continue;
+            }
+            TRY(set_block_allocation_state(new_blocks[i], false));
         }
+        m_preallocated_block_count += window.block_count;
     }
 
-    VERIFY(blocks.size() == count);
+    TRY(m_preallocation_windows.try_set(inode.index(), window));
     return blocks;
 }
 
+ErrorOr<void> Ext2FS::discard_preallocation_window(InodeIndex inode_index)
+{
+    MutexLocker locker(m_lock);
+    auto window = m_preallocation_windows.get(inode_index);
+    if (!window.has_value())
+        return {};
+    m_preallocation_windows.remove(inode_index);
+    if (window->block_count == 0)
+        return {};
+    dbgln_if(EXT2_DEBUG, "Ext2FS: Discarding {} preallocated block(s) at {} for inode {}", window->block_count, window->first_block, inode_index);
+    m_preallocated_block_count -= window->block_count;
+    return set_block_run_allocation_state(window->first_block, window->block_count, false);
+}
+
+ErrorOr<void> Ext2FS::discard_all_preallocation_windows()
+{
+    MutexLocker locker(m_lock);
+    while (!m_preallocation_windows.is_empty())
+        TRY(discard_preallocation_window(m_preallocation_windows.begin()->key));
+    return {};
+}
+
 ErrorOr<InodeIndex> Ext2FS::allocate_inode(GroupIndex preferred_group)
 {
     dbgln_if(EXT2_DEBUG, "Ext2FS: allocate_inode(preferred_group: {})", preferred_group);
@@ -1345,7 +1573,7 @@ Ext2FS::GroupIndex Ext2FS::group_index_from_block_index(BlockIndex block_index)
 {
     if (!block_index)
         return 0;
-    return (block_index.value() - 1) / blocks_per_group() + 1;
+    return (block_index.value() - first_block_index().value()) / blocks_per_group() + 1;
 }
 
 auto Ext2FS::group_index_from_inode(InodeIndex inode) const -> GroupIndex
@@ -1427,16 +1655,47 @@ ErrorOr<Ext2FS::CachedBitmap*> Ext2FS::get_bitmap_block(BlockIndex bitmap_block_
 
 ErrorOr<void> Ext2FS::set_block_allocation_state(BlockIndex block_index, bool new_state)
 {
-    VERIFY(block_index != 0);
+    return set_block_run_allocation_state(block_index, 1, new_state);
+}
+
+ErrorOr<void> Ext2FS::set_block_run_allocation_state(BlockIndex first_block, size_t count, bool new_state)
+{
+    VERIFY(first_block != 0);
     MutexLocker locker(m_lock);
 
-    auto group_index = group_index_from_block_index(block_index);
-    unsigned index_in_group = (block_index.value() - first_block_index().value()) - ((group_index.value() - 1) * blocks_per_group());
-    unsigned bit_index = index_in_group % blocks_per_group();
+    auto group_index = group_index_from_block_index(first_block);
+    size_t bit_index = first_block.value() - first_block_in_group(group_index).value();
+    VERIFY(bit_index + count <= blocks_per_group());
     auto& bgd = const_cast<ext2_group_desc&>(group_descriptor(group_index));
 
-    dbgln_if(EXT2_DEBUG, "Ext2FS: Block {} state -> {} (in bitmap block {})", block_index, new_state, bgd.bg_block_bitmap);
-    return update_bitmap_block(bgd.bg_block_bitmap, bit_index, new_state, m_super_block.s_free_blocks_count, bgd.bg_free_blocks_count);
+    dbgln_if(EXT2_DEBUG, "Ext2FS: Blocks {}-{} state -> {} (in bitmap block {})", first_block, first_block.value() + count - 1, new_state, bgd.bg_block_bitmap);
+
+    auto* cached_bitmap = TRY(get_bitmap_block(bgd.bg_block_bitmap));
+    auto block_bitmap = cached_bitmap->bitmap(blocks_per_group());
+    if (auto unexpected_count = block_bitmap.count_in_range(bit_index, count, new_state); unexpected_count != 0) {
+        dbgln("Ext2FS: {} of blocks {}-{} in bitmap block {} had unexpected state {}", unexpected_count, first_block, first_block.value() + count - 1, bgd.bg_block_bitmap, new_state);
+        return EIO;
+    }
+    block_bitmap.set_range(bit_index, count, new_state);
+    cached_bitmap->dirty = true;
+
+    auto& summary = m_block_group_summaries[group_index.value() - 1];
+    if (new_state) {
+        m_super_block.s_free_blocks_count -= count;
+        bgd.bg_free_blocks_count -= count;
+        if (summary.first_free_block_hint == bit_index)
+            summary.first_free_block_hint += count;
+    } else {
+        m_super_block.s_free_blocks_count += count;
+        bgd.bg_free_blocks_count += count;
+        // Freeing blocks may have joined free runs, so we no longer know how long the longest one is.
+        summary.first_free_block_hint = min<u32>(summary.first_free_block_hint, bit_index);
+        summary.longest_free_run = {};
+    }
+
+    m_super_block_dirty = true;
+    m_block_group_descriptors_dirty = true;
+    return {};
 }
 
 ErrorOr<NonnullRefPtr<Inode>> Ext2FS::create_directory(Ext2FSInode& parent_inode, StringView name, mode_t mode, UserID uid, GroupID gid)
@@ -1662,7 +1921,8 @@ unsigned Ext2FS::total_block_count() const
 unsigned Ext2FS::free_block_count() const
 {
     MutexLocker locker(m_lock);
-    return super_block().s_free_blocks_count;
+    // Preallocated blocks are marked as in use, but they're given back whenever someone else needs them.
+    return super_block().s_free_blocks_count + m_preallocated_block_count;
 }
 
 unsigned Ext2FS::total_inode_count() const
@@ -1686,6 +1946,7 @@ ErrorOr<void> Ext2FS::prepare_to_unmount()
             return EBUSY;
     }
 
+    TRY(discard_all_preallocation_windows());
     m_inode_cache.clear();
     m_root_inode = nullptr;
     return {};
@@ -63,6 +63,7 @@ private:
     ErrorOr<void> grow_triply_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, Span<BlockBasedFileSystem::BlockIndex>, Vector<BlockBasedFileSystem::BlockIndex>&, unsigned&);
     ErrorOr<void> shrink_triply_indirect_block(BlockBasedFileSystem::BlockIndex, size_t, size_t, unsigned&);
     ErrorOr<void> flush_block_list();
+    size_t contiguous_block_run_length(BlockBasedFileSystem::BlockIndex first_logical_index, BlockBasedFileSystem::BlockIndex last_logical_index, size_t offset_into_block, u64 remaining_count) const;
     ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_block_list() const;
     ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_block_list_with_meta_blocks() const;
     ErrorOr<Vector<BlockBasedFileSystem::BlockIndex>> compute_block_list_impl(bool include_block_list_blocks) const;
@@ -133,13 +134,28 @@ private:
 
     BlockIndex first_block_index() const;
     ErrorOr<InodeIndex> allocate_inode(GroupIndex preferred_group = 0);
-    ErrorOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count);
+    ErrorOr<Vector<BlockIndex>> allocate_blocks(GroupIndex preferred_group_index, size_t count, BlockIndex goal = 0);
+    ErrorOr<Vector<BlockIndex>> allocate_data_blocks(Ext2FSInode&, size_t count);
     GroupIndex group_index_from_inode(InodeIndex) const;
     GroupIndex group_index_from_block_index(BlockIndex) const;
+    BlockIndex first_block_in_group(GroupIndex) const;
+    u64 blocks_in_group(GroupIndex) const;
 
     ErrorOr<bool> get_inode_allocation_state(InodeIndex) const;
     ErrorOr<void> set_inode_allocation_state(InodeIndex, bool);
     ErrorOr<void> set_block_allocation_state(BlockIndex, bool);
+    ErrorOr<void> set_block_run_allocation_state(BlockIndex first_block, size_t count, bool);
+
+    struct BlockRun {
+        BlockIndex first_block { 0 };
+        size_t count { 0 };
+    };
+
+    ErrorOr<Optional<BlockRun>> find_free_block_run(GroupIndex, size_t count, bool accept_shorter_run);
+    ErrorOr<size_t> count_free_blocks_at(BlockIndex, size_t max_count);
+
+    ErrorOr<void> discard_preallocation_window(InodeIndex);
+    ErrorOr<void> discard_all_preallocation_windows();
 
     void uncache_inode(InodeIndex);
     ErrorOr<void> free_inode(Ext2FSInode&);
@@ -180,6 +196,28 @@ private:
     ErrorOr<void> update_bitmap_block(BlockIndex bitmap_block, size_t bit_index, bool new_state, u32& super_block_counter, u16& group_descriptor_counter);
 
     Vector<OwnPtr<CachedBitmap>> m_cached_bitmaps;
+
+    // What we know about the free space in a block group without looking at its bitmap.
+    struct BlockGroupSummary {
+        // Every block in the group before this one is in use.
+        u32 first_free_block_hint { 0 };
+        // An upper bound on the length of the longest run of free blocks in the group, if we know one.
+        Optional<u32> longest_free_run;
+    };
+
+    Vector<BlockGroupSummary> m_block_group_summaries;
+
+    // Blocks that are reserved for an inode right after the end of its data, so that it can keep growing
+    // contiguously while other inodes are growing at the same time. They are marked as in use in the bitmap.
+    struct PreallocationWindow {
+        BlockIndex first_block { 0 };
+        size_t block_count { 0 };
+        size_t next_window_size { 0 };
+    };
+
+    HashMap<InodeIndex, PreallocationWindow> m_preallocation_windows;
+    size_t m_preallocated_block_count { 0 };
+
     RefPtr<Ext2FSInode> m_root_inode;
 };
 
@@ -132,6 +132,29 @@ ErrorOr<size_t> FIFO::write(OpenFileDescription& fd, u64, const UserOrKernelBuff
     return m_buffer->write(buffer, size);
 }
 
+ErrorOr<size_t> FIFO::read_with(OpenFileDescription& fd, size_t size, Function<ErrorOr<size_t>(UserOrKernelBuffer const&, size_t)> const& callback)
+{
+    if (m_buffer->is_empty()) {
+        if (!m_writers)
+            return 0;
+        if (!fd.is_blocking())
+            return EAGAIN;
+    }
+    return m_buffer->read_with(size, callback);
+}
+
+ErrorOr<size_t> FIFO::write_with(OpenFileDescription& fd, size_t size, Function<ErrorOr<size_t>(UserOrKernelBuffer&, size_t)> const& callback)
+{
+    if (!m_readers) {
+        Thread::current()->send_signal(SIGPIPE, &Process::current());
+        return EPIPE;
+    }
+    if (!fd.is_blocking() && m_buffer->space_for_writing() == 0)
+        return EAGAIN;
+
+    return m_buffer->write_with(size, callback);
+}
+
 ErrorOr<NonnullOwnPtr<KString>> FIFO::pseudo_path(const OpenFileDescription&) const
 {
     return KString::formatted("fifo:{}", m_fifo_id);
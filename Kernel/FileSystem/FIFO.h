@@ -32,6 +32,10 @@ public:
     ErrorOr<NonnullRefPtr<OpenFileDescription>> open_direction(Direction);
     ErrorOr<NonnullRefPtr<OpenFileDescription>> open_direction_blocking(Direction);
 
+    // Used by splice() to move data straight between the pipe's buffer and another file.
+    ErrorOr<size_t> read_with(OpenFileDescription&, size_t, Function<ErrorOr<size_t>(UserOrKernelBuffer const&, size_t)> const&);
+    ErrorOr<size_t> write_with(OpenFileDescription&, size_t, Function<ErrorOr<size_t>(UserOrKernelBuffer&, size_t)> const&);
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Woverloaded-virtual"
     void attach(Direction);
@@ -6,6 +6,7 @@
 
 #include <AK/StringView.h>
 #include <AK/Userspace.h>
+#include <Kernel/FileSystem/EPoll.h>
 #include <Kernel/FileSystem/File.h>
 #include <Kernel/FileSystem/OpenFileDescription.h>
 #include <Kernel/Process.h>
@@ -35,6 +36,26 @@ ErrorOr<void> File::close()
     return {};
 }
 
+void File::notify_epoll_watches()
+{
+    m_epoll_watches.with([](auto& watches) {
+        for (auto& watch : watches)
+            watch.epoll.file_did_change_state({}, watch);
+    });
+}
+
+void File::remove_epoll_watches(Badge<OpenFileDescription>, OpenFileDescription& description)
+{
+    m_epoll_watches.with([&](auto& watches) {
+        for (auto it = watches.begin(); it != watches.end();) {
+            auto& watch = *it;
+            ++it;
+            if (watch.description == &description)
+                watch.epoll.forget_watch({}, watch);
+        }
+    });
+}
+
 ErrorOr<void> File::ioctl(OpenFileDescription&, unsigned, Userspace<void*>)
 {
     return ENOTTY;
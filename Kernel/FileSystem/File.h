@@ -6,13 +6,16 @@
 
 #pragma once
 
+#include <AK/Badge.h>
 #include <AK/Error.h>
+#include <AK/IntrusiveList.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/RefCounted.h>
 #include <AK/StringView.h>
 #include <AK/Types.h>
 #include <AK/Weakable.h>
 #include <Kernel/Forward.h>
+#include <Kernel/Locking/SpinlockProtected.h>
 #include <Kernel/UnixTypes.h>
 #include <Kernel/UserOrKernelBuffer.h>
 #include <Kernel/VirtualAddress.h>
@@ -43,6 +46,25 @@ public:
     }
 };
 
+// A registration of an OpenFileDescription with an EPoll instance.
+// The watch is linked into the list of its file, which tells the EPoll instance
+// whenever the file's state changes, and into the EPoll instance's ready list
+// while it may have events to report.
+struct EPollWatch {
+    EPoll& epoll;
+    OpenFileDescription* description { nullptr };
+    int fd { -1 };
+    u32 events { 0 };
+    u64 data { 0 };
+    bool is_disabled { false };
+
+    IntrusiveListNode<EPollWatch> file_list_node;
+    IntrusiveListNode<EPollWatch> ready_list_node;
+
+    using FileList = IntrusiveList<&EPollWatch::file_list_node>;
+    using ReadyList = IntrusiveList<&EPollWatch::ready_list_node>;
+};
+
 // File is the base class for anything that can be referenced by a OpenFileDescription.
 //
 // The most important functions in File are:
@@ -114,9 +136,13 @@ public:
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
     virtual bool is_inode_watcher() const { return false; }
+    virtual bool is_epoll() const { return false; }
 
     virtual FileBlockerSet& blocker_set() { return m_blocker_set; }
 
+    SpinlockProtected<EPollWatch::FileList>& epoll_watches() { return m_epoll_watches; }
+    void remove_epoll_watches(Badge<OpenFileDescription>, OpenFileDescription&);
+
     size_t attach_count() const { return m_attach_count; }
 
 protected:
@@ -142,9 +168,13 @@ private:
     {
         VERIFY(!Processor::current_in_irq());
         blocker_set().unblock_all_blockers_whose_conditions_are_met();
+        notify_epoll_watches();
     }
 
+    void notify_epoll_watches();
+
     FileBlockerSet m_blocker_set;
+    SpinlockProtected<EPollWatch::FileList> m_epoll_watches;
     size_t m_attach_count { 0 };
 };
 
@@ -76,6 +76,9 @@ public:
     const TTY* tty() const;
     TTY* tty();
 
+    bool is_epoll() const;
+    EPoll* epoll();
+
     bool is_inode_watcher() const;
     const InodeWatcher* inode_watcher() const;
     InodeWatcher* inode_watcher();
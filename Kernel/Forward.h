@@ -23,6 +23,8 @@ class DevTmpFSRootDirectoryInode;
 class Device;
 class DiskCache;
 class DoubleBuffer;
+class EPoll;
+struct EPollWatch;
 class File;
 class OpenFileDescription;
 class FileSystem;
@@ -123,6 +123,10 @@ private:
             TRY(obj.add("bytes_in", socket.bytes_in()));
             TRY(obj.add("packets_out", socket.packets_out()));
             TRY(obj.add("bytes_out", socket.bytes_out()));
+            TRY(obj.add("congestion_control", socket.congestion_control_name()));
+            TRY(obj.add("congestion_window", socket.congestion_window()));
+            TRY(obj.add("send_window_size", socket.send_window_size()));
+            TRY(obj.add("smoothed_rtt_ms", socket.smoothed_rtt().to_milliseconds()));
             if (Process::current().is_superuser() || Process::current().uid() == socket.origin_uid()) {
                 TRY(obj.add("origin_pid", socket.origin_pid().value()));
                 TRY(obj.add("origin_uid", socket.origin_uid().value()));
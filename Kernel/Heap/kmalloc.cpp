@@ -6,6 +6,8 @@
 
 #include <AK/Assertions.h>
 #include <AK/Types.h>
+#include <Kernel/Arch/Processor.h>
+#include <Kernel/Arch/x86/InterruptDisabler.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Heap/Heap.h>
 #include <Kernel/Heap/kmalloc.h>
@@ -120,6 +122,21 @@ public:
     size_t slab_size() const { return m_slab_size; }
 
     void* allocate()
+    {
+        auto* ptr = take_slab();
+        memset(ptr, KMALLOC_SCRUB_BYTE, m_slab_size);
+        return ptr;
+    }
+
+    void deallocate(void* ptr)
+    {
+        memset(ptr, KFREE_SCRUB_BYTE, m_slab_size);
+        return_slab(ptr);
+    }
+
+    // These hand out and take back slabs without scrubbing them, for callers
+    // that scrub themselves (i.e. the per-processor slab magazines).
+    void* take_slab()
     {
         if (m_usable_blocks.is_empty()) {
             // FIXME: This allocation wastes `block_size` bytes due to the implementation of kmalloc_aligned().
@@ -136,15 +153,11 @@ public:
         auto* ptr = block->allocate();
         if (block->is_full())
             m_full_blocks.append(*block);
-
-        memset(ptr, KMALLOC_SCRUB_BYTE, m_slab_size);
         return ptr;
     }
 
-    void deallocate(void* ptr)
+    void return_slab(void* ptr)
     {
-        memset(ptr, KFREE_SCRUB_BYTE, m_slab_size);
-
         auto* block = (KmallocSlabBlock*)((FlatPtr)ptr & KmallocSlabBlock::block_mask);
         bool block_was_full = block->is_full();
         block->deallocate(ptr);
@@ -191,6 +204,15 @@ struct KmallocGlobalData {
         subheaps.append(*subheap);
     }
 
+    Optional<size_t> slabheap_index_for(size_t size) const
+    {
+        for (size_t i = 0; i < slabheap_count; ++i) {
+            if (size <= slabheaps[i].slab_size())
+                return i;
+        }
+        return {};
+    }
+
     void* allocate(size_t size)
     {
         VERIFY(!expansion_in_progress);
@@ -347,7 +369,8 @@ struct KmallocGlobalData {
 
     KmallocSubheap::List subheaps;
 
-    KmallocSlabheap slabheaps[6] = { 16, 32, 64, 128, 256, 512 };
+    static constexpr size_t slabheap_count = 6;
+    KmallocSlabheap slabheaps[slabheap_count] = { 16, 32, 64, 128, 256, 512 };
 
     bool expansion_in_progress { false };
 };
@@ -355,6 +378,45 @@ struct KmallocGlobalData {
 READONLY_AFTER_INIT static KmallocGlobalData* g_kmalloc_global;
 alignas(KmallocGlobalData) static u8 g_kmalloc_global_heap[sizeof(KmallocGlobalData)];
 
+// A small per-processor stack of free slabs of one size. Allocations and
+// frees are served from here with interrupts disabled, and only an empty
+// or full magazine takes s_lock to exchange a batch of slabs with the
+// shared slabheap.
+class KmallocSlabMagazine {
+public:
+    static constexpr size_t capacity = 32;
+    static constexpr size_t batch_size = capacity / 2;
+
+    bool is_empty() const { return m_count == 0; }
+    bool is_full() const { return m_count == capacity; }
+
+    void push(void* ptr)
+    {
+        VERIFY(!is_full());
+        m_slabs[m_count++] = ptr;
+    }
+
+    void* pop()
+    {
+        VERIFY(!is_empty());
+        return m_slabs[--m_count];
+    }
+
+private:
+    size_t m_count { 0 };
+    void* m_slabs[capacity];
+};
+
+struct KmallocPerProcessorData {
+    static ProcessorSpecificDataID processor_specific_data_id() { return ProcessorSpecificDataID::Kmalloc; }
+
+    KmallocSlabMagazine magazines[KmallocGlobalData::slabheap_count];
+
+    Atomic<size_t> kmalloc_call_count { 0 };
+    Atomic<size_t> kfree_call_count { 0 };
+    size_t nested_kfree_calls { 0 };
+};
+
 static size_t g_kmalloc_call_count;
 static size_t g_kfree_call_count;
 static size_t g_nested_kfree_calls;
@@ -365,6 +427,49 @@ void kmalloc_enable_expand()
     g_kmalloc_global->enable_expansion();
 }
 
+void kmalloc_enable_processor_cache()
+{
+    // NOTE: Allocating the per-processor data goes through the locked slow path,
+    //       as this processor doesn't have any magazines yet.
+    ProcessorSpecific<KmallocPerProcessorData>::initialize();
+}
+
+static KmallocPerProcessorData* kmalloc_processor_data()
+{
+    VERIFY_INTERRUPTS_DISABLED();
+    // Stack dumping wants to see every allocation, so send everything through the slow path.
+    if (g_dump_kmalloc_stacks || !Processor::is_initialized())
+        return nullptr;
+    return Processor::current().get_specific<KmallocPerProcessorData>();
+}
+
+static void* kmalloc_from_magazine(KmallocPerProcessorData& data, size_t slabheap_index)
+{
+    auto& magazine = data.magazines[slabheap_index];
+    auto& slabheap = g_kmalloc_global->slabheaps[slabheap_index];
+    if (magazine.is_empty()) {
+        SpinlockLocker lock(s_lock);
+        for (size_t i = 0; i < KmallocSlabMagazine::batch_size; ++i)
+            magazine.push(slabheap.take_slab());
+    }
+    auto* ptr = magazine.pop();
+    memset(ptr, KMALLOC_SCRUB_BYTE, slabheap.slab_size());
+    return ptr;
+}
+
+static void kfree_to_magazine(KmallocPerProcessorData& data, size_t slabheap_index, void* ptr)
+{
+    auto& magazine = data.magazines[slabheap_index];
+    auto& slabheap = g_kmalloc_global->slabheaps[slabheap_index];
+    memset(ptr, KFREE_SCRUB_BYTE, slabheap.slab_size());
+    if (magazine.is_full()) {
+        SpinlockLocker lock(s_lock);
+        for (size_t i = 0; i < KmallocSlabMagazine::batch_size; ++i)
+            slabheap.return_slab(magazine.pop());
+    }
+    magazine.push(ptr);
+}
+
 static inline void kmalloc_verify_nospinlock_held()
 {
     // Catch bad callers allocating under spinlock.
@@ -382,9 +487,44 @@ UNMAP_AFTER_INIT void kmalloc_init()
     s_lock.initialize();
 }
 
+static void add_kmalloc_perf_event(size_t size, void* ptr)
+{
+    Thread* current_thread = Thread::current();
+    if (!current_thread)
+        current_thread = Processor::idle_thread();
+    if (current_thread) {
+        // FIXME: By the time we check this, we have already allocated above.
+        //        This means that in the case of an infinite recursion, we can't catch it this way.
+        VERIFY(current_thread->is_allocation_enabled());
+        PerformanceManager::add_kmalloc_perf_event(*current_thread, size, (FlatPtr)ptr);
+    }
+}
+
+static void add_kfree_perf_event(void* ptr)
+{
+    Thread* current_thread = Thread::current();
+    if (!current_thread)
+        current_thread = Processor::idle_thread();
+    if (current_thread) {
+        VERIFY(current_thread->is_allocation_enabled());
+        PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
+    }
+}
+
 void* kmalloc(size_t size)
 {
     kmalloc_verify_nospinlock_held();
+
+    if (auto slabheap_index = g_kmalloc_global->slabheap_index_for(size); slabheap_index.has_value()) {
+        InterruptDisabler disabler;
+        if (auto* data = kmalloc_processor_data()) {
+            data->kmalloc_call_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+            void* ptr = kmalloc_from_magazine(*data, *slabheap_index);
+            add_kmalloc_perf_event(size, ptr);
+            return ptr;
+        }
+    }
+
     SpinlockLocker lock(s_lock);
     ++g_kmalloc_call_count;
 
@@ -394,17 +534,7 @@ void* kmalloc(size_t size)
     }
 
     void* ptr = g_kmalloc_global->allocate(size);
-
-    Thread* current_thread = Thread::current();
-    if (!current_thread)
-        current_thread = Processor::idle_thread();
-    if (current_thread) {
-        // FIXME: By the time we check this, we have already allocated above.
-        //        This means that in the case of an infinite recursion, we can't catch it this way.
-        VERIFY(current_thread->is_allocation_enabled());
-        PerformanceManager::add_kmalloc_perf_event(*current_thread, size, (FlatPtr)ptr);
-    }
-
+    add_kmalloc_perf_event(size, ptr);
     return ptr;
 }
 
@@ -416,19 +546,26 @@ void kfree_sized(void* ptr, size_t size)
     VERIFY(size > 0);
 
     kmalloc_verify_nospinlock_held();
+
+    if (auto slabheap_index = g_kmalloc_global->slabheap_index_for(size); slabheap_index.has_value()) {
+        InterruptDisabler disabler;
+        if (auto* data = kmalloc_processor_data()) {
+            VERIFY(g_kmalloc_global->is_valid_kmalloc_address(VirtualAddress { ptr }));
+            data->kfree_call_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+            if (++data->nested_kfree_calls == 1)
+                add_kfree_perf_event(ptr);
+            kfree_to_magazine(*data, *slabheap_index, ptr);
+            --data->nested_kfree_calls;
+            return;
+        }
+    }
+
     SpinlockLocker lock(s_lock);
     ++g_kfree_call_count;
     ++g_nested_kfree_calls;
 
-    if (g_nested_kfree_calls == 1) {
-        Thread* current_thread = Thread::current();
-        if (!current_thread)
-            current_thread = Processor::idle_thread();
-        if (current_thread) {
-            VERIFY(current_thread->is_allocation_enabled());
-            PerformanceManager::add_kfree_perf_event(*current_thread, 0, (FlatPtr)ptr);
-        }
-    }
+    if (g_nested_kfree_calls == 1)
+        add_kfree_perf_event(ptr);
 
     g_kmalloc_global->deallocate(ptr, size);
     --g_nested_kfree_calls;
@@ -526,8 +663,16 @@ void operator delete[](void* ptr, size_t size) noexcept
 void get_kmalloc_stats(kmalloc_stats& stats)
 {
     SpinlockLocker lock(s_lock);
+    // NOTE: Slabs sitting in the per-processor magazines are counted as allocated.
     stats.bytes_allocated = g_kmalloc_global->allocated_bytes();
     stats.bytes_free = g_kmalloc_global->free_bytes();
     stats.kmalloc_call_count = g_kmalloc_call_count;
     stats.kfree_call_count = g_kfree_call_count;
+    Processor::for_each([&](Processor& processor) {
+        auto* data = processor.get_specific<KmallocPerProcessorData>();
+        if (!data)
+            return;
+        stats.kmalloc_call_count += data->kmalloc_call_count.load(AK::MemoryOrder::memory_order_relaxed);
+        stats.kfree_call_count += data->kfree_call_count.load(AK::MemoryOrder::memory_order_relaxed);
+    });
 }
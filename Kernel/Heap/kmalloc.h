@@ -85,3 +85,4 @@ inline void kfree_aligned(void* ptr)
 size_t kmalloc_good_size(size_t);
 
 void kmalloc_enable_expand();
+void kmalloc_enable_processor_cache();
@@ -98,6 +98,26 @@ u8 InterruptManagement::get_irq_vector(u8 mapped_interrupt_vector)
     return mapped_interrupt_vector;
 }
 
+// Message signalled interrupts get vectors above the ones the IOAPICs are programmed to deliver
+// (IRQ_VECTOR_BASE + GSI) and below the ones the local APIC uses itself (timer, IPI, error and spurious).
+static constexpr u8 first_message_signalled_interrupt_number = 0x90 - IRQ_VECTOR_BASE;
+static constexpr u8 last_message_signalled_interrupt_number = 0xfb - IRQ_VECTOR_BASE;
+
+ErrorOr<u8> InterruptManagement::reserve_message_signalled_interrupt_number()
+{
+    VERIFY(m_smp_enabled);
+    static_assert(last_message_signalled_interrupt_number - first_message_signalled_interrupt_number + 1 == sizeof(m_reserved_message_signalled_interrupt_numbers));
+    InterruptDisabler disabler;
+    for (u8 number = first_message_signalled_interrupt_number; number <= last_message_signalled_interrupt_number; ++number) {
+        auto& is_reserved = m_reserved_message_signalled_interrupt_numbers[number - first_message_signalled_interrupt_number];
+        if (is_reserved || get_interrupt_handler(number).type() != HandlerType::UnhandledInterruptHandler)
+            continue;
+        is_reserved = true;
+        return number;
+    }
+    return ENOSPC;
+}
+
 RefPtr<IRQController> InterruptManagement::get_responsible_irq_controller(IRQControllerType controller_type, u8 interrupt_vector)
 {
     for (auto& irq_controller : m_interrupt_controllers) {
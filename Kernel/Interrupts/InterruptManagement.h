@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/Function.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/OwnPtr.h>
@@ -61,6 +62,10 @@ public:
     u8 get_mapped_interrupt_vector(u8 original_irq);
     u8 get_irq_vector(u8 mapped_interrupt_vector);
 
+    // Hands out an interrupt number that isn't routed through any IRQ controller, to be used
+    // with message signalled interrupts (see MSIInterruptHandler). Only available in APIC mode.
+    ErrorOr<u8> reserve_message_signalled_interrupt_number();
+
     void enumerate_interrupt_handlers(Function<void(GenericInterruptHandler&)>);
     IRQController& get_interrupt_controller(int index);
 
@@ -72,6 +77,7 @@ private:
     PhysicalAddress search_for_madt();
     void locate_apic_data();
     bool m_smp_enabled { false };
+    Array<bool, 0xfc - 0x90> m_reserved_message_signalled_interrupt_numbers {};
     Vector<RefPtr<IRQController>> m_interrupt_controllers;
     Vector<ISAInterruptOverrideMetadata> m_isa_interrupt_overrides;
     Vector<PCIInterruptOverrideMetadata> m_pci_interrupt_overrides;
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Interrupts/APIC.h>
+#include <Kernel/Interrupts/MSIInterruptHandler.h>
+
+namespace Kernel {
+
+bool MSIInterruptHandler::eoi()
+{
+    APIC::the().eoi();
+    return true;
+}
+
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Types.h>
+#include <Kernel/Interrupts/GenericInterruptHandler.h>
+
+namespace Kernel {
+
+// A handler for a message signalled interrupt. The device writes directly to the local APIC
+// of the processor it was configured to target, so unlike IRQHandler there is no IRQ
+// controller involved and the interrupt number is never shared or remapped.
+class MSIInterruptHandler : public GenericInterruptHandler {
+public:
+    virtual ~MSIInterruptHandler() = default;
+
+    virtual bool handle_interrupt(RegisterState const& regs) override { return handle_irq(regs); }
+    virtual bool handle_irq(RegisterState const&) = 0;
+
+    virtual bool eoi() override;
+
+    virtual HandlerType type() const override { return HandlerType::IRQHandler; }
+    virtual StringView purpose() const override { return "MSI Handler"sv; }
+    virtual StringView controller() const override { return "APIC"sv; }
+
+    virtual size_t sharing_devices_count() const override { return 0; }
+    virtual bool is_shared_handler() const override { return false; }
+    virtual bool is_sharing_with_others() const override { return false; }
+
+protected:
+    // The interrupt number has to come from InterruptManagement::reserve_message_signalled_interrupt_number().
+    explicit MSIInterruptHandler(u8 interrupt_number)
+        : GenericInterruptHandler(interrupt_number, true)
+    {
+    }
+};
+
+}
@@ -642,6 +642,8 @@ UNMAP_AFTER_INIT void MemoryManager::initialize(u32 cpu)
         new MemoryManager;
         kmalloc_enable_expand();
     }
+
+    kmalloc_enable_processor_cache();
 }
 
 Region* MemoryManager::kernel_region_from_vaddr(VirtualAddress vaddr)
@@ -31,6 +31,8 @@ public:
     static ErrorOr<NonnullRefPtr<Socket>> create(int type, int protocol);
     virtual ~IPv4Socket() override;
 
+    static constexpr size_t receive_buffer_size = 256 * KiB;
+
     virtual ErrorOr<void> close() override;
     virtual ErrorOr<void> bind(Userspace<const sockaddr*>, socklen_t) override;
     virtual ErrorOr<void> connect(OpenFileDescription&, Userspace<const sockaddr*>, socklen_t, ShouldBlock = ShouldBlock::Yes) override;
@@ -94,6 +96,10 @@ protected:
 
     static ErrorOr<NonnullOwnPtr<DoubleBuffer>> try_create_receive_buffer();
     void drop_receive_buffer();
+    size_t receive_buffer_space() const { return m_receive_buffer ? m_receive_buffer->space_for_writing() : 0; }
+
+    // Called with the socket mutex held after userspace has consumed data from the receive buffer.
+    virtual void protocol_did_read() { }
 
 private:
     virtual bool is_ipv4() const override { return true; }
@@ -19,6 +19,7 @@
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCP.h>
 #include <Kernel/Net/TCPSocket.h>
+#include <Kernel/Net/TCPTimerWheel.h>
 #include <Kernel/Net/UDP.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/Process.h>
@@ -32,11 +33,9 @@ static void handle_udp(IPv4Packet const&, Time const& packet_timestamp);
 static void handle_tcp(IPv4Packet const&, Time const& packet_timestamp);
 static void send_delayed_tcp_ack(RefPtr<TCPSocket> socket);
 static void send_tcp_rst(IPv4Packet const& ipv4_packet, TCPPacket const& tcp_packet, RefPtr<NetworkAdapter> adapter);
-static void flush_delayed_tcp_acks();
-static void retransmit_tcp_packets();
+static void handle_tcp_timers();
 
 static Thread* network_task = nullptr;
-static HashTable<RefPtr<TCPSocket>>* delayed_ack_sockets;
 
 [[noreturn]] static void NetworkTask_main(void*);
 
@@ -57,8 +56,6 @@ bool NetworkTask::is_current()
 
 void NetworkTask_main(void*)
 {
-    delayed_ack_sockets = new HashTable<RefPtr<TCPSocket>>;
-
     WaitQueue packet_wait_queue;
     int pending_packets = 0;
     NetworkingManagement::the().for_each([&](auto& adapter) {
@@ -99,11 +96,14 @@ void NetworkTask_main(void*)
     Time packet_timestamp;
 
     for (;;) {
-        flush_delayed_tcp_acks();
-        retransmit_tcp_packets();
+        handle_tcp_timers();
         size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
         if (!packet_size) {
+            // Sleep until the next TCP timer is due. Timers armed from other threads are at least
+            // a second out (retransmissions), so waking up every 500 milliseconds is good enough for them.
             auto timeout_time = Time::from_milliseconds(500);
+            if (auto time_until_next_timer = TCPTimerWheel::the().time_until_next_expiration(); time_until_next_timer.has_value())
+                timeout_time = max(min(timeout_time, time_until_next_timer.value()), TCPTimerWheel::tick_duration);
             auto timeout = Thread::BlockTimeout { false, &timeout_time };
             [[maybe_unused]] auto result = packet_wait_queue.wait_on(timeout, "NetworkTask");
             continue;
@@ -310,28 +310,7 @@ void send_delayed_tcp_ack(RefPtr<TCPSocket> socket)
         return;
     }
 
-    delayed_ack_sockets->set(move(socket));
-}
-
-void flush_delayed_tcp_acks()
-{
-    Vector<RefPtr<TCPSocket>, 32> remaining_sockets;
-    for (auto& socket : *delayed_ack_sockets) {
-        MutexLocker locker(socket->mutex());
-        if (socket->should_delay_next_ack()) {
-            MUST(remaining_sockets.try_append(socket));
-            continue;
-        }
-        [[maybe_unused]] auto result = socket->send_ack();
-    }
-
-    if (remaining_sockets.size() != delayed_ack_sockets->size()) {
-        delayed_ack_sockets->clear();
-        if (remaining_sockets.size() > 0)
-            dbgln("flush_delayed_tcp_acks: {} sockets remaining", remaining_sockets.size());
-        for (auto&& socket : remaining_sockets)
-            delayed_ack_sockets->set(move(socket));
-    }
+    socket->schedule_delayed_ack();
 }
 
 void send_tcp_rst(IPv4Packet const& ipv4_packet, TCPPacket const& tcp_packet, RefPtr<NetworkAdapter> adapter)
@@ -459,6 +438,7 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            client->apply_syn_options(tcp_packet);
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             client->set_state(TCPSocket::State::SynReceived);
             return;
@@ -620,6 +600,12 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
         }
 
         if (tcp_packet.sequence_number() != socket->ack_number()) {
+            if (socket->queue_out_of_order_segment(ipv4_packet, tcp_packet, payload_size, packet_timestamp)) {
+                dbgln_if(TCP_DEBUG, "Queued out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
+                // RFC 5681 section 4.2: Out of order data has to be acknowledged immediately.
+                [[maybe_unused]] auto result = socket->send_ack(true);
+                return;
+            }
             dbgln_if(TCP_DEBUG, "Discarding out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
             if (socket->duplicate_acks() < TCPSocket::maximum_duplicate_acks) {
                 dbgln_if(TCP_DEBUG, "Sending ACK with same ack number to trigger fast retransmission");
@@ -647,26 +633,26 @@ void handle_tcp(IPv4Packet const& ipv4_packet, Time const& packet_timestamp)
                 socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
                 dbgln_if(TCP_DEBUG, "Got packet with ack_no={}, seq_no={}, payload_size={}, acking it with new ack_no={}, seq_no={}",
                     tcp_packet.ack_number(), tcp_packet.sequence_number(), payload_size, socket->ack_number(), socket->sequence_number());
-                send_delayed_tcp_ack(socket);
+                if (socket->has_queued_out_of_order_segments()) {
+                    // RFC 5681 section 4.2: Filling a gap has to be acknowledged immediately.
+                    socket->deliver_queued_segments();
+                    [[maybe_unused]] auto result = socket->send_ack(true);
+                } else {
+                    send_delayed_tcp_ack(socket);
+                }
             }
         }
     }
 }
 
-void retransmit_tcp_packets()
+void handle_tcp_timers()
 {
-    // We must keep the sockets alive until after we've unlocked the hash table
-    // in case retransmit_packets() realizes that it wants to close the socket.
-    NonnullRefPtrVector<TCPSocket, 16> sockets;
-    TCPSocket::sockets_for_retransmit().for_each_shared([&](const auto& socket) {
-        // We ignore allocation failures above the first 16 guaranteed socket slots, as
-        // we will just retransmit their packets the next time around
-        (void)sockets.try_append(socket);
-    });
+    TCPTimerWheel::ExpiredTimers expired_timers;
+    TCPTimerWheel::the().collect_expired_timers(expired_timers);
 
-    for (auto& socket : sockets) {
-        MutexLocker socket_locker(socket.mutex());
-        socket.retransmit_packets();
+    for (auto& expired_timer : expired_timers) {
+        MutexLocker socket_locker(expired_timer.socket->mutex());
+        expired_timer.socket->timer_expired(expired_timer.kind);
     }
 }
 
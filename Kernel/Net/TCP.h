@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Span.h>
 #include <AK/StdLibExtras.h>
 #include <Kernel/Net/IPv4.h>
 
@@ -22,6 +23,15 @@ struct TCPFlags {
     };
 };
 
+enum class TCPOptionKind : u8 {
+    End = 0,
+    NoOperation = 1,
+    MSS = 2,
+    WindowScale = 3,
+    SACKPermitted = 4,
+    SACK = 5,
+};
+
 class [[gnu::packed]] TCPOptionMSS {
 public:
     TCPOptionMSS(u16 value)
@@ -32,13 +42,52 @@ public:
     u16 value() const { return m_value; }
 
 private:
-    u8 m_option_kind { 0x02 };
+    u8 m_option_kind { (u8)TCPOptionKind::MSS };
     u8 m_option_length { sizeof(TCPOptionMSS) };
     NetworkOrdered<u16> m_value;
 };
 
 static_assert(AssertSize<TCPOptionMSS, 4>());
 
+// RFC 7323: The window scale option is padded with a leading NOP to keep the header 32-bit aligned.
+class [[gnu::packed]] TCPOptionWindowScale {
+public:
+    TCPOptionWindowScale(u8 shift_count)
+        : m_shift_count(shift_count)
+    {
+    }
+
+    u8 shift_count() const { return m_shift_count; }
+
+private:
+    u8 m_padding { (u8)TCPOptionKind::NoOperation };
+    u8 m_option_kind { (u8)TCPOptionKind::WindowScale };
+    u8 m_option_length { sizeof(TCPOptionWindowScale) - 1 };
+    u8 m_shift_count { 0 };
+};
+
+static_assert(AssertSize<TCPOptionWindowScale, 4>());
+
+// RFC 2018: Likewise, SACK-permitted is padded with two leading NOPs.
+class [[gnu::packed]] TCPOptionSACKPermitted {
+private:
+    u8 m_padding[2] { (u8)TCPOptionKind::NoOperation, (u8)TCPOptionKind::NoOperation };
+    u8 m_option_kind { (u8)TCPOptionKind::SACKPermitted };
+    u8 m_option_length { sizeof(TCPOptionSACKPermitted) - 2 };
+};
+
+static_assert(AssertSize<TCPOptionSACKPermitted, 4>());
+
+struct [[gnu::packed]] TCPSACKBlock {
+    NetworkOrdered<u32> left_edge;
+    NetworkOrdered<u32> right_edge;
+};
+
+static_assert(AssertSize<TCPSACKBlock, 8>());
+
+// RFC 2018: At most four SACK blocks fit into the 40 bytes of option space.
+static constexpr size_t maximum_tcp_sack_blocks = 4;
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
@@ -78,6 +127,8 @@ public:
     u16 urgent() const { return m_urgent; }
     void set_urgent(u16 urgent) { m_urgent = urgent; }
 
+    ReadonlyBytes options() const { return { ((const u8*)this) + sizeof(TCPPacket), header_size() - sizeof(TCPPacket) }; }
+
     const void* payload() const { return ((const u8*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Net/TCPCongestionControl.h>
+
+namespace Kernel {
+
+// RFC 6928: IW = min (10*MSS, max (2*MSS, 14600))
+static u32 initial_window(u32 maximum_segment_size)
+{
+    return min(10 * maximum_segment_size, max(2 * maximum_segment_size, 14600u));
+}
+
+static constexpr u32 maximum_congestion_window = NumericLimits<u32>::max() / 2;
+
+ErrorOr<NonnullOwnPtr<TCPCongestionControl>> TCPCongestionControl::try_create(Algorithm algorithm, u32 maximum_segment_size)
+{
+    switch (algorithm) {
+    case Algorithm::NewReno:
+        return adopt_nonnull_own_or_enomem<TCPCongestionControl>(new (nothrow) TCPNewReno(maximum_segment_size));
+    case Algorithm::Cubic:
+        return adopt_nonnull_own_or_enomem<TCPCongestionControl>(new (nothrow) TCPCubic(maximum_segment_size));
+    }
+    VERIFY_NOT_REACHED();
+}
+
+TCPCongestionControl::TCPCongestionControl(u32 maximum_segment_size)
+    : m_maximum_segment_size(maximum_segment_size)
+    , m_congestion_window(initial_window(maximum_segment_size))
+{
+}
+
+void TCPCongestionControl::set_maximum_segment_size(u32 maximum_segment_size)
+{
+    m_maximum_segment_size = maximum_segment_size;
+    m_congestion_window = initial_window(maximum_segment_size);
+}
+
+void TCPCongestionControl::grow_in_slow_start(u32 bytes_acked)
+{
+    // RFC 5681 section 3.1: Increase by at most SMSS bytes for each ACK received.
+    m_congestion_window = min(m_congestion_window + min(bytes_acked, m_maximum_segment_size), maximum_congestion_window);
+}
+
+void TCPNewReno::on_ack(u32 bytes_acked, Time const&, Time const&)
+{
+    if (is_in_slow_start()) {
+        grow_in_slow_start(bytes_acked);
+        return;
+    }
+
+    // RFC 5681 section 3.1: In congestion avoidance, grow by one SMSS per round-trip time,
+    // i.e. once a full congestion window worth of data has been acknowledged.
+    m_bytes_acked_in_congestion_avoidance += bytes_acked;
+    if (m_bytes_acked_in_congestion_avoidance >= m_congestion_window) {
+        m_bytes_acked_in_congestion_avoidance -= m_congestion_window;
+        m_congestion_window = min(m_congestion_window + m_maximum_segment_size, maximum_congestion_window);
+    }
+}
+
+void TCPNewReno::on_loss(u32 bytes_in_flight, Time const&)
+{
+    // RFC 5681 equation (4): ssthresh = max (FlightSize / 2, 2*SMSS)
+    m_slow_start_threshold = max(bytes_in_flight / 2, 2 * m_maximum_segment_size);
+    m_congestion_window = m_slow_start_threshold;
+    m_bytes_acked_in_congestion_avoidance = 0;
+}
+
+void TCPNewReno::on_retransmission_timeout(u32 bytes_in_flight, Time const&)
+{
+    m_slow_start_threshold = max(bytes_in_flight / 2, 2 * m_maximum_segment_size);
+    m_congestion_window = m_maximum_segment_size;
+    m_bytes_acked_in_congestion_avoidance = 0;
+}
+
+// RFC 8312 section 5: beta_cubic = 0.7, C = 0.4
+static constexpr u64 cubic_beta_numerator = 7;
+static constexpr u64 cubic_beta_denominator = 10;
+
+static u64 integer_cube_root(u64 value)
+{
+    u64 low = 0;
+    u64 high = 1 << 21;
+    while (low < high) {
+        auto middle = (low + high + 1) / 2;
+        if (middle * middle * middle <= value)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+// W_cubic(t) = C*(t-K)^3 + W_max, in bytes
+u64 TCPCubic::cubic_window(i64 milliseconds_since_epoch) const
+{
+    // Clamp the distance from K so that the cube can't overflow.
+    auto distance = clamp<i64>(milliseconds_since_epoch - m_k_milliseconds, -500'000, 500'000);
+    // C*d^3 with d in milliseconds, in thousandths of a segment: 0.4 * d^3 / 10^9 * 1000
+    i64 cubic_term = 4 * distance * distance * distance / 10'000'000;
+    i64 window = static_cast<i64>(m_window_max) + cubic_term * m_maximum_segment_size / 1000;
+    return max<i64>(window, m_maximum_segment_size);
+}
+
+// W_est(t) = W_max*beta_cubic + [3*(1-beta_cubic)/(1+beta_cubic)] * (t/RTT), in bytes
+u64 TCPCubic::tcp_friendly_window(i64 milliseconds_since_epoch, i64 rtt_milliseconds) const
+{
+    rtt_milliseconds = max<i64>(rtt_milliseconds, 1);
+    // 3 * (1 - 0.7) / (1 + 0.7) ~= 0.529
+    u64 additive_increase = static_cast<u64>(m_maximum_segment_size) * 529 * max<i64>(milliseconds_since_epoch, 0) / (1000 * rtt_milliseconds);
+    return m_window_max * cubic_beta_numerator / cubic_beta_denominator + additive_increase;
+}
+
+void TCPCubic::on_ack(u32 bytes_acked, Time const& now, Time const& smoothed_rtt)
+{
+    if (is_in_slow_start()) {
+        grow_in_slow_start(bytes_acked);
+        return;
+    }
+
+    if (!m_epoch_start.has_value()) {
+        m_epoch_start = now;
+        if (m_congestion_window < m_window_max) {
+            // K = cubic_root((W_max - cwnd) / C), with the window in segments and K in milliseconds.
+            u64 missing_bytes = m_window_max - m_congestion_window;
+            m_k_milliseconds = integer_cube_root(missing_bytes * 2'500'000 / m_maximum_segment_size * 1000);
+        } else {
+            m_k_milliseconds = 0;
+            m_window_max = m_congestion_window;
+        }
+    }
+
+    auto rtt_milliseconds = smoothed_rtt.to_milliseconds();
+    auto milliseconds_since_epoch = (now - m_epoch_start.value()).to_milliseconds();
+
+    // RFC 8312 section 4.1: The target is the window one RTT from now, but never more than 1.5 times the current window.
+    u64 target = min<u64>(cubic_window(milliseconds_since_epoch + rtt_milliseconds), static_cast<u64>(m_congestion_window) * 3 / 2);
+    // RFC 8312 section 4.2: Don't be less aggressive than standard TCP would be.
+    target = max(target, tcp_friendly_window(milliseconds_since_epoch, rtt_milliseconds));
+
+    u64 increase;
+    if (target > m_congestion_window)
+        increase = (target - m_congestion_window) * bytes_acked / m_congestion_window;
+    else
+        increase = static_cast<u64>(m_maximum_segment_size) * bytes_acked / (100 * static_cast<u64>(m_congestion_window));
+    m_congestion_window = min<u64>(m_congestion_window + increase, maximum_congestion_window);
+}
+
+void TCPCubic::reduce_window()
+{
+    // RFC 8312 section 4.6: Fast convergence.
+    if (m_congestion_window < m_last_window_max)
+        m_window_max = static_cast<u64>(m_congestion_window) * (cubic_beta_denominator + cubic_beta_numerator) / (2 * cubic_beta_denominator);
+    else
+        m_window_max = m_congestion_window;
+    m_last_window_max = m_congestion_window;
+
+    m_slow_start_threshold = max<u32>(static_cast<u64>(m_congestion_window) * cubic_beta_numerator / cubic_beta_denominator, 2 * m_maximum_segment_size);
+    m_epoch_start.clear();
+}
+
+void TCPCubic::on_loss(u32, Time const&)
+{
+    reduce_window();
+    m_congestion_window = m_slow_start_threshold;
+}
+
+void TCPCubic::on_retransmission_timeout(u32, Time const&)
+{
+    reduce_window();
+    m_congestion_window = m_maximum_segment_size;
+}
+
+}
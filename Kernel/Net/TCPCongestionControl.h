@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/OwnPtr.h>
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// Decides how many bytes a TCP connection may have in flight. TCPSocket reports the
+// events of RFC 5681 (new data acknowledged, loss detected through duplicate ACKs,
+// retransmission timeout) and the algorithm adjusts the congestion window in response.
+class TCPCongestionControl {
+public:
+    enum class Algorithm {
+        NewReno,
+        Cubic,
+    };
+
+    static constexpr Algorithm default_algorithm = Algorithm::Cubic;
+
+    static ErrorOr<NonnullOwnPtr<TCPCongestionControl>> try_create(Algorithm, u32 maximum_segment_size);
+    virtual ~TCPCongestionControl() = default;
+
+    virtual StringView name() const = 0;
+
+    u32 congestion_window() const { return m_congestion_window; }
+    u32 slow_start_threshold() const { return m_slow_start_threshold; }
+    bool is_in_slow_start() const { return m_congestion_window < m_slow_start_threshold; }
+
+    // Only meant to be used during the handshake, as it resets the window to the initial window.
+    void set_maximum_segment_size(u32);
+
+    // Called for every ACK that acknowledges new data while not recovering from a loss.
+    virtual void on_ack(u32 bytes_acked, Time const& now, Time const& smoothed_rtt) = 0;
+
+    // Called when entering fast recovery after three duplicate ACKs.
+    virtual void on_loss(u32 bytes_in_flight, Time const& now) = 0;
+
+    // Called when the ACK that ends fast recovery arrives.
+    virtual void on_recovery_complete() { m_congestion_window = m_slow_start_threshold; }
+
+    // Called when the retransmission timer expires.
+    virtual void on_retransmission_timeout(u32 bytes_in_flight, Time const& now) = 0;
+
+protected:
+    explicit TCPCongestionControl(u32 maximum_segment_size);
+
+    void grow_in_slow_start(u32 bytes_acked);
+
+    u32 m_maximum_segment_size { 0 };
+    u32 m_congestion_window { 0 };
+    u32 m_slow_start_threshold { NumericLimits<u32>::max() };
+};
+
+// RFC 5681 / RFC 6582
+class TCPNewReno final : public TCPCongestionControl {
+public:
+    explicit TCPNewReno(u32 maximum_segment_size)
+        : TCPCongestionControl(maximum_segment_size)
+    {
+    }
+
+    virtual StringView name() const override { return "newreno"sv; }
+    virtual void on_ack(u32 bytes_acked, Time const& now, Time const& smoothed_rtt) override;
+    virtual void on_loss(u32 bytes_in_flight, Time const& now) override;
+    virtual void on_retransmission_timeout(u32 bytes_in_flight, Time const& now) override;
+
+private:
+    u32 m_bytes_acked_in_congestion_avoidance { 0 };
+};
+
+// RFC 8312, using fixed-point arithmetic since the kernel can't touch the FPU.
+class TCPCubic final : public TCPCongestionControl {
+public:
+    explicit TCPCubic(u32 maximum_segment_size)
+        : TCPCongestionControl(maximum_segment_size)
+    {
+    }
+
+    virtual StringView name() const override { return "cubic"sv; }
+    virtual void on_ack(u32 bytes_acked, Time const& now, Time const& smoothed_rtt) override;
+    virtual void on_loss(u32 bytes_in_flight, Time const& now) override;
+    virtual void on_retransmission_timeout(u32 bytes_in_flight, Time const& now) override;
+
+private:
+    void reduce_window();
+    u64 cubic_window(i64 milliseconds_since_epoch) const;
+    u64 tcp_friendly_window(i64 milliseconds_since_epoch, i64 rtt_milliseconds) const;
+
+    u64 m_window_max { 0 };
+    u64 m_last_window_max { 0 };
+    i64 m_k_milliseconds { 0 };
+    Optional<Time> m_epoch_start;
+};
+
+}
@@ -22,6 +22,95 @@
 
 namespace Kernel {
 
+// Sequence numbers wrap around, so they have to be compared modulo 2^32 (RFC 793 section 3.3).
+static bool sequence_number_less_than(u32 a, u32 b)
+{
+    return static_cast<i32>(a - b) < 0;
+}
+
+static bool sequence_number_less_than_or_equal(u32 a, u32 b)
+{
+    return static_cast<i32>(a - b) <= 0;
+}
+
+// RFC 7323 section 2.3: Pick the smallest shift that lets us advertise the whole receive buffer.
+static constexpr u8 compute_receive_window_scale()
+{
+    u8 shift = 0;
+    while ((IPv4Socket::receive_buffer_size >> shift) > NumericLimits<u16>::max())
+        ++shift;
+    return shift;
+}
+
+static constexpr u8 maximum_window_scale = 14;
+static_assert(compute_receive_window_scale() <= maximum_window_scale);
+
+// RFC 6298 section 4: The clock granularity G is that of the timer wheel driving the retransmission timer.
+static constexpr Time retransmit_clock_granularity = TCPTimerWheel::tick_duration;
+static constexpr Time minimum_retransmission_timeout = Time::from_seconds(1);
+static constexpr Time maximum_retransmission_timeout = Time::from_seconds(60);
+
+// RFC 5681 section 3.2
+static constexpr u32 duplicate_ack_threshold = 3;
+
+// RFC 1122 section 4.2.2.13 asks for 2 * MSL. Like most other stacks, we use an MSL of 30 seconds rather than RFC 793's two minutes.
+static constexpr Time time_wait_duration = Time::from_seconds(60);
+
+// RFC 1122 section 4.2.3.2: An ACK must not be delayed for more than 500 milliseconds.
+static constexpr Time maximum_ack_delay = Time::from_milliseconds(500);
+
+struct TCPSocket::ReceivedOptions {
+    Optional<u16> maximum_segment_size;
+    Optional<u8> window_scale;
+    bool sack_permitted { false };
+    Array<TCPSACKBlock, maximum_tcp_sack_blocks> sack_blocks;
+    size_t sack_block_count { 0 };
+};
+
+static TCPSocket::ReceivedOptions parse_tcp_options(TCPPacket const& packet)
+{
+    TCPSocket::ReceivedOptions options;
+    auto bytes = packet.options();
+    size_t offset = 0;
+    while (offset < bytes.size()) {
+        auto kind = static_cast<TCPOptionKind>(bytes[offset]);
+        if (kind == TCPOptionKind::End)
+            break;
+        if (kind == TCPOptionKind::NoOperation) {
+            ++offset;
+            continue;
+        }
+        if (offset + 1 >= bytes.size())
+            break;
+        size_t length = bytes[offset + 1];
+        if (length < 2 || offset + length > bytes.size())
+            break;
+        auto data = bytes.slice(offset + 2, length - 2);
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == 2)
+                options.maximum_segment_size = (data[0] << 8) | data[1];
+            break;
+        case TCPOptionKind::WindowScale:
+            // RFC 7323 section 2.3: Treat shift counts above 14 as 14.
+            if (data.size() == 1)
+                options.window_scale = min(data[0], maximum_window_scale);
+            break;
+        case TCPOptionKind::SACKPermitted:
+            options.sack_permitted = true;
+            break;
+        case TCPOptionKind::SACK:
+            options.sack_block_count = min(data.size() / sizeof(TCPSACKBlock), maximum_tcp_sack_blocks);
+            memcpy(options.sack_blocks.data(), data.data(), options.sack_block_count * sizeof(TCPSACKBlock));
+            break;
+        default:
+            break;
+        }
+        offset += length;
+    }
+    return options;
+}
+
 void TCPSocket::for_each(Function<void(const TCPSocket&)> callback)
 {
     sockets_by_tuple().for_each_shared([&](const auto& it) {
@@ -44,6 +133,8 @@ bool TCPSocket::unref() const
         if (deref_base())
             return false;
         table.remove(tuple());
+        // The timer wheel hands out references to sockets while holding this lock, so make sure it can't find us anymore.
+        const_cast<TCPSocket&>(*this).cancel_all_timers();
         const_cast<TCPSocket&>(*this).revoke_weak_ptrs();
         return true;
     });
@@ -73,9 +164,12 @@ void TCPSocket::set_state(State new_state)
         // are packets on the way which we wouldn't want a new socket to get hit
         // with, so there's no point in keeping the receive buffer around.
         drop_receive_buffer();
+        TCPTimerWheel::the().arm(m_time_wait_timer, time_wait_duration);
     }
 
     if (new_state == State::Closed) {
+        cancel_all_timers();
+
         closing_sockets().with_exclusive([&](auto& table) {
             table.remove(tuple());
         });
@@ -162,15 +256,16 @@ void TCPSocket::release_for_accept(RefPtr<TCPSocket> socket)
     [[maybe_unused]] auto rc = queue_connection_from(*socket);
 }
 
-TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer)
+TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer, NonnullOwnPtr<TCPCongestionControl> congestion_control)
     : IPv4Socket(SOCK_STREAM, protocol, move(receive_buffer), move(scratch_buffer))
+    , m_congestion_control(move(congestion_control))
 {
-    m_last_retransmit_time = kgettimeofday();
+    m_retransmit_timer_start = kgettimeofday();
 }
 
 TCPSocket::~TCPSocket()
 {
-    dequeue_for_retransmit();
+    cancel_all_timers();
 
     dbgln_if(TCP_SOCKET_DEBUG, "~TCPSocket in state {}", to_string(state()));
 }
@@ -179,7 +274,8 @@ ErrorOr<NonnullRefPtr<TCPSocket>> TCPSocket::try_create(int protocol, NonnullOwn
 {
     // Note: Scratch buffer is only used for SOCK_STREAM sockets.
     auto scratch_buffer = TRY(KBuffer::try_create_with_size(65536));
-    return adopt_nonnull_ref_or_enomem(new (nothrow) TCPSocket(protocol, move(receive_buffer), move(scratch_buffer)));
+    auto congestion_control = TRY(TCPCongestionControl::try_create(TCPCongestionControl::default_algorithm, default_maximum_segment_size));
+    return adopt_nonnull_ref_or_enomem(new (nothrow) TCPSocket(protocol, move(receive_buffer), move(scratch_buffer), move(congestion_control)));
 }
 
 ErrorOr<size_t> TCPSocket::protocol_size(ReadonlyBytes raw_ipv4_packet)
@@ -205,7 +301,18 @@ ErrorOr<size_t> TCPSocket::protocol_send(const UserOrKernelBuffer& data, size_t
     RoutingDecision routing_decision = route_to(peer_address(), local_address(), bound_interface());
     if (routing_decision.is_zero())
         return set_so_error(EHOSTUNREACH);
-    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+    size_t mss = min<size_t>(routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), m_peer_maximum_segment_size);
+
+    // Only send as much as both the peer's receive window and the congestion window allow.
+    // If nothing is in flight, always allow one segment so that a closed window gets probed.
+    size_t bytes_in_flight = m_unacked_packets.with_shared([](auto& unacked_packets) { return unacked_packets.size; });
+    if (bytes_in_flight > 0) {
+        size_t window = min(m_send_window_size, m_congestion_control->congestion_window());
+        if (bytes_in_flight >= window)
+            return set_so_error(EAGAIN);
+        mss = min(mss, window - bytes_in_flight);
+    }
+
     data_length = min(data_length, mss);
     TRY(send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &data, data_length, &routing_decision));
     return data_length;
@@ -226,8 +333,29 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
 
-    const bool has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    // Our own SYN offers window scaling and SACK. A SYN-ACK may only echo what the peer offered.
+    const bool is_syn = flags & TCPFlags::SYN;
+    const bool is_syn_ack = is_syn && (flags & TCPFlags::ACK);
+    const bool has_mss_option = is_syn;
+    const bool has_window_scale_option = is_syn && (!is_syn_ack || m_receive_window_scale != 0);
+    const bool has_sack_permitted_option = is_syn && (!is_syn_ack || m_sack_permitted);
+    if (is_syn && !is_syn_ack)
+        m_receive_window_scale = 0;
+
+    Array<TCPSACKBlock, maximum_tcp_sack_blocks> sack_blocks;
+    size_t sack_block_count = 0;
+    if ((flags & TCPFlags::ACK) && !is_syn && m_sack_permitted)
+        sack_block_count = sack_blocks_to_send(sack_blocks);
+
+    size_t options_size = 0;
+    if (has_mss_option)
+        options_size += sizeof(TCPOptionMSS);
+    if (has_window_scale_option)
+        options_size += sizeof(TCPOptionWindowScale);
+    if (has_sack_permitted_option)
+        options_size += sizeof(TCPOptionSACKPermitted);
+    if (sack_block_count > 0)
+        options_size += 4 + sack_block_count * sizeof(TCPSACKBlock);
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -241,7 +369,7 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
+    tcp_packet.set_window_size(window_to_advertise(is_syn));
     tcp_packet.set_sequence_number(m_sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
@@ -256,20 +384,43 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
     if (flags & TCPFlags::ACK) {
         m_last_ack_number_sent = m_ack_number;
         m_last_ack_sent_time = kgettimeofday();
+        TCPTimerWheel::the().cancel(m_delayed_ack_timer);
         tcp_packet.set_ack_number(m_ack_number);
     }
 
+    auto packet_sequence_number = m_sequence_number;
     if (flags & TCPFlags::SYN) {
         ++m_sequence_number;
     } else {
         m_sequence_number += payload_size;
     }
 
+    VERIFY(packet->buffer->size() >= ipv4_payload_offset + tcp_header_size);
+    auto* options = packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket);
     if (has_mss_option) {
         u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
         TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer->size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
+        memcpy(options, &mss_option, sizeof(mss_option));
+        options += sizeof(mss_option);
+    }
+    if (has_window_scale_option) {
+        if (!is_syn_ack)
+            m_receive_window_scale = compute_receive_window_scale();
+        TCPOptionWindowScale window_scale_option { compute_receive_window_scale() };
+        memcpy(options, &window_scale_option, sizeof(window_scale_option));
+        options += sizeof(window_scale_option);
+    }
+    if (has_sack_permitted_option) {
+        TCPOptionSACKPermitted sack_permitted_option;
+        memcpy(options, &sack_permitted_option, sizeof(sack_permitted_option));
+        options += sizeof(sack_permitted_option);
+    }
+    if (sack_block_count > 0) {
+        *options++ = (u8)TCPOptionKind::NoOperation;
+        *options++ = (u8)TCPOptionKind::NoOperation;
+        *options++ = (u8)TCPOptionKind::SACK;
+        *options++ = 2 + sack_block_count * sizeof(TCPSACKBlock);
+        memcpy(options, sack_blocks.data(), sack_block_count * sizeof(TCPSACKBlock));
     }
 
     tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
@@ -279,11 +430,18 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
     m_packets_out++;
     m_bytes_out += buffer_size;
     if (tcp_packet.has_syn() || payload_size > 0) {
-        m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-            unacked_packets.packets.append({ m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter });
+        auto now = kgettimeofday();
+        bool should_start_timer = m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+            bool was_empty = unacked_packets.packets.is_empty();
+            unacked_packets.packets.append({ packet_sequence_number, m_sequence_number, move(packet), ipv4_payload_offset, *routing_decision.adapter, 0, now });
             unacked_packets.size += payload_size;
-            enqueue_for_retransmit();
+            return was_empty;
         });
+        // RFC 6298 section 5.1: Start the timer if it isn't running already.
+        if (should_start_timer) {
+            m_retransmit_timer_start = now;
+            restart_retransmit_timer();
+        }
     } else {
         routing_decision.adapter->release_packet_buffer(*packet);
     }
@@ -293,46 +451,277 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* pa
 
 void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
 {
-    if (packet.has_ack()) {
-        u32 ack_number = packet.ack_number();
-
-        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
-
-        int removed = 0;
-        m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-            while (!unacked_packets.packets.is_empty()) {
-                auto& packet = unacked_packets.packets.first();
-
-                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
-
-                if (packet.ack_number <= ack_number) {
-                    auto old_adapter = packet.adapter.strong_ref();
-                    if (old_adapter)
-                        old_adapter->release_packet_buffer(*packet.buffer);
-                    TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                    auto payload_size = packet.buffer->buffer->data() + packet.buffer->buffer->size() - (u8*)tcp_packet.payload();
-                    unacked_packets.size -= payload_size;
-                    evaluate_block_conditions();
-                    unacked_packets.packets.take_first();
-                    removed++;
-                } else {
-                    break;
-                }
-            }
+    auto options = parse_tcp_options(packet);
 
-            if (unacked_packets.packets.is_empty()) {
-                m_retransmit_attempts = 0;
-                dequeue_for_retransmit();
-            }
+    if (packet.has_syn() && m_state == State::SynSent)
+        apply_syn_options(options);
 
-            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
-        });
-    }
+    if (packet.has_ack())
+        process_ack(packet, size - packet.header_size(), options);
 
     m_packets_in++;
     m_bytes_in += packet.header_size() + size;
 }
 
+void TCPSocket::apply_syn_options(TCPPacket const& packet)
+{
+    apply_syn_options(parse_tcp_options(packet));
+}
+
+void TCPSocket::apply_syn_options(ReceivedOptions const& options)
+{
+    m_peer_maximum_segment_size = options.maximum_segment_size.value_or(default_maximum_segment_size);
+    m_congestion_control->set_maximum_segment_size(m_peer_maximum_segment_size);
+
+    // RFC 7323 section 2.2: Scaling is only in effect if both sides sent the option.
+    if (options.window_scale.has_value()) {
+        m_send_window_scale = options.window_scale.value();
+        if (m_state != State::SynSent)
+            m_receive_window_scale = compute_receive_window_scale();
+    } else {
+        m_send_window_scale = 0;
+        m_receive_window_scale = 0;
+    }
+
+    m_sack_permitted = options.sack_permitted;
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) peer MSS {}, send window scale {}, receive window scale {}, SACK {}", this, m_peer_maximum_segment_size, m_send_window_scale, m_receive_window_scale, m_sack_permitted);
+}
+
+void TCPSocket::process_ack(TCPPacket const& packet, size_t payload_size, ReceivedOptions const& options)
+{
+    u32 ack_number = packet.ack_number();
+    auto now = kgettimeofday();
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
+
+    // RFC 793 section 3.9: Only take the window from segments that are at least as new as the one it was last taken from,
+    // so that reordered old segments can't shrink it. The handshake sets it unconditionally.
+    bool send_window_changed = false;
+    if (m_state == State::SynSent || m_state == State::SynReceived
+        || sequence_number_less_than(m_send_window_update_sequence_number, packet.sequence_number())
+        || (m_send_window_update_sequence_number == packet.sequence_number() && sequence_number_less_than_or_equal(m_send_window_update_ack_number, ack_number))) {
+        // RFC 7323 section 2.2: The window field of a SYN segment is never scaled.
+        u32 send_window_size = static_cast<u32>(packet.window_size()) << (packet.has_syn() ? 0 : m_send_window_scale);
+        send_window_changed = send_window_size != m_send_window_size;
+        m_send_window_size = send_window_size;
+        m_send_window_update_sequence_number = packet.sequence_number();
+        m_send_window_update_ack_number = ack_number;
+    }
+
+    int removed = 0;
+    u32 bytes_acked = 0;
+    size_t bytes_in_flight = 0;
+    Optional<Time> rtt_sample;
+    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        bytes_in_flight = unacked_packets.size;
+        while (!unacked_packets.packets.is_empty()) {
+            auto& packet = unacked_packets.packets.first();
+
+            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
+
+            if (!sequence_number_less_than_or_equal(packet.ack_number, ack_number))
+                break;
+
+            // RFC 6298 section 3 (Karn's algorithm): Only sample packets that were never retransmitted.
+            if (packet.tx_counter == 0)
+                rtt_sample = now - packet.first_sent_time;
+
+            auto old_adapter = packet.adapter.strong_ref();
+            if (old_adapter)
+                old_adapter->release_packet_buffer(*packet.buffer);
+            TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
+            auto payload_size = packet.buffer->buffer->data() + packet.buffer->buffer->size() - (u8*)tcp_packet.payload();
+            unacked_packets.size -= payload_size;
+            bytes_acked += packet.ack_number - packet.sequence_number;
+            unacked_packets.packets.take_first();
+            removed++;
+        }
+
+        // RFC 2018: Remember which of the remaining packets the peer already has, so we don't retransmit them.
+        for (size_t i = 0; i < options.sack_block_count; ++i) {
+            u32 left_edge = options.sack_blocks[i].left_edge;
+            u32 right_edge = options.sack_blocks[i].right_edge;
+            for (auto& packet : unacked_packets.packets) {
+                if (sequence_number_less_than_or_equal(left_edge, packet.sequence_number) && sequence_number_less_than_or_equal(packet.ack_number, right_edge))
+                    packet.is_sacked = true;
+            }
+        }
+
+        if (unacked_packets.packets.is_empty()) {
+            m_retransmit_attempts = 0;
+            stop_retransmit_timer();
+        }
+
+        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
+    });
+
+    if (removed > 0) {
+        if (rtt_sample.has_value())
+            update_rtt_estimate(rtt_sample.value());
+        // RFC 6298 section 5.3: Restart the timer whenever new data is acknowledged.
+        m_retransmit_timer_start = now;
+        if (TCPTimerWheel::the().is_armed(m_retransmit_timer))
+            restart_retransmit_timer();
+        m_retransmit_attempts = 0;
+        m_duplicate_acks_received = 0;
+
+        if (!m_recovery_point.has_value()) {
+            m_congestion_control->on_ack(bytes_acked, now, m_smoothed_rtt);
+        } else if (sequence_number_less_than_or_equal(m_recovery_point.value(), ack_number)) {
+            // RFC 6582 section 3.2 step 3: Full acknowledgement, recovery is over.
+            if (m_is_recovering_from_timeout)
+                m_congestion_control->on_ack(bytes_acked, now, m_smoothed_rtt);
+            else
+                m_congestion_control->on_recovery_complete();
+            m_recovery_point.clear();
+            m_is_recovering_from_timeout = false;
+        } else {
+            // RFC 6582 section 3.2 step 4: A partial acknowledgement means the next segment was lost as well.
+            if (m_is_recovering_from_timeout)
+                m_congestion_control->on_ack(bytes_acked, now, m_smoothed_rtt);
+            retransmit_first_unacknowledged_packet();
+        }
+
+        // Wake up writers only now that both the acknowledged data and the grown congestion window make room.
+        evaluate_block_conditions();
+        return;
+    }
+
+    // A pure window update can make room as well, e.g. when the peer opens a zero window.
+    if (send_window_changed)
+        evaluate_block_conditions();
+
+    // RFC 5681 section 2: An ACK that carries no data and doesn't move the window while data is outstanding is a duplicate.
+    if (bytes_in_flight == 0 || payload_size != 0 || packet.has_syn() || packet.has_fin() || send_window_changed)
+        return;
+    if (++m_duplicate_acks_received != duplicate_ack_threshold || m_recovery_point.has_value())
+        return;
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) got {} duplicate ACKs for {}, entering fast recovery", this, m_duplicate_acks_received, ack_number);
+    m_congestion_control->on_loss(bytes_in_flight, now);
+    m_recovery_point = m_sequence_number;
+    m_is_recovering_from_timeout = false;
+    retransmit_first_unacknowledged_packet();
+}
+
+void TCPSocket::update_rtt_estimate(Time const& sample)
+{
+    auto sample_us = max<i64>(sample.to_microseconds(), 1);
+    if (!m_has_rtt_estimate) {
+        // RFC 6298 section 2.2
+        m_smoothed_rtt = Time::from_microseconds(sample_us);
+        m_rtt_variance = Time::from_microseconds(sample_us / 2);
+        m_has_rtt_estimate = true;
+    } else {
+        // RFC 6298 section 2.3, with alpha = 1/8 and beta = 1/4
+        auto smoothed_rtt_us = m_smoothed_rtt.to_microseconds();
+        auto deviation_us = smoothed_rtt_us > sample_us ? smoothed_rtt_us - sample_us : sample_us - smoothed_rtt_us;
+        m_rtt_variance = Time::from_microseconds((3 * m_rtt_variance.to_microseconds() + deviation_us) / 4);
+        m_smoothed_rtt = Time::from_microseconds((7 * smoothed_rtt_us + sample_us) / 8);
+    }
+
+    auto variance_term = Time::from_microseconds(4 * m_rtt_variance.to_microseconds());
+    m_retransmission_timeout = m_smoothed_rtt + max(retransmit_clock_granularity, variance_term);
+    m_retransmission_timeout = clamp(m_retransmission_timeout, minimum_retransmission_timeout, maximum_retransmission_timeout);
+}
+
+u16 TCPSocket::window_to_advertise(bool is_syn)
+{
+    size_t window = receive_buffer_space();
+    m_last_advertised_window = window;
+    // RFC 7323 section 2.2: The window field of a SYN segment is never scaled.
+    if (is_syn)
+        return min<size_t>(window, NumericLimits<u16>::max());
+    return min<size_t>(window >> m_receive_window_scale, NumericLimits<u16>::max());
+}
+
+size_t TCPSocket::sack_blocks_to_send(Array<TCPSACKBlock, maximum_tcp_sack_blocks>& blocks) const
+{
+    size_t count = 0;
+    size_t most_recent_block = 0;
+    for (auto& segment : m_out_of_order_segments) {
+        u32 left_edge = segment.sequence_number;
+        u32 right_edge = segment.sequence_number + segment.payload_size;
+        if (count > 0 && blocks[count - 1].right_edge == left_edge) {
+            blocks[count - 1].right_edge = right_edge;
+        } else {
+            if (count == blocks.size())
+                break;
+            blocks[count++] = { left_edge, right_edge };
+        }
+        if (segment.sequence_number == m_last_out_of_order_sequence_number)
+            most_recent_block = count - 1;
+    }
+
+    // RFC 2018 section 4: The first block must report the most recently received segment.
+    if (most_recent_block != 0)
+        swap(blocks[0], blocks[most_recent_block]);
+    return count;
+}
+
+bool TCPSocket::queue_out_of_order_segment(IPv4Packet const& ipv4_packet, TCPPacket const& tcp_packet, size_t payload_size, Time const& packet_timestamp)
+{
+    u32 sequence_number = tcp_packet.sequence_number();
+    if (payload_size == 0 || tcp_packet.has_fin() || !sequence_number_less_than(m_ack_number, sequence_number))
+        return false;
+    // Don't hold on to anything that wouldn't fit into the receive buffer once the gap is filled.
+    if (sequence_number + payload_size - m_ack_number > receive_buffer_space())
+        return false;
+
+    size_t index = 0;
+    for (; index < m_out_of_order_segments.size(); ++index) {
+        auto& segment = m_out_of_order_segments[index];
+        if (segment.sequence_number == sequence_number) {
+            m_last_out_of_order_sequence_number = sequence_number;
+            return true;
+        }
+        if (sequence_number_less_than(sequence_number, segment.sequence_number))
+            break;
+    }
+    if (m_out_of_order_segments.size() >= maximum_out_of_order_segments)
+        return false;
+
+    auto packet_or_error = ByteBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size());
+    if (packet_or_error.is_error())
+        return false;
+    if (m_out_of_order_segments.try_insert(index, { sequence_number, static_cast<u32>(payload_size), packet_timestamp, packet_or_error.release_value() }).is_error())
+        return false;
+    m_last_out_of_order_sequence_number = sequence_number;
+    return true;
+}
+
+void TCPSocket::deliver_queued_segments()
+{
+    while (!m_out_of_order_segments.is_empty()) {
+        auto& segment = m_out_of_order_segments.first();
+        if (segment.sequence_number != m_ack_number) {
+            // Anything we've already moved past (e.g. overlapping retransmissions) can go.
+            if (sequence_number_less_than(segment.sequence_number, m_ack_number)) {
+                m_out_of_order_segments.take_first();
+                continue;
+            }
+            break;
+        }
+        if (!did_receive(peer_address(), peer_port(), segment.ipv4_packet.bytes(), segment.timestamp))
+            break;
+        m_ack_number = segment.sequence_number + segment.payload_size;
+        m_out_of_order_segments.take_first();
+    }
+}
+
+void TCPSocket::protocol_did_read()
+{
+    if (m_state != State::Established && m_state != State::FinWait1 && m_state != State::FinWait2)
+        return;
+    // RFC 1122 section 4.2.3.3: Let the peer know once a shrunken window has opened up substantially.
+    if (m_last_advertised_window >= receive_buffer_size / 2)
+        return;
+    if (receive_buffer_space() - m_last_advertised_window < receive_buffer_size / 4)
+        return;
+    [[maybe_unused]] auto result = send_ack(true);
+}
+
 bool TCPSocket::should_delay_next_ack() const
 {
     // FIXME: We don't know the MSS here so make a reasonable guess.
@@ -343,7 +732,7 @@ bool TCPSocket::should_delay_next_ack() const
         return false;
 
     // RFC 1122 says we should not delay ACKs for more than 500 milliseconds.
-    if (kgettimeofday() >= m_last_ack_sent_time + Time::from_milliseconds(500))
+    if (kgettimeofday() >= m_last_ack_sent_time + maximum_ack_delay)
         return false;
 
     return true;
@@ -535,24 +924,99 @@ ErrorOr<void> TCPSocket::close()
     return result;
 }
 
-static Singleton<MutexProtected<TCPSocket::RetransmitList>> s_sockets_for_retransmit;
+void TCPSocket::restart_retransmit_timer()
+{
+    TCPTimerWheel::the().arm(m_retransmit_timer, m_retransmit_timer_start + m_retransmission_timeout - kgettimeofday());
+}
 
-MutexProtected<TCPSocket::RetransmitList>& TCPSocket::sockets_for_retransmit()
+void TCPSocket::stop_retransmit_timer()
 {
-    return *s_sockets_for_retransmit;
+    TCPTimerWheel::the().cancel(m_retransmit_timer);
 }
 
-void TCPSocket::enqueue_for_retransmit()
+void TCPSocket::schedule_delayed_ack()
 {
-    sockets_for_retransmit().with_exclusive([&](auto& list) {
-        list.append(*this);
-    });
+    if (TCPTimerWheel::the().is_armed(m_delayed_ack_timer))
+        return;
+    TCPTimerWheel::the().arm(m_delayed_ack_timer, m_last_ack_sent_time + maximum_ack_delay - kgettimeofday());
 }
 
-void TCPSocket::dequeue_for_retransmit()
+void TCPSocket::cancel_all_timers()
 {
-    sockets_for_retransmit().with_exclusive([&](auto& list) {
-        list.remove(*this);
+    auto& timer_wheel = TCPTimerWheel::the();
+    timer_wheel.cancel(m_retransmit_timer);
+    timer_wheel.cancel(m_delayed_ack_timer);
+    timer_wheel.cancel(m_time_wait_timer);
+}
+
+void TCPSocket::timer_expired(TCPTimer::Kind kind)
+{
+    switch (kind) {
+    case TCPTimer::Kind::Retransmit:
+        retransmit_packets();
+        return;
+    case TCPTimer::Kind::DelayedAck: {
+        [[maybe_unused]] auto result = send_ack();
+        return;
+    }
+    case TCPTimer::Kind::TimeWait:
+        if (m_state == State::TimeWait)
+            set_state(State::Closed);
+        return;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+void TCPSocket::send_outgoing_packet(OutgoingPacket& packet, RoutingDecision const& routing_decision)
+{
+    packet.tx_counter++;
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
+
+    auto adapter = routing_decision.adapter;
+    size_t ipv4_payload_offset = adapter->ipv4_payload_offset();
+    if (ipv4_payload_offset != packet.ipv4_payload_offset) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // like the previous adapter.
+        VERIFY_NOT_REACHED();
+    }
+
+    auto packet_buffer = packet.buffer->bytes();
+
+    adapter->fill_in_ipv4_header(*packet.buffer,
+        local_address(), routing_decision.next_hop, peer_address(),
+        IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
+    adapter->send_packet(packet_buffer);
+    m_packets_out++;
+    m_bytes_out += packet_buffer.size();
+}
+
+void TCPSocket::retransmit_first_unacknowledged_packet()
+{
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return;
+
+    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        for (auto& packet : unacked_packets.packets) {
+            if (packet.is_sacked)
+                continue;
+            send_outgoing_packet(packet, routing_decision);
+            return;
+        }
     });
 }
 
@@ -560,18 +1024,19 @@ void TCPSocket::retransmit_packets()
 {
     auto now = kgettimeofday();
 
-    // RFC6298 says we should have at least one second between retransmits. According to
-    // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
-    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
+    bool has_unacked_packets = m_unacked_packets.with_shared([](auto& unacked_packets) { return !unacked_packets.packets.is_empty(); });
+    if (!has_unacked_packets || m_state == State::Closed)
+        return;
 
-    if (m_last_retransmit_time > now - Time::from_seconds(retransmit_interval))
+    // The wheel can fire a little early since it runs off the monotonic clock.
+    if (m_retransmit_timer_start + m_retransmission_timeout > now) {
+        restart_retransmit_timer();
         return;
+    }
 
     dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
 
-    m_last_retransmit_time = now;
+    m_retransmit_timer_start = now;
     ++m_retransmit_attempts;
 
     if (m_retransmit_attempts > maximum_retransmits) {
@@ -581,46 +1046,23 @@ void TCPSocket::retransmit_packets()
         return;
     }
 
-    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
-    if (routing_decision.is_zero())
-        return;
-
-    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-        for (auto& packet : unacked_packets.packets) {
-            packet.tx_counter++;
-
-            if constexpr (TCP_SOCKET_DEBUG) {
-                auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                    local_address(), local_port(),
-                    peer_address(), peer_port(),
-                    (tcp_packet.has_syn() ? "SYN " : ""),
-                    (tcp_packet.has_ack() ? "ACK " : ""),
-                    (tcp_packet.has_fin() ? "FIN " : ""),
-                    (tcp_packet.has_rst() ? "RST " : ""),
-                    tcp_packet.sequence_number(),
-                    tcp_packet.ack_number(),
-                    packet.tx_counter);
-            }
-
-            size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-            if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-                // FIXME: Add support for this. This can happen if after a route change
-                // we ended up on another adapter which doesn't have the same layer 2 type
-                // like the previous adapter.
-                VERIFY_NOT_REACHED();
-            }
-
-            auto packet_buffer = packet.buffer->bytes();
+    // RFC 6298 section 5.5: Back off the timer. According to RFC 1122 we must do this even for SYN packets.
+    m_retransmission_timeout = min(m_retransmission_timeout + m_retransmission_timeout, maximum_retransmission_timeout);
 
-            routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-                local_address(), routing_decision.next_hop, peer_address(),
-                IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
-            routing_decision.adapter->send_packet(packet_buffer);
-            m_packets_out++;
-            m_bytes_out += packet_buffer.size();
-        }
+    size_t bytes_in_flight = m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        // RFC 2018 section 8: The peer may have discarded what it SACKed, so start over from the first unacknowledged packet.
+        for (auto& packet : unacked_packets.packets)
+            packet.is_sacked = false;
+        return unacked_packets.size;
     });
+
+    // RFC 5681 section 3.1: Fall back to slow start and resend the earliest segment that wasn't acknowledged.
+    m_congestion_control->on_retransmission_timeout(bytes_in_flight, now);
+    m_recovery_point = m_sequence_number;
+    m_is_recovering_from_timeout = true;
+    m_duplicate_acks_received = 0;
+    retransmit_first_unacknowledged_packet();
+    restart_retransmit_timer();
 }
 
 bool TCPSocket::can_write(const OpenFileDescription& file_description, u64 size) const
@@ -635,7 +1077,7 @@ bool TCPSocket::can_write(const OpenFileDescription& file_description, u64 size)
         return true;
 
     return m_unacked_packets.with_shared([&](auto& unacked_packets) {
-        return unacked_packets.size + size <= m_send_window_size;
+        return unacked_packets.size + size < min(m_send_window_size, m_congestion_control->congestion_window());
     });
 }
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
 #include <AK/Error.h>
 #include <AK/Function.h>
 #include <AK/HashMap.h>
@@ -13,6 +14,10 @@
 #include <AK/WeakPtr.h>
 #include <Kernel/Locking/MutexProtected.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/Routing.h>
+#include <Kernel/Net/TCP.h>
+#include <Kernel/Net/TCPCongestionControl.h>
+#include <Kernel/Net/TCPTimerWheel.h>
 
 namespace Kernel {
 
@@ -139,11 +144,31 @@ public:
     void set_duplicate_acks(u32 acks) { m_duplicate_acks = acks; }
     u32 duplicate_acks() const { return m_duplicate_acks; }
 
+    u32 send_window_size() const { return m_send_window_size; }
+    u32 congestion_window() const { return m_congestion_control->congestion_window(); }
+    StringView congestion_control_name() const { return m_congestion_control->name(); }
+    Time const& smoothed_rtt() const { return m_smoothed_rtt; }
+    Time const& retransmission_timeout() const { return m_retransmission_timeout; }
+
     ErrorOr<void> send_ack(bool allow_duplicate = false);
     ErrorOr<void> send_tcp_packet(u16 flags, const UserOrKernelBuffer* = nullptr, size_t = 0, RoutingDecision* = nullptr);
     void receive_tcp_packet(const TCPPacket&, u16 size);
 
+    // Records the MSS, window scale and SACK-permitted options from the peer's SYN.
+    struct ReceivedOptions;
+    void apply_syn_options(TCPPacket const&);
+
+    // Holds on to a segment that arrived ahead of ack_number(), so that it can be SACKed now and delivered
+    // once the gap has been filled. Returns false if the segment couldn't be kept around.
+    bool queue_out_of_order_segment(IPv4Packet const&, TCPPacket const&, size_t payload_size, Time const& packet_timestamp);
+    void deliver_queued_segments();
+    bool has_queued_out_of_order_segments() const { return !m_out_of_order_segments.is_empty(); }
+
     bool should_delay_next_ack() const;
+    void schedule_delayed_ack();
+
+    // Called by NetworkTask with the socket mutex held.
+    void timer_expired(TCPTimer::Kind);
 
     static MutexProtected<HashMap<IPv4SocketTuple, TCPSocket*>>& sockets_by_tuple();
     static RefPtr<TCPSocket> from_tuple(const IPv4SocketTuple& tuple);
@@ -156,8 +181,6 @@ public:
     void release_to_originator();
     void release_for_accept(RefPtr<TCPSocket>);
 
-    void retransmit_packets();
-
     virtual ErrorOr<void> close() override;
 
     virtual bool can_write(const OpenFileDescription&, u64) const override;
@@ -168,7 +191,7 @@ protected:
     void set_direction(Direction direction) { m_direction = direction; }
 
 private:
-    explicit TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer);
+    explicit TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer, NonnullOwnPtr<TCPCongestionControl>);
     virtual StringView class_name() const override { return "TCPSocket"sv; }
 
     virtual void shut_down_for_writing() override;
@@ -181,9 +204,22 @@ private:
     virtual bool protocol_is_disconnected() const override;
     virtual ErrorOr<void> protocol_bind() override;
     virtual ErrorOr<void> protocol_listen(bool did_allocate_port) override;
+    virtual void protocol_did_read() override;
+
+    void retransmit_packets();
+    void restart_retransmit_timer();
+    void stop_retransmit_timer();
+    void cancel_all_timers();
 
-    void enqueue_for_retransmit();
-    void dequeue_for_retransmit();
+    struct OutgoingPacket;
+
+    void apply_syn_options(ReceivedOptions const&);
+    void process_ack(TCPPacket const&, size_t payload_size, ReceivedOptions const&);
+    void update_rtt_estimate(Time const& sample);
+    u16 window_to_advertise(bool is_syn);
+    size_t sack_blocks_to_send(Array<TCPSACKBlock, maximum_tcp_sack_blocks>&) const;
+    void send_outgoing_packet(OutgoingPacket&, RoutingDecision const&);
+    void retransmit_first_unacknowledged_packet();
 
     WeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullRefPtr<TCPSocket>> m_pending_release_for_accept;
@@ -199,11 +235,14 @@ private:
     u32 m_bytes_out { 0 };
 
     struct OutgoingPacket {
+        u32 sequence_number { 0 };
         u32 ack_number { 0 };
         RefPtr<PacketWithTimestamp> buffer;
         size_t ipv4_payload_offset;
         WeakPtr<NetworkAdapter> adapter;
         int tx_counter { 0 };
+        Time first_sent_time;
+        bool is_sacked { false };
     };
 
     struct UnackedPackets {
@@ -217,20 +256,52 @@ private:
 
     u32 m_last_ack_number_sent { 0 };
     Time m_last_ack_sent_time;
+    u32 m_last_advertised_window { 0 };
 
     // FIXME: Make this configurable (sysctl)
     static constexpr u32 maximum_retransmits = 5;
-    Time m_last_retransmit_time;
+    Time m_retransmit_timer_start;
     u32 m_retransmit_attempts { 0 };
 
-    // FIXME: Parse window size TCP option from the peer
-    u32 m_send_window_size { 64 * KiB };
+    // RFC 6298
+    bool m_has_rtt_estimate { false };
+    Time m_smoothed_rtt;
+    Time m_rtt_variance;
+    Time m_retransmission_timeout { Time::from_seconds(1) };
 
-    IntrusiveListNode<TCPSocket> m_retransmit_list_node;
+    // RFC 879: Without an MSS option, the peer can only be assumed to accept 536 byte segments.
+    static constexpr u16 default_maximum_segment_size = 536;
+    u16 m_peer_maximum_segment_size { default_maximum_segment_size };
 
-public:
-    using RetransmitList = IntrusiveList<&TCPSocket::m_retransmit_list_node>;
-    static MutexProtected<TCPSocket::RetransmitList>& sockets_for_retransmit();
+    // RFC 7323: Both shift counts stay 0 unless both sides sent a window scale option.
+    u8 m_send_window_scale { 0 };
+    u8 m_receive_window_scale { 0 };
+    bool m_sack_permitted { false };
+
+    u32 m_send_window_size { 64 * KiB };
+    // SND.WL1 and SND.WL2 from RFC 793: The sequence and acknowledgement numbers of the segment the window was last taken from.
+    u32 m_send_window_update_sequence_number { 0 };
+    u32 m_send_window_update_ack_number { 0 };
+    NonnullOwnPtr<TCPCongestionControl> m_congestion_control;
+    u32 m_duplicate_acks_received { 0 };
+
+    // Set while recovering from a loss, until everything sent before the loss has been acknowledged (RFC 6582).
+    Optional<u32> m_recovery_point;
+    bool m_is_recovering_from_timeout { false };
+
+    struct OutOfOrderSegment {
+        u32 sequence_number { 0 };
+        u32 payload_size { 0 };
+        Time timestamp;
+        ByteBuffer ipv4_packet;
+    };
+    static constexpr size_t maximum_out_of_order_segments = 64;
+    Vector<OutOfOrderSegment> m_out_of_order_segments;
+    u32 m_last_out_of_order_sequence_number { 0 };
+
+    TCPTimer m_retransmit_timer { *this, TCPTimer::Kind::Retransmit };
+    TCPTimer m_delayed_ack_timer { *this, TCPTimer::Kind::DelayedAck };
+    TCPTimer m_time_wait_timer { *this, TCPTimer::Kind::TimeWait };
 };
 
 }
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BuiltinWrappers.h>
+#include <AK/Singleton.h>
+#include <Kernel/Net/TCPSocket.h>
+#include <Kernel/Net/TCPTimerWheel.h>
+#include <Kernel/Time/TimeManagement.h>
+
+namespace Kernel {
+
+static Singleton<TCPTimerWheel> s_the;
+
+TCPTimerWheel& TCPTimerWheel::the()
+{
+    return *s_the;
+}
+
+TCPTimerWheel::TCPTimerWheel()
+    : m_epoch(TimeManagement::the().monotonic_time())
+{
+}
+
+u64 TCPTimerWheel::tick_for(Time const& time) const
+{
+    auto microseconds = (time - m_epoch).to_microseconds();
+    if (microseconds <= 0)
+        return 0;
+    return static_cast<u64>(microseconds) / tick_microseconds;
+}
+
+void TCPTimerWheel::insert(Wheel& wheel, TCPTimer& timer)
+{
+    VERIFY(timer.m_expiration_tick >= wheel.current_tick);
+    auto delta = timer.m_expiration_tick - wheel.current_tick;
+
+    // Each level covers 64 times the range of the previous one. A timer goes into the
+    // lowest level that can hold it, and moves down as the wheel turns.
+    size_t level = 0;
+    while (level + 1 < level_count && delta >= (1ull << level_shift(level + 1)))
+        ++level;
+    size_t slot = (timer.m_expiration_tick >> level_shift(level)) & (slots_per_level - 1);
+
+    timer.m_level = level;
+    timer.m_slot = slot;
+    wheel.levels[level].slots[slot].append(timer);
+    wheel.levels[level].occupied_slots |= 1ull << slot;
+}
+
+void TCPTimerWheel::remove(Wheel& wheel, TCPTimer& timer)
+{
+    auto& level = wheel.levels[timer.m_level];
+    auto& list = level.slots[timer.m_slot];
+    list.remove(timer);
+    if (list.is_empty())
+        level.occupied_slots &= ~(1ull << timer.m_slot);
+}
+
+void TCPTimerWheel::arm(TCPTimer& timer, Time const& delay)
+{
+    auto now_tick = tick_for(TimeManagement::the().monotonic_time());
+    auto delay_microseconds = max<i64>(delay.to_microseconds(), 0);
+    u64 delay_ticks = (static_cast<u64>(delay_microseconds) + tick_microseconds - 1) / tick_microseconds;
+
+    m_wheel.with([&](Wheel& wheel) {
+        if (timer.m_list_node.is_in_list())
+            remove(wheel, timer);
+
+        // The wheel may lag behind the clock if the network task hasn't run for a while,
+        // so make sure the timer doesn't land in a slot that has already been processed.
+        auto expiration_tick = max(now_tick + delay_ticks, wheel.current_tick + 1);
+        timer.m_expiration_tick = min(expiration_tick, wheel.current_tick + maximum_delay_ticks);
+        insert(wheel, timer);
+    });
+}
+
+void TCPTimerWheel::cancel(TCPTimer& timer)
+{
+    m_wheel.with([&](Wheel& wheel) {
+        if (timer.m_list_node.is_in_list())
+            remove(wheel, timer);
+    });
+}
+
+bool TCPTimerWheel::is_armed(TCPTimer const& timer) const
+{
+    return m_wheel.with([&](auto&) {
+        return timer.m_list_node.is_in_list();
+    });
+}
+
+void TCPTimerWheel::advance_one_tick(Wheel& wheel, ExpiredTimers& expired_timers)
+{
+    auto tick = ++wheel.current_tick;
+
+    // Whenever a level wraps around, the next slot of the level above is redistributed.
+    for (size_t level_index = level_count - 1; level_index > 0; --level_index) {
+        if ((tick & ((1ull << level_shift(level_index)) - 1)) != 0)
+            continue;
+        auto& level = wheel.levels[level_index];
+        size_t slot = (tick >> level_shift(level_index)) & (slots_per_level - 1);
+        auto& list = level.slots[slot];
+        while (!list.is_empty()) {
+            auto* timer = list.take_first();
+            insert(wheel, *timer);
+        }
+        level.occupied_slots &= ~(1ull << slot);
+    }
+
+    auto& level = wheel.levels[0];
+    size_t slot = tick & (slots_per_level - 1);
+    auto& list = level.slots[slot];
+    while (!list.is_empty()) {
+        auto* timer = list.take_first();
+        VERIFY(timer->m_expiration_tick == tick);
+        if (expired_timers.try_append({ timer->m_socket, timer->m_kind }).is_error()) {
+            // We'll get another chance on the next tick.
+            timer->m_expiration_tick = tick + 1;
+            insert(wheel, *timer);
+        }
+    }
+    if (list.is_empty())
+        level.occupied_slots &= ~(1ull << slot);
+}
+
+Optional<u64> TCPTimerWheel::next_event_tick(Wheel const& wheel)
+{
+    Optional<u64> next_tick;
+    for (size_t level_index = 0; level_index < level_count; ++level_index) {
+        auto occupied_slots = wheel.levels[level_index].occupied_slots;
+        if (occupied_slots == 0)
+            continue;
+
+        // Find the first occupied slot after the current one, wrapping around.
+        u64 period = wheel.current_tick >> level_shift(level_index);
+        size_t first_slot = (period + 1) & (slots_per_level - 1);
+        u64 rotated = first_slot == 0 ? occupied_slots : (occupied_slots >> first_slot) | (occupied_slots << (slots_per_level - first_slot));
+        u64 tick = (period + 1 + count_trailing_zeroes(rotated)) << level_shift(level_index);
+
+        // For the upper levels, this is the tick at which the slot gets redistributed.
+        if (!next_tick.has_value() || tick < next_tick.value())
+            next_tick = tick;
+    }
+    return next_tick;
+}
+
+void TCPTimerWheel::collect_expired_timers(ExpiredTimers& expired_timers)
+{
+    auto now_tick = tick_for(TimeManagement::the().monotonic_time());
+
+    // Holding the socket table lock keeps TCPSocket::unref() from destroying any of the
+    // sockets before we've taken a reference to them. It cancels all timers of a socket
+    // before giving up the lock.
+    TCPSocket::sockets_by_tuple().with_shared([&](auto&) {
+        m_wheel.with([&](Wheel& wheel) {
+            while (wheel.current_tick < now_tick) {
+                auto next_tick = next_event_tick(wheel);
+                if (!next_tick.has_value() || next_tick.value() > now_tick) {
+                    wheel.current_tick = now_tick;
+                    break;
+                }
+                // Nothing happens in between, so skip straight to the next event.
+                wheel.current_tick = next_tick.value() - 1;
+                advance_one_tick(wheel, expired_timers);
+            }
+        });
+    });
+}
+
+Optional<Time> TCPTimerWheel::time_until_next_expiration() const
+{
+    auto now_tick = tick_for(TimeManagement::the().monotonic_time());
+    return m_wheel.with([&](Wheel const& wheel) -> Optional<Time> {
+        auto next_tick = next_event_tick(wheel);
+        if (!next_tick.has_value())
+            return {};
+        if (next_tick.value() <= now_tick)
+            return Time::zero();
+        return Time::from_microseconds((next_tick.value() - now_tick) * tick_microseconds);
+    });
+}
+
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/Time.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+#include <Kernel/Locking/SpinlockProtected.h>
+
+namespace Kernel {
+
+class TCPSocket;
+
+class TCPTimer {
+    AK_MAKE_NONCOPYABLE(TCPTimer);
+    AK_MAKE_NONMOVABLE(TCPTimer);
+
+public:
+    enum class Kind : u8 {
+        Retransmit,
+        DelayedAck,
+        TimeWait,
+    };
+
+    TCPTimer(TCPSocket& socket, Kind kind)
+        : m_socket(socket)
+        , m_kind(kind)
+    {
+    }
+
+    ~TCPTimer() { VERIFY(!m_list_node.is_in_list()); }
+
+    Kind kind() const { return m_kind; }
+
+private:
+    friend class TCPTimerWheel;
+
+    TCPSocket& m_socket;
+    Kind m_kind;
+    u64 m_expiration_tick { 0 };
+    u8 m_level { 0 };
+    u8 m_slot { 0 };
+    IntrusiveListNode<TCPTimer> m_list_node;
+
+public:
+    using List = IntrusiveList<&TCPTimer::m_list_node>;
+};
+
+// A hierarchical timer wheel (Varghese & Lauck) holding the retransmission, delayed ACK
+// and TIME_WAIT timers of all TCP sockets. Arming and cancelling a timer is O(1), and
+// advancing the wheel only touches the timers that expire or cascade down a level, so the
+// cost of a tick doesn't grow with the number of open connections.
+class TCPTimerWheel {
+public:
+    static TCPTimerWheel& the();
+
+    static constexpr i64 tick_microseconds = 10'000;
+    static constexpr Time tick_duration = Time::from_microseconds(tick_microseconds);
+
+    TCPTimerWheel();
+
+    // (Re-)arms the timer to expire after the given delay, rounded up to the next tick.
+    void arm(TCPTimer&, Time const& delay);
+    void cancel(TCPTimer&);
+    bool is_armed(TCPTimer const&) const;
+
+    struct ExpiredTimer {
+        NonnullRefPtr<TCPSocket> socket;
+        TCPTimer::Kind kind;
+    };
+    using ExpiredTimers = Vector<ExpiredTimer, 32>;
+
+    // Advances the wheel to the current time and collects the timers that expired along the way.
+    void collect_expired_timers(ExpiredTimers&);
+
+    // How long until the earliest armed timer expires, if any timer is armed at all.
+    Optional<Time> time_until_next_expiration() const;
+
+private:
+    static constexpr size_t level_count = 4;
+    static constexpr size_t slot_bits = 6;
+    static constexpr size_t slots_per_level = 1 << slot_bits;
+    static constexpr u64 maximum_delay_ticks = (1ull << (slot_bits * level_count)) - 1;
+
+    struct Level {
+        Array<TCPTimer::List, slots_per_level> slots;
+        u64 occupied_slots { 0 };
+    };
+
+    struct Wheel {
+        Array<Level, level_count> levels;
+        u64 current_tick { 0 };
+    };
+
+    static constexpr size_t level_shift(size_t level) { return level * slot_bits; }
+
+    u64 tick_for(Time const&) const;
+    static void insert(Wheel&, TCPTimer&);
+    static void remove(Wheel&, TCPTimer&);
+    static void advance_one_tick(Wheel&, ExpiredTimers&);
+    static Optional<u64> next_event_tick(Wheel const&);
+
+    Time m_epoch;
+    SpinlockProtected<Wheel> m_wheel;
+};
+
+}
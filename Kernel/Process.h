@@ -314,6 +314,9 @@ public:
     ErrorOr<FlatPtr> sys$msync(Userspace<void*>, size_t, int flags);
     ErrorOr<FlatPtr> sys$purge(int mode);
     ErrorOr<FlatPtr> sys$poll(Userspace<const Syscall::SC_poll_params*>);
+    ErrorOr<FlatPtr> sys$epoll_create(int flags);
+    ErrorOr<FlatPtr> sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*>);
+    ErrorOr<FlatPtr> sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*>);
     ErrorOr<FlatPtr> sys$get_dir_entries(int fd, Userspace<void*>, size_t);
     ErrorOr<FlatPtr> sys$getcwd(Userspace<char*>, size_t);
     ErrorOr<FlatPtr> sys$chdir(Userspace<const char*>, size_t);
@@ -405,6 +408,8 @@ public:
     ErrorOr<FlatPtr> sys$ptrace(Userspace<const Syscall::SC_ptrace_params*>);
     ErrorOr<FlatPtr> sys$sendfd(int sockfd, int fd);
     ErrorOr<FlatPtr> sys$recvfd(int sockfd, int options);
+    ErrorOr<FlatPtr> sys$sendfile(int out_fd, int in_fd, Userspace<off_t*>, size_t);
+    ErrorOr<FlatPtr> sys$splice(Userspace<const Syscall::SC_splice_params*>);
     ErrorOr<FlatPtr> sys$sysconf(int name);
     ErrorOr<FlatPtr> sys$disown(ProcessID);
     ErrorOr<FlatPtr> sys$allocate_tls(Userspace<const char*> initial_data, size_t);
@@ -6,8 +6,8 @@
 
 #include <AK/BuiltinWrappers.h>
 #include <AK/ScopeGuard.h>
-#include <AK/Singleton.h>
 #include <AK/Time.h>
+#include <Kernel/Arch/Processor.h>
 #include <Kernel/Arch/x86/InterruptDisabler.h>
 #include <Kernel/Arch/x86/TrapFrame.h>
 #include <Kernel/Debug.h>
@@ -50,7 +50,25 @@ struct ThreadReadyQueues {
     Array<ThreadReadyQueue, count> queues;
 };
 
-static Singleton<SpinlockProtected<ThreadReadyQueues>> g_ready_queues;
+// How often (in timer ticks) a processor compares its load against the other
+// processors and pulls runnable threads over from the busiest one.
+static constexpr u32 load_balance_interval = 50;
+
+struct SchedulerPerProcessorData {
+    static ProcessorSpecificDataID processor_specific_data_id() { return ProcessorSpecificDataID::Scheduler; }
+
+    SpinlockProtected<ThreadReadyQueues> ready_queues;
+
+    // The number of threads in ready_queues. This can be read without taking
+    // the lock to get a cheap (but racy) estimate of this processor's load.
+    Atomic<u32> ready_thread_count { 0 };
+
+    u32 ticks_until_load_balance { load_balance_interval };
+};
+
+// Processors that pull threads from their ready queues. Only these are
+// considered when picking a processor to queue a runnable thread on.
+static Atomic<u32> s_scheduling_processors { 0 };
 
 static SpinlockProtected<TotalTimeScheduled> g_total_time_scheduled;
 
@@ -63,7 +81,7 @@ static void dump_thread_list(bool = false);
 static inline u32 thread_priority_to_priority_index(u32 thread_priority)
 {
     // Converts the priority in the range of THREAD_PRIORITY_MIN...THREAD_PRIORITY_MAX
-    // to a index into g_ready_queues where 0 is the highest priority bucket
+    // to a index into ThreadReadyQueues::queues where 0 is the highest priority bucket
     VERIFY(thread_priority >= THREAD_PRIORITY_MIN && thread_priority <= THREAD_PRIORITY_MAX);
     constexpr u32 thread_priority_count = THREAD_PRIORITY_MAX - THREAD_PRIORITY_MIN + 1;
     static_assert(thread_priority_count > 0);
@@ -72,11 +90,65 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+static SchedulerPerProcessorData& scheduler_data_for(u32 cpu)
 {
-    auto affinity_mask = 1u << Processor::current_id();
+    auto* data = Processor::by_id(cpu).get_specific<SchedulerPerProcessorData>();
+    VERIFY(data);
+    return *data;
+}
+
+static u32 select_processor_for(Thread const& thread)
+{
+    auto candidates = thread.affinity() & s_scheduling_processors.load(AK::MemoryOrder::memory_order_acquire);
+    if (candidates == 0) {
+        // None of the processors this thread may run on are scheduling yet
+        // (e.g. the idle thread of an AP that is still booting). Park it
+        // here, the affinity checks keep us from running it.
+        return Processor::current_id();
+    }
+
+    u32 least_loaded_cpu = 0;
+    u32 least_load = NumericLimits<u32>::max();
+    for (auto mask = candidates; mask != 0;) {
+        auto cpu = bit_scan_forward(mask) - 1;
+        mask &= ~(1u << cpu);
+        auto load = scheduler_data_for(cpu).ready_thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+        if (load < least_load) {
+            least_loaded_cpu = cpu;
+            least_load = load;
+        }
+    }
+
+    // Prefer the processor the thread last ran on, as its caches are likely
+    // still warm, unless that would leave it noticeably more loaded than the
+    // others.
+    auto last_cpu = thread.cpu();
+    if ((candidates & (1u << last_cpu)) && scheduler_data_for(last_cpu).ready_thread_count.load(AK::MemoryOrder::memory_order_relaxed) <= least_load + 1)
+        return last_cpu;
+    return least_loaded_cpu;
+}
+
+void Scheduler::queue_runnable_thread(SchedulerPerProcessorData& data, u32 cpu, Thread& thread)
+{
+    auto priority = thread_priority_to_priority_index(thread.priority());
+
+    data.ready_queues.with([&](auto& ready_queues) {
+        VERIFY(thread.m_runnable_priority < 0);
+        thread.m_runnable_priority = (int)priority;
+        thread.m_runnable_cpu = cpu;
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        auto& ready_queue = ready_queues.queues[priority];
+        bool was_empty = ready_queue.thread_list.is_empty();
+        ready_queue.thread_list.append(thread);
+        if (was_empty)
+            ready_queues.mask |= (1u << priority);
+    });
+    data.ready_thread_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+}
 
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread& {
+Thread* Scheduler::take_runnable_thread(SchedulerPerProcessorData& data, u32 affinity_mask)
+{
+    auto* thread = data.ready_queues.with([&](auto& ready_queues) -> Thread* {
         auto priority_mask = ready_queues.mask;
         while (priority_mask != 0) {
             auto priority = bit_scan_forward(priority_mask);
@@ -92,30 +164,111 @@ Thread& Scheduler::pull_next_runnable_thread()
                 ready_queue.thread_list.remove(thread);
                 if (ready_queue.thread_list.is_empty())
                     ready_queues.mask &= ~(1u << priority);
-                // Mark it as active because we are using this thread. This is similar
-                // to comparing it with Processor::current_thread, but when there are
-                // multiple processors there's no easy way to check whether the thread
-                // is actually still needed. This prevents accidental finalization when
-                // a thread is no longer in Running state, but running on another core.
-
-                // We need to mark it active here so that this thread won't be
-                // scheduled on another core if it were to be queued before actually
-                // switching to it.
-                // FIXME: Figure out a better way maybe?
-                thread.set_active(true);
-                return thread;
+                return &thread;
             }
             priority_mask &= ~(1u << priority);
         }
-        return *Processor::idle_thread();
+        return nullptr;
     });
+    if (thread)
+        data.ready_thread_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+    return thread;
+}
+
+static Optional<u32> find_busiest_processor(u32 processors, u32& busiest_load)
+{
+    Optional<u32> busiest_cpu;
+    busiest_load = 0;
+    for (auto mask = processors; mask != 0;) {
+        auto cpu = bit_scan_forward(mask) - 1;
+        mask &= ~(1u << cpu);
+        auto load = scheduler_data_for(cpu).ready_thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+        if (load > busiest_load) {
+            busiest_cpu = cpu;
+            busiest_load = load;
+        }
+    }
+    return busiest_cpu;
+}
+
+Thread* Scheduler::steal_runnable_thread()
+{
+    // Our own ready queues are empty, so rather than going idle take over a
+    // thread from the busiest processor that has one we are allowed to run.
+    auto current_cpu = Processor::current_id();
+    auto affinity_mask = 1u << current_cpu;
+    auto processors = s_scheduling_processors.load(AK::MemoryOrder::memory_order_acquire) & ~affinity_mask;
+    while (processors != 0) {
+        u32 victim_load;
+        auto victim_cpu = find_busiest_processor(processors, victim_load);
+        if (!victim_cpu.has_value())
+            break;
+        if (auto* thread = take_runnable_thread(scheduler_data_for(*victim_cpu), affinity_mask)) {
+            dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Stole {} from processor {}", current_cpu, *thread, *victim_cpu);
+            return thread;
+        }
+        // Everything queued there is either already running or not allowed on this processor.
+        processors &= ~(1u << *victim_cpu);
+    }
+    return nullptr;
+}
+
+void Scheduler::balance_ready_queues()
+{
+    VERIFY(g_scheduler_lock.is_locked_by_current_processor());
+
+    auto current_cpu = Processor::current_id();
+    auto affinity_mask = 1u << current_cpu;
+    auto processors = s_scheduling_processors.load(AK::MemoryOrder::memory_order_acquire) & ~affinity_mask;
+    u32 busiest_load;
+    auto busiest_cpu = find_busiest_processor(processors, busiest_load);
+    if (!busiest_cpu.has_value())
+        return;
+
+    auto& local = ProcessorSpecific<SchedulerPerProcessorData>::get();
+    auto local_load = local.ready_thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+    if (busiest_load <= local_load + 1)
+        return;
+
+    // Move half of the difference over, so that both end up roughly equally loaded.
+    for (auto to_move = (busiest_load - local_load) / 2; to_move > 0; --to_move) {
+        auto* thread = take_runnable_thread(scheduler_data_for(*busiest_cpu), affinity_mask);
+        if (!thread)
+            break;
+        dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Load balancing {} from processor {}", current_cpu, *thread, *busiest_cpu);
+        queue_runnable_thread(local, current_cpu, *thread);
+    }
+}
+
+Thread& Scheduler::pull_next_runnable_thread()
+{
+    auto affinity_mask = 1u << Processor::current_id();
+
+    auto* thread = take_runnable_thread(ProcessorSpecific<SchedulerPerProcessorData>::get(), affinity_mask);
+    if (!thread)
+        thread = steal_runnable_thread();
+    if (!thread)
+        return *Processor::idle_thread();
+
+    // Mark it as active because we are using this thread. This is similar
+    // to comparing it with Processor::current_thread, but when there are
+    // multiple processors there's no easy way to check whether the thread
+    // is actually still needed. This prevents accidental finalization when
+    // a thread is no longer in Running state, but running on another core.
+
+    // We need to mark it active here so that this thread won't be
+    // scheduled on another core if it were to be queued before actually
+    // switching to it.
+    // FIXME: Figure out a better way maybe?
+    thread->set_active(true);
+    return *thread;
 }
 
 Thread* Scheduler::peek_next_runnable_thread()
 {
     auto affinity_mask = 1u << Processor::current_id();
 
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread* {
+    return ProcessorSpecific<SchedulerPerProcessorData>::get().ready_queues.with([&](auto& ready_queues) -> Thread* {
         auto priority_mask = ready_queues.mask;
         while (priority_mask != 0) {
             auto priority = bit_scan_forward(priority_mask);
@@ -141,27 +294,32 @@ Thread* Scheduler::peek_next_runnable_thread()
 
 bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
 {
+    VERIFY(g_scheduler_lock.is_locked_by_current_processor());
     if (thread.is_idle_thread())
         return true;
 
-    return g_ready_queues->with([&](auto& ready_queues) {
-        auto priority = thread.m_runnable_priority;
-        if (priority < 0) {
-            VERIFY(!thread.m_ready_queue_node.is_in_list());
-            return false;
-        }
+    if (thread.m_runnable_priority < 0) {
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        return false;
+    }
 
-        if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
-            return false;
+    if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
+        return false;
 
+    // The thread can't move to another processor's queues under us, as that
+    // also requires holding the scheduler lock.
+    auto& data = scheduler_data_for(thread.m_runnable_cpu);
+    data.ready_queues.with([&](auto& ready_queues) {
+        auto priority = thread.m_runnable_priority;
         VERIFY(ready_queues.mask & (1u << priority));
         auto& ready_queue = ready_queues.queues[priority];
         thread.m_runnable_priority = -1;
         ready_queue.thread_list.remove(thread);
         if (ready_queue.thread_list.is_empty())
             ready_queues.mask &= ~(1u << priority);
-        return true;
     });
+    data.ready_thread_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+    return true;
 }
 
 void Scheduler::enqueue_runnable_thread(Thread& thread)
@@ -169,18 +327,9 @@ void Scheduler::enqueue_runnable_thread(Thread& thread)
     VERIFY(g_scheduler_lock.is_locked_by_current_processor());
     if (thread.is_idle_thread())
         return;
-    auto priority = thread_priority_to_priority_index(thread.priority());
 
-    g_ready_queues->with([&](auto& ready_queues) {
-        VERIFY(thread.m_runnable_priority < 0);
-        thread.m_runnable_priority = (int)priority;
-        VERIFY(!thread.m_ready_queue_node.is_in_list());
-        auto& ready_queue = ready_queues.queues[priority];
-        bool was_empty = ready_queue.thread_list.is_empty();
-        ready_queue.thread_list.append(thread);
-        if (was_empty)
-            ready_queues.mask |= (1u << priority);
-    });
+    auto cpu = select_processor_for(thread);
+    queue_runnable_thread(scheduler_data_for(cpu), cpu, thread);
 }
 
 UNMAP_AFTER_INIT void Scheduler::start()
@@ -384,10 +533,27 @@ static u64 current_time_monotonic()
     return (u64)TimeManagement::the().monotonic_time(TimePrecision::Precise).to_nanoseconds();
 }
 
+UNMAP_AFTER_INIT static void initialize_ready_queues()
+{
+    if (Processor::current().get_specific<SchedulerPerProcessorData>())
+        return;
+    ProcessorSpecific<SchedulerPerProcessorData>::initialize();
+
+#if !SCHEDULE_ON_ALL_PROCESSORS
+    // Other processors don't pick threads to run yet, so don't queue any on them.
+    if (!Processor::is_bootstrap_processor())
+        return;
+#endif
+    s_scheduling_processors.fetch_or(1u << Processor::current_id(), AK::MemoryOrder::memory_order_release);
+}
+
 UNMAP_AFTER_INIT void Scheduler::initialize()
 {
     VERIFY(Processor::is_initialized()); // sanity check
 
+    // Creating the colonel process already queues its first thread.
+    initialize_ready_queues();
+
     // Figure out a good scheduling time source
     if (Processor::current().has_feature(CPUFeature::TSC)) {
         // TODO: only use if TSC is running at a constant frequency?
@@ -412,6 +578,7 @@ UNMAP_AFTER_INIT void Scheduler::initialize()
 
 UNMAP_AFTER_INIT void Scheduler::set_idle_thread(Thread* idle_thread)
 {
+    initialize_ready_queues();
     idle_thread->set_idle_thread();
     Processor::current().set_idle_thread(*idle_thread);
     Processor::set_current_thread(*idle_thread);
@@ -471,6 +638,13 @@ void Scheduler::timer_tick(const RegisterState& regs)
         return;
     }
 
+    auto& scheduler_data = ProcessorSpecific<SchedulerPerProcessorData>::get();
+    if (--scheduler_data.ticks_until_load_balance == 0) {
+        scheduler_data.ticks_until_load_balance = load_balance_interval;
+        SpinlockLocker scheduler_lock(g_scheduler_lock);
+        balance_ready_queues();
+    }
+
     if (current_thread->tick())
         return;
 
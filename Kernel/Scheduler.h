@@ -18,6 +18,7 @@
 namespace Kernel {
 
 struct RegisterState;
+struct SchedulerPerProcessorData;
 
 extern Thread* g_finalizer;
 extern WaitQueue* g_finalizer_wait_queue;
@@ -56,6 +57,12 @@ public:
     static TotalTimeScheduled get_total_time_scheduled();
     static void add_time_scheduled(u64, bool);
     static u64 (*current_time)();
+
+private:
+    static void queue_runnable_thread(SchedulerPerProcessorData&, u32 cpu, Thread&);
+    static Thread* take_runnable_thread(SchedulerPerProcessorData&, u32 affinity_mask);
+    static Thread* steal_runnable_thread();
+    static void balance_ready_queues();
 };
 
 }
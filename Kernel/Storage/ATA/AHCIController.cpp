@@ -68,6 +68,11 @@ void AHCIController::start_request(const ATADevice& device, AsyncBlockDeviceRequ
     port->start_request(request);
 }
 
+size_t AHCIController::max_transfer_size() const
+{
+    return AHCIPort::max_transfer_size;
+}
+
 void AHCIController::complete_current_request(AsyncDeviceRequest::RequestResult)
 {
     VERIFY_NOT_REACHED();
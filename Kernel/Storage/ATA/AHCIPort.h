@@ -39,6 +39,10 @@ class AHCIPort
 public:
     UNMAP_AFTER_INIT static NonnullRefPtr<AHCIPort> create(const AHCIPortHandler&, volatile AHCI::PortRegisters&, u32 port_index);
 
+    // Each request is staged through this many DMA pages, one physical region descriptor per page.
+    static constexpr size_t max_dma_pages_per_request = 16;
+    static constexpr size_t max_transfer_size = max_dma_pages_per_request * PAGE_SIZE;
+
     u32 port_index() const { return m_port_index; }
     u32 representative_port_index() const { return port_index() + 1; }
     bool is_operable() const;
@@ -72,7 +76,7 @@ private:
 
     void start_request(AsyncBlockDeviceRequest&);
     void complete_current_request(AsyncDeviceRequest::RequestResult);
-    bool access_device(AsyncBlockDeviceRequest::RequestType, u64 lba, u8 block_count);
+    bool access_device(AsyncBlockDeviceRequest::RequestType, u64 lba, u16 block_count);
     size_t calculate_descriptors_count(size_t block_count) const;
     [[nodiscard]] Optional<AsyncDeviceRequest::RequestResult> prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request);
 
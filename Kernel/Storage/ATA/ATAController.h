@@ -22,6 +22,7 @@ class ATAController
     , public Weakable<ATAController> {
 public:
     virtual void start_request(const ATADevice&, AsyncBlockDeviceRequest&) = 0;
+    virtual size_t max_transfer_size() const { return PAGE_SIZE; }
 
 protected:
     ATAController() = default;
@@ -32,4 +32,12 @@ void ATADevice::start_request(AsyncBlockDeviceRequest& request)
     controller->start_request(*this, request);
 }
 
+size_t ATADevice::max_blocks_per_request() const
+{
+    auto controller = m_controller.strong_ref();
+    if (!controller)
+        return StorageDevice::max_blocks_per_request();
+    return controller->max_transfer_size() / block_size();
+}
+
 }
@@ -11,20 +11,22 @@
 #include <AK/Types.h>
 #include <Kernel/Arch/x86/IO.h>
 #include <Kernel/Arch/x86/Processor.h>
+#include <Kernel/Arch/x86/ProcessorInfo.h>
 #include <Kernel/Arch/x86/SafeMem.h>
 #include <Kernel/Bus/PCI/API.h>
 #include <Kernel/CommandLine.h>
 #include <Kernel/Devices/Device.h>
 #include <Kernel/FileSystem/ProcFS.h>
+#include <Kernel/Interrupts/InterruptManagement.h>
 #include <Kernel/Sections.h>
 
 namespace Kernel {
 Atomic<u8> NVMeController::controller_id {};
 
-UNMAP_AFTER_INIT ErrorOr<NonnullRefPtr<NVMeController>> NVMeController::try_initialize(const Kernel::PCI::DeviceIdentifier& device_identifier, bool is_queue_polled)
+UNMAP_AFTER_INIT ErrorOr<NonnullRefPtr<NVMeController>> NVMeController::try_initialize(const Kernel::PCI::DeviceIdentifier& device_identifier, bool is_queue_polled, bool is_hybrid_polling_enabled)
 {
     auto controller = TRY(adopt_nonnull_ref_or_enomem(new NVMeController(device_identifier)));
-    TRY(controller->initialize(is_queue_polled));
+    TRY(controller->initialize(is_queue_polled, is_hybrid_polling_enabled));
     NVMeController::controller_id++;
     return controller;
 }
@@ -35,11 +37,10 @@ UNMAP_AFTER_INIT NVMeController::NVMeController(const PCI::DeviceIdentifier& dev
 {
 }
 
-UNMAP_AFTER_INIT ErrorOr<void> NVMeController::initialize(bool is_queue_polled)
+UNMAP_AFTER_INIT ErrorOr<void> NVMeController::initialize(bool is_queue_polled, bool is_hybrid_polling_enabled)
 {
     // Nr of queues = one queue per core
     auto nr_of_queues = Processor::count();
-    auto irq = is_queue_polled ? Optional<u8> {} : m_pci_device_id.interrupt_line().value();
 
     PCI::enable_memory_space(m_pci_device_id.address());
     PCI::enable_bus_mastering(m_pci_device_id.address());
@@ -55,7 +56,22 @@ UNMAP_AFTER_INIT ErrorOr<void> NVMeController::initialize(bool is_queue_polled)
     m_ready_timeout = Time::from_milliseconds((CAP_TO(caps) + 1) * 500); // CAP.TO is in 500ms units
 
     calculate_doorbell_stride();
-    TRY(create_admin_queue(irq));
+
+    if (!is_queue_polled) {
+        m_hybrid_polling = is_hybrid_polling_enabled;
+        // With MSI-X, every queue gets its own interrupt which is delivered to the processor
+        // that submits on it. We need one table entry for the admin queue and one per I/O queue.
+        if (is_msix_capable() && InterruptManagement::the().smp_enabled() && extended_message_signalled_interrupt_count() > nr_of_queues) {
+            m_interrupt_type = NVMeQueueInterrupt::Type::MSIX;
+            disable_pin_based_interrupts();
+            enable_extended_message_signalled_interrupts();
+        } else {
+            m_interrupt_type = NVMeQueueInterrupt::Type::PinBased;
+        }
+    }
+    dbgln_if(NVME_DEBUG, "NVMe: Using {} completion", m_interrupt_type == NVMeQueueInterrupt::Type::MSIX ? "MSI-X" : m_interrupt_type == NVMeQueueInterrupt::Type::PinBased ? "pin-based interrupt" : "polled");
+
+    TRY(create_admin_queue());
     VERIFY(m_admin_queue_ready == true);
 
     VERIFY(IO_QUEUE_SIZE < MQES(caps));
@@ -64,7 +80,7 @@ UNMAP_AFTER_INIT ErrorOr<void> NVMeController::initialize(bool is_queue_polled)
     // Create an IO queue per core
     for (u32 cpuid = 0; cpuid < nr_of_queues; ++cpuid) {
         // qid is zero is used for admin queue
-        TRY(create_io_queue(cpuid + 1, irq));
+        TRY(create_io_queue(cpuid + 1));
     }
     TRY(identify_and_init_namespaces());
     return {};
@@ -255,7 +271,32 @@ void NVMeController::complete_current_request([[maybe_unused]] AsyncDeviceReques
     VERIFY_NOT_REACHED();
 }
 
-UNMAP_AFTER_INIT ErrorOr<void> NVMeController::create_admin_queue(Optional<u8> irq)
+UNMAP_AFTER_INIT ErrorOr<NVMeQueueInterrupt> NVMeController::setup_queue_interrupt(u16 qid)
+{
+    NVMeQueueInterrupt interrupt;
+    interrupt.type = m_interrupt_type;
+    interrupt.hybrid_polling = m_hybrid_polling && qid != 0;
+
+    switch (m_interrupt_type) {
+    case NVMeQueueInterrupt::Type::Polled:
+        break;
+    case NVMeQueueInterrupt::Type::PinBased:
+        interrupt.interrupt_number = m_pci_device_id.interrupt_line().value();
+        break;
+    case NVMeQueueInterrupt::Type::MSIX: {
+        // MSI-X table entry N belongs to queue N. The admin queue interrupts the BSP, and
+        // each I/O queue the processor it was created for (see NVMeNameSpace::start_request).
+        interrupt.interrupt_number = TRY(InterruptManagement::the().reserve_message_signalled_interrupt_number());
+        u32 processor_id = qid == 0 ? 0 : qid - 1;
+        auto apic_id = Processor::by_id(processor_id).info().apic_id();
+        TRY(configure_extended_message_signalled_interrupt(qid, IRQ_VECTOR_BASE + interrupt.interrupt_number, apic_id));
+        break;
+    }
+    }
+    return interrupt;
+}
+
+UNMAP_AFTER_INIT ErrorOr<void> NVMeController::create_admin_queue()
 {
     auto qdepth = get_admin_q_dept();
     OwnPtr<Memory::Region> cq_dma_region;
@@ -291,14 +332,16 @@ UNMAP_AFTER_INIT ErrorOr<void> NVMeController::create_admin_queue(Optional<u8> i
         return EFAULT;
     }
     set_admin_queue_ready_flag();
-    m_admin_queue = TRY(NVMeQueue::try_create(0, irq, qdepth, move(cq_dma_region), cq_dma_pages, move(sq_dma_region), sq_dma_pages, move(doorbell_regs)));
+    auto interrupt = TRY(setup_queue_interrupt(0));
+    m_admin_queue = TRY(NVMeQueue::try_create(0, interrupt, qdepth, move(cq_dma_region), cq_dma_pages, move(sq_dma_region), sq_dma_pages, move(doorbell_regs)));
 
     dbgln_if(NVME_DEBUG, "NVMe: Admin queue created");
     return {};
 }
 
-UNMAP_AFTER_INIT ErrorOr<void> NVMeController::create_io_queue(u8 qid, Optional<u8> irq)
+UNMAP_AFTER_INIT ErrorOr<void> NVMeController::create_io_queue(u8 qid)
 {
+    auto interrupt = TRY(setup_queue_interrupt(qid));
     OwnPtr<Memory::Region> cq_dma_region;
     NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_pages;
     OwnPtr<Memory::Region> sq_dma_region;
@@ -327,12 +370,12 @@ UNMAP_AFTER_INIT ErrorOr<void> NVMeController::create_io_queue(u8 qid, Optional<
         sub.create_cq.cqid = qid;
         // The queue size is 0 based
         sub.create_cq.qsize = AK::convert_between_host_and_little_endian(IO_QUEUE_SIZE - 1);
-        auto flags = irq.has_value() ? QUEUE_IRQ_ENABLED : QUEUE_IRQ_DISABLED;
+        auto flags = interrupt.type != NVMeQueueInterrupt::Type::Polled ? QUEUE_IRQ_ENABLED : QUEUE_IRQ_DISABLED;
         flags |= QUEUE_PHY_CONTIGUOUS;
-        // TODO: Eventually move to MSI.
-        // For now using pin based interrupts. Clear the first 16 bits
-        // to use pin-based interrupts.
         sub.create_cq.cq_flags = AK::convert_between_host_and_little_endian(flags & 0xFFFF);
+        // With pin-based interrupts the vector has to be 0, with MSI-X it's the table entry of this queue.
+        if (interrupt.type == NVMeQueueInterrupt::Type::MSIX)
+            sub.create_cq.irq_vector = AK::convert_between_host_and_little_endian<u16>(qid);
         submit_admin_command(sub, true);
     }
     {
@@ -351,7 +394,7 @@ UNMAP_AFTER_INIT ErrorOr<void> NVMeController::create_io_queue(u8 qid, Optional<
     auto queue_doorbell_offset = REG_SQ0TDBL_START + ((2 * qid) * (4 << m_dbl_stride));
     auto doorbell_regs = TRY(Memory::map_typed_writable<volatile DoorbellRegister>(PhysicalAddress(m_bar + queue_doorbell_offset)));
 
-    m_queues.append(TRY(NVMeQueue::try_create(qid, irq, IO_QUEUE_SIZE, move(cq_dma_region), cq_dma_pages, move(sq_dma_region), sq_dma_pages, move(doorbell_regs))));
+    m_queues.append(TRY(NVMeQueue::try_create(qid, interrupt, IO_QUEUE_SIZE, move(cq_dma_region), cq_dma_pages, move(sq_dma_region), sq_dma_pages, move(doorbell_regs))));
     dbgln_if(NVME_DEBUG, "NVMe: Created IO Queue with QID{}", m_queues.size());
     return {};
 }
@@ -26,8 +26,8 @@ namespace Kernel {
 class NVMeController : public PCI::Device
     , public StorageController {
 public:
-    static ErrorOr<NonnullRefPtr<NVMeController>> try_initialize(PCI::DeviceIdentifier const&, bool is_queue_polled);
-    ErrorOr<void> initialize(bool is_queue_polled);
+    static ErrorOr<NonnullRefPtr<NVMeController>> try_initialize(PCI::DeviceIdentifier const&, bool is_queue_polled, bool is_hybrid_polling_enabled);
+    ErrorOr<void> initialize(bool is_queue_polled, bool is_hybrid_polling_enabled);
     explicit NVMeController(PCI::DeviceIdentifier const&);
     RefPtr<StorageDevice> device(u32 index) const override;
     size_t devices_count() const override;
@@ -58,8 +58,9 @@ public:
 private:
     ErrorOr<void> identify_and_init_namespaces();
     Tuple<u64, u8> get_ns_features(IdentifyNamespace& identify_data_struct);
-    ErrorOr<void> create_admin_queue(Optional<u8> irq);
-    ErrorOr<void> create_io_queue(u8 qid, Optional<u8> irq);
+    ErrorOr<NVMeQueueInterrupt> setup_queue_interrupt(u16 qid);
+    ErrorOr<void> create_admin_queue();
+    ErrorOr<void> create_io_queue(u8 qid);
     void calculate_doorbell_stride()
     {
         m_dbl_stride = (m_controller_regs->cap >> CAP_DBL_SHIFT) & CAP_DBL_MASK;
@@ -77,6 +78,8 @@ private:
     AK::Time m_ready_timeout;
     u32 m_bar;
     u8 m_dbl_stride;
+    NVMeQueueInterrupt::Type m_interrupt_type { NVMeQueueInterrupt::Type::Polled };
+    bool m_hybrid_polling { false };
     static Atomic<u8> controller_id;
 };
 }
@@ -7,18 +7,75 @@
 #include "NVMeInterruptQueue.h"
 #include "Kernel/Devices/BlockDevice.h"
 #include "NVMeDefinitions.h"
+#include <AK/TemporaryChange.h>
+#include <Kernel/Arch/x86/IO.h>
+#include <Kernel/Interrupts/IRQHandler.h>
+#include <Kernel/Interrupts/MSIInterruptHandler.h>
 #include <Kernel/WorkQueue.h>
 
 namespace Kernel {
 
-UNMAP_AFTER_INIT NVMeInterruptQueue::NVMeInterruptQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u8 irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
-    : NVMeQueue(move(rw_dma_region), rw_dma_page, qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))
-    , IRQHandler(irq)
+// With hybrid polling, a read spins for roughly this many microseconds before leaving it to the interrupt.
+static constexpr size_t hybrid_polling_microseconds = 50;
+
+class NVMeInterruptQueue::PinBasedInterruptHandler final : public IRQHandler {
+public:
+    PinBasedInterruptHandler(NVMeInterruptQueue& queue, u8 irq)
+        : IRQHandler(irq)
+        , m_queue(queue)
+    {
+    }
+
+private:
+    virtual bool handle_irq(RegisterState const&) override { return m_queue.handle_completion_interrupt(); }
+
+    NVMeInterruptQueue& m_queue;
+};
+
+class NVMeInterruptQueue::MSIXInterruptHandler final : public MSIInterruptHandler {
+public:
+    MSIXInterruptHandler(NVMeInterruptQueue& queue, u8 interrupt_number)
+        : MSIInterruptHandler(interrupt_number)
+        , m_queue(queue)
+    {
+    }
+
+    virtual StringView purpose() const override { return "NVMe MSI-X"sv; }
+
+private:
+    virtual bool handle_irq(RegisterState const&) override { return m_queue.handle_completion_interrupt(); }
+
+    NVMeInterruptQueue& m_queue;
+};
+
+UNMAP_AFTER_INIT NVMeInterruptQueue::NVMeInterruptQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, NVMeQueueInterrupt const& interrupt, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
+    : NVMeQueue(move(rw_dma_region), move(rw_dma_pages), qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))
+    , m_interrupt(interrupt)
 {
-    enable_irq();
+    VERIFY(m_interrupt.type != NVMeQueueInterrupt::Type::Polled);
 }
 
-bool NVMeInterruptQueue::handle_irq(const RegisterState&)
+UNMAP_AFTER_INIT ErrorOr<void> NVMeInterruptQueue::initialize_interrupt_handler()
+{
+    if (m_interrupt.type == NVMeQueueInterrupt::Type::MSIX) {
+        auto handler = TRY(adopt_nonnull_own_or_enomem(new (nothrow) MSIXInterruptHandler(*this, m_interrupt.interrupt_number)));
+        handler->register_interrupt_handler();
+        m_interrupt_handler = move(handler);
+        return {};
+    }
+    auto handler = TRY(adopt_nonnull_own_or_enomem(new (nothrow) PinBasedInterruptHandler(*this, m_interrupt.interrupt_number)));
+    handler->enable_irq();
+    m_interrupt_handler = move(handler);
+    return {};
+}
+
+NVMeInterruptQueue::~NVMeInterruptQueue()
+{
+    if (m_interrupt_handler)
+        m_interrupt_handler->will_be_destroyed();
+}
+
+bool NVMeInterruptQueue::handle_completion_interrupt()
 {
     SpinlockLocker lock(m_request_lock);
     return process_cq() ? true : false;
@@ -29,29 +86,49 @@ void NVMeInterruptQueue::submit_sqe(NVMeSubmission& sub)
     NVMeQueue::submit_sqe(sub);
 }
 
-void NVMeInterruptQueue::complete_current_request(u16 status)
+void NVMeInterruptQueue::did_submit_request(AsyncBlockDeviceRequest& request)
 {
-    VERIFY(m_request_lock.is_locked());
+    if (!m_interrupt.hybrid_polling || request.request_type() != AsyncBlockDeviceRequest::Read)
+        return;
 
-    g_io_work->queue([this, status]() {
-        SpinlockLocker lock(m_request_lock);
-        auto current_request = m_current_request;
-        m_current_request.clear();
-        if (status) {
-            lock.unlock();
-            current_request->complete(AsyncBlockDeviceRequest::Failure);
-            return;
-        }
-        if (current_request->request_type() == AsyncBlockDeviceRequest::RequestType::Read) {
-            if (auto result = current_request->write_to_buffer(current_request->buffer(), m_rw_dma_region->vaddr().as_ptr(), 512 * current_request->block_count()); result.is_error()) {
-                lock.unlock();
-                current_request->complete(AsyncDeviceRequest::MemoryFault);
+    // A fast device often completes a read sooner than it takes to get through the interrupt
+    // handler and the I/O work queue, so spin on the completion queue for a little while first.
+    for (size_t i = 0; i < hybrid_polling_microseconds; ++i) {
+        Optional<u16> status;
+        {
+            SpinlockLocker lock(m_request_lock);
+            if (m_current_request.ptr() != &request || m_completion_queued)
                 return;
+            if (cqe_available()) {
+                TemporaryChange polling(m_polling_for_completion, true);
+                process_cq();
+                status = exchange(m_polled_status, {});
             }
         }
-        lock.unlock();
-        current_request->complete(AsyncDeviceRequest::Success);
+        if (status.has_value()) {
+            finish_current_request(status.value());
+            return;
+        }
+        IO::delay(1);
+    }
+}
+
+void NVMeInterruptQueue::complete_current_request(u16 status)
+{
+    VERIFY(m_request_lock.is_locked());
+
+    if (m_polling_for_completion) {
+        m_polled_status = status;
         return;
+    }
+
+    m_completion_queued = true;
+    g_io_work->queue([this, status]() {
+        {
+            SpinlockLocker lock(m_request_lock);
+            m_completion_queued = false;
+        }
+        finish_current_request(status);
     });
 }
 }
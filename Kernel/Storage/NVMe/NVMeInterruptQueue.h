@@ -6,19 +6,30 @@
 
 #pragma once
 
+#include <Kernel/Interrupts/GenericInterruptHandler.h>
 #include <Kernel/Storage/NVMe/NVMeQueue.h>
 
 namespace Kernel {
 
-class NVMeInterruptQueue : public NVMeQueue
-    , public IRQHandler {
+class NVMeInterruptQueue : public NVMeQueue {
 public:
-    NVMeInterruptQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u8 irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs);
+    NVMeInterruptQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, NVMeQueueInterrupt const& interrupt, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs);
+    ErrorOr<void> initialize_interrupt_handler();
     void submit_sqe(NVMeSubmission& submission) override;
-    virtual ~NVMeInterruptQueue() override {};
+    virtual ~NVMeInterruptQueue() override;
 
 private:
+    class PinBasedInterruptHandler;
+    class MSIXInterruptHandler;
+
+    bool handle_completion_interrupt();
     virtual void complete_current_request(u16 status) override;
-    bool handle_irq(RegisterState const&) override;
+    virtual void did_submit_request(AsyncBlockDeviceRequest&) override;
+
+    NVMeQueueInterrupt m_interrupt;
+    OwnPtr<GenericInterruptHandler> m_interrupt_handler;
+    bool m_polling_for_completion { false };
+    bool m_completion_queued { false };
+    Optional<u16> m_polled_status;
 };
 }
@@ -29,16 +29,24 @@ UNMAP_AFTER_INIT NVMeNameSpace::NVMeNameSpace(NonnullRefPtrVector<NVMeQueue> que
 
 void NVMeNameSpace::start_request(AsyncBlockDeviceRequest& request)
 {
-    auto index = Processor::current_id();
-    auto& queue = m_queues.at(index);
-    // TODO: For now we support only IO transfers of size PAGE_SIZE (Going along with the current constraint in the block layer)
-    // Eventually remove this constraint by using the PRP2 field in the submission struct and remove block layer constraint for NVMe driver.
-    VERIFY(request.block_count() <= (PAGE_SIZE / block_size()));
+    VERIFY(request.block_count() <= max_blocks_per_request());
 
-    if (request.request_type() == AsyncBlockDeviceRequest::Read) {
-        queue.read(request, m_nsid, request.block_index(), request.block_count());
-    } else {
-        queue.write(request, m_nsid, request.block_index(), request.block_count());
+    // Prefer the queue of the submitting processor, so that its completion interrupt is
+    // steered back to us. If that one is busy, use any idle queue instead of waiting.
+    auto* queue = &m_queues.at(Processor::current_id());
+    if (!queue->is_idle()) {
+        for (auto& other_queue : m_queues) {
+            if (other_queue.is_idle()) {
+                queue = &other_queue;
+                break;
+            }
+        }
     }
+    queue->submit_request(request, m_nsid);
+}
+
+size_t NVMeNameSpace::max_blocks_per_request() const
+{
+    return NVMeQueue::max_transfer_size / block_size();
 }
 }
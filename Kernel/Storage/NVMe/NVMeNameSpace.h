@@ -27,6 +27,9 @@ public:
 
     CommandSet command_set() const override { return CommandSet::NVMe; };
     void start_request(AsyncBlockDeviceRequest& request) override;
+    size_t max_blocks_per_request() const override;
+    // Every I/O queue can work on a request at the same time.
+    size_t max_concurrent_requests() const override { return m_queues.size(); }
 
 private:
     u16 m_nsid;
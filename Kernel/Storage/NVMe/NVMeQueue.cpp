@@ -13,20 +13,22 @@
 #include <Kernel/Storage/NVMe/NVMePollQueue.h>
 
 namespace Kernel {
-ErrorOr<NonnullRefPtr<NVMeQueue>> NVMeQueue::try_create(u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
+ErrorOr<NonnullRefPtr<NVMeQueue>> NVMeQueue::try_create(u16 qid, NVMeQueueInterrupt const& interrupt, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
 {
-    // Note: Allocate DMA region for RW operation. For now the requests don't exceed more than 4096 bytes (Storage device takes care of it)
-    RefPtr<Memory::PhysicalPage> rw_dma_page;
-    auto rw_dma_region = TRY(MM.allocate_dma_buffer_page("NVMe Queue Read/Write DMA"sv, Memory::Region::Access::ReadWrite, rw_dma_page));
-    if (!irq.has_value()) {
-        auto queue = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) NVMePollQueue(move(rw_dma_region), *rw_dma_page, qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
+    // Note: Allocate DMA region for RW operation. The requests never exceed max_transfer_size (NVMeNameSpace takes care of it).
+    // One extra page at the end of the region holds the PRP list describing the data pages.
+    NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages;
+    auto rw_dma_region = TRY(MM.allocate_dma_buffer_pages(max_transfer_size + PAGE_SIZE, "NVMe Queue Read/Write DMA"sv, Memory::Region::Access::ReadWrite, rw_dma_pages));
+    if (interrupt.type == NVMeQueueInterrupt::Type::Polled) {
+        auto queue = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) NVMePollQueue(move(rw_dma_region), rw_dma_pages, qid, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
         return queue;
     }
-    auto queue = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) NVMeInterruptQueue(move(rw_dma_region), *rw_dma_page, qid, irq.value(), q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
+    auto queue = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) NVMeInterruptQueue(move(rw_dma_region), move(rw_dma_pages), qid, interrupt, q_depth, move(cq_dma_region), cq_dma_page, move(sq_dma_region), sq_dma_page, move(db_regs))));
+    TRY(queue->initialize_interrupt_handler());
     return queue;
 }
 
-UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
+UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs)
     : m_current_request(nullptr)
     , m_rw_dma_region(move(rw_dma_region))
     , m_qid(qid)
@@ -37,11 +39,31 @@ UNMAP_AFTER_INIT NVMeQueue::NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_regio
     , m_sq_dma_region(move(sq_dma_region))
     , m_sq_dma_page(sq_dma_page)
     , m_db_regs(move(db_regs))
-    , m_rw_dma_page(rw_dma_page)
+    , m_rw_dma_pages(move(rw_dma_pages))
 
 {
     m_sqe_array = { reinterpret_cast<NVMeSubmission*>(m_sq_dma_region->vaddr().as_ptr()), m_qdepth };
     m_cqe_array = { reinterpret_cast<NVMeCompletion*>(m_cq_dma_region->vaddr().as_ptr()), m_qdepth };
+
+    // Transfers always start at the beginning of the first data page, so the PRP list
+    // (which describes every data page after the first one) never changes.
+    VERIFY(m_rw_dma_pages.size() == max_rw_dma_pages + 1);
+    auto* prp_list = reinterpret_cast<u64*>(m_rw_dma_region->vaddr().offset(max_transfer_size).as_ptr());
+    for (size_t i = 1; i < max_rw_dma_pages; ++i)
+        prp_list[i - 1] = AK::convert_between_host_and_little_endian(static_cast<u64>(m_rw_dma_pages[i].paddr().get()));
+}
+
+void NVMeQueue::fill_data_pointer(NVMeSubmission& sub, size_t transfer_size)
+{
+    VERIFY(transfer_size <= max_transfer_size);
+    sub.rw.data_ptr.prp1 = m_rw_dma_pages[0].paddr().get();
+    if (transfer_size <= PAGE_SIZE)
+        return;
+    if (transfer_size <= 2 * PAGE_SIZE) {
+        sub.rw.data_ptr.prp2 = m_rw_dma_pages[1].paddr().get();
+        return;
+    }
+    sub.rw.data_ptr.prp2 = m_rw_dma_pages[max_rw_dma_pages].paddr().get();
 }
 
 bool NVMeQueue::cqe_available()
@@ -134,42 +156,115 @@ u16 NVMeQueue::submit_sync_sqe(NVMeSubmission& sub)
     return status;
 }
 
+bool NVMeQueue::is_idle() const
+{
+    SpinlockLocker lock(m_request_lock);
+    return !m_current_request && m_pending_requests.is_empty();
+}
+
+void NVMeQueue::submit_request(AsyncBlockDeviceRequest& request, u16 nsid)
+{
+    SpinlockLocker lock(m_request_lock);
+    if (m_current_request) {
+        if (m_pending_requests.try_append({ request, nsid }).is_error()) {
+            lock.unlock();
+            request.complete(AsyncDeviceRequest::Failure);
+        }
+        return;
+    }
+    start_request(move(lock), request, nsid);
+}
+
+void NVMeQueue::start_request(SpinlockLocker<Spinlock>&& lock, AsyncBlockDeviceRequest& first_request, u16 first_nsid)
+{
+    NonnullRefPtr<AsyncBlockDeviceRequest> request = first_request;
+    u16 nsid = first_nsid;
+    for (;;) {
+        VERIFY(!m_current_request);
+        m_current_request = request;
+        if (request->request_type() == AsyncBlockDeviceRequest::Read) {
+            read(request, nsid, request->block_index(), request->block_count());
+            break;
+        }
+        if (auto result = write(request, nsid, request->block_index(), request->block_count()); !result.is_error())
+            break;
+
+        m_current_request.clear();
+        lock.unlock();
+        request->complete(AsyncDeviceRequest::MemoryFault);
+
+        // No completion is going to start the requests queued behind the failed one, so we have to.
+        lock.lock();
+        if (m_current_request || m_pending_requests.is_empty()) {
+            lock.unlock();
+            return;
+        }
+        auto next_request = m_pending_requests.take_first();
+        request = move(next_request.request);
+        nsid = next_request.nsid;
+    }
+    lock.unlock();
+    did_submit_request(request);
+}
+
+void NVMeQueue::finish_current_request(u16 status)
+{
+    SpinlockLocker lock(m_request_lock);
+    auto current_request = m_current_request;
+    VERIFY(current_request);
+    m_current_request.clear();
+
+    auto result = AsyncDeviceRequest::Success;
+    if (status) {
+        result = AsyncDeviceRequest::Failure;
+    } else if (current_request->request_type() == AsyncBlockDeviceRequest::RequestType::Read) {
+        if (auto copy_result = current_request->write_to_buffer(current_request->buffer(), m_rw_dma_region->vaddr().as_ptr(), current_request->buffer_size()); copy_result.is_error())
+            result = AsyncDeviceRequest::MemoryFault;
+    }
+
+    // The data has been copied out of the DMA buffer, so the next request can go ahead.
+    if (!m_pending_requests.is_empty()) {
+        auto next_request = m_pending_requests.take_first();
+        start_request(move(lock), next_request.request, next_request.nsid);
+    } else {
+        lock.unlock();
+    }
+
+    current_request->complete(result);
+}
+
 void NVMeQueue::read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count)
 {
+    VERIFY(m_request_lock.is_locked());
     NVMeSubmission sub {};
-    SpinlockLocker m_lock(m_request_lock);
-    m_current_request = request;
 
     sub.op = OP_NVME_READ;
     sub.rw.nsid = nsid;
     sub.rw.slba = AK::convert_between_host_and_little_endian(index);
     // No. of lbas is 0 based
     sub.rw.length = AK::convert_between_host_and_little_endian((count - 1) & 0xFFFF);
-    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_page->paddr().as_ptr()));
+    fill_data_pointer(sub, request.buffer_size());
 
     full_memory_barrier();
     submit_sqe(sub);
 }
 
-void NVMeQueue::write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count)
+ErrorOr<void> NVMeQueue::write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count)
 {
+    VERIFY(m_request_lock.is_locked());
     NVMeSubmission sub {};
-    SpinlockLocker m_lock(m_request_lock);
-    m_current_request = request;
 
-    if (auto result = m_current_request->read_from_buffer(m_current_request->buffer(), m_rw_dma_region->vaddr().as_ptr(), 512 * m_current_request->block_count()); result.is_error()) {
-        complete_current_request(AsyncDeviceRequest::MemoryFault);
-        return;
-    }
+    TRY(request.read_from_buffer(request.buffer(), m_rw_dma_region->vaddr().as_ptr(), request.buffer_size()));
     sub.op = OP_NVME_WRITE;
     sub.rw.nsid = nsid;
     sub.rw.slba = AK::convert_between_host_and_little_endian(index);
     // No. of lbas is 0 based
     sub.rw.length = AK::convert_between_host_and_little_endian((count - 1) & 0xFFFF);
-    sub.rw.data_ptr.prp1 = reinterpret_cast<u64>(AK::convert_between_host_and_little_endian(m_rw_dma_page->paddr().as_ptr()));
+    fill_data_pointer(sub, request.buffer_size());
 
     full_memory_barrier();
     submit_sqe(sub);
+    return {};
 }
 
 UNMAP_AFTER_INIT NVMeQueue::~NVMeQueue()
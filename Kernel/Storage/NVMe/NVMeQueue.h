@@ -12,6 +12,7 @@
 #include <AK/RefCounted.h>
 #include <AK/RefPtr.h>
 #include <AK/Types.h>
+#include <AK/Vector.h>
 #include <Kernel/Bus/PCI/Device.h>
 #include <Kernel/Interrupts/IRQHandler.h>
 #include <Kernel/Locking/Spinlock.h>
@@ -26,27 +27,61 @@ struct DoorbellRegister {
     u32 cq_head;
 };
 
+// How an NVMe queue finds out about completions.
+struct NVMeQueueInterrupt {
+    enum class Type {
+        Polled,
+        PinBased,
+        MSIX,
+    };
+
+    Type type { Type::Polled };
+    // The IRQ line for pin-based interrupts, or a reserved interrupt number for MSI-X.
+    u8 interrupt_number { 0 };
+    // Spin briefly on the completion queue after submitting a read before relying on the interrupt.
+    bool hybrid_polling { false };
+};
+
 class AsyncBlockDeviceRequest;
 class NVMeQueue : public RefCounted<NVMeQueue> {
 public:
-    static ErrorOr<NonnullRefPtr<NVMeQueue>> try_create(u16 qid, Optional<u8> irq, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs);
+    // Read/write requests are staged through a physically contiguous DMA buffer of this many pages.
+    static constexpr size_t max_rw_dma_pages = 16;
+    static constexpr size_t max_transfer_size = max_rw_dma_pages * PAGE_SIZE;
+
+    static ErrorOr<NonnullRefPtr<NVMeQueue>> try_create(u16 qid, NVMeQueueInterrupt const&, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs);
     bool is_admin_queue() { return m_admin_queue; };
     u16 submit_sync_sqe(NVMeSubmission&);
-    void read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
-    void write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
+    // Each queue works on a single request at a time. If it is busy, the request is queued
+    // and started as soon as the current one completes.
+    void submit_request(AsyncBlockDeviceRequest&, u16 nsid);
+    bool is_idle() const;
     virtual void submit_sqe(NVMeSubmission&);
     virtual ~NVMeQueue();
 
 protected:
     u32 process_cq();
+    bool cqe_available();
+    // Called after a request has been submitted, without any locks held.
+    virtual void did_submit_request(AsyncBlockDeviceRequest&) { }
+    // Hands the current request back to its device. Must be called without m_request_lock held.
+    void finish_current_request(u16 status);
     void update_sq_doorbell()
     {
         m_db_regs->sq_tail = m_sq_tail;
     }
-    NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, Memory::PhysicalPage const& rw_dma_page, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs);
+    NVMeQueue(NonnullOwnPtr<Memory::Region> rw_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> rw_dma_pages, u16 qid, u32 q_depth, OwnPtr<Memory::Region> cq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> cq_dma_page, OwnPtr<Memory::Region> sq_dma_region, NonnullRefPtrVector<Memory::PhysicalPage> sq_dma_page, Memory::TypedMapping<volatile DoorbellRegister> db_regs);
 
 private:
-    bool cqe_available();
+    struct PendingRequest {
+        NonnullRefPtr<AsyncBlockDeviceRequest> request;
+        u16 nsid;
+    };
+
+    void start_request(SpinlockLocker<Spinlock>&&, AsyncBlockDeviceRequest&, u16 nsid);
+    void read(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
+    ErrorOr<void> write(AsyncBlockDeviceRequest& request, u16 nsid, u64 index, u32 count);
+    void fill_data_pointer(NVMeSubmission&, size_t transfer_size);
     void update_cqe_head();
     virtual void complete_current_request(u16 status) = 0;
     void update_cq_doorbell()
@@ -58,7 +93,8 @@ protected:
     Spinlock m_cq_lock { LockRank::Interrupts };
     RefPtr<AsyncBlockDeviceRequest> m_current_request;
     NonnullOwnPtr<Memory::Region> m_rw_dma_region;
-    Spinlock m_request_lock;
+    mutable Spinlock m_request_lock;
+    Vector<PendingRequest> m_pending_requests;
 
 private:
     u16 m_qid {};
@@ -76,6 +112,6 @@ private:
     NonnullRefPtrVector<Memory::PhysicalPage> m_sq_dma_page;
     Span<NVMeCompletion> m_cqe_array;
     Memory::TypedMapping<volatile DoorbellRegister> m_db_regs;
-    NonnullRefPtr<Memory::PhysicalPage> m_rw_dma_page;
+    NonnullRefPtrVector<Memory::PhysicalPage> m_rw_dma_pages;
 };
 }
@@ -47,6 +47,14 @@ void DiskPartition::start_request(AsyncBlockDeviceRequest& request)
     request.add_sub_request(sub_request_or_error.release_value());
 }
 
+size_t DiskPartition::max_concurrent_requests() const
+{
+    // Requests are passed straight on to the disk, so it gets to decide how many can be in flight.
+    if (auto device = m_device.strong_ref())
+        return device->max_concurrent_requests();
+    return 1;
+}
+
 ErrorOr<size_t> DiskPartition::read(OpenFileDescription& fd, u64 offset, UserOrKernelBuffer& outbuf, size_t len)
 {
     u64 adjust = m_metadata.start_block() * block_size();
@@ -46,7 +46,7 @@ bool StorageManagement::boot_argument_contains_partition_uuid()
     return m_boot_argument.starts_with(partition_uuid_prefix);
 }
 
-UNMAP_AFTER_INIT void StorageManagement::enumerate_pci_controllers(bool force_pio, bool nvme_poll)
+UNMAP_AFTER_INIT void StorageManagement::enumerate_pci_controllers(bool force_pio, bool nvme_poll, bool nvme_hybrid_poll)
 {
     VERIFY(m_controllers.is_empty());
 
@@ -62,10 +62,10 @@ UNMAP_AFTER_INIT void StorageManagement::enumerate_pci_controllers(bool force_pi
                 constexpr PCI::HardwareID vmd_device = { 0x8086, 0x9a0b };
                 if (device_identifier.hardware_id() == vmd_device) {
                     auto controller = PCI::VolumeManagementDevice::must_create(device_identifier);
-                    PCI::Access::the().add_host_controller_and_enumerate_attached_devices(move(controller), [this, nvme_poll](PCI::DeviceIdentifier const& device_identifier) -> void {
+                    PCI::Access::the().add_host_controller_and_enumerate_attached_devices(move(controller), [this, nvme_poll, nvme_hybrid_poll](PCI::DeviceIdentifier const& device_identifier) -> void {
                         auto subclass_code = static_cast<SubclassID>(device_identifier.subclass_code().value());
                         if (subclass_code == SubclassID::NVMeController) {
-                            auto controller = NVMeController::try_initialize(device_identifier, nvme_poll);
+                            auto controller = NVMeController::try_initialize(device_identifier, nvme_poll, nvme_hybrid_poll);
                             if (controller.is_error()) {
                                 dmesgln("Unable to initialize NVMe controller: {}", controller.error());
                             } else {
@@ -86,7 +86,7 @@ UNMAP_AFTER_INIT void StorageManagement::enumerate_pci_controllers(bool force_pi
                 m_controllers.append(AHCIController::initialize(device_identifier));
             }
             if (subclass_code == SubclassID::NVMeController) {
-                auto controller = NVMeController::try_initialize(device_identifier, nvme_poll);
+                auto controller = NVMeController::try_initialize(device_identifier, nvme_poll, nvme_hybrid_poll);
                 if (controller.is_error()) {
                     dmesgln("Unable to initialize NVMe controller: {}", controller.error());
                 } else {
@@ -269,7 +269,7 @@ NonnullRefPtr<FileSystem> StorageManagement::root_filesystem() const
     return file_system;
 }
 
-UNMAP_AFTER_INIT void StorageManagement::initialize(StringView root_device, bool force_pio, bool poll)
+UNMAP_AFTER_INIT void StorageManagement::initialize(StringView root_device, bool force_pio, bool poll, bool hybrid_poll)
 {
     VERIFY(s_device_minor_number == 0);
     m_boot_argument = root_device;
@@ -278,7 +278,7 @@ UNMAP_AFTER_INIT void StorageManagement::initialize(StringView root_device, bool
         // to probe and use
         m_controllers.append(ISAIDEController::initialize());
     } else {
-        enumerate_pci_controllers(force_pio, poll);
+        enumerate_pci_controllers(force_pio, poll, hybrid_poll);
     }
     // Note: Whether PCI bus is present on the system or not, always try to attach
     // a given ramdisk.
@@ -23,7 +23,7 @@ class StorageManagement {
 public:
     StorageManagement();
     static bool initialized();
-    void initialize(StringView boot_argument, bool force_pio, bool nvme_poll);
+    void initialize(StringView boot_argument, bool force_pio, bool nvme_poll, bool nvme_hybrid_poll);
     static StorageManagement& the();
 
     NonnullRefPtr<FileSystem> root_filesystem() const;
@@ -36,7 +36,7 @@ public:
 private:
     bool boot_argument_contains_partition_uuid();
 
-    void enumerate_pci_controllers(bool force_pio, bool nvme_poll);
+    void enumerate_pci_controllers(bool force_pio, bool nvme_poll, bool nvme_hybrid_poll);
     void enumerate_storage_devices();
     void enumerate_disk_partitions();
 
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ScopeGuard.h>
+#include <AK/Time.h>
+#include <Kernel/API/POSIX/sys/epoll.h>
+#include <Kernel/FileSystem/EPoll.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+ErrorOr<FlatPtr> Process::sys$epoll_create(int flags)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    auto fd_allocation = TRY(allocate_fd());
+    auto epoll = TRY(EPoll::try_create());
+    auto description = TRY(OpenFileDescription::try_create(move(epoll)));
+
+    description->set_readable(true);
+
+    return m_fds.with_exclusive([&](auto& fds) -> ErrorOr<FlatPtr> {
+        fds[fd_allocation.fd].set(move(description));
+
+        if (flags & EPOLL_CLOEXEC)
+            fds[fd_allocation.fd].set_flags(fds[fd_allocation.fd].flags() | FD_CLOEXEC);
+
+        return fd_allocation.fd;
+    });
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    auto params = TRY(copy_typed_from_user(user_params));
+
+    auto epoll_description = TRY(open_file_description(params.epfd));
+    if (!epoll_description->is_epoll())
+        return EINVAL;
+    auto& epoll = *epoll_description->epoll();
+
+    auto description = TRY(open_file_description(params.fd));
+
+    epoll_event event {};
+    if (params.op != EPOLL_CTL_DEL)
+        TRY(copy_from_user(&event, params.event));
+
+    switch (params.op) {
+    case EPOLL_CTL_ADD:
+        TRY(epoll.add_watch(params.fd, *description, event));
+        return 0;
+    case EPOLL_CTL_MOD:
+        TRY(epoll.modify_watch(params.fd, *description, event));
+        return 0;
+    case EPOLL_CTL_DEL:
+        TRY(epoll.remove_watch(params.fd, *description));
+        return 0;
+    default:
+        return EINVAL;
+    }
+}
+
+ErrorOr<FlatPtr> Process::sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*> user_params)
+{
+    VERIFY_NO_PROCESS_BIG_LOCK(this)
+    TRY(require_promise(Pledge::stdio));
+
+    auto params = TRY(copy_typed_from_user(user_params));
+
+    if (params.max_events <= 0 || static_cast<size_t>(params.max_events) > OpenFileDescriptions::max_open())
+        return EINVAL;
+
+    auto description = TRY(open_file_description(params.epfd));
+    if (!description->is_epoll())
+        return EINVAL;
+    auto& epoll = *description->epoll();
+
+    Thread::BlockTimeout timeout;
+    if (params.timeout) {
+        auto timeout_time = TRY(copy_time_from_user(params.timeout));
+        timeout = Thread::BlockTimeout(false, &timeout_time);
+    }
+
+    sigset_t sigmask = {};
+    if (params.sigmask)
+        TRY(copy_from_user(&sigmask, params.sigmask));
+
+    Vector<epoll_event> events;
+    TRY(events.try_resize(params.max_events));
+
+    auto* current_thread = Thread::current();
+
+    u32 previous_signal_mask = 0;
+    if (params.sigmask)
+        previous_signal_mask = current_thread->update_signal_mask(sigmask);
+    ScopeGuard rollback_signal_mask([&]() {
+        if (params.sigmask)
+            current_thread->update_signal_mask(previous_signal_mask);
+    });
+
+    size_t event_count = 0;
+    for (;;) {
+        event_count = epoll.collect_events(events.span());
+        if (event_count > 0)
+            break;
+
+        // NOTE: We may be woken up for watches that turn out not to be ready anymore, in which
+        //       case we block again until the same deadline.
+        auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
+        auto result = current_thread->block<Thread::ReadBlocker>(timeout, *description, unblock_flags);
+        if (result.was_interrupted())
+            return EINTR;
+        if (result == Thread::BlockResult::InterruptedByTimeout) {
+            event_count = epoll.collect_events(events.span());
+            break;
+        }
+    }
+
+    if (event_count > 0)
+        TRY(copy_to_user(params.events, events.data(), event_count * sizeof(epoll_event)));
+
+    return event_count;
+}
+
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/NumericLimits.h>
+#include <Kernel/API/POSIX/fcntl.h>
+#include <Kernel/FileSystem/FIFO.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+// Transfers between two files that aren't pipes go through a kernel buffer of this size.
+static constexpr size_t bounce_buffer_size = 64 * KiB;
+
+static ErrorOr<void> wait_until_readable(OpenFileDescription& description, bool may_block)
+{
+    if (description.can_read())
+        return {};
+    if (!may_block || !description.is_blocking())
+        return EAGAIN;
+    auto unblock_flags = BlockFlags::None;
+    if (Thread::current()->block<Thread::ReadBlocker>({}, description, unblock_flags).was_interrupted())
+        return EINTR;
+    if (!has_flag(unblock_flags, BlockFlags::Read))
+        return EAGAIN;
+    return {};
+}
+
+static ErrorOr<void> wait_until_writable(OpenFileDescription& description, bool may_block)
+{
+    if (description.can_write())
+        return {};
+    if (!may_block || !description.is_blocking())
+        return EAGAIN;
+    auto unblock_flags = BlockFlags::None;
+    if (Thread::current()->block<Thread::WriteBlocker>({}, description, unblock_flags).was_interrupted())
+        return EINTR;
+    if (!has_flag(unblock_flags, BlockFlags::Write))
+        return EAGAIN;
+    return {};
+}
+
+// If an explicit offset is given, it is used and advanced instead of the description's own offset.
+static ErrorOr<size_t> read_from(OpenFileDescription& description, Optional<u64>& offset, UserOrKernelBuffer& buffer, size_t size)
+{
+    if (!offset.has_value())
+        return description.read(buffer, size);
+    auto nread = TRY(description.read(buffer, *offset, size));
+    *offset += nread;
+    return nread;
+}
+
+static ErrorOr<size_t> write_to(OpenFileDescription& description, Optional<u64>& offset, UserOrKernelBuffer const& data, size_t size)
+{
+    if (!offset.has_value())
+        return description.write(data, size);
+    auto nwritten = TRY(description.write(*offset, data, size));
+    *offset += nwritten;
+    return nwritten;
+}
+
+// Moves up to `size` bytes from one description to another without the data ever passing
+// through userspace. If either side is a pipe, the other side reads from or writes into the
+// pipe's buffer directly. Otherwise, the input has to be seekable, so that bytes which were
+// read but couldn't be written can simply be read again later.
+static ErrorOr<size_t> transfer(OpenFileDescription& in, Optional<u64>& in_offset, OpenFileDescription& out, Optional<u64>& out_offset, size_t size, bool nonblocking)
+{
+    bool use_bounce_buffer = !in.is_fifo() && !out.is_fifo();
+    bool update_in_description_offset = false;
+    if (use_bounce_buffer) {
+        if (!in.file().is_seekable())
+            return EINVAL;
+        if (!in_offset.has_value()) {
+            in_offset = in.offset();
+            update_in_description_offset = true;
+        }
+    }
+
+    if (!out_offset.has_value() && out.should_append() && out.file().is_seekable())
+        TRY(out.seek(0, SEEK_END));
+
+    ByteBuffer bounce_buffer;
+    if (use_bounce_buffer)
+        bounce_buffer = TRY(ByteBuffer::create_uninitialized(min(size, bounce_buffer_size)));
+
+    auto transfer_chunk = [&](size_t chunk_size, bool may_block_for_input) -> ErrorOr<size_t> {
+        TRY(wait_until_readable(in, may_block_for_input && !nonblocking));
+        TRY(wait_until_writable(out, !nonblocking));
+
+        if (in.is_fifo()) {
+            return in.fifo()->read_with(in, chunk_size, [&](UserOrKernelBuffer const& data, size_t data_size) {
+                return write_to(out, out_offset, data, data_size);
+            });
+        }
+        if (out.is_fifo()) {
+            return out.fifo()->write_with(out, chunk_size, [&](UserOrKernelBuffer& buffer, size_t buffer_size) {
+                return read_from(in, in_offset, buffer, buffer_size);
+            });
+        }
+
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(bounce_buffer.data());
+        chunk_size = min(chunk_size, bounce_buffer.size());
+        auto nread = TRY(in.read(buffer, *in_offset, chunk_size));
+        if (nread == 0)
+            return 0;
+        auto nwritten = TRY(write_to(out, out_offset, buffer, nread));
+        *in_offset += nwritten;
+        return nwritten;
+    };
+
+    size_t total_transferred = 0;
+    while (total_transferred < size) {
+        // Like read(), we only wait for input until we have transferred something.
+        auto result = transfer_chunk(size - total_transferred, total_transferred == 0);
+        if (result.is_error()) {
+            if (total_transferred > 0)
+                break;
+            return result.release_error();
+        }
+        if (result.value() == 0)
+            break;
+        total_transferred += result.value();
+    }
+
+    if (update_in_description_offset)
+        TRY(in.seek(*in_offset, SEEK_SET));
+
+    return total_transferred;
+}
+
+static ErrorOr<Optional<u64>> copy_offset_from_user(Userspace<off_t*> user_offset)
+{
+    if (!user_offset)
+        return Optional<u64> {};
+    off_t offset;
+    TRY(copy_from_user(&offset, user_offset));
+    if (offset < 0)
+        return EINVAL;
+    return Optional<u64> { static_cast<u64>(offset) };
+}
+
+static ErrorOr<void> copy_offset_to_user(Userspace<off_t*> user_offset, Optional<u64> const& offset)
+{
+    if (!user_offset)
+        return {};
+    off_t new_offset = static_cast<off_t>(offset.value());
+    return copy_to_user(user_offset, &new_offset);
+}
+
+ErrorOr<FlatPtr> Process::sys$sendfile(int out_fd, int in_fd, Userspace<off_t*> user_offset, size_t count)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    if (count == 0)
+        return 0;
+    count = min(count, static_cast<size_t>(NumericLimits<ssize_t>::max()));
+
+    auto in_description = TRY(open_file_description(in_fd));
+    if (!in_description->is_readable())
+        return EBADF;
+    if (in_description->is_directory())
+        return EISDIR;
+    auto out_description = TRY(open_file_description(out_fd));
+    if (!out_description->is_writable())
+        return EBADF;
+
+    auto in_offset = TRY(copy_offset_from_user(user_offset));
+    if (in_offset.has_value() && !in_description->file().is_seekable())
+        return ESPIPE;
+    if (in_description->is_fifo() && out_description->is_fifo() && in_description->fifo() == out_description->fifo())
+        return EINVAL;
+
+    Optional<u64> out_offset;
+    auto ntransferred = TRY(transfer(*in_description, in_offset, *out_description, out_offset, count, false));
+    TRY(copy_offset_to_user(user_offset, in_offset));
+    return ntransferred;
+}
+
+ErrorOr<FlatPtr> Process::sys$splice(Userspace<const Syscall::SC_splice_params*> user_params)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this)
+    TRY(require_promise(Pledge::stdio));
+    auto params = TRY(copy_typed_from_user(user_params));
+
+    if (params.flags & ~(SPLICE_F_MOVE | SPLICE_F_NONBLOCK | SPLICE_F_MORE | SPLICE_F_GIFT))
+        return EINVAL;
+    if (params.count == 0)
+        return 0;
+    auto count = min(params.count, static_cast<size_t>(NumericLimits<ssize_t>::max()));
+
+    auto in_description = TRY(open_file_description(params.in_fd));
+    if (!in_description->is_readable())
+        return EBADF;
+    if (in_description->is_directory())
+        return EISDIR;
+    auto out_description = TRY(open_file_description(params.out_fd));
+    if (!out_description->is_writable())
+        return EBADF;
+
+    // One end of the transfer has to be a pipe, whose buffer the data is moved through.
+    if (!in_description->is_fifo() && !out_description->is_fifo())
+        return EINVAL;
+    if (in_description->is_fifo() && out_description->is_fifo() && in_description->fifo() == out_description->fifo())
+        return EINVAL;
+
+    Userspace<off_t*> user_in_offset { (FlatPtr)params.in_offset };
+    Userspace<off_t*> user_out_offset { (FlatPtr)params.out_offset };
+    if ((user_in_offset && !in_description->file().is_seekable()) || (user_out_offset && !out_description->file().is_seekable()))
+        return ESPIPE;
+    auto in_offset = TRY(copy_offset_from_user(user_in_offset));
+    auto out_offset = TRY(copy_offset_from_user(user_out_offset));
+
+    auto ntransferred = TRY(transfer(*in_description, in_offset, *out_description, out_offset, count, params.flags & SPLICE_F_NONBLOCK));
+    TRY(copy_offset_to_user(user_in_offset, in_offset));
+    TRY(copy_offset_to_user(user_out_offset, out_offset));
+    return ntransferred;
+}
+
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+TEST_CASE(epoll_level_triggered)
+{
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    EXPECT_NE(epoll_fd, -1);
+
+    epoll_event event { EPOLLIN, { .u64 = 1234 } };
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fds[0], &event), 0);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 1000), 1);
+    EXPECT_EQ(events[0].events, EPOLLIN);
+    EXPECT_EQ(events[0].data.u64, 1234u);
+
+    // The pipe stays readable until we drain it.
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+
+    char buffer;
+    EXPECT_EQ(read(pipe_fds[0], &buffer, 1), 1);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    close(epoll_fd);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+TEST_CASE(epoll_edge_triggered)
+{
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    int epoll_fd = epoll_create1(0);
+    EXPECT_NE(epoll_fd, -1);
+
+    epoll_event event { EPOLLIN | EPOLLET, { .fd = pipe_fds[0] } };
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fds[0], &event), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 1000), 1);
+    EXPECT_EQ(events[0].data.fd, pipe_fds[0]);
+
+    // Nothing changed since the last report, so we shouldn't hear about the pipe again.
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    EXPECT_EQ(write(pipe_fds[1], "y", 1), 1);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 1000), 1);
+
+    close(epoll_fd);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+TEST_CASE(epoll_one_shot)
+{
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    int epoll_fd = epoll_create1(0);
+    EXPECT_NE(epoll_fd, -1);
+
+    epoll_event event { EPOLLIN | EPOLLONESHOT, { .u64 = 0 } };
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fds[0], &event), 0);
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 1000), 1);
+    EXPECT_EQ(write(pipe_fds[1], "y", 1), 1);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    // Modifying the watch re-arms it.
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_MOD, pipe_fds[0], &event), 0);
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 1);
+
+    close(epoll_fd);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+TEST_CASE(epoll_ctl_errors)
+{
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    int epoll_fd = epoll_create1(0);
+    EXPECT_NE(epoll_fd, -1);
+
+    epoll_event event { EPOLLIN, { .u64 = 0 } };
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_MOD, pipe_fds[0], &event), -1);
+    EXPECT_EQ(errno, ENOENT);
+
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fds[0], &event), 0);
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fds[0], &event), -1);
+    EXPECT_EQ(errno, EEXIST);
+
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pipe_fds[0], nullptr), 0);
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pipe_fds[0], nullptr), -1);
+    EXPECT_EQ(errno, ENOENT);
+
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, epoll_fd, &event), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    close(epoll_fd);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+TEST_CASE(epoll_watch_removed_when_description_closes)
+{
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    int epoll_fd = epoll_create1(0);
+    EXPECT_NE(epoll_fd, -1);
+
+    epoll_event event { EPOLLIN, { .u64 = 0 } };
+    EXPECT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fds[0], &event), 0);
+    EXPECT_EQ(write(pipe_fds[1], "x", 1), 1);
+    close(pipe_fds[0]);
+
+    epoll_event events[4];
+    EXPECT_EQ(epoll_wait(epoll_fd, events, 4, 0), 0);
+
+    close(epoll_fd);
+    close(pipe_fds[1]);
+}
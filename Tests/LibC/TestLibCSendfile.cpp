@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+
+static constexpr char file_contents[] = "Well hello friends, this file gets copied without a trip through userspace!";
+static constexpr size_t file_size = sizeof(file_contents) - 1;
+
+static int create_source_file(char* path)
+{
+    int fd = mkstemp(path);
+    EXPECT_NE(fd, -1);
+    EXPECT_EQ(write(fd, file_contents, file_size), static_cast<ssize_t>(file_size));
+    EXPECT_EQ(lseek(fd, 0, SEEK_SET), 0);
+    return fd;
+}
+
+TEST_CASE(sendfile_to_pipe)
+{
+    char path[] = "/tmp/sendfile.XXXXXX";
+    int file_fd = create_source_file(path);
+
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    EXPECT_EQ(sendfile(pipe_fds[1], file_fd, nullptr, 1024), static_cast<ssize_t>(file_size));
+    EXPECT_EQ(lseek(file_fd, 0, SEEK_CUR), static_cast<off_t>(file_size));
+
+    char buffer[sizeof(file_contents)] {};
+    EXPECT_EQ(read(pipe_fds[0], buffer, sizeof(buffer)), static_cast<ssize_t>(file_size));
+    EXPECT_EQ(memcmp(buffer, file_contents, file_size), 0);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(file_fd);
+    unlink(path);
+}
+
+TEST_CASE(sendfile_with_offset_keeps_file_offset)
+{
+    char source_path[] = "/tmp/sendfile.XXXXXX";
+    int source_fd = create_source_file(source_path);
+    char destination_path[] = "/tmp/sendfile.XXXXXX";
+    int destination_fd = mkstemp(destination_path);
+    EXPECT_NE(destination_fd, -1);
+
+    off_t offset = 5;
+    EXPECT_EQ(sendfile(destination_fd, source_fd, &offset, 5), 5);
+    EXPECT_EQ(offset, 10);
+    EXPECT_EQ(lseek(source_fd, 0, SEEK_CUR), 0);
+
+    char buffer[5] {};
+    EXPECT_EQ(pread(destination_fd, buffer, sizeof(buffer), 0), 5);
+    EXPECT_EQ(memcmp(buffer, file_contents + 5, 5), 0);
+
+    close(source_fd);
+    close(destination_fd);
+    unlink(source_path);
+    unlink(destination_path);
+}
+
+TEST_CASE(splice_from_pipe)
+{
+    char path[] = "/tmp/splice.XXXXXX";
+    int file_fd = mkstemp(path);
+    EXPECT_NE(file_fd, -1);
+
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    EXPECT_EQ(write(pipe_fds[1], file_contents, file_size), static_cast<ssize_t>(file_size));
+
+    // Only as much as we ask for is taken out of the pipe.
+    EXPECT_EQ(splice(pipe_fds[0], nullptr, file_fd, nullptr, 4, 0), 4);
+    EXPECT_EQ(splice(pipe_fds[0], nullptr, file_fd, nullptr, 1024, 0), static_cast<ssize_t>(file_size - 4));
+
+    // The pipe is empty now, so we'd block.
+    EXPECT_EQ(splice(pipe_fds[0], nullptr, file_fd, nullptr, 1024, SPLICE_F_NONBLOCK), -1);
+    EXPECT_EQ(errno, EAGAIN);
+
+    char buffer[sizeof(file_contents)] {};
+    EXPECT_EQ(pread(file_fd, buffer, sizeof(buffer), 0), static_cast<ssize_t>(file_size));
+    EXPECT_EQ(memcmp(buffer, file_contents, file_size), 0);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(file_fd);
+    unlink(path);
+}
+
+TEST_CASE(splice_needs_a_pipe)
+{
+    char source_path[] = "/tmp/splice.XXXXXX";
+    int source_fd = create_source_file(source_path);
+    char destination_path[] = "/tmp/splice.XXXXXX";
+    int destination_fd = mkstemp(destination_path);
+    EXPECT_NE(destination_fd, -1);
+
+    EXPECT_EQ(splice(source_fd, nullptr, destination_fd, nullptr, 1024, 0), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+    off_t offset = 0;
+    EXPECT_EQ(splice(pipe_fds[0], &offset, destination_fd, nullptr, 1024, 0), -1);
+    EXPECT_EQ(errno, ESPIPE);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(source_fd);
+    close(destination_fd);
+    unlink(source_path);
+    unlink(destination_path);
+}
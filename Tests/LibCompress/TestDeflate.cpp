@@ -68,6 +68,26 @@ TEST_CASE(deflate_decompress_compressed_block)
     EXPECT(decompressed.value().bytes() == ReadonlyBytes({ uncompressed, sizeof(uncompressed) - 1 }));
 }
 
+TEST_CASE(deflate_decompress_leaves_trailing_data)
+{
+    // The same stream as above, followed by data that belongs to whoever reads the deflate stream (e.g. a gzip footer).
+    const Array<u8, 32> compressed {
+        0x0B, 0xC9, 0xC8, 0x2C, 0x56, 0x00, 0xA2, 0x44, 0x85, 0xE2, 0xCC, 0xDC,
+        0x82, 0x9C, 0x54, 0x85, 0x92, 0xD4, 0x8A, 0x12, 0x85, 0xB4, 0x4C, 0x20,
+        0xCB, 0x4A, 0x13, 0x00, 0xDE, 0xAD, 0xBE, 0xEF
+    };
+
+    const u8 uncompressed[] = "This is a simple text file :)";
+
+    auto memory_stream = InputMemoryStream { compressed };
+    Compress::DeflateDecompressor deflate_stream { memory_stream };
+    u8 buffer[64];
+    auto nread = deflate_stream.read({ buffer, sizeof(buffer) });
+    EXPECT(deflate_stream.unreliable_eof());
+    EXPECT(ReadonlyBytes(buffer, nread) == ReadonlyBytes({ uncompressed, sizeof(uncompressed) - 1 }));
+    EXPECT_EQ(memory_stream.offset(), 28u);
+}
+
 TEST_CASE(deflate_decompress_uncompressed_block)
 {
     const Array<u8, 18> compressed {
@@ -147,6 +167,38 @@ TEST_CASE(deflate_round_trip_compress_large)
     EXPECT(uncompressed.value() == original);
 }
 
+TEST_CASE(deflate_round_trip_compress_long_codes)
+{
+    auto size = Compress::DeflateCompressor::block_size * 2;
+    auto original = ByteBuffer::create_uninitialized(size).release_value();
+    // Byte values follow a geometric distribution, so the rare ones get Huffman codes of up to 15 bits.
+    for (size_t i = 0; i < size; ++i)
+        original[i] = count_trailing_zeroes(get_random<u32>() | 0x80000000);
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST);
+    EXPECT(compressed.has_value());
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
+
+TEST_CASE(deflate_round_trip_compress_parallel)
+{
+    auto size = Compress::DeflateCompressor::parallel_chunk_size * 2 + Compress::DeflateCompressor::block_size;
+    auto original = ByteBuffer::create_uninitialized(size).release_value();
+    for (size_t i = 0; i < size; ++i)
+        original[i] = count_trailing_zeroes(get_random<u32>() | 0x80000000);
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST, 4);
+    EXPECT(compressed.has_value());
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+
+    // Chunks only add a sync flush (at most 6 bytes) each, as matches never cross block boundaries anyway.
+    auto compressed_serially = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST);
+    EXPECT(compressed_serially.has_value());
+    EXPECT(compressed.value().size() <= compressed_serially.value().size() + 2 * 6);
+}
+
 TEST_CASE(deflate_compress_literals)
 {
     // This byte array is known to not produce any back references with our lz77 implementation even at the highest compression settings
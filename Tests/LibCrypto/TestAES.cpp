@@ -454,3 +454,39 @@ TEST_CASE(test_AES_GCM_128bit_decrypt_multiple_blocks_with_aad)
     EXPECT(memcmp(result_pt, out.data(), out.size()) == 0);
     EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
 }
+
+TEST_CASE(test_AES_GCM_256bit_encrypt_and_decrypt_many_blocks_with_aad)
+{
+    // Long enough to go through several iterations of the multi-block loop, and to end in a partial block.
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = i;
+    u8 iv[16] {};
+    for (size_t i = 0; i < 12; ++i)
+        iv[i] = 0xa0 + i;
+    u8 plaintext[517];
+    for (size_t i = 0; i < sizeof(plaintext); ++i)
+        plaintext[i] = i * 7 + 3;
+    u8 aad[77];
+    for (size_t i = 0; i < sizeof(aad); ++i)
+        aad[i] = i * 13 + 5;
+    // Generated with OpenSSL.
+    u8 result_tag[] { 0x33, 0xc6, 0x17, 0xb5, 0xcc, 0x29, 0x73, 0x9e, 0xed, 0x37, 0x7e, 0x6a, 0x54, 0x17, 0x14, 0xa8 };
+    u8 result_ct_end[] { 0x31, 0xe4, 0xf0, 0x42, 0x3d, 0xc4, 0xd4, 0x2f };
+
+    Crypto::Cipher::AESCipher::GCMMode cipher(ReadonlyBytes { key, sizeof(key) }, 256, Crypto::Cipher::Intent::Encryption);
+    auto tag = ByteBuffer::create_uninitialized(16).release_value();
+    auto ciphertext = ByteBuffer::create_uninitialized(sizeof(plaintext)).release_value();
+    cipher.encrypt({ plaintext, sizeof(plaintext) }, ciphertext.bytes(), { iv, sizeof(iv) }, { aad, sizeof(aad) }, tag);
+    EXPECT(memcmp(result_tag, tag.data(), tag.size()) == 0);
+    EXPECT(memcmp(result_ct_end, ciphertext.data() + ciphertext.size() - sizeof(result_ct_end), sizeof(result_ct_end)) == 0);
+
+    auto decrypted = ByteBuffer::create_uninitialized(sizeof(plaintext)).release_value();
+    auto consistency = cipher.decrypt(ciphertext, decrypted.bytes(), { iv, sizeof(iv) }, { aad, sizeof(aad) }, tag);
+    EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
+    EXPECT(memcmp(plaintext, decrypted.data(), decrypted.size()) == 0);
+
+    ciphertext[100] ^= 1;
+    consistency = cipher.decrypt(ciphertext, decrypted.bytes(), { iv, sizeof(iv) }, { aad, sizeof(aad) }, tag);
+    EXPECT_EQ(consistency, Crypto::VerificationConsistency::Inconsistent);
+}
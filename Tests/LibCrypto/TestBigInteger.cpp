@@ -201,6 +201,38 @@ TEST_CASE(test_unsigned_bigint_multiplication_with_big_numbers2)
     EXPECT_EQ(result.words(), expected_result);
 }
 
+TEST_CASE(test_unsigned_bigint_multiplication_with_karatsuba_sized_numbers)
+{
+    // These are large enough to be split by Karatsuba multiplication, even with 64-bit limbs.
+    Crypto::UnsignedBigInteger num1 = bigint_fibonacci(9000);
+    Crypto::UnsignedBigInteger num2 = bigint_fibonacci(7001);
+    Crypto::UnsignedBigInteger result = num1.multiplied_by(num2);
+
+    auto division = result.divided_by(num1);
+    EXPECT_EQ(division.quotient, num2);
+    EXPECT_EQ(division.remainder, 0);
+    division = result.divided_by(num2);
+    EXPECT_EQ(division.quotient, num1);
+    EXPECT_EQ(division.remainder, 0);
+
+    // (a + b)^2 = a^2 + 2ab + b^2, where the squares take the dedicated squaring path.
+    auto sum = num1.plus(num2);
+    auto expected = num1.multiplied_by(num1).plus(result).plus(result).plus(num2.multiplied_by(num2));
+    EXPECT_EQ(sum.multiplied_by(sum), expected);
+}
+
+TEST_CASE(test_unsigned_bigint_multiplication_with_unbalanced_numbers)
+{
+    Crypto::UnsignedBigInteger num1 = bigint_fibonacci(20000);
+    Crypto::UnsignedBigInteger num2 = bigint_fibonacci(3001);
+    Crypto::UnsignedBigInteger result = num1.multiplied_by(num2);
+
+    auto division = result.divided_by(num2);
+    EXPECT_EQ(division.quotient, num1);
+    EXPECT_EQ(division.remainder, 0);
+    EXPECT_EQ(num2.multiplied_by(num1), result);
+}
+
 TEST_CASE(test_unsigned_bigint_simple_division)
 {
     Crypto::UnsignedBigInteger num1(27194);
@@ -304,6 +336,20 @@ TEST_CASE(test_bigint_large_odd_fibonacci_with_carry_modular_power)
     EXPECT_EQ(result.words(), expected_result);
 }
 
+TEST_CASE(test_bigint_large_odd_modular_power_with_wide_window)
+{
+    // The exponent is long enough for the widest window, and the modulus is long enough for Karatsuba multiplication.
+    Crypto::UnsignedBigInteger base = bigint_fibonacci(4000);
+    Crypto::UnsignedBigInteger exponent = bigint_fibonacci(1000);
+    Crypto::UnsignedBigInteger modulo = bigint_fibonacci(2999);
+    EXPECT(modulo.words()[0] % 2 == 1);
+
+    // The even modulus goes through the generic algorithm instead of the Montgomery one.
+    auto even_modulo = modulo.multiplied_by(2);
+    auto expected = Crypto::NumberTheory::ModularPower(base, exponent, even_modulo).divided_by(modulo).remainder;
+    EXPECT_EQ(Crypto::NumberTheory::ModularPower(base, exponent, modulo), expected);
+}
+
 TEST_CASE(test_bigint_modular_power_extra_tests)
 {
     struct {
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <LibCrypto/Authentication/Poly1305.h>
+#include <LibCrypto/Cipher/ChaCha20.h>
+#include <LibTest/TestCase.h>
+#include <cstring>
+
+static ReadonlyBytes operator""_b(const char* string, size_t length)
+{
+    return ReadonlyBytes(string, length);
+}
+
+static auto const sunscreen = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it."_b;
+
+TEST_CASE(test_ChaCha20_encrypt)
+{
+    // https://datatracker.ietf.org/doc/html/rfc8439#section-2.4.2
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = i;
+    u8 nonce[12] { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4a, 0x00, 0x00, 0x00, 0x00 };
+    u8 result[] {
+        0x6e, 0x2e, 0x35, 0x9a, 0x25, 0x68, 0xf9, 0x80, 0x41, 0xba, 0x07, 0x28, 0xdd, 0x0d, 0x69, 0x81,
+        0xe9, 0x7e, 0x7a, 0xec, 0x1d, 0x43, 0x60, 0xc2, 0x0a, 0x27, 0xaf, 0xcc, 0xfd, 0x9f, 0xae, 0x0b,
+        0xf9, 0x1b, 0x65, 0xc5, 0x52, 0x47, 0x33, 0xab, 0x8f, 0x59, 0x3d, 0xab, 0xcd, 0x62, 0xb3, 0x57,
+        0x16, 0x39, 0xd6, 0x24, 0xe6, 0x51, 0x52, 0xab, 0x8f, 0x53, 0x0c, 0x35, 0x9f, 0x08, 0x61, 0xd8,
+        0x07, 0xca, 0x0d, 0xbf, 0x50, 0x0d, 0x6a, 0x61, 0x56, 0xa3, 0x8e, 0x08, 0x8a, 0x22, 0xb6, 0x5e,
+        0x52, 0xbc, 0x51, 0x4d, 0x16, 0xcc, 0xf8, 0x06, 0x81, 0x8c, 0xe9, 0x1a, 0xb7, 0x79, 0x37, 0x36,
+        0x5a, 0xf9, 0x0b, 0xbf, 0x74, 0xa3, 0x5b, 0xe6, 0xb4, 0x0b, 0x8e, 0xed, 0xf2, 0x78, 0x5e, 0x42,
+        0x87, 0x4d
+    };
+
+    Crypto::Cipher::ChaCha20 cipher({ key, sizeof(key) });
+    auto ciphertext = ByteBuffer::create_uninitialized(sunscreen.size()).release_value();
+    cipher.crypt(sunscreen, ciphertext.bytes(), { nonce, sizeof(nonce) }, 1);
+    EXPECT_EQ(ciphertext.size(), sizeof(result));
+    EXPECT(memcmp(result, ciphertext.data(), ciphertext.size()) == 0);
+
+    auto decrypted = ByteBuffer::create_uninitialized(ciphertext.size()).release_value();
+    cipher.crypt(ciphertext, decrypted.bytes(), { nonce, sizeof(nonce) }, 1);
+    EXPECT(decrypted.bytes() == sunscreen);
+}
+
+TEST_CASE(test_Poly1305)
+{
+    // https://datatracker.ietf.org/doc/html/rfc8439#section-2.5.2
+    u8 key[32] {
+        0x85, 0xd6, 0xbe, 0x78, 0x57, 0x55, 0x6d, 0x33, 0x7f, 0x44, 0x52, 0xfe, 0x42, 0xd5, 0x06, 0xa8,
+        0x01, 0x03, 0x80, 0x8a, 0xfb, 0x0d, 0xb2, 0xfd, 0x4a, 0xbf, 0xf6, 0xaf, 0x41, 0x49, 0xf5, 0x1b
+    };
+    u8 result[16] { 0xa8, 0x06, 0x1d, 0xc1, 0x30, 0x51, 0x36, 0xc6, 0xc2, 0x2b, 0x8b, 0xaf, 0x0c, 0x01, 0x27, 0xa9 };
+    auto message = "Cryptographic Forum Research Group"_b;
+
+    Crypto::Authentication::Poly1305 poly1305({ key, sizeof(key) });
+    poly1305.update(message);
+    auto tag = poly1305.digest();
+    EXPECT(memcmp(result, tag.data, sizeof(result)) == 0);
+
+    // Feeding the message in pieces that don't line up with the blocks gives the same tag.
+    Crypto::Authentication::Poly1305 piecewise_poly1305({ key, sizeof(key) });
+    piecewise_poly1305.update(message.slice(0, 5));
+    piecewise_poly1305.update(message.slice(5, 20));
+    piecewise_poly1305.update(message.slice(25));
+    tag = piecewise_poly1305.digest();
+    EXPECT(memcmp(result, tag.data, sizeof(result)) == 0);
+}
+
+TEST_CASE(test_ChaCha20_Poly1305_encrypt_and_decrypt)
+{
+    // https://datatracker.ietf.org/doc/html/rfc8439#section-2.8.2
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = 0x80 + i;
+    u8 nonce[12] { 0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47 };
+    u8 aad[12] { 0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7 };
+    u8 result_ct[] {
+        0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2,
+        0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe, 0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6,
+        0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+        0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36,
+        0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c, 0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58,
+        0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+        0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b,
+        0x61, 0x16
+    };
+    u8 result_tag[16] { 0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91 };
+
+    Crypto::Cipher::ChaCha20Poly1305 cipher({ key, sizeof(key) });
+    auto ciphertext = ByteBuffer::create_uninitialized(sunscreen.size()).release_value();
+    u8 tag[16];
+    cipher.encrypt(sunscreen, ciphertext.bytes(), { nonce, sizeof(nonce) }, { aad, sizeof(aad) }, { tag, sizeof(tag) });
+    EXPECT_EQ(ciphertext.size(), sizeof(result_ct));
+    EXPECT(memcmp(result_ct, ciphertext.data(), ciphertext.size()) == 0);
+    EXPECT(memcmp(result_tag, tag, sizeof(tag)) == 0);
+
+    auto decrypted = ByteBuffer::create_uninitialized(ciphertext.size()).release_value();
+    auto consistency = cipher.decrypt(ciphertext, decrypted.bytes(), { nonce, sizeof(nonce) }, { aad, sizeof(aad) }, { tag, sizeof(tag) });
+    EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
+    EXPECT(decrypted.bytes() == sunscreen);
+}
+
+TEST_CASE(test_ChaCha20_Poly1305_encrypt_and_decrypt_many_blocks)
+{
+    // Long enough to need several key stream blocks, and to end in a partial block of the cipher and the authenticator.
+    u8 key[32];
+    for (size_t i = 0; i < sizeof(key); ++i)
+        key[i] = i;
+    u8 nonce[12];
+    for (size_t i = 0; i < sizeof(nonce); ++i)
+        nonce[i] = 0xa0 + i;
+    u8 plaintext[1000];
+    for (size_t i = 0; i < sizeof(plaintext); ++i)
+        plaintext[i] = i * 7 + 3;
+    u8 aad[33];
+    for (size_t i = 0; i < sizeof(aad); ++i)
+        aad[i] = i * 13 + 5;
+    // Generated with OpenSSL.
+    u8 result_tag[] { 0xc6, 0xca, 0xd0, 0x4e, 0x04, 0xe8, 0xe0, 0x1d, 0x17, 0x16, 0xc8, 0x8a, 0xf6, 0x7b, 0xa5, 0xd0 };
+    u8 result_ct_end[] { 0xeb, 0xbc, 0x53, 0x34, 0x97, 0x5c, 0x1d, 0xa9 };
+
+    Crypto::Cipher::ChaCha20Poly1305 cipher({ key, sizeof(key) });
+    auto ciphertext = ByteBuffer::create_uninitialized(sizeof(plaintext)).release_value();
+    u8 tag[16];
+    cipher.encrypt({ plaintext, sizeof(plaintext) }, ciphertext.bytes(), { nonce, sizeof(nonce) }, { aad, sizeof(aad) }, { tag, sizeof(tag) });
+    EXPECT(memcmp(result_tag, tag, sizeof(tag)) == 0);
+    EXPECT(memcmp(result_ct_end, ciphertext.data() + ciphertext.size() - sizeof(result_ct_end), sizeof(result_ct_end)) == 0);
+
+    auto decrypted = ByteBuffer::create_uninitialized(sizeof(plaintext)).release_value();
+    auto consistency = cipher.decrypt(ciphertext, decrypted.bytes(), { nonce, sizeof(nonce) }, { aad, sizeof(aad) }, { tag, sizeof(tag) });
+    EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
+    EXPECT(memcmp(plaintext, decrypted.data(), decrypted.size()) == 0);
+
+    ciphertext[100] ^= 1;
+    consistency = cipher.decrypt(ciphertext, decrypted.bytes(), { nonce, sizeof(nonce) }, { aad, sizeof(aad) }, { tag, sizeof(tag) });
+    EXPECT_EQ(consistency, Crypto::VerificationConsistency::Inconsistent);
+}
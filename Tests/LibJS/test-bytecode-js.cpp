@@ -138,3 +138,86 @@ TEST_CASE(catch_exception)
                             "if (hitCatch !== true) throw new Exception('failed');\n"
                             "if (hitFinally !== true) throw new Exception('failed');");
 }
+
+// NOTE: These run at the top level, as exceptions thrown inside the function that EXPECT_NO_EXCEPTION_ALL
+//       wraps its source in don't make the run fail. Since the source runs twice in the same realm, they
+//       declare their functions with var.
+#define EXPECT_NO_EXCEPTION_AT_TOP_LEVEL(source) \
+    SETUP_AND_PARSE(source)                      \
+    EXPECT_NO_EXCEPTION(executable)              \
+    EXPECT_NO_EXCEPTION_WITH_OPTIMIZATIONS(executable)
+
+TEST_CASE(property_access_with_many_shapes)
+{
+    // More shapes than fit in the property lookup cache of a single GetById/PutById.
+    EXPECT_NO_EXCEPTION_AT_TOP_LEVEL("var get = function (o) { return o.x; };\n"
+                                     "var put = function (o, v) { o.x = v; };\n"
+                                     "var objects = [{ x: 0 }, { a: 1, x: 1 }, { b: 1, x: 2 }, { c: 1, x: 3 }, { d: 1, x: 4 }, { e: 1, x: 5 }];\n"
+                                     "for (var round = 0; round < 3; ++round) {\n"
+                                     "    for (var i = 0; i < objects.length; ++i) {\n"
+                                     "        if (get(objects[i]) !== i + round * 10 || get(objects[i]) !== i + round * 10) throw new Exception('failed');\n"
+                                     "        put(objects[i], i + (round + 1) * 10);\n"
+                                     "    }\n"
+                                     "}\n"
+                                     "if (get({ y: 1 }) !== undefined) throw new Exception('failed');");
+}
+
+TEST_CASE(property_access_through_prototype_after_prototype_changes)
+{
+    EXPECT_NO_EXCEPTION_AT_TOP_LEVEL("var get = function (o) { return o.x; };\n"
+                                     "var prototype = { x: 1 };\n"
+                                     "var object = Object.create(prototype);\n"
+                                     "if (get(object) !== 1 || get(object) !== 1) throw new Exception('failed');\n"
+                                     "prototype.x = 2;\n"
+                                     "if (get(object) !== 2) throw new Exception('failed');\n"
+                                     "Reflect.deleteProperty(prototype, 'x');\n"
+                                     "if (get(object) !== undefined) throw new Exception('failed');\n"
+                                     "prototype.x = 3;\n"
+                                     "if (get(object) !== 3) throw new Exception('failed');\n"
+                                     "Object.setPrototypeOf(object, { x: 4 });\n"
+                                     "if (get(object) !== 4) throw new Exception('failed');\n"
+                                     "object.x = 5;\n"
+                                     "if (get(object) !== 5) throw new Exception('failed');");
+}
+
+TEST_CASE(property_access_after_redefining_data_property_as_accessor)
+{
+    EXPECT_NO_EXCEPTION_AT_TOP_LEVEL("var get = function (o) { return o.x; };\n"
+                                     "var put = function (o, v) { o.x = v; };\n"
+                                     "var object = { x: 1 };\n"
+                                     "put(object, 2);\n"
+                                     "if (get(object) !== 2 || get(object) !== 2) throw new Exception('failed');\n"
+                                     "var stored;\n"
+                                     "Object.defineProperty(object, 'x', { get: function () { return 'getter'; }, set: function (v) { stored = v; } });\n"
+                                     "if (get(object) !== 'getter') throw new Exception('failed');\n"
+                                     "put(object, 3);\n"
+                                     "if (stored !== 3 || get(object) !== 'getter') throw new Exception('failed');\n"
+                                     "if (get(Object.create(object)) !== 'getter') throw new Exception('failed');");
+}
+
+TEST_CASE(property_access_on_unique_shapes)
+{
+    // Deleting a property gives the object a unique shape, which is changed in place from then on.
+    EXPECT_NO_EXCEPTION_AT_TOP_LEVEL("var get = function (o) { return o.x; };\n"
+                                     "var put = function (o, v) { o.x = v; };\n"
+                                     "var object = { w: 0, x: 1, y: 2 };\n"
+                                     "Reflect.deleteProperty(object, 'y');\n"
+                                     "if (get(object) !== 1 || get(object) !== 1) throw new Exception('failed');\n"
+                                     "put(object, 2);\n"
+                                     "put(object, 3);\n"
+                                     "if (get(object) !== 3) throw new Exception('failed');\n"
+                                     "Reflect.deleteProperty(object, 'w');\n"
+                                     "if (get(object) !== 3) throw new Exception('failed');\n"
+                                     "put(object, 4);\n"
+                                     "if (get(object) !== 4 || object.w !== undefined) throw new Exception('failed');\n"
+                                     "Reflect.deleteProperty(object, 'x');\n"
+                                     "if (get(object) !== undefined) throw new Exception('failed');\n"
+                                     "object.z = 5;\n"
+                                     "put(object, 6);\n"
+                                     "if (get(object) !== 6 || object.z !== 5) throw new Exception('failed');\n"
+                                     "var inheriting = Object.create(object);\n"
+                                     "if (get(inheriting) !== 6) throw new Exception('failed');\n"
+                                     "Reflect.deleteProperty(object, 'z');\n"
+                                     "object.x = 7;\n"
+                                     "if (get(inheriting) !== 7) throw new Exception('failed');");
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Heap/Handle.h>
+#include <LibJS/Heap/Heap.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/PrimitiveString.h>
+#include <LibJS/Runtime/VM.h>
+#include <LibTest/TestCase.h>
+
+namespace {
+
+// Stands in for constructors that allocate (e.g. to create a shape), which may trigger a collection while the object is half-built.
+class ObjectThatCollectsWhileConstructed final : public JS::Object {
+    JS_OBJECT(ObjectThatCollectsWhileConstructed, JS::Object);
+
+public:
+    explicit ObjectThatCollectsWhileConstructed(JS::Object& prototype)
+        : JS::Object(prototype)
+    {
+        prototype.heap().collect_garbage(JS::Heap::CollectionType::CollectYoungGeneration);
+    }
+};
+
+}
+
+template<>
+inline constexpr bool JS::cell_has_write_barriers<ObjectThatCollectsWhileConstructed> = true;
+
+TEST_CASE(young_collection_during_construction)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto& global_object = interpreter->global_object();
+    auto& heap = vm->heap();
+
+    auto* object = heap.allocate<ObjectThatCollectsWhileConstructed>(global_object, *global_object.object_prototype());
+    auto handle = JS::make_handle(object);
+    EXPECT(object->has_write_barriers());
+
+    // After a full collection, the object must be an ordinary old cell with write barriers...
+    heap.collect_garbage(JS::Heap::CollectionType::CollectGarbage);
+    EXPECT(object->is_old());
+    EXPECT(!object->is_remembered());
+
+    // ...so that storing a young cell in it remembers it, and the young cell survives the next young collection.
+    object->define_direct_property("young", JS::js_string(heap, "still alive"), JS::default_attributes);
+    EXPECT(object->is_remembered());
+    heap.collect_garbage(JS::Heap::CollectionType::CollectYoungGeneration);
+
+    auto value = object->get_without_side_effects("young");
+    EXPECT(value.is_string());
+    EXPECT(value.is_string() && value.as_string().is_old());
+    if (value.is_string())
+        EXPECT_EQ(value.as_string().string(), "still alive");
+}
@@ -933,6 +933,8 @@ TEST_CASE(optimizer_atomic_groups)
         Tuple { "(1+)\\1"sv, "11"sv, true },
         Tuple { "(1+)1"sv, "11"sv, true },
         Tuple { "(1+)0"sv, "10"sv, true },
+        Tuple { "(b)*[ab]"sv, "b"sv, true },
+        Tuple { "(a+)[a-c]"sv, "aa"sv, true },
         // Rewrite should not skip over first required iteration of <x>+.
         Tuple { "a+"sv, ""sv, false },
     };
@@ -1034,3 +1036,74 @@ TEST_CASE(single_match_flag)
         EXPECT_EQ(result.matches.first().view.to_string(), "A"sv);
     }
 }
+
+TEST_CASE(lazy_dfa)
+{
+    // Patterns without backreferences or lookarounds don't need to backtrack.
+    EXPECT(Regex<ECMA262>("(a|aa)*b"sv).dfa);
+    EXPECT(Regex<PosixExtended>("^[a-z]+([0-9]|_)?$"sv).dfa);
+    EXPECT(!Regex<ECMA262>("(a)\\1"sv).dfa);
+    EXPECT(!Regex<ECMA262>("a(?=b)"sv).dfa);
+
+    // These would take exponential time to fail with the backtracker.
+    auto lots_of_x_s = String::repeated('x', 64);
+    EXPECT_EQ(Regex<ECMA262>("(x+x+)+y"sv).match(lots_of_x_s).success, false);
+    EXPECT_EQ(Regex<ECMA262>("(x|xx)*z"sv).search(lots_of_x_s).success, false);
+
+    Array tests {
+        // Pattern, Subject, Expected match, Expected first capture (null if the group didn't participate)
+        Tuple { "(b)*[ab]"sv, "b"sv, "b"sv, StringView {} },
+        Tuple { "(a|ab)(c|bcd)"sv, "xabcd"sv, "abcd"sv, "a"sv },
+        Tuple { "a(b*?)b*c"sv, "abbbc"sv, "abbbc"sv, ""sv },
+        Tuple { "(a+|b)*c"sv, "xxabac"sv, "abac"sv, "a"sv },
+        // FIXME: `(a*)*b` on "aaab" and `x(y|)+` on "xyy" should capture "aaa" and "y", as an iteration that matches
+        //        the empty string must not replace the captures of the previous one. The backtracker captures "" in both.
+    };
+
+    for (auto& test : tests) {
+        Regex<ECMA262> re(test.get<0>());
+        EXPECT(re.dfa);
+        auto result = re.search(test.get<1>());
+        EXPECT_EQ(result.success, true);
+        if (!result.success)
+            continue;
+        EXPECT_EQ(result.matches.first().view.to_string(), test.get<2>());
+
+        auto& captures = result.capture_group_matches.first();
+        if (test.get<3>().is_null()) {
+            EXPECT(captures.is_empty());
+        } else {
+            EXPECT(!captures.is_empty());
+            if (!captures.is_empty())
+                EXPECT_EQ(captures.first().view.to_string(), test.get<3>());
+        }
+
+        // The backtracker has to agree with the DFA.
+        Regex<ECMA262> backtracking_re(test.get<0>());
+        backtracking_re.dfa = nullptr;
+        auto backtracking_result = backtracking_re.search(test.get<1>());
+        EXPECT_EQ(backtracking_result.success, true);
+        if (!backtracking_result.success)
+            continue;
+        EXPECT_EQ(backtracking_result.matches.first().view.to_string(), result.matches.first().view.to_string());
+        auto& backtracking_captures = backtracking_result.capture_group_matches.first();
+        EXPECT_EQ(backtracking_captures.size(), captures.size());
+        for (size_t i = 0; i < min(captures.size(), backtracking_captures.size()); ++i)
+            EXPECT_EQ(backtracking_captures[i].view.to_string(), captures[i].view.to_string());
+    }
+
+    {
+        // Anchors and global matches have to pick up where the previous match left off.
+        Regex<ECMA262> re("^a+$"sv, ECMAScriptFlags::Global | ECMAScriptFlags::Multiline);
+        EXPECT(re.dfa);
+        auto result = re.match("aa\nb\naaa\na"sv);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.count, 3u);
+        if (result.count == 3) {
+            EXPECT_EQ(result.matches[0].view.to_string(), "aa"sv);
+            EXPECT_EQ(result.matches[1].view.to_string(), "aaa"sv);
+            EXPECT_EQ(result.matches[1].global_offset, 5u);
+            EXPECT_EQ(result.matches[2].view.to_string(), "a"sv);
+        }
+    }
+}
@@ -225,3 +225,48 @@ TEST_CASE(insert_100_into_table)
 {
     insert_and_verify(100);
 }
+
+TEST_CASE(insert_1000_into_table)
+{
+    insert_and_verify(1000);
+}
+
+TEST_CASE(read_blocks_after_flush)
+{
+    ScopeGuard guard([]() { unlink("/tmp/test.db"); });
+    auto heap = SQL::Heap::construct("/tmp/test.db");
+    EXPECT(!heap->open().is_error());
+
+    auto write_blocks = [&](u32 first_block, u32 count, u8 fill) {
+        for (auto block = first_block; block < first_block + count; block++) {
+            auto buffer = ByteBuffer::create_uninitialized(SQL::BLOCKSIZE).release_value();
+            buffer.bytes().fill(fill + block);
+            heap->add_to_wal(block, buffer);
+        }
+    };
+    auto verify_blocks = [&](u32 first_block, u32 count, u8 fill) {
+        for (auto block = first_block; block < first_block + count; block++) {
+            auto buffer_or_error = heap->read_block(block);
+            EXPECT(!buffer_or_error.is_error());
+            auto buffer = buffer_or_error.release_value();
+            EXPECT_EQ(buffer.size(), SQL::BLOCKSIZE);
+            EXPECT_EQ(buffer[0], static_cast<u8>(fill + block));
+            EXPECT_EQ(buffer[SQL::BLOCKSIZE - 1], static_cast<u8>(fill + block));
+        }
+    };
+
+    // More blocks than fit in the cache.
+    auto block_count = static_cast<u32>(SQL::Heap::max_cached_blocks) * 2;
+    for (u32 block = 0; block < block_count; block++)
+        EXPECT_EQ(heap->new_record_pointer(), block + 1);
+    write_blocks(1, block_count, 0);
+    EXPECT(!heap->flush().is_error());
+    verify_blocks(1, block_count, 0);
+    EXPECT(heap->cached_blocks() <= SQL::Heap::max_cached_blocks);
+
+    // Blocks that were read before have to reflect writes made afterwards.
+    write_blocks(1, 10, 42);
+    EXPECT(!heap->flush().is_error());
+    verify_blocks(1, 10, 42);
+    verify_blocks(11, block_count - 10, 0);
+}
@@ -252,6 +252,29 @@ TEST_CASE(binary_operator)
     }
 }
 
+TEST_CASE(binary_operator_precedence)
+{
+    auto validate = [](StringView sql, SQL::AST::BinaryOperator expected_operator, SQL::AST::BinaryOperator expected_lhs_operator, SQL::AST::BinaryOperator expected_rhs_operator) {
+        auto result = parse(sql);
+        EXPECT(!result.is_error());
+
+        auto expression = result.release_value();
+        EXPECT(is<SQL::AST::BinaryOperatorExpression>(*expression));
+
+        const auto& binary = static_cast<const SQL::AST::BinaryOperatorExpression&>(*expression);
+        EXPECT_EQ(binary.type(), expected_operator);
+        EXPECT(is<SQL::AST::BinaryOperatorExpression>(*binary.lhs()));
+        EXPECT_EQ(static_cast<const SQL::AST::BinaryOperatorExpression&>(*binary.lhs()).type(), expected_lhs_operator);
+        EXPECT(is<SQL::AST::BinaryOperatorExpression>(*binary.rhs()));
+        EXPECT_EQ(static_cast<const SQL::AST::BinaryOperatorExpression&>(*binary.rhs()).type(), expected_rhs_operator);
+    };
+
+    validate("a >= 1 AND a < 2", SQL::AST::BinaryOperator::And, SQL::AST::BinaryOperator::GreaterThanEquals, SQL::AST::BinaryOperator::LessThan);
+    validate("a = 1 OR b = 2 AND c = 3", SQL::AST::BinaryOperator::Or, SQL::AST::BinaryOperator::Equals, SQL::AST::BinaryOperator::And);
+    validate("1 * 2 + 3 * 4", SQL::AST::BinaryOperator::Plus, SQL::AST::BinaryOperator::Multiplication, SQL::AST::BinaryOperator::Multiplication);
+    validate("1 - 2 - 3 = 4 - 5", SQL::AST::BinaryOperator::Equals, SQL::AST::BinaryOperator::Minus, SQL::AST::BinaryOperator::Minus);
+}
+
 TEST_CASE(chained_expression)
 {
     EXPECT(parse("()").is_error());
@@ -754,4 +754,170 @@ TEST_CASE(binary_operator_failure)
     expect_failure(move(result), '&');
 }
 
+TEST_CASE(select_using_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+
+    for (auto count = 0; count < 100; ++count) {
+        auto result = execute(database,
+            String::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test_{}', {} );", count, count));
+        EXPECT_EQ(result.size(), 1u);
+    }
+    auto result = execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable ( IntColumn );");
+    EXPECT_EQ(result.command(), SQL::SQLCommand::Create);
+
+    // Rows inserted after the index was created have to show up as well.
+    for (auto count = 100; count < 150; ++count) {
+        result = execute(database,
+            String::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test_{}', {} );", count, count % 50));
+        EXPECT_EQ(result.size(), 1u);
+    }
+
+    result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE IntColumn = 42 ORDER BY TextColumn;");
+    EXPECT_EQ(result.size(), 2u);
+    EXPECT_EQ(result[0].row[0].to_string(), "Test_142");
+    EXPECT_EQ(result[1].row[0].to_string(), "Test_42");
+
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn >= 60 AND IntColumn < 70;");
+    EXPECT_EQ(result.size(), 10u);
+    for (auto& row : result)
+        EXPECT(row.row[0].to_int().value() >= 60 && row.row[0].to_int().value() < 70);
+
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE 95 < IntColumn AND TextColumn <> 'Test_99';");
+    EXPECT_EQ(result.size(), 3u);
+
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn <= 1;");
+    EXPECT_EQ(result.size(), 4u);
+
+    // The index is read back when the database is reopened.
+    EXPECT(!database->commit().is_error());
+    auto reopened_database = SQL::Database::construct(db_name);
+    EXPECT(!reopened_database->open().is_error());
+    result = execute(reopened_database, "SELECT TextColumn FROM TestSchema.TestTable WHERE IntColumn = 99;");
+    EXPECT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0].row[0].to_string(), "Test_99");
+}
+
+TEST_CASE(explain_query_plan)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+
+    auto result = execute(database, "EXPLAIN QUERY PLAN SELECT * FROM TestSchema.TestTable WHERE IntColumn = 42;");
+    EXPECT_EQ(result.command(), SQL::SQLCommand::Explain);
+    EXPECT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0].row[0].to_string(), "SCAN TESTSCHEMA.TESTTABLE");
+
+    execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable ( IntColumn DESC );");
+    execute(database, "CREATE INDEX TestSchema.TextIntIndex ON TestTable ( TextColumn, IntColumn );");
+
+    result = execute(database, "EXPLAIN QUERY PLAN SELECT * FROM TestSchema.TestTable WHERE IntColumn = 42;");
+    EXPECT_EQ(result[0].row[0].to_string(), "SEARCH TESTSCHEMA.TESTTABLE USING INDEX INTINDEX (INTCOLUMN=?)");
+
+    result = execute(database, "EXPLAIN QUERY PLAN SELECT * FROM TestSchema.TestTable WHERE IntColumn > 1 AND 10 >= IntColumn;");
+    EXPECT_EQ(result[0].row[0].to_string(), "SEARCH TESTSCHEMA.TESTTABLE USING INDEX INTINDEX (INTCOLUMN>? AND INTCOLUMN<=?)");
+
+    result = execute(database, "EXPLAIN QUERY PLAN SELECT * FROM TestSchema.TestTable WHERE IntColumn < 10 AND TextColumn = 'Test_1';");
+    EXPECT_EQ(result[0].row[0].to_string(), "SEARCH TESTSCHEMA.TESTTABLE USING INDEX TEXTINTINDEX (TEXTCOLUMN=? AND INTCOLUMN<?)");
+
+    // Comparisons that can't use an index fall back to scanning the table.
+    result = execute(database, "EXPLAIN QUERY PLAN SELECT * FROM TestSchema.TestTable WHERE IntColumn = 42 OR IntColumn = 43;");
+    EXPECT_EQ(result[0].row[0].to_string(), "SCAN TESTSCHEMA.TESTTABLE");
+}
+
+TEST_CASE(select_using_descending_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable ( IntColumn DESC );");
+
+    for (auto count = 0; count < 50; ++count) {
+        auto result = execute(database,
+            String::formatted("INSERT INTO TestSchema.TestTable ( TextColumn, IntColumn ) VALUES ( 'Test_{}', {} );", count, count));
+        EXPECT_EQ(result.size(), 1u);
+    }
+
+    auto result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn > 10 AND IntColumn <= 20;");
+    EXPECT_EQ(result.size(), 10u);
+    for (auto& row : result)
+        EXPECT(row.row[0].to_int().value() > 10 && row.row[0].to_int().value() <= 20);
+}
+
+TEST_CASE(primary_key)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_schema(database);
+    execute(database, "CREATE TABLE TestSchema.TestTable ( IntColumn integer PRIMARY KEY, TextColumn text );");
+
+    for (auto count = 0; count < 20; ++count)
+        execute(database, String::formatted("INSERT INTO TestSchema.TestTable VALUES ( {}, 'Test_{}' );", count, count));
+
+    auto result = try_execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 7, 'Duplicate' );");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::UniqueConstraintViolated);
+
+    result = execute(database, "SELECT TextColumn FROM TestSchema.TestTable WHERE IntColumn = 7;");
+    EXPECT_EQ(result.value().size(), 1u);
+    EXPECT_EQ(result.value()[0].row[0].to_string(), "Test_7");
+
+    result = execute(database, "EXPLAIN SELECT TextColumn FROM TestSchema.TestTable WHERE IntColumn = 7;");
+    EXPECT_EQ(result.value()[0].row[0].to_string(), "SEARCH TESTSCHEMA.TESTTABLE USING PRIMARY KEY (INTCOLUMN=?)");
+
+    // The key isn't the last column, but it still has to be compared as an integer (as text, "10" < "5").
+    result = execute(database, "EXPLAIN SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn > 5;");
+    EXPECT_EQ(result.value()[0].row[0].to_string(), "SEARCH TESTSCHEMA.TESTTABLE USING PRIMARY KEY (INTCOLUMN>?)");
+    auto expect_int_columns_above_5 = [](SQL::ResultSet const& result) {
+        EXPECT_EQ(result.size(), 14u);
+        for (auto& row : result)
+            EXPECT(row.row[0].to_int().value() > 5);
+    };
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn > 5;");
+    expect_int_columns_above_5(result.value());
+
+    EXPECT(!database->commit().is_error());
+    auto reopened_database = SQL::Database::construct(db_name);
+    EXPECT(!reopened_database->open().is_error());
+    expect_int_columns_above_5(execute(reopened_database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn > 5;"));
+
+    result = try_execute(database, "CREATE TABLE TestSchema.OtherTable ( IntColumn integer PRIMARY KEY, TextColumn text PRIMARY KEY );");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::TooManyPrimaryKeys);
+}
+
+TEST_CASE(unique_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    EXPECT(!database->open().is_error());
+    create_table(database);
+    execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 'Test_1', 1 ), ( 'Test_2', 1 );");
+
+    auto result = try_execute(database, "CREATE UNIQUE INDEX TestSchema.IntIndex ON TestTable ( IntColumn );");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::UniqueConstraintViolated);
+
+    execute(database, "CREATE UNIQUE INDEX TestSchema.TextIndex ON TestTable ( TextColumn );");
+    result = try_execute(database, "CREATE UNIQUE INDEX TestSchema.TextIndex ON TestTable ( TextColumn );");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::IndexExists);
+    execute(database, "CREATE UNIQUE INDEX IF NOT EXISTS TestSchema.TextIndex ON TestTable ( TextColumn );");
+
+    result = try_execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 'Test_2', 3 );");
+    EXPECT(result.is_error());
+    EXPECT_EQ(result.release_error().error(), SQL::SQLErrorCode::UniqueConstraintViolated);
+
+    execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 'Test_3', 3 );");
+    result = execute(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE TextColumn = 'Test_3';");
+    EXPECT_EQ(result.value().size(), 1u);
+}
+
 }
@@ -131,6 +131,84 @@ TEST_CASE(create_table)
     validate("CREATE TABLE test ( column1 varchar(1e3) );", {}, "TEST", { { "COLUMN1", "VARCHAR", { 1000 } } });
 }
 
+TEST_CASE(create_table_with_primary_key)
+{
+    EXPECT(parse("CREATE TABLE test ( column1 int PRIMARY );").is_error());
+    EXPECT(parse("CREATE TABLE test ( column1 int KEY );").is_error());
+
+    auto validate = [](StringView sql, Vector<bool> expected_primary_keys, SQL::Order expected_primary_key_order = SQL::Order::Ascending) {
+        auto result = parse(sql);
+        if (result.is_error())
+            outln("{}: {}", sql, result.error());
+        EXPECT(!result.is_error());
+
+        auto statement = result.release_value();
+        EXPECT(is<SQL::AST::CreateTable>(*statement));
+
+        const auto& columns = static_cast<const SQL::AST::CreateTable&>(*statement).columns();
+        EXPECT_EQ(columns.size(), expected_primary_keys.size());
+
+        for (size_t i = 0; i < columns.size(); ++i) {
+            EXPECT_EQ(columns[i].is_primary_key(), expected_primary_keys[i]);
+            if (columns[i].is_primary_key())
+                EXPECT_EQ(columns[i].primary_key_order(), expected_primary_key_order);
+        }
+    };
+
+    validate("CREATE TABLE test ( column1 int PRIMARY KEY, column2 text );", { true, false });
+    validate("CREATE TABLE test ( column1 int, column2 text PRIMARY KEY ASC );", { false, true });
+    validate("CREATE TABLE test ( column1 int PRIMARY KEY DESC, column2 text );", { true, false }, SQL::Order::Descending);
+    validate("CREATE TABLE test ( column1 PRIMARY KEY );", { true });
+}
+
+TEST_CASE(create_index)
+{
+    EXPECT(parse("CREATE INDEX").is_error());
+    EXPECT(parse("CREATE INDEX index_name;").is_error());
+    EXPECT(parse("CREATE INDEX index_name ON;").is_error());
+    EXPECT(parse("CREATE INDEX index_name ON table_name;").is_error());
+    EXPECT(parse("CREATE INDEX index_name ON table_name ();").is_error());
+    EXPECT(parse("CREATE INDEX index_name table_name ( column1 );").is_error());
+    EXPECT(parse("CREATE UNIQUE index_name ON table_name ( column1 );").is_error());
+    EXPECT(parse("CREATE INDEX IF NOT index_name ON table_name ( column1 );").is_error());
+
+    struct IndexedColumn {
+        StringView name;
+        SQL::Order order { SQL::Order::Ascending };
+    };
+
+    auto validate = [](StringView sql, StringView expected_schema, StringView expected_index, StringView expected_table, Vector<IndexedColumn> expected_columns, bool expected_is_unique = false, bool expected_is_error_if_index_exists = true) {
+        auto result = parse(sql);
+        if (result.is_error())
+            outln("{}: {}", sql, result.error());
+        EXPECT(!result.is_error());
+
+        auto statement = result.release_value();
+        EXPECT(is<SQL::AST::CreateIndex>(*statement));
+
+        const auto& index = static_cast<const SQL::AST::CreateIndex&>(*statement);
+        EXPECT_EQ(index.schema_name(), expected_schema);
+        EXPECT_EQ(index.index_name(), expected_index);
+        EXPECT_EQ(index.table_name(), expected_table);
+        EXPECT_EQ(index.is_unique(), expected_is_unique);
+        EXPECT_EQ(index.is_error_if_index_exists(), expected_is_error_if_index_exists);
+
+        const auto& columns = index.indexed_columns();
+        EXPECT_EQ(columns.size(), expected_columns.size());
+
+        for (size_t i = 0; i < columns.size(); ++i) {
+            EXPECT_EQ(columns[i].column_name(), expected_columns[i].name);
+            EXPECT_EQ(columns[i].order(), expected_columns[i].order);
+        }
+    };
+
+    validate("CREATE INDEX index_name ON table_name ( column1 );", {}, "INDEX_NAME", "TABLE_NAME", { { "COLUMN1" } });
+    validate("CREATE INDEX schema_name.index_name ON table_name ( column1 );", "SCHEMA_NAME", "INDEX_NAME", "TABLE_NAME", { { "COLUMN1" } });
+    validate("CREATE INDEX index_name ON table_name ( column1 ASC, column2 DESC );", {}, "INDEX_NAME", "TABLE_NAME", { { "COLUMN1" }, { "COLUMN2", SQL::Order::Descending } });
+    validate("CREATE UNIQUE INDEX index_name ON table_name ( column1 );", {}, "INDEX_NAME", "TABLE_NAME", { { "COLUMN1" } }, true);
+    validate("CREATE INDEX IF NOT EXISTS index_name ON table_name ( column1 );", {}, "INDEX_NAME", "TABLE_NAME", { { "COLUMN1" } }, false, false);
+}
+
 TEST_CASE(alter_table)
 {
     // This test case only contains common error cases of the AlterTable subclasses.
@@ -776,3 +854,28 @@ TEST_CASE(describe_table)
     validate("DESCRIBE TABLE TableName;", {}, "TABLENAME");
     validate("DESCRIBE TABLE SchemaName.TableName;", "SCHEMANAME", "TABLENAME");
 }
+
+TEST_CASE(explain)
+{
+    EXPECT(parse("EXPLAIN").is_error());
+    EXPECT(parse("EXPLAIN;").is_error());
+    EXPECT(parse("EXPLAIN QUERY SELECT * FROM table_name;").is_error());
+    EXPECT(parse("EXPLAIN PLAN SELECT * FROM table_name;").is_error());
+    EXPECT(parse("EXPLAIN QUERY PLAN DESCRIBE TABLE table_name;").is_error());
+
+    auto validate = [](StringView sql) {
+        auto result = parse(sql);
+        if (result.is_error())
+            outln("{}: {}", sql, result.error());
+        EXPECT(!result.is_error());
+
+        auto statement = result.release_value();
+        EXPECT(is<SQL::AST::Explain>(*statement));
+
+        const auto& explain_statement = static_cast<const SQL::AST::Explain&>(*statement);
+        EXPECT(!explain_statement.select_statement()->where_clause().is_null());
+    };
+
+    validate("EXPLAIN SELECT * FROM table_name WHERE column1 = 1;");
+    validate("EXPLAIN QUERY PLAN SELECT * FROM table_name WHERE column1 = 1;");
+}
@@ -7,9 +7,12 @@
 
 #include <AK/Array.h>
 #include <AK/Assertions.h>
+#include <AK/Atomic.h>
 #include <AK/BinaryHeap.h>
-#include <AK/BinarySearch.h>
+#include <AK/BuiltinWrappers.h>
 #include <AK/MemoryStream.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <LibThreading/Thread.h>
 #include <string.h>
 
 #include <LibCompress/Deflate.h>
@@ -18,29 +21,14 @@ namespace Compress {
 
 const CanonicalCode& CanonicalCode::fixed_literal_codes()
 {
-    static CanonicalCode code;
-    static bool initialized = false;
-
-    if (initialized)
-        return code;
-
-    code = CanonicalCode::from_bytes(fixed_literal_bit_lengths).value();
-    initialized = true;
-
+    // Compressors on several threads may ask for this at the same time, which a static local is safe against.
+    static CanonicalCode const code = CanonicalCode::from_bytes(fixed_literal_bit_lengths).value();
     return code;
 }
 
 const CanonicalCode& CanonicalCode::fixed_distance_codes()
 {
-    static CanonicalCode code;
-    static bool initialized = false;
-
-    if (initialized)
-        return code;
-
-    code = CanonicalCode::from_bytes(fixed_distance_bit_lengths).value();
-    initialized = true;
-
+    static CanonicalCode const code = CanonicalCode::from_bytes(fixed_distance_bit_lengths).value();
     return code;
 }
 
@@ -59,10 +47,9 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         }
     }
     if (non_zero_symbols == 1) { // special case - only 1 symbol
-        code.m_symbol_codes.append(0b10);
-        code.m_symbol_values.append(last_non_zero);
         code.m_bit_codes[last_non_zero] = 0;
         code.m_bit_code_lengths[last_non_zero] = 1;
+        code.build_lookup_table();
         return code;
     }
 
@@ -78,8 +65,6 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
             if (next_code > start_bit)
                 return {};
 
-            code.m_symbol_codes.append(start_bit | next_code);
-            code.m_symbol_values.append(symbol);
             code.m_bit_codes[symbol] = fast_reverse16(start_bit | next_code, code_length); // DEFLATE writes huffman encoded symbols as lsb-first
             code.m_bit_code_lengths[symbol] = code_length;
 
@@ -91,23 +76,76 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         return {};
     }
 
+    code.build_lookup_table();
     return code;
 }
 
+void CanonicalCode::build_lookup_table()
+{
+    // Codes are read starting with their first bit, which m_bit_codes holds in its least significant bit.
+    // Codes that fit into fast_lookup_bits are repeated for all the bits that may follow them, longer codes
+    // continue in a second level table that is just large enough for the longest code sharing its first bits.
+    constexpr size_t first_level_size = 1 << fast_lookup_bits;
+    m_lookup_table.resize(first_level_size);
+
+    Array<u8, first_level_size> longest_code_lengths {};
+    for (size_t symbol = 0; symbol < m_bit_code_lengths.size(); ++symbol) {
+        auto code_length = m_bit_code_lengths[symbol];
+        if (code_length <= fast_lookup_bits)
+            continue;
+        auto& longest_code_length = longest_code_lengths[m_bit_codes[symbol] & (first_level_size - 1)];
+        longest_code_length = max<u8>(longest_code_length, code_length);
+    }
+    for (size_t index = 0; index < first_level_size; ++index) {
+        if (longest_code_lengths[index] == 0)
+            continue;
+        auto table_bits = longest_code_lengths[index] - fast_lookup_bits;
+        m_lookup_table[index] = { static_cast<u16>(m_lookup_table.size()), 0, static_cast<u8>(table_bits) };
+        m_lookup_table.resize(m_lookup_table.size() + (1 << table_bits));
+    }
+
+    for (size_t symbol = 0; symbol < m_bit_code_lengths.size(); ++symbol) {
+        auto code_length = m_bit_code_lengths[symbol];
+        if (code_length == 0)
+            continue;
+        auto code = m_bit_codes[symbol];
+        LookupEntry entry { static_cast<u16>(symbol), static_cast<u8>(code_length), 0 };
+        if (code_length <= fast_lookup_bits) {
+            for (size_t index = code; index < first_level_size; index += 1 << code_length)
+                m_lookup_table[index] = entry;
+            continue;
+        }
+        auto const& link = m_lookup_table[code & (first_level_size - 1)];
+        for (size_t index = code >> fast_lookup_bits; index < (1u << link.table_bits); index += 1 << (code_length - fast_lookup_bits))
+            m_lookup_table[link.value + index] = entry;
+    }
+}
+
 u32 CanonicalCode::read_symbol(InputBitStream& stream) const
 {
-    u32 code_bits = 1;
+    // The maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error.
+    if (m_lookup_table.is_empty())
+        return UINT32_MAX;
 
+    // We only read as many bytes as the code needs, since the bytes after the end of the deflate stream belong to
+    // the container format. Bits that aren't buffered yet are zero, so the first lookup may land on a longer code
+    // than the buffered bits can tell apart, in which case we buffer that many bits and look again.
     for (;;) {
-        code_bits = code_bits << 1 | stream.read_bits(1);
-        if (code_bits >= (1 << 16))
-            return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
-
-        // FIXME: This is very inefficient and could greatly be improved by implementing this
-        //        algorithm: https://www.hanshq.net/zip.html#huffdec
-        size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
-            return m_symbol_values[index];
+        auto bits = stream.peek_bits(max_code_length);
+        auto entry = m_lookup_table[bits & ((1 << fast_lookup_bits) - 1)];
+        if (entry.table_bits != 0)
+            entry = m_lookup_table[entry.value + ((bits >> fast_lookup_bits) & ((1 << entry.table_bits) - 1))];
+
+        if (entry.code_length == 0)
+            return UINT32_MAX;
+
+        if (entry.code_length <= stream.buffered_bit_count()) {
+            stream.discard_bits(entry.code_length);
+            return entry.value;
+        }
+
+        if (!stream.ensure_buffered_bits(entry.code_length))
+            return UINT32_MAX;
     }
 }
 
@@ -128,20 +166,29 @@ bool DeflateDecompressor::CompressedBlock::try_read_more()
     if (m_eof == true)
         return false;
 
-    const auto symbol = m_literal_codes.read_symbol(m_decompressor.m_input_stream);
+    // Symbols are decoded in batches for as long as the longest back reference still fits into the output,
+    // so that the caller doesn't have to come back for every single one of them.
+    auto& output_stream = m_decompressor.m_output_stream;
+    bool produced_output = false;
+    while (output_stream.remaining_space() >= max_back_reference_length) {
+        const auto symbol = m_literal_codes.read_symbol(m_decompressor.m_input_stream);
 
-    if (symbol >= 286) { // invalid deflate literal/length symbol
-        m_decompressor.set_fatal_error();
-        return false;
-    }
+        if (symbol >= 286) { // invalid deflate literal/length symbol
+            m_decompressor.set_fatal_error();
+            return false;
+        }
+
+        if (symbol < 256) {
+            output_stream << static_cast<u8>(symbol);
+            produced_output = true;
+            continue;
+        }
+
+        if (symbol == 256) {
+            m_eof = true;
+            return produced_output;
+        }
 
-    if (symbol < 256) {
-        m_decompressor.m_output_stream << static_cast<u8>(symbol);
-        return true;
-    } else if (symbol == 256) {
-        m_eof = true;
-        return false;
-    } else {
         if (!m_distance_codes.has_value()) {
             m_decompressor.set_fatal_error();
             return false;
@@ -155,18 +202,15 @@ bool DeflateDecompressor::CompressedBlock::try_read_more()
         }
         const auto distance = m_decompressor.decode_distance(distance_symbol);
 
-        for (size_t idx = 0; idx < length; ++idx) {
-            u8 byte = 0;
-            m_decompressor.m_output_stream.read({ &byte, sizeof(byte) }, distance);
-            if (m_decompressor.m_output_stream.handle_any_error()) {
-                m_decompressor.set_fatal_error();
-                return false; // a back reference was requested that was too far back (outside our current sliding window)
-            }
-            m_decompressor.m_output_stream << byte;
+        if (!output_stream.copy_from_seekback(distance, length)) {
+            output_stream.handle_any_error();
+            m_decompressor.set_fatal_error();
+            return false; // a back reference was requested that was too far back (outside our current sliding window)
         }
-
-        return true;
+        produced_output = true;
     }
+
+    return true;
 }
 
 DeflateDecompressor::UncompressedBlock::UncompressedBlock(DeflateDecompressor& decompressor, size_t length)
@@ -554,19 +598,30 @@ size_t DeflateCompressor::compare_match_candidate(size_t start, size_t candidate
 {
     VERIFY(previous_match_length < maximum_match_length);
 
-    // We firstly check that the match is at least (prev_match_length + 1) long, we check backwards as there's a higher chance the end mismatches
-    for (ssize_t i = previous_match_length; i >= 0; i--) {
-        if (m_rolling_window[start + i] != m_rolling_window[candidate + i])
-            return 0;
+    // Most candidates can't beat the previous match, which the byte that would extend it usually tells us right away
+    if (m_rolling_window[start + previous_match_length] != m_rolling_window[candidate + previous_match_length])
+        return 0;
+
+    // Find the actual length 8 bytes at a time, the first mismatching byte is the lowest non-zero byte of their (little endian) xor
+    size_t match_length = 0;
+    while (match_length + sizeof(u64) <= maximum_match_length) {
+        u64 start_bytes;
+        u64 candidate_bytes;
+        __builtin_memcpy(&start_bytes, &m_rolling_window[start + match_length], sizeof(u64));
+        __builtin_memcpy(&candidate_bytes, &m_rolling_window[candidate + match_length], sizeof(u64));
+        auto difference = AK::convert_between_host_and_little_endian(start_bytes ^ candidate_bytes);
+        if (difference != 0) {
+            match_length += count_trailing_zeroes(difference) / 8;
+            return match_length > previous_match_length ? match_length : 0;
+        }
+        match_length += sizeof(u64);
     }
-
-    // Find the actual length
-    auto match_length = previous_match_length + 1;
-    while (match_length < maximum_match_length && m_rolling_window[start + match_length] == m_rolling_window[candidate + match_length]) {
+    while (match_length < maximum_match_length && m_rolling_window[start + match_length] == m_rolling_window[candidate + match_length])
         match_length++;
-    }
 
-    VERIFY(match_length > previous_match_length);
+    if (match_length <= previous_match_length)
+        return 0;
+
     VERIFY(match_length <= maximum_match_length);
     return match_length;
 }
@@ -604,7 +659,7 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
                 return match_length; // bail if we got the maximum possible length
         }
 
-        candidate = m_hash_prev[candidate % window_size];
+        candidate = m_hash_prev[candidate];
     }
     if (!match_found)
         return 0;                 // we didn't find any matches
@@ -694,10 +749,11 @@ void DeflateCompressor::lz77_compress_block()
         slot = empty_slot;
     }
 
+    // The table only ever holds positions of the pending block, which are all below window_size, so they don't need to wrap around
     auto insert_hash = [&](auto pos, auto hash) {
-        auto window_pos = pos % window_size;
-        m_hash_prev[window_pos] = m_hash_head[hash];
-        m_hash_head[hash] = window_pos;
+        VERIFY(pos < window_size);
+        m_hash_prev[pos] = m_hash_head[hash];
+        m_hash_head[hash] = pos;
     };
 
     auto emit_literal = [&](auto literal) {
@@ -1052,19 +1108,95 @@ void DeflateCompressor::final_flush()
     flush();
 }
 
-Optional<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level)
+void DeflateCompressor::sync_flush()
 {
-    DuplexMemoryStream output_stream;
-    DeflateCompressor deflate_stream { output_stream, compression_level };
+    VERIFY(!m_finished);
+    if (m_pending_block_size != 0)
+        flush();
+    m_finished = true;
 
-    deflate_stream.write_or_error(bytes);
+    if (m_output_stream.handle_any_error()) {
+        set_fatal_error();
+        return;
+    }
 
-    deflate_stream.final_flush();
+    m_output_stream.write_bit(false);    // not the final block
+    m_output_stream.write_bits(0b00, 2); // no compression
+    m_output_stream.align_to_byte_boundary();
+    LittleEndian<u16> len = 0;
+    m_output_stream << len;
+    LittleEndian<u16> nlen = ~0;
+    m_output_stream << nlen;
+}
 
-    if (deflate_stream.handle_any_error())
-        return {};
+Optional<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level, size_t thread_count)
+{
+    auto chunk_count = ceil_div(bytes.size(), parallel_chunk_size);
+    if (thread_count <= 1 || chunk_count <= 1) {
+        DuplexMemoryStream output_stream;
+        DeflateCompressor deflate_stream { output_stream, compression_level };
 
-    return output_stream.copy_into_contiguous_buffer();
+        deflate_stream.write_or_error(bytes);
+
+        deflate_stream.final_flush();
+
+        if (deflate_stream.handle_any_error())
+            return {};
+
+        return output_stream.copy_into_contiguous_buffer();
+    }
+
+    Vector<Optional<ByteBuffer>> compressed_chunks;
+    compressed_chunks.resize(chunk_count);
+    Atomic<size_t> next_chunk_index { 0 };
+
+    // Every thread (including this one) keeps taking the next chunk until there are none left
+    auto compress_chunks = [&]() -> intptr_t {
+        for (size_t index = next_chunk_index++; index < chunk_count; index = next_chunk_index++) {
+            auto chunk_offset = index * parallel_chunk_size;
+            auto chunk = bytes.slice(chunk_offset, min(parallel_chunk_size, bytes.size() - chunk_offset));
+
+            DuplexMemoryStream output_stream;
+            // The compressor is a few hundred KiB large, which is too much for the stack of a secondary thread
+            auto deflate_stream = make<DeflateCompressor>(output_stream, compression_level);
+            deflate_stream->write_or_error(chunk);
+            if (index == chunk_count - 1)
+                deflate_stream->final_flush();
+            else
+                deflate_stream->sync_flush();
+
+            if (!deflate_stream->handle_any_error())
+                compressed_chunks[index] = output_stream.copy_into_contiguous_buffer();
+        }
+        return 0;
+    };
+
+    NonnullRefPtrVector<Threading::Thread> threads;
+    for (size_t i = 1; i < min(thread_count, chunk_count); ++i) {
+        threads.append(Threading::Thread::construct([&] { return compress_chunks(); }, "Deflate worker"sv));
+        threads.last().start();
+    }
+    compress_chunks();
+    for (auto& thread : threads)
+        [[maybe_unused]] auto result = thread.join();
+
+    size_t output_size = 0;
+    for (auto& compressed_chunk : compressed_chunks) {
+        if (!compressed_chunk.has_value())
+            return {};
+        output_size += compressed_chunk->size();
+    }
+
+    auto output_or_error = ByteBuffer::create_uninitialized(output_size);
+    if (output_or_error.is_error())
+        return {};
+    auto output = output_or_error.release_value();
+    size_t offset = 0;
+    for (auto& compressed_chunk : compressed_chunks) {
+        compressed_chunk->bytes().copy_to(output.bytes().slice(offset));
+        offset += compressed_chunk->size();
+    }
+    return output;
 }
 
 }
@@ -28,9 +28,19 @@ public:
     static Optional<CanonicalCode> from_bytes(ReadonlyBytes);
 
 private:
-    // Decompression - indexed by code
-    Vector<u16> m_symbol_codes;
-    Vector<u16> m_symbol_values;
+    static constexpr size_t max_code_length = 15;
+    static constexpr size_t fast_lookup_bits = 9;
+
+    struct LookupEntry {
+        u16 value { 0 };      // the decoded symbol, or the index of a second level table
+        u8 code_length { 0 }; // the length of the symbol's code, zero if no code starts with these bits
+        u8 table_bits { 0 };  // the number of bits indexing the second level table, zero for symbols
+    };
+
+    void build_lookup_table();
+
+    // Decompression - indexed by the next fast_lookup_bits bits of input, followed by the second level tables for longer codes
+    Vector<LookupEntry> m_lookup_table;
 
     // Compression - indexed by symbol
     Array<u16, 288> m_bit_codes {}; // deflate uses a maximum of 288 symbols (maximum of 32 for distances)
@@ -39,6 +49,8 @@ private:
 
 class DeflateDecompressor final : public InputStream {
 private:
+    static constexpr size_t max_back_reference_length = 258;
+
     class CompressedBlock {
     public:
         CompressedBlock(DeflateDecompressor&, CanonicalCode literal_codes, Optional<CanonicalCode> distance_codes);
@@ -119,6 +131,9 @@ public:
     static constexpr size_t min_match_length = 4;   // matches smaller than these are not worth the size of the back reference
     static constexpr size_t max_match_length = 258; // matches longer than these cannot be encoded using huffman codes
     static constexpr u16 empty_slot = UINT16_MAX;
+    // The input is split into chunks of this size when compressing on multiple threads. Matches never cross block
+    // boundaries, so as long as chunks are made of whole blocks this compresses just as well as a single thread.
+    static constexpr size_t parallel_chunk_size = 32 * block_size;
 
     struct CompressionConstants {
         size_t good_match_length;  // Once we find a match of at least this length (a good enough match) we reduce max_chain to lower processing time
@@ -150,8 +165,12 @@ public:
     size_t write(ReadonlyBytes) override;
     bool write_or_error(ReadonlyBytes) override;
     void final_flush();
+    // Ends the output with an empty uncompressed block instead of a final block, which leaves it on a byte boundary.
+    // The output of another compressor can then be appended to form a single deflate stream.
+    void sync_flush();
 
-    static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD);
+    // With more than one thread, the input is compressed in independent chunks that are stitched together with sync flushes.
+    static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD, size_t thread_count = 1);
 
 private:
     Bytes pending_block() { return { m_rolling_window + block_size, block_size }; }
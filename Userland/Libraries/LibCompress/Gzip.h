@@ -81,16 +81,17 @@ private:
 
 class GzipCompressor final : public OutputStream {
 public:
-    GzipCompressor(OutputStream&);
+    GzipCompressor(OutputStream&, size_t thread_count = 1);
     ~GzipCompressor();
 
     size_t write(ReadonlyBytes) override;
     bool write_or_error(ReadonlyBytes) override;
 
-    static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes);
+    static Optional<ByteBuffer> compress_all(ReadonlyBytes bytes, size_t thread_count = 1);
 
 private:
     OutputStream& m_output_stream;
+    size_t m_thread_count { 1 };
 };
 
 }
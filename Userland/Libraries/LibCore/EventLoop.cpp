@@ -13,6 +13,7 @@
 #include <AK/JsonObject.h>
 #include <AK/JsonValue.h>
 #include <AK/NeverDestroyed.h>
+#include <AK/NumericLimits.h>
 #include <AK/Singleton.h>
 #include <AK/TemporaryChange.h>
 #include <AK/Time.h>
@@ -28,12 +29,18 @@
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
-#include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__serenity__) || defined(__linux__)
+#    include <sys/epoll.h>
+#    define CORE_EVENTLOOP_USE_EPOLL
+#else
+#    include <poll.h>
+#endif
+
 #ifdef __serenity__
 extern bool s_global_initializers_ran;
 #endif
@@ -68,10 +75,29 @@ static Threading::MutexProtected<RefPtr<InspectorServerConnection>> s_inspector_
 // Each thread has its own event loop stack, its own timers, notifiers and a wake pipe.
 static thread_local Vector<EventLoop&>* s_event_loop_stack;
 static thread_local HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
-static thread_local HashTable<Notifier*>* s_notifiers;
 thread_local int EventLoop::s_wake_pipe_fds[2];
 thread_local bool EventLoop::s_wake_pipe_initialized { false };
 
+// The notifiers of each thread are grouped by file descriptor, along with the combined
+// event mask that the file descriptor is currently being watched for.
+struct NotifiersForFD {
+    Vector<Notifier*, 1> notifiers;
+    unsigned watched_event_mask { Notifier::None };
+};
+static thread_local HashMap<int, NotifiersForFD>* s_notifiers;
+
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+// The file descriptors we're watching (including the wake pipe) are kept in a kernel-side
+// interest set, so waiting for events doesn't require passing all of them every time.
+static thread_local int s_epoll_fd { -1 };
+// Some files (like regular files on Linux) can't be watched, but they're always ready anyway.
+static thread_local HashMap<int, unsigned>* s_always_ready_fds;
+#else
+// Without a kernel-side interest set, we keep the pollfd array around until the notifiers change.
+static thread_local Vector<pollfd>* s_pollfds;
+static thread_local bool s_pollfds_need_rebuild { true };
+#endif
+
 void EventLoop::initialize_wake_pipes()
 {
     if (!s_wake_pipe_initialized) {
@@ -85,7 +111,92 @@ void EventLoop::initialize_wake_pipes()
 #endif
         VERIFY(rc == 0);
         s_wake_pipe_initialized = true;
+
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+        if (s_epoll_fd >= 0)
+            close(s_epoll_fd);
+        s_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        VERIFY(s_epoll_fd >= 0);
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = s_wake_pipe_fds[0];
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, s_wake_pipe_fds[0], &event);
+        VERIFY(rc == 0);
+#else
+        s_pollfds_need_rebuild = true;
+#endif
+    }
+}
+
+enum class ForceWatch {
+    No,
+    Yes,
+};
+
+static void watch_fd(int fd, unsigned event_mask, ForceWatch force_watch)
+{
+    auto& notifiers_for_fd = s_notifiers->find(fd)->value;
+    auto old_event_mask = notifiers_for_fd.watched_event_mask;
+    if (event_mask == old_event_mask && force_watch == ForceWatch::No)
+        return;
+    notifiers_for_fd.watched_event_mask = event_mask;
+
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+    epoll_event event {};
+    if (event_mask & Notifier::Read)
+        event.events |= EPOLLIN;
+    if (event_mask & Notifier::Write)
+        event.events |= EPOLLOUT;
+    if (event_mask & Notifier::Exceptional)
+        VERIFY_NOT_REACHED();
+    event.data.fd = fd;
+
+    if (s_always_ready_fds->contains(fd)) {
+        if (event_mask == Notifier::None)
+            s_always_ready_fds->remove(fd);
+        else
+            s_always_ready_fds->set(fd, event_mask);
+        return;
     }
+
+    int rc;
+    if (event_mask == Notifier::None) {
+        // NOTE: The watch is gone already if the file descriptor was closed before its notifiers were removed.
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        if (rc < 0 && (errno == EBADF || errno == ENOENT))
+            rc = 0;
+    } else if (old_event_mask == Notifier::None || force_watch == ForceWatch::Yes) {
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+        if (rc < 0 && errno == EEXIST)
+            rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+        if (rc < 0 && errno == EPERM) {
+            s_always_ready_fds->set(fd, event_mask);
+            rc = 0;
+        }
+    } else {
+        rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_MOD, fd, &event);
+        if (rc < 0 && errno == ENOENT)
+            rc = epoll_ctl(s_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+    if (rc < 0)
+        dbgln("Core::EventLoop: Failed to watch fd {} for event mask {}: {}", fd, event_mask, strerror(errno));
+#else
+    s_pollfds_need_rebuild = true;
+#endif
+}
+
+// A new notifier forces the file descriptor to be watched again, as it may refer to a new file
+// that reused the number of one which was closed before its notifiers were removed.
+static void update_watched_event_mask(int fd, ForceWatch force_watch = ForceWatch::No)
+{
+    auto it = s_notifiers->find(fd);
+    VERIFY(it != s_notifiers->end());
+    unsigned event_mask = Notifier::None;
+    for (auto* notifier : it->value.notifiers)
+        event_mask |= notifier->event_mask();
+    watch_fd(fd, event_mask, force_watch);
+    if (it->value.notifiers.is_empty())
+        s_notifiers->remove(it);
 }
 
 bool EventLoop::has_been_instantiated()
@@ -320,7 +431,12 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
     if (!s_event_loop_stack) {
         s_event_loop_stack = new Vector<EventLoop&>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
-        s_notifiers = new HashTable<Notifier*>;
+        s_notifiers = new HashMap<int, NotifiersForFD>;
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+        s_always_ready_fds = new HashMap<int, unsigned>;
+#else
+        s_pollfds = new Vector<pollfd>;
+#endif
     }
     s_main_event_loop.with_locked([&, this](auto*& main_event_loop) {
         if (main_event_loop == nullptr) {
@@ -340,6 +456,10 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
         }
     });
 
+    // The first event loop on any other thread becomes that thread's outermost loop.
+    if (s_event_loop_stack->is_empty())
+        s_event_loop_stack->append(*this);
+
     initialize_wake_pipes();
 
     dbgln_if(EVENTLOOP_DEBUG, "{} Core::EventLoop constructed :)", getpid());
@@ -347,13 +467,14 @@ EventLoop::EventLoop([[maybe_unused]] MakeInspectable make_inspectable)
 
 EventLoop::~EventLoop()
 {
-    // NOTE: Pop the main event loop off of the stack when destroyed.
     s_main_event_loop.with_locked([this](auto*& main_event_loop) {
-        if (this == main_event_loop) {
-            s_event_loop_stack->take_last();
+        if (this == main_event_loop)
             main_event_loop = nullptr;
-        }
     });
+
+    // NOTE: Pop the outermost event loop of this thread off of the stack when destroyed.
+    if (!s_event_loop_stack->is_empty() && &s_event_loop_stack->last() == this)
+        s_event_loop_stack->take_last();
 }
 
 bool connect_to_inspector_server()
@@ -633,6 +754,9 @@ void EventLoop::notify_forked(ForkEvent event)
         s_event_loop_stack->clear();
         s_timers->clear();
         s_notifiers->clear();
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+        s_always_ready_fds->clear();
+#endif
         s_wake_pipe_initialized = false;
         initialize_wake_pipes();
         if (auto* info = signals_info<false>()) {
@@ -651,31 +775,14 @@ void EventLoop::notify_forked(ForkEvent event)
 
 void EventLoop::wait_for_event(WaitMode mode)
 {
-    fd_set rfds;
-    fd_set wfds;
-retry:
-    FD_ZERO(&rfds);
-    FD_ZERO(&wfds);
-
-    int max_fd = 0;
-    auto add_fd_to_set = [&max_fd](int fd, fd_set& set) {
-        FD_SET(fd, &set);
-        if (fd > max_fd)
-            max_fd = fd;
+    struct ReadyFD {
+        int fd { -1 };
+        unsigned event_mask { Notifier::None };
     };
+    Vector<ReadyFD, 64> ready_fds;
 
-    int max_fd_added = -1;
-    add_fd_to_set(s_wake_pipe_fds[0], rfds);
-    max_fd = max(max_fd, max_fd_added);
-
-    for (auto& notifier : *s_notifiers) {
-        if (notifier->event_mask() & Notifier::Read)
-            add_fd_to_set(notifier->fd(), rfds);
-        if (notifier->event_mask() & Notifier::Write)
-            add_fd_to_set(notifier->fd(), wfds);
-        if (notifier->event_mask() & Notifier::Exceptional)
-            VERIFY_NOT_REACHED();
-    }
+retry:
+    ready_fds.clear_with_capacity();
 
     bool queued_events_is_empty;
     {
@@ -684,8 +791,7 @@ retry:
     }
 
     Time now;
-    struct timeval timeout = { 0, 0 };
-    bool should_wait_forever = false;
+    int timeout_ms = 0;
     if (mode == WaitMode::WaitForEvents && queued_events_is_empty) {
         auto next_timer_expiration = get_next_timer_expiration();
         if (next_timer_expiration.has_value()) {
@@ -693,14 +799,46 @@ retry:
             auto computed_timeout = next_timer_expiration.value() - now;
             if (computed_timeout.is_negative())
                 computed_timeout = Time::zero();
-            timeout = computed_timeout.to_timeval();
+            // NOTE: This rounds up, so we don't wake up before the timer has expired.
+            timeout_ms = static_cast<int>(min(computed_timeout.to_milliseconds(), static_cast<i64>(NumericLimits<int>::max())));
         } else {
-            should_wait_forever = true;
+            timeout_ms = -1;
+        }
+    }
+
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+    if (!s_always_ready_fds->is_empty()) {
+        timeout_ms = 0;
+        for (auto& it : *s_always_ready_fds)
+            ready_fds.append({ it.key, it.value });
+    }
+
+    epoll_event events[64];
+try_select_again:
+    int marked_fd_count = epoll_wait(s_epoll_fd, events, array_size(events), timeout_ms);
+#else
+    if (s_pollfds_need_rebuild) {
+        s_pollfds->clear_with_capacity();
+        s_pollfds->append({ s_wake_pipe_fds[0], POLLIN, 0 });
+        for (auto& it : *s_notifiers) {
+            auto event_mask = it.value.watched_event_mask;
+            if (event_mask == Notifier::None)
+                continue;
+            short events = 0;
+            if (event_mask & Notifier::Read)
+                events |= POLLIN;
+            if (event_mask & Notifier::Write)
+                events |= POLLOUT;
+            if (event_mask & Notifier::Exceptional)
+                VERIFY_NOT_REACHED();
+            s_pollfds->append({ it.key, events, 0 });
         }
+        s_pollfds_need_rebuild = false;
     }
 
 try_select_again:
-    int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+    int marked_fd_count = poll(s_pollfds->data(), s_pollfds->size(), timeout_ms);
+#endif
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
@@ -711,7 +849,38 @@ try_select_again:
         dbgln("Core::EventLoop::wait_for_event: {} ({}: {})", marked_fd_count, saved_errno, strerror(saved_errno));
         VERIFY_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+
+    bool wake_pipe_is_readable = false;
+    auto add_ready_fd = [&](int fd, bool readable, bool writable, bool hung_up) {
+        // NOTE: Like select(), we report errors and hangups as readiness for whatever the notifiers are waiting for.
+        if (fd == s_wake_pipe_fds[0]) {
+            wake_pipe_is_readable = true;
+            return;
+        }
+        unsigned event_mask = Notifier::None;
+        if (readable || hung_up)
+            event_mask |= Notifier::Read;
+        if (writable || hung_up)
+            event_mask |= Notifier::Write;
+        ready_fds.append({ fd, event_mask });
+    };
+
+#ifdef CORE_EVENTLOOP_USE_EPOLL
+    for (int i = 0; i < marked_fd_count; ++i) {
+        auto& event = events[i];
+        add_ready_fd(event.data.fd, event.events & EPOLLIN, event.events & EPOLLOUT, event.events & (EPOLLERR | EPOLLHUP));
+    }
+#else
+    if (marked_fd_count > 0) {
+        for (auto& pollfd : *s_pollfds) {
+            if (pollfd.revents == 0)
+                continue;
+            add_ready_fd(pollfd.fd, pollfd.revents & POLLIN, pollfd.revents & POLLOUT, pollfd.revents & (POLLERR | POLLHUP | POLLNVAL));
+        }
+    }
+#endif
+
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         ssize_t nread;
         // We might receive another signal while read()ing here. The signal will go to the handle_signal properly,
@@ -766,16 +935,15 @@ try_select_again:
         }
     }
 
-    if (!marked_fd_count)
-        return;
-
-    for (auto& notifier : *s_notifiers) {
-        if (FD_ISSET(notifier->fd(), &rfds)) {
-            if (notifier->event_mask() & Notifier::Event::Read)
+    // Only the notifiers of file descriptors that are actually ready are visited.
+    for (auto& ready_fd : ready_fds) {
+        auto it = s_notifiers->find(ready_fd.fd);
+        if (it == s_notifiers->end())
+            continue;
+        for (auto* notifier : it->value.notifiers) {
+            if ((ready_fd.event_mask & Notifier::Read) && (notifier->event_mask() & Notifier::Event::Read))
                 post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
-        }
-        if (FD_ISSET(notifier->fd(), &wfds)) {
-            if (notifier->event_mask() & Notifier::Event::Write)
+            if ((ready_fd.event_mask & Notifier::Write) && (notifier->event_mask() & Notifier::Event::Write))
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
@@ -839,12 +1007,28 @@ bool EventLoop::unregister_timer(int timer_id)
 
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->set(&notifier);
+    auto& notifiers_for_fd = s_notifiers->ensure(notifier.fd());
+    if (notifiers_for_fd.notifiers.contains_slow(&notifier))
+        return;
+    notifiers_for_fd.notifiers.append(&notifier);
+    update_watched_event_mask(notifier.fd(), ForceWatch::Yes);
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->remove(&notifier);
+    auto it = s_notifiers->find(notifier.fd());
+    if (it == s_notifiers->end())
+        return;
+    it->value.notifiers.remove_first_matching([&](auto* other) { return other == &notifier; });
+    update_watched_event_mask(notifier.fd());
+}
+
+void EventLoop::notifier_event_mask_did_change(Badge<Notifier>, Notifier& notifier)
+{
+    auto it = s_notifiers->find(notifier.fd());
+    if (it == s_notifiers->end() || !it->value.notifiers.contains_slow(&notifier))
+        return;
+    update_watched_event_mask(notifier.fd());
 }
 
 void EventLoop::wake_current()
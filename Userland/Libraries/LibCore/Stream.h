@@ -304,6 +304,12 @@ public:
     ErrorOr<void> set_blocking(bool enabled) override { return m_helper.set_blocking(enabled); }
     ErrorOr<void> set_close_on_exec(bool enabled) override { return m_helper.set_close_on_exec(enabled); }
 
+    /// Release the fd associated with this TCPSocket, e.g. to hand it to
+    /// another thread. After the fd is released, the socket will be considered
+    /// "closed" and all operations done on it will fail with ENOTCONN. Fails
+    /// with ENOTCONN if the socket is already closed.
+    ErrorOr<int> release_fd();
+
     virtual ~TCPSocket() override { close(); }
 
 private:
@@ -44,6 +44,7 @@ public:
         for (size_t i = 0; i < 16; i += 4) {
             m_key[i / 4] = AK::convert_between_host_and_big_endian(ByteReader::load32(key.offset(i)));
         }
+        compute_key_powers();
     }
 
     constexpr static size_t digest_size() { return TagType::Size; }
@@ -57,10 +58,23 @@ public:
 
     TagType process(ReadonlyBytes aad, ReadonlyBytes cipher);
 
+    // Hashes the AAD and the ciphertext piece by piece, for when they aren't available all at once.
+    // Partial blocks are padded with zeroes, so only the last piece of the AAD and of the ciphertext may
+    // have a size that isn't a multiple of the block size.
+    void update(ReadonlyBytes);
+    // Mixes in the lengths of the AAD and the ciphertext, and resets the state for the next message.
+    TagType digest(u64 aad_length, u64 cipher_length);
+
 private:
-    inline void transform(ReadonlyBytes, ReadonlyBytes);
+    // How many blocks the carry-less multiplication hashes before it reduces the product.
+    static constexpr size_t aggregated_blocks = 4;
+
+    void compute_key_powers();
 
     u32 m_key[4];
+    u32 m_state[4] { 0, 0, 0, 0 };
+    // H^1 to H^4, in the byte reflected layout of the carry-less multiplication. Only used if the CPU has it.
+    u32 m_key_powers[aggregated_blocks][4] {};
 };
 
 }
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibCrypto/Authentication/Poly1305.h>
+
+namespace Crypto::Authentication {
+
+static constexpr u32 limb_mask = 0x3ffffff;
+
+static u32 load_le32(u8 const* data)
+{
+    return AK::convert_between_host_and_little_endian(ByteReader::load32(data));
+}
+
+Poly1305::Poly1305(ReadonlyBytes key)
+{
+    VERIFY(key.size() == KeySize);
+
+    // r is "clamped" by clearing the bits that the specification requires to be zero.
+    m_r[0] = load_le32(key.offset(0)) & 0x3ffffff;
+    m_r[1] = (load_le32(key.offset(3)) >> 2) & 0x3ffff03;
+    m_r[2] = (load_le32(key.offset(6)) >> 4) & 0x3ffc0ff;
+    m_r[3] = (load_le32(key.offset(9)) >> 6) & 0x3f03fff;
+    m_r[4] = (load_le32(key.offset(12)) >> 8) & 0x00fffff;
+
+    for (size_t i = 0; i < 4; ++i)
+        m_s[i] = load_le32(key.offset(16 + i * 4));
+}
+
+// Adds every block to the accumulator and multiplies it by r, modulo 2^130 - 5.
+// The high bit is the bit that's appended to a block, which is only left out for a padded final block.
+void Poly1305::process_blocks(ReadonlyBytes data, u32 high_bit)
+{
+    u64 r0 = m_r[0], r1 = m_r[1], r2 = m_r[2], r3 = m_r[3], r4 = m_r[4];
+    // 2^130 is congruent to 5, so the limbs of a product that overflow are folded back in multiplied by 5.
+    u64 s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    u64 h0 = m_accumulator[0], h1 = m_accumulator[1], h2 = m_accumulator[2], h3 = m_accumulator[3], h4 = m_accumulator[4];
+
+    for (size_t offset = 0; offset + BlockSize <= data.size(); offset += BlockSize) {
+        auto const* block = data.offset(offset);
+        h0 += load_le32(block + 0) & limb_mask;
+        h1 += (load_le32(block + 3) >> 2) & limb_mask;
+        h2 += (load_le32(block + 6) >> 4) & limb_mask;
+        h3 += (load_le32(block + 9) >> 6) & limb_mask;
+        h4 += (load_le32(block + 12) >> 8) | high_bit;
+
+        u64 d0 = h0 * r0 + h1 * s4 + h2 * s3 + h3 * s2 + h4 * s1;
+        u64 d1 = h0 * r1 + h1 * r0 + h2 * s4 + h3 * s3 + h4 * s2;
+        u64 d2 = h0 * r2 + h1 * r1 + h2 * r0 + h3 * s4 + h4 * s3;
+        u64 d3 = h0 * r3 + h1 * r2 + h2 * r1 + h3 * r0 + h4 * s4;
+        u64 d4 = h0 * r4 + h1 * r3 + h2 * r2 + h3 * r1 + h4 * r0;
+
+        // Partially reduce the product, which leaves every limb small enough for the next block.
+        d1 += d0 >> 26;
+        h0 = d0 & limb_mask;
+        d2 += d1 >> 26;
+        h1 = d1 & limb_mask;
+        d3 += d2 >> 26;
+        h2 = d2 & limb_mask;
+        d4 += d3 >> 26;
+        h3 = d3 & limb_mask;
+        h0 += (d4 >> 26) * 5;
+        h4 = d4 & limb_mask;
+        h1 += h0 >> 26;
+        h0 &= limb_mask;
+    }
+
+    m_accumulator[0] = h0;
+    m_accumulator[1] = h1;
+    m_accumulator[2] = h2;
+    m_accumulator[3] = h3;
+    m_accumulator[4] = h4;
+}
+
+void Poly1305::update(ReadonlyBytes data)
+{
+    if (m_buffer_size > 0) {
+        auto length = min(data.size(), BlockSize - m_buffer_size);
+        data.trim(length).copy_to({ m_buffer + m_buffer_size, length });
+        m_buffer_size += length;
+        data = data.slice(length);
+        if (m_buffer_size < BlockSize)
+            return;
+        process_blocks({ m_buffer, BlockSize }, 1 << 24);
+        m_buffer_size = 0;
+    }
+
+    auto full_blocks_length = data.size() - data.size() % BlockSize;
+    process_blocks(data.trim(full_blocks_length), 1 << 24);
+
+    data.slice(full_blocks_length).copy_to({ m_buffer, BlockSize });
+    m_buffer_size = data.size() - full_blocks_length;
+}
+
+Poly1305::TagType Poly1305::digest()
+{
+    if (m_buffer_size > 0) {
+        // The final block is padded with a one bit and zeroes instead.
+        m_buffer[m_buffer_size] = 1;
+        __builtin_memset(m_buffer + m_buffer_size + 1, 0, BlockSize - m_buffer_size - 1);
+        process_blocks({ m_buffer, BlockSize }, 0);
+        m_buffer_size = 0;
+    }
+
+    u32 h0 = m_accumulator[0], h1 = m_accumulator[1], h2 = m_accumulator[2], h3 = m_accumulator[3], h4 = m_accumulator[4];
+
+    // Fully carry the accumulator.
+    h2 += h1 >> 26;
+    h1 &= limb_mask;
+    h3 += h2 >> 26;
+    h2 &= limb_mask;
+    h4 += h3 >> 26;
+    h3 &= limb_mask;
+    h0 += (h4 >> 26) * 5;
+    h4 &= limb_mask;
+    h1 += h0 >> 26;
+    h0 &= limb_mask;
+
+    // Compute h - p = h + 5 - 2^130, and pick it over h if it didn't underflow, without branching on the result.
+    u32 g0 = h0 + 5;
+    u32 g1 = h1 + (g0 >> 26);
+    g0 &= limb_mask;
+    u32 g2 = h2 + (g1 >> 26);
+    g1 &= limb_mask;
+    u32 g3 = h3 + (g2 >> 26);
+    g2 &= limb_mask;
+    u32 g4 = h4 + (g3 >> 26) - (1 << 26);
+    g3 &= limb_mask;
+
+    u32 select_g = (g4 >> 31) - 1;
+    u32 select_h = ~select_g;
+    h0 = (h0 & select_h) | (g0 & select_g);
+    h1 = (h1 & select_h) | (g1 & select_g);
+    h2 = (h2 & select_h) | (g2 & select_g);
+    h3 = (h3 & select_h) | (g3 & select_g);
+    h4 = (h4 & select_h) | (g4 & select_g);
+
+    // Pack the limbs into 32-bit words, and add s modulo 2^128.
+    u32 words[4] {
+        h0 | (h1 << 26),
+        (h1 >> 6) | (h2 << 20),
+        (h2 >> 12) | (h3 << 14),
+        (h3 >> 18) | (h4 << 8),
+    };
+
+    TagType tag;
+    u64 carry = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        carry += static_cast<u64>(words[i]) + m_s[i];
+        ByteReader::store(tag.data + i * 4, AK::convert_between_host_and_little_endian(static_cast<u32>(carry)));
+        carry >>= 32;
+    }
+
+    for (auto& limb : m_accumulator)
+        limb = 0;
+
+    return tag;
+}
+
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/Types.h>
+
+#ifndef KERNEL
+#    include <AK/String.h>
+#endif
+
+namespace Crypto::Authentication {
+
+struct Poly1305Digest {
+    constexpr static size_t Size = 16;
+    u8 data[Size];
+
+    const u8* immutable_data() const { return data; }
+    size_t data_length() { return Size; }
+};
+
+// The one-time authenticator from RFC 8439 section 2.5. A key must never be used for more than one message.
+class Poly1305 final {
+public:
+    using TagType = Poly1305Digest;
+
+    static constexpr size_t KeySize = 32;
+    static constexpr size_t BlockSize = 16;
+
+    explicit Poly1305(ReadonlyBytes key);
+
+    constexpr static size_t digest_size() { return TagType::Size; }
+
+#ifndef KERNEL
+    String class_name() const
+    {
+        return "Poly1305";
+    }
+#endif
+
+    void update(ReadonlyBytes);
+    TagType digest();
+
+private:
+    void process_blocks(ReadonlyBytes, u32 high_bit);
+
+    // The accumulator and r are held in five 26-bit limbs, so that the products of two limbs, and the sums of
+    // a few of them, still fit into 64 bits.
+    u32 m_r[5];
+    u32 m_accumulator[5] { 0, 0, 0, 0, 0 };
+    u32 m_s[4];
+    u8 m_buffer[BlockSize];
+    size_t m_buffer_size { 0 };
+};
+
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Types.h>
+
+// Word-level kernels for the multiplication of big integers.
+// They work on "limbs", which are either UnsignedBigInteger::Words or the widest integer the platform can multiply
+// into a double-width result. Limbs are stored least significant first, just like the words of an UnsignedBigInteger.
+namespace Crypto::Limbs {
+
+template<typename Limb>
+struct DoubleWidth;
+
+template<>
+struct DoubleWidth<u32> {
+    using Type = u64;
+};
+
+#ifdef __SIZEOF_INT128__
+template<>
+struct DoubleWidth<u64> {
+    using Type = unsigned __int128;
+};
+
+using NativeLimb = u64;
+#else
+using NativeLimb = u32;
+#endif
+
+template<typename Limb>
+static constexpr size_t bits_in_limb = sizeof(Limb) * 8;
+
+// Below this many limbs, the quadratic algorithms beat Karatsuba thanks to their lower overhead.
+static constexpr size_t karatsuba_threshold = 32;
+
+// Adds the product of a and b to the three limb accumulator (c2:c1:c0).
+template<typename Limb>
+ALWAYS_INLINE void multiply_accumulate(Limb a, Limb b, Limb& c0, Limb& c1, Limb& c2)
+{
+    using DoubleLimb = typename DoubleWidth<Limb>::Type;
+    DoubleLimb product = static_cast<DoubleLimb>(a) * b;
+    DoubleLimb sum = static_cast<DoubleLimb>(c0) + static_cast<Limb>(product);
+    c0 = static_cast<Limb>(sum);
+    sum = static_cast<DoubleLimb>(c1) + static_cast<Limb>(product >> bits_in_limb<Limb>) + static_cast<Limb>(sum >> bits_in_limb<Limb>);
+    c1 = static_cast<Limb>(sum);
+    c2 += static_cast<Limb>(sum >> bits_in_limb<Limb>);
+}
+
+// Adds value to accumulator, which must be at least as long, and returns the carry out of the accumulator.
+template<typename Limb>
+Limb add(Span<Limb> accumulator, Span<Limb const> value)
+{
+    VERIFY(accumulator.size() >= value.size());
+    Limb carry = 0;
+    size_t i = 0;
+    for (; i < value.size(); ++i) {
+        Limb sum = accumulator[i] + carry;
+        carry = sum < carry;
+        sum += value[i];
+        carry += sum < value[i];
+        accumulator[i] = sum;
+    }
+    for (; carry != 0 && i < accumulator.size(); ++i) {
+        accumulator[i] += carry;
+        carry = accumulator[i] == 0;
+    }
+    return carry;
+}
+
+// Subtracts value from accumulator, which must be at least as long, and returns the borrow out of the accumulator.
+template<typename Limb>
+Limb subtract(Span<Limb> accumulator, Span<Limb const> value)
+{
+    VERIFY(accumulator.size() >= value.size());
+    Limb borrow = 0;
+    size_t i = 0;
+    for (; i < value.size(); ++i) {
+        Limb difference = accumulator[i] - value[i];
+        Limb next_borrow = difference > accumulator[i];
+        next_borrow += difference < borrow;
+        accumulator[i] = difference - borrow;
+        borrow = next_borrow;
+    }
+    for (; borrow != 0 && i < accumulator.size(); ++i) {
+        borrow = accumulator[i] == 0;
+        --accumulator[i];
+    }
+    return borrow;
+}
+
+// Product scanning ("Comba") multiplication: every limb of the output is computed in one go by summing the products
+// of its column into a three limb accumulator, so every output limb is written exactly once.
+template<typename Limb>
+void comba_multiply(Span<Limb const> left, Span<Limb const> right, Span<Limb> output)
+{
+    VERIFY(output.size() == left.size() + right.size());
+    if (left.is_empty() || right.is_empty()) {
+        output.fill(0);
+        return;
+    }
+
+    Limb c0 = 0, c1 = 0, c2 = 0;
+    for (size_t column = 0; column < output.size() - 1; ++column) {
+        auto first = column < right.size() ? 0 : column - right.size() + 1;
+        auto last = min(column + 1, left.size());
+        for (size_t i = first; i < last; ++i)
+            multiply_accumulate(left[i], right[column - i], c0, c1, c2);
+        output[column] = c0;
+        c0 = c1;
+        c1 = c2;
+        c2 = 0;
+    }
+    output[output.size() - 1] = c0;
+}
+
+// Like comba_multiply(), but every product of two different limbs appears twice in a square, so it's only computed once and doubled.
+template<typename Limb>
+void comba_square(Span<Limb const> value, Span<Limb> output)
+{
+    VERIFY(output.size() == value.size() * 2);
+    if (value.is_empty())
+        return;
+
+    Limb c0 = 0, c1 = 0, c2 = 0;
+    for (size_t column = 0; column < output.size() - 1; ++column) {
+        Limb d0 = 0, d1 = 0, d2 = 0;
+        auto first = column < value.size() ? 0 : column - value.size() + 1;
+        for (size_t i = first; i < (column + 1) / 2; ++i)
+            multiply_accumulate(value[i], value[column - i], d0, d1, d2);
+
+        d2 = (d2 << 1) | (d1 >> (bits_in_limb<Limb> - 1));
+        d1 = (d1 << 1) | (d0 >> (bits_in_limb<Limb> - 1));
+        d0 <<= 1;
+        if (column % 2 == 0)
+            multiply_accumulate(value[column / 2], value[column / 2], d0, d1, d2);
+
+        c0 += d0;
+        Limb carry = c0 < d0;
+        c1 += carry;
+        carry = c1 < carry;
+        c1 += d1;
+        carry += c1 < d1;
+        c2 += d2 + carry;
+
+        output[column] = c0;
+        c0 = c1;
+        c1 = c2;
+        c2 = 0;
+    }
+    output[output.size() - 1] = c0;
+}
+
+// The number of scratch limbs multiply() and square() need for operands of up to the given length.
+inline size_t karatsuba_scratch_size(size_t length)
+{
+    size_t size = 0;
+    while (length >= karatsuba_threshold) {
+        auto half = (length + 1) / 2;
+        size += 4 * (half + 1);
+        length = half + 1;
+    }
+    return size;
+}
+
+// Karatsuba multiplication: with left = l1 * B^h + l0 and right = r1 * B^h + r0, the product is
+// l1 * r1 * B^2h + ((l0 + l1) * (r0 + r1) - l0 * r0 - l1 * r1) * B^h + l0 * r0, which takes three half-size products instead of four.
+template<typename Limb>
+void multiply(Span<Limb const> left, Span<Limb const> right, Span<Limb> output, Span<Limb> scratch)
+{
+    VERIFY(output.size() == left.size() + right.size());
+    auto shorter_length = min(left.size(), right.size());
+    auto half = (max(left.size(), right.size()) + 1) / 2;
+    // Splitting only pays off when both operands have a high half.
+    if (shorter_length < karatsuba_threshold || shorter_length <= half) {
+        comba_multiply(left, right, output);
+        return;
+    }
+
+    auto low_product = output.trim(half * 2);
+    auto high_product = output.slice(half * 2);
+    multiply(left.trim(half), right.trim(half), low_product, scratch);
+    multiply(left.slice(half), right.slice(half), high_product, scratch);
+
+    auto left_sum = scratch.slice(0, half + 1);
+    auto right_sum = scratch.slice(half + 1, half + 1);
+    auto middle_product = scratch.slice(half * 2 + 2, half * 2 + 2);
+    auto remaining_scratch = scratch.slice(half * 4 + 4);
+
+    left.trim(half).copy_to(left_sum);
+    left_sum[half] = add(left_sum.trim(half), left.slice(half));
+    right.trim(half).copy_to(right_sum);
+    right_sum[half] = add(right_sum.trim(half), right.slice(half));
+    multiply<Limb>(left_sum, right_sum, middle_product, remaining_scratch);
+
+    subtract<Limb>(middle_product, low_product);
+    subtract<Limb>(middle_product, high_product);
+    // The middle product fits into the output, so any limbs of it that don't are zero.
+    auto middle_output = output.slice(half);
+    add<Limb>(middle_output, middle_product.trim(min(middle_product.size(), middle_output.size())));
+}
+
+template<typename Limb>
+void square(Span<Limb const> value, Span<Limb> output, Span<Limb> scratch)
+{
+    VERIFY(output.size() == value.size() * 2);
+    if (value.size() < karatsuba_threshold) {
+        comba_square(value, output);
+        return;
+    }
+
+    auto half = (value.size() + 1) / 2;
+    auto low_product = output.trim(half * 2);
+    auto high_product = output.slice(half * 2);
+    square(value.trim(half), low_product, scratch);
+    square(value.slice(half), high_product, scratch);
+
+    auto sum = scratch.slice(0, half + 1);
+    auto middle_product = scratch.slice(half * 2 + 2, half * 2 + 2);
+    auto remaining_scratch = scratch.slice(half * 4 + 4);
+
+    value.trim(half).copy_to(sum);
+    sum[half] = add(sum.trim(half), value.slice(half));
+    square<Limb>(sum, middle_product, remaining_scratch);
+
+    subtract<Limb>(middle_product, low_product);
+    subtract<Limb>(middle_product, high_product);
+    auto middle_output = output.slice(half);
+    add<Limb>(middle_output, middle_product.trim(min(middle_product.size(), middle_output.size())));
+}
+
+}
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include "Limbs.h"
 #include "UnsignedBigIntegerAlgorithms.h"
 
 namespace Crypto {
@@ -26,7 +27,7 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
     while (!(ep < 1)) {
         if (ep.words()[0] % 2 == 1) {
             // exp = (exp * base) % m;
-            multiply_without_allocation(exp, base, temp_1, temp_2, temp_3, temp_multiply);
+            multiply_without_allocation(exp, base, temp_1, temp_multiply);
             divide_without_allocation(temp_multiply, m, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
             exp.set_to(temp_remainder);
         }
@@ -36,7 +37,7 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
         ep.set_to(temp_quotient);
 
         // base = (base * base) % m;
-        multiply_without_allocation(base, base, temp_1, temp_2, temp_3, temp_multiply);
+        multiply_without_allocation(base, base, temp_1, temp_multiply);
         divide_without_allocation(temp_multiply, m, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
         base.set_to(temp_remainder);
 
@@ -50,137 +51,100 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
 }
 
 /**
- * Compute (1/value) % 2^32.
+ * Compute (-1/value) % 2^bits_in_limb.
  * This needs an odd input value
  * Algorithm from: Dumas, J.G. "On Newton–Raphson Iteration for Multiplicative Inverses Modulo Prime Powers".
  */
-ALWAYS_INLINE static u32 inverse_wrapped(u32 value)
+template<typename Limb>
+ALWAYS_INLINE static Limb inverse_wrapped(Limb value)
 {
     VERIFY(value & 1);
 
-    u64 b = static_cast<u64>(value);
-    u64 k0 = (2 - b);
-    u64 t = (b - 1);
+    Limb b = value;
+    Limb k0 = (2 - b);
+    Limb t = (b - 1);
     size_t i = 1;
-    while (i < 32) {
+    while (i < Limbs::bits_in_limb<Limb>) {
         t = t * t;
         k0 = k0 * (t + 1);
         i <<= 1;
     }
-    return static_cast<u32>(-k0);
+    return -k0;
 }
 
 /**
- * Computes z = x * y + c. z_carry contains the top bits, z contains the bottom bits.
+ * Computes the "almost montgomery" reduction of the 2n + 1 limbs of t, where n is the length of the modulo : t * 2 ^ (-n * bits_in_limb) % modulo
+ * [Note : the result fits in n limbs, but isn't necessarily smaller than the modulo]
+ * assuming :
+ *  - t < modulo * 2 ^ (n * bits_in_limb), which holds for the product of any two numbers of n limbs
+ *  - k = inverse_wrapped(modulo) (optimization to not recompute K each time)
+ * Algorithm from: Gueron, "Efficient Software Implementations of Modular Exponentiation". (https://eprint.iacr.org/2011/239.pdf)
  */
-ALWAYS_INLINE static void linear_multiplication_with_carry(u32 x, u32 y, u32 c, u32& z_carry, u32& z)
+template<typename Limb>
+static void almost_montgomery_reduce(Span<Limb> t, Span<Limb const> modulo, Limb k, Span<Limb> result)
 {
-    u64 result = static_cast<u64>(x) * static_cast<u64>(y) + static_cast<u64>(c);
-    z_carry = static_cast<u32>(result >> 32);
-    z = static_cast<u32>(result);
-}
+    using DoubleLimb = typename Limbs::DoubleWidth<Limb>::Type;
+    auto num_limbs = modulo.size();
+    VERIFY(t.size() == num_limbs * 2 + 1);
+    VERIFY(result.size() == num_limbs);
+
+    // Add multiples of the modulo that clear the low limbs of t one after the other, which doesn't change t % modulo.
+    for (size_t i = 0; i < num_limbs; ++i) {
+        Limb u = t[i] * k;
+        Limb carry = 0;
+        for (size_t j = 0; j < num_limbs; ++j) {
+            DoubleLimb sum = static_cast<DoubleLimb>(u) * modulo[j] + t[i + j] + carry;
+            t[i + j] = static_cast<Limb>(sum);
+            carry = static_cast<Limb>(sum >> Limbs::bits_in_limb<Limb>);
+        }
+        for (size_t j = i + num_limbs; carry != 0; ++j) {
+            VERIFY(j < t.size());
+            t[j] += carry;
+            carry = t[j] < carry;
+        }
+    }
 
-/**
- * Computes z = a + b. z_carry contains the top bit (1 or 0), z contains the bottom bits.
- */
-ALWAYS_INLINE static void addition_with_carry(u32 a, u32 b, u32& z_carry, u32& z)
-{
-    u64 result = static_cast<u64>(a) + static_cast<u64>(b);
-    z_carry = static_cast<u32>(result >> 32);
-    z = static_cast<u32>(result);
+    // The top half of t is the result now, but it may have overflown into the extra limb by (at most) one modulo.
+    auto top_half = t.slice(num_limbs, num_limbs);
+    if (t[num_limbs * 2] != 0)
+        Limbs::subtract(top_half, modulo);
+    top_half.copy_to(result);
 }
 
 /**
- * Computes a montgomery "fragment" for y_i. This computes "z[i] += x[i] * y_i" for all words while rippling the carry, and returns the carry.
- * Algorithm from: Gueron, "Efficient Software Implementations of Modular Exponentiation". (https://eprint.iacr.org/2011/239.pdf)
+ * Picks the number of exponent bits that are consumed at once.
+ * Larger windows need more precomputed powers, but fewer multiplications by them while going over the exponent.
+ * These thresholds were "borrowed" from OpenSSL.
  */
-UnsignedBigInteger::Word UnsignedBigIntegerAlgorithms::montgomery_fragment(UnsignedBigInteger& z, size_t offset_in_z, UnsignedBigInteger const& x, UnsignedBigInteger::Word y_digit, size_t num_words)
+static size_t window_size_for_exponent(size_t exponent_bits)
 {
-    UnsignedBigInteger::Word carry { 0 };
-    for (size_t i = 0; i < num_words; ++i) {
-        UnsignedBigInteger::Word a_carry;
-        UnsignedBigInteger::Word a;
-        linear_multiplication_with_carry(x.m_words[i], y_digit, z.m_words[offset_in_z + i], a_carry, a);
-        UnsignedBigInteger::Word b_carry;
-        UnsignedBigInteger::Word b;
-        addition_with_carry(a, carry, b_carry, b);
-        z.m_words[offset_in_z + i] = b;
-        carry = a_carry + b_carry;
-    }
-    return carry;
+    if (exponent_bits > 671)
+        return 6;
+    if (exponent_bits > 239)
+        return 5;
+    if (exponent_bits > 79)
+        return 4;
+    if (exponent_bits > 23)
+        return 3;
+    return 1;
 }
 
-/**
- * Computes the "almost montgomery" product : x * y * 2 ^ (-num_words * BITS_IN_WORD) % modulo
- * [Note : that means that the result z satisfies z * 2^(num_words * BITS_IN_WORD) % modulo = x * y % modulo]
- * assuming :
- *  - x, y and modulo are all already padded to num_words
- *  - k = inverse_wrapped(modulo) (optimization to not recompute K each time)
- * Algorithm from: Gueron, "Efficient Software Implementations of Modular Exponentiation". (https://eprint.iacr.org/2011/239.pdf)
- */
-void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allocation(
-    UnsignedBigInteger const& x,
-    UnsignedBigInteger const& y,
-    UnsignedBigInteger const& modulo,
-    UnsignedBigInteger& z,
-    UnsignedBigInteger::Word k,
-    size_t num_words,
-    UnsignedBigInteger& result)
+static size_t exponent_window(UnsignedBigInteger const& exponent, size_t bit_index, size_t window_size)
 {
-    VERIFY(x.length() >= num_words);
-    VERIFY(y.length() >= num_words);
-    VERIFY(modulo.length() >= num_words);
-
-    z.set_to(0);
-    z.resize_with_leading_zeros(num_words * 2);
-
-    UnsignedBigInteger::Word previous_double_carry { 0 };
-    for (size_t i = 0; i < num_words; ++i) {
-        // z[i->num_words+i] += x * y_i
-        UnsignedBigInteger::Word carry_1 = montgomery_fragment(z, i, x, y.m_words[i], num_words);
-        // z[i->num_words+i] += modulo * (z_i * k)
-        UnsignedBigInteger::Word t = z.m_words[i] * k;
-        UnsignedBigInteger::Word carry_2 = montgomery_fragment(z, i, modulo, t, num_words);
-
-        // Compute the carry by combining all of the carries of the previous computations
-        // Put it "right after" the range that we computed above
-        UnsignedBigInteger::Word temp_carry = previous_double_carry + carry_1;
-        UnsignedBigInteger::Word overall_carry = temp_carry + carry_2;
-        z.m_words[num_words + i] = overall_carry;
-
-        // Detect if there was a "double carry" for this word by checking if our carry results are smaller than their components
-        previous_double_carry = (temp_carry < carry_1 || overall_carry < carry_2) ? 1 : 0;
-    }
-
-    if (previous_double_carry == 0) {
-        // Return the top num_words bytes of Z, which contains our result.
-        shift_right_by_n_words(z, num_words, result);
-        result.resize_with_leading_zeros(num_words);
-        return;
-    }
-
-    // We have a carry, so we're "one bigger" than we need to be.
-    // Subtract the modulo from the result (the top half of z), and write it to the bottom half of Z since we have space.
-    // (With carry, of course.)
-    UnsignedBigInteger::Word c { 0 };
-    for (size_t i = 0; i < num_words; ++i) {
-        UnsignedBigInteger::Word z_digit = z.m_words[num_words + i];
-        UnsignedBigInteger::Word modulo_digit = modulo.m_words[i];
-        UnsignedBigInteger::Word new_z_digit = z_digit - modulo_digit - c;
-        z.m_words[i] = new_z_digit;
-        // Detect if the subtraction underflowed - from "Hacker's Delight"
-        c = ((modulo_digit & ~z_digit) | ((modulo_digit | ~z_digit) & new_z_digit)) >> (UnsignedBigInteger::BITS_IN_WORD - 1);
-    }
-
-    // Return the bottom num_words bytes of Z (with the carry bit handled)
-    z.m_words.resize(num_words);
-    result.set_to(z);
-    result.resize_with_leading_zeros(num_words);
+    auto& words = exponent.words();
+    auto word_index = bit_index / UnsignedBigInteger::BITS_IN_WORD;
+    auto bit_in_word = bit_index % UnsignedBigInteger::BITS_IN_WORD;
+    u64 bits = words[word_index] >> bit_in_word;
+    if (bit_in_word + window_size > UnsignedBigInteger::BITS_IN_WORD && word_index + 1 < words.size())
+        bits |= static_cast<u64>(words[word_index + 1]) << (UnsignedBigInteger::BITS_IN_WORD - bit_in_word);
+    return bits & ((1u << window_size) - 1);
 }
 
 /**
  * Complexity: still O(N^3) with N the number of words in the largest word, but less complex than the classical mod power.
- * Note: the montgomery multiplications requires an inverse modulo over 2^32, which is only defined for odd numbers.
+ * The numbers are kept in montgomery form (x * 2 ^ (n * bits_in_limb) % modulo) in limbs of the widest size the platform can multiply,
+ * and the exponent is consumed in fixed windows of bits, which need a single multiplication by a precomputed power each.
+ * Note: the montgomery multiplications requires an inverse modulo over 2^bits_in_limb, which is only defined for odd numbers.
  */
 void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocations(
     UnsignedBigInteger const& base,
@@ -197,88 +161,105 @@ void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocat
 {
     VERIFY(modulo.is_odd());
 
-    // Note: While this is a constexpr variable for clarity and could be changed in theory,
-    // various optimized parts of the algorithm rely on this value being exactly 4.
-    constexpr size_t window_size = 4;
+    auto exponent_bits = exponent.one_based_index_of_highest_set_bit();
+    if (exponent_bits == 0) {
+        result.set_to(1);
+        return;
+    }
+
+    using Limb = Limbs::NativeLimb;
+    constexpr size_t words_per_limb = sizeof(Limb) / sizeof(UnsignedBigInteger::Word);
 
     size_t num_words = modulo.trimmed_length();
-    UnsignedBigInteger::Word k = inverse_wrapped(modulo.m_words[0]);
+    size_t num_limbs = ceil_div(num_words, words_per_limb);
 
     one.set_to(1);
 
-    // rr = ( 2 ^ (2 * modulo.length() * BITS_IN_WORD) ) % modulo
-    shift_left_by_n_words(one, 2 * num_words, x);
+    // rr = ( 2 ^ (2 * num_limbs * bits_in_limb) ) % modulo
+    shift_left_by_n_words(one, 2 * num_limbs * words_per_limb, x);
     divide_without_allocation(x, modulo, temp_z, one, z, zz, temp_extra, rr);
-    rr.resize_with_leading_zeros(num_words);
 
     // x = base [% modulo, if x doesn't already fit in modulo's words]
     x.set_to(base);
     if (x.trimmed_length() > num_words)
         divide_without_allocation(base, modulo, temp_z, one, z, zz, temp_extra, x);
-    x.resize_with_leading_zeros(num_words);
 
-    one.set_to(1);
-    one.resize_with_leading_zeros(num_words);
-
-    // Compute the montgomery powers from 0 to 2^window_size. powers[i] = x^i
-    UnsignedBigInteger powers[1 << window_size];
-    almost_montgomery_multiplication_without_allocation(one, rr, modulo, temp_z, k, num_words, powers[0]);
-    almost_montgomery_multiplication_without_allocation(x, rr, modulo, temp_z, k, num_words, powers[1]);
-    for (size_t i = 2; i < (1 << window_size); ++i)
-        almost_montgomery_multiplication_without_allocation(powers[i - 1], powers[1], modulo, temp_z, k, num_words, powers[i]);
-
-    z.set_to(powers[0]);
-    z.resize_with_leading_zeros(num_words);
-    zz.set_to(0);
-    zz.resize_with_leading_zeros(num_words);
-
-    ssize_t exponent_length = exponent.trimmed_length();
-    for (ssize_t word_in_exponent = exponent_length - 1; word_in_exponent >= 0; --word_in_exponent) {
-        UnsignedBigInteger::Word exponent_word = exponent.m_words[word_in_exponent];
-        size_t bit_in_word = 0;
-        while (bit_in_word < UnsignedBigInteger::BITS_IN_WORD) {
-            if (word_in_exponent != exponent_length - 1 || bit_in_word != 0) {
-                almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
-                almost_montgomery_multiplication_without_allocation(z, z, modulo, temp_z, k, num_words, zz);
-                almost_montgomery_multiplication_without_allocation(zz, zz, modulo, temp_z, k, num_words, z);
-            }
-            auto power_index = exponent_word >> (UnsignedBigInteger::BITS_IN_WORD - window_size);
-            auto& power = powers[power_index];
-            almost_montgomery_multiplication_without_allocation(z, power, modulo, temp_z, k, num_words, zz);
-
-            swap(z, zz);
-
-            // Move to the next window
-            exponent_word <<= window_size;
-            bit_in_word += window_size;
-        }
+    auto window_size = window_size_for_exponent(exponent_bits);
+
+    // All the limbs we need are carved out of a single allocation.
+    auto scratch_size = Limbs::karatsuba_scratch_size(num_limbs);
+    Vector<Limb> workspace;
+    workspace.resize(num_limbs * ((1 << window_size) + 5) + 1 + scratch_size);
+    Span<Limb> remaining_workspace = workspace.span();
+    auto take_limbs = [&](size_t count) {
+        auto limbs = remaining_workspace.slice(0, count);
+        remaining_workspace = remaining_workspace.slice(count);
+        return limbs;
+    };
+
+    auto modulo_limbs = take_limbs(num_limbs);
+    auto x_limbs = take_limbs(num_limbs);
+    auto rr_limbs = take_limbs(num_limbs);
+    auto product = take_limbs(num_limbs * 2 + 1);
+    auto scratch = take_limbs(scratch_size);
+    Vector<Span<Limb>, 64> powers;
+    for (size_t i = 0; i < (1u << window_size); ++i)
+        powers.append(take_limbs(num_limbs));
+
+    auto import_limbs = [&](UnsignedBigInteger const& number, Span<Limb> limbs) {
+        limbs.fill(0);
+        auto length = min(number.length(), num_limbs * words_per_limb);
+        for (size_t i = 0; i < length; ++i)
+            limbs[i / words_per_limb] |= static_cast<Limb>(number.m_words[i]) << ((i % words_per_limb) * UnsignedBigInteger::BITS_IN_WORD);
+    };
+    import_limbs(modulo, modulo_limbs);
+    import_limbs(x, x_limbs);
+    import_limbs(rr, rr_limbs);
+
+    Limb k = inverse_wrapped(modulo_limbs[0]);
+    auto multiply = [&](Span<Limb const> left, Span<Limb const> right, Span<Limb> output) {
+        if (left.data() == right.data())
+            Limbs::square(left, product.trim(num_limbs * 2), scratch);
+        else
+            Limbs::multiply(left, right, product.trim(num_limbs * 2), scratch);
+        product[num_limbs * 2] = 0;
+        almost_montgomery_reduce<Limb>(product, modulo_limbs, k, output);
+    };
+
+    // Compute the montgomery powers from 1 to 2^window_size - 1. powers[i] = x^i
+    // (powers[0] is never needed, as a window of zero bits doesn't multiply anything in)
+    multiply(x_limbs, rr_limbs, powers[1]);
+    for (size_t i = 2; i < powers.size(); ++i)
+        multiply(powers[i - 1], powers[1], powers[i]);
+
+    // The windows are aligned to the lowest bit of the exponent, so the topmost one may be narrower than the others.
+    // (x isn't needed anymore, so z takes over its limbs)
+    auto z_limbs = x_limbs;
+    size_t bit_index = exponent_bits - ((exponent_bits - 1) % window_size + 1);
+    powers[exponent_window(exponent, bit_index, window_size)].copy_to(z_limbs);
+    while (bit_index > 0) {
+        bit_index -= window_size;
+        for (size_t i = 0; i < window_size; ++i)
+            multiply(z_limbs, z_limbs, z_limbs);
+        if (auto window = exponent_window(exponent, bit_index, window_size); window != 0)
+            multiply(z_limbs, powers[window], z_limbs);
     }
 
-    almost_montgomery_multiplication_without_allocation(z, one, modulo, temp_z, k, num_words, zz);
-
-    if (zz < modulo) {
-        result.set_to(zz);
-        result.clamp_to_trimmed_length();
-        return;
-    }
-
-    // Note : Since we were using "almost montgomery" multiplications, we aren't guaranteed to be under the modulo already.
-    // So, if we're here, we need to respect the modulo.
-    // We can, however, start by trying to subtract the modulo, just in case we're close.
-    subtract_without_allocation(zz, modulo, result);
-
-    if (modulo < zz) {
-        // Note: This branch shouldn't happen in theory (as noted in https://github.com/rust-num/num-bigint/blob/master/src/biguint/monty.rs#L210)
-        // Let's dbgln the values we used. That way, if we hit this branch, we can contribute these values for test cases.
-        dbgln("Encountered the modulo branch during a montgomery modular power. Params : {} - {} - {}", base, exponent, modulo);
-        // We just clobber all the other temporaries that we don't need for the division.
-        // This is wasteful, but we're on the edgiest of cases already.
-        divide_without_allocation(zz, modulo, temp_z, rr, z, x, temp_extra, result);
+    // Leave montgomery form by multiplying with 1, which is at most one modulo away from the actual result.
+    product.fill(0);
+    z_limbs.copy_to(product);
+    almost_montgomery_reduce<Limb>(product, modulo_limbs, k, z_limbs);
+
+    result.set_to_0();
+    result.m_words.resize(num_limbs * words_per_limb);
+    for (size_t i = 0; i < result.m_words.size(); ++i)
+        result.m_words[i] = static_cast<UnsignedBigInteger::Word>(z_limbs[i / words_per_limb] >> ((i % words_per_limb) * UnsignedBigInteger::BITS_IN_WORD));
+    if (!(result < modulo)) {
+        subtract_without_allocation(result, modulo, temp_z);
+        result.set_to(temp_z);
     }
 
     result.clamp_to_trimmed_length();
-    return;
 }
 
 }
@@ -5,42 +5,43 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include "Limbs.h"
 #include "UnsignedBigIntegerAlgorithms.h"
 
 namespace Crypto {
 
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
+ * Complexity: O(N^2) where N is the number of words in the larger number, or O(N^1.58) once both are longer than Limbs::karatsuba_threshold
  * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indices of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit),
- * and add y<<i to the result.
+ * Short operands are multiplied word by word with Comba's method (see Limbs.h), longer ones are split in halves
+ * with Karatsuba's method first. Squares skip the products that would be computed twice.
+ * temp_scratch holds the intermediate products of Karatsuba's method.
  */
 FLATTEN void UnsignedBigIntegerAlgorithms::multiply_without_allocation(
     UnsignedBigInteger const& left,
     UnsignedBigInteger const& right,
-    UnsignedBigInteger& temp_shift_result,
-    UnsignedBigInteger& temp_shift_plus,
-    UnsignedBigInteger& temp_shift,
+    UnsignedBigInteger& temp_scratch,
     UnsignedBigInteger& output)
 {
+    VERIFY(&output != &left && &output != &right);
+
+    auto left_length = left.trimmed_length();
+    auto right_length = right.trimmed_length();
     output.set_to_0();
+    if (left_length == 0 || right_length == 0)
+        return;
 
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    output.m_words.resize_and_keep_capacity(left_length + right_length);
+    temp_scratch.m_words.resize_and_keep_capacity(Limbs::karatsuba_scratch_size(max(left_length, right_length)));
 
-            size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
+    Span<UnsignedBigInteger::Word const> left_words { left.m_words.data(), left_length };
+    Span<UnsignedBigInteger::Word const> right_words { right.m_words.data(), right_length };
+    if (&left == &right)
+        Limbs::square(left_words, output.m_words.span(), temp_scratch.m_words.span());
+    else
+        Limbs::multiply(left_words, right_words, output.m_words.span(), temp_scratch.m_words.span());
 
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_into_accumulator_without_allocation(output, temp_shift);
-        }
-    }
+    output.clamp_to_trimmed_length();
 }
 
 }
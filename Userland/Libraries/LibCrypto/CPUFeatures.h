@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Platform.h>
+
+// The kernel doesn't save the SSE state of its own code, so it always uses the portable implementations.
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+#    define CRYPTO_HAS_X86_ACCELERATION 1
+#    include <cpuid.h>
+#endif
+
+namespace Crypto {
+
+// The instruction set extensions the accelerated algorithms can use, as reported by CPUID.
+struct CPUFeatures {
+    bool has_ssse3 { false };
+    bool has_aes { false };
+    bool has_pclmul { false };
+
+    static CPUFeatures const& the()
+    {
+        static CPUFeatures const features = detect();
+        return features;
+    }
+
+private:
+    static CPUFeatures detect()
+    {
+        CPUFeatures features;
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+        unsigned eax, ebx, ecx, edx;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            features.has_ssse3 = ecx & bit_SSSE3;
+            features.has_aes = ecx & bit_AES;
+            features.has_pclmul = ecx & bit_PCLMUL;
+        }
+#endif
+        return features;
+    }
+};
+
+}
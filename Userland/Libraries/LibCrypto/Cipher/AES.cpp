@@ -5,9 +5,14 @@
  */
 
 #include <AK/StringBuilder.h>
+#include <LibCrypto/CPUFeatures.h>
 #include <LibCrypto/Cipher/AES.h>
 #include <LibCrypto/Cipher/AESTables.h>
 
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+#    include <immintrin.h>
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
@@ -24,6 +29,65 @@ constexpr void swap_keys(u32* keys, size_t i, size_t j)
     keys[j] = temp;
 }
 
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+static bool has_aes_instructions()
+{
+    return CPUFeatures::the().has_aes && CPUFeatures::the().has_ssse3;
+}
+
+// The round keys are stored as big endian words, but the AES instructions want them in the order of their bytes.
+[[gnu::target("aes,ssse3")]] static void load_round_keys(u32 const* round_keys, size_t rounds, __m128i* keys)
+{
+    auto const byte_swap_words = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    for (size_t i = 0; i <= rounds; ++i)
+        keys[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(round_keys + i * 4)), byte_swap_words);
+}
+
+// An AES round takes several cycles to finish, but a new one can be started every cycle, so we go through
+// this many independent blocks round by round.
+static constexpr size_t parallel_blocks = 8;
+
+[[gnu::target("aes,ssse3")]] static void encrypt_blocks_with_aes_instructions(AESCipherKey const& key, u8 const* in, u8* out, size_t count)
+{
+    __m128i keys[15];
+    auto rounds = key.rounds();
+    load_round_keys(key.round_keys(), rounds, keys);
+
+    size_t i = 0;
+    for (; i + parallel_blocks <= count; i += parallel_blocks) {
+        __m128i blocks[parallel_blocks];
+        for (size_t j = 0; j < parallel_blocks; ++j)
+            blocks[j] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in + (i + j) * 16)), keys[0]);
+        for (size_t round = 1; round < rounds; ++round) {
+            for (size_t j = 0; j < parallel_blocks; ++j)
+                blocks[j] = _mm_aesenc_si128(blocks[j], keys[round]);
+        }
+        for (size_t j = 0; j < parallel_blocks; ++j)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (i + j) * 16), _mm_aesenclast_si128(blocks[j], keys[rounds]));
+    }
+
+    for (; i < count; ++i) {
+        auto block = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i * 16)), keys[0]);
+        for (size_t round = 1; round < rounds; ++round)
+            block = _mm_aesenc_si128(block, keys[round]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 16), _mm_aesenclast_si128(block, keys[rounds]));
+    }
+}
+
+// The decryption key schedule is already in the form of the equivalent inverse cipher, which is what AESDEC implements.
+[[gnu::target("aes,ssse3")]] static void decrypt_block_with_aes_instructions(AESCipherKey const& key, u8 const* in, u8* out)
+{
+    __m128i keys[15];
+    auto rounds = key.rounds();
+    load_round_keys(key.round_keys(), rounds, keys);
+
+    auto block = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in)), keys[0]);
+    for (size_t round = 1; round < rounds; ++round)
+        block = _mm_aesdec_si128(block, keys[round]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_aesdeclast_si128(block, keys[rounds]));
+}
+#endif
+
 #ifndef KERNEL
 String AESCipherBlock::to_string() const
 {
@@ -199,6 +263,13 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
 
 void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 {
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+    if (has_aes_instructions()) {
+        encrypt_blocks_with_aes_instructions(key(), in.bytes().data(), out.bytes().data(), 1);
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -291,6 +362,13 @@ void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 
 void AESCipher::decrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 {
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+    if (has_aes_instructions()) {
+        decrypt_block_with_aes_instructions(key(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -378,6 +456,26 @@ void AESCipher::decrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
     // clang-format on
 }
 
+void AESCipher::encrypt_blocks(ReadonlyBytes in, Bytes out)
+{
+    VERIFY(in.size() % AESCipherBlock::block_size() == 0);
+    VERIFY(out.size() >= in.size());
+
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+    if (has_aes_instructions()) {
+        encrypt_blocks_with_aes_instructions(key(), in.data(), out.data(), in.size() / AESCipherBlock::block_size());
+        return;
+    }
+#endif
+
+    AESCipherBlock block;
+    for (size_t offset = 0; offset < in.size(); offset += AESCipherBlock::block_size()) {
+        block.overwrite(in.slice(offset, AESCipherBlock::block_size()));
+        encrypt_block(block, block);
+        block.bytes().copy_to(out.slice(offset));
+    }
+}
+
 void AESCipherBlock::overwrite(ReadonlyBytes bytes)
 {
     auto data = bytes.data();
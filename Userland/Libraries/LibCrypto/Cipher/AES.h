@@ -119,6 +119,9 @@ public:
     virtual void encrypt_block(const BlockType& in, BlockType& out) override;
     virtual void decrypt_block(const BlockType& in, BlockType& out) override;
 
+    // Encrypts consecutive blocks. With AES instructions, several blocks are in flight at once to hide their latency.
+    void encrypt_blocks(ReadonlyBytes in, Bytes out);
+
 #ifndef KERNEL
     virtual String class_name() const override
     {
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <LibCrypto/Authentication/Poly1305.h>
+#include <LibCrypto/Cipher/ChaCha20.h>
+
+namespace Crypto::Cipher {
+
+static u32 load_le32(u8 const* data)
+{
+    return AK::convert_between_host_and_little_endian(ByteReader::load32(data));
+}
+
+static void store_le64(u8* data, u64 value)
+{
+    ByteReader::store(data, AK::convert_between_host_and_little_endian(value));
+}
+
+static constexpr u32 rotate_left(u32 value, size_t bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+ALWAYS_INLINE static void quarter_round(u32& a, u32& b, u32& c, u32& d)
+{
+    a += b;
+    d = rotate_left(d ^ a, 16);
+    c += d;
+    b = rotate_left(b ^ c, 12);
+    a += b;
+    d = rotate_left(d ^ a, 8);
+    c += d;
+    b = rotate_left(b ^ c, 7);
+}
+
+ChaCha20::ChaCha20(ReadonlyBytes key)
+{
+    VERIFY(key.size() == KeySize);
+    for (size_t i = 0; i < 8; ++i)
+        m_key[i] = load_le32(key.offset(i * 4));
+}
+
+void ChaCha20::generate_block(ReadonlyBytes nonce, u32 counter, u8 (&out)[BlockSize]) const
+{
+    VERIFY(nonce.size() == NonceSize);
+
+    // "expand 32-byte k"
+    u32 const initial_state[16] {
+        0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+        m_key[0], m_key[1], m_key[2], m_key[3],
+        m_key[4], m_key[5], m_key[6], m_key[7],
+        counter, load_le32(nonce.offset(0)), load_le32(nonce.offset(4)), load_le32(nonce.offset(8)),
+    };
+
+    u32 x[16];
+    for (size_t i = 0; i < 16; ++i)
+        x[i] = initial_state[i];
+
+    for (size_t i = 0; i < 10; ++i) {
+        // Column rounds.
+        quarter_round(x[0], x[4], x[8], x[12]);
+        quarter_round(x[1], x[5], x[9], x[13]);
+        quarter_round(x[2], x[6], x[10], x[14]);
+        quarter_round(x[3], x[7], x[11], x[15]);
+        // Diagonal rounds.
+        quarter_round(x[0], x[5], x[10], x[15]);
+        quarter_round(x[1], x[6], x[11], x[12]);
+        quarter_round(x[2], x[7], x[8], x[13]);
+        quarter_round(x[3], x[4], x[9], x[14]);
+    }
+
+    for (size_t i = 0; i < 16; ++i)
+        ByteReader::store(out + i * 4, AK::convert_between_host_and_little_endian(x[i] + initial_state[i]));
+}
+
+void ChaCha20::crypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, u32 initial_counter) const
+{
+    VERIFY(out.size() >= in.size());
+
+    u8 key_stream[BlockSize];
+    u32 counter = initial_counter;
+    for (size_t offset = 0; offset < in.size(); offset += BlockSize) {
+        generate_block(nonce, counter++, key_stream);
+
+        auto length = min(in.size() - offset, BlockSize);
+        auto input = in.slice(offset, length);
+        auto output = out.slice(offset, length);
+
+        size_t i = 0;
+        for (; i + sizeof(u64) <= length; i += sizeof(u64))
+            ByteReader::store(output.offset(i), ByteReader::load64(input.offset(i)) ^ ByteReader::load64(key_stream + i));
+        for (; i < length; ++i)
+            output[i] = input[i] ^ key_stream[i];
+    }
+}
+
+void ChaCha20Poly1305::compute_tag(ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes ciphertext, u8 (&tag)[TagSize]) const
+{
+    // The one-time Poly1305 key is the start of the first key stream block, the message is encrypted from the second block onwards.
+    u8 key_block[ChaCha20::BlockSize];
+    m_cipher.generate_block(nonce, 0, key_block);
+    Authentication::Poly1305 poly1305 { { key_block, Authentication::Poly1305::KeySize } };
+    __builtin_memset(key_block, 0, sizeof(key_block));
+
+    u8 const zeroes[Authentication::Poly1305::BlockSize] {};
+    auto padding_for = [&](size_t length) {
+        return ReadonlyBytes { zeroes, (Authentication::Poly1305::BlockSize - length % Authentication::Poly1305::BlockSize) % Authentication::Poly1305::BlockSize };
+    };
+
+    poly1305.update(aad);
+    poly1305.update(padding_for(aad.size()));
+    poly1305.update(ciphertext);
+    poly1305.update(padding_for(ciphertext.size()));
+
+    u8 lengths[16];
+    store_le64(lengths, aad.size());
+    store_le64(lengths + 8, ciphertext.size());
+    poly1305.update({ lengths, sizeof(lengths) });
+
+    auto digest = poly1305.digest();
+    __builtin_memcpy(tag, digest.data, TagSize);
+}
+
+void ChaCha20Poly1305::encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag) const
+{
+    VERIFY(tag.size() >= TagSize);
+
+    m_cipher.crypt(in, out, nonce, 1);
+
+    u8 computed_tag[TagSize];
+    compute_tag(nonce, aad, out.trim(in.size()), computed_tag);
+    ReadonlyBytes { computed_tag, TagSize }.copy_to(tag);
+}
+
+VerificationConsistency ChaCha20Poly1305::decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag) const
+{
+    if (tag.size() != TagSize)
+        return VerificationConsistency::Inconsistent;
+
+    u8 computed_tag[TagSize];
+    compute_tag(nonce, aad, in, computed_tag);
+
+    // Compare the whole tag, so that the time it takes doesn't tell how much of it was right.
+    u8 difference = 0;
+    for (size_t i = 0; i < TagSize; ++i)
+        difference |= computed_tag[i] ^ tag[i];
+    if (difference != 0)
+        return VerificationConsistency::Inconsistent;
+
+    m_cipher.crypt(in, out, nonce, 1);
+    return VerificationConsistency::Consistent;
+}
+
+}
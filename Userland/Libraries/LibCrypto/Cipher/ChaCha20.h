@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <LibCrypto/Verification.h>
+
+#ifndef KERNEL
+#    include <AK/String.h>
+#endif
+
+namespace Crypto::Cipher {
+
+// The stream cipher from RFC 8439 section 2.4, with a 96-bit nonce and a 32-bit block counter.
+// Unlike AES, it only needs additions, rotations and XORs, so it's fast even without special CPU instructions.
+class ChaCha20 final {
+public:
+    static constexpr size_t KeySize = 32;
+    static constexpr size_t NonceSize = 12;
+    static constexpr size_t BlockSize = 64;
+
+    explicit ChaCha20(ReadonlyBytes key);
+
+#ifndef KERNEL
+    String class_name() const
+    {
+        return "ChaCha20";
+    }
+#endif
+
+    // XORs the key stream for the nonce into the input, starting at the given block.
+    // Encryption and decryption are the same operation.
+    void crypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, u32 initial_counter = 0) const;
+
+    void generate_block(ReadonlyBytes nonce, u32 counter, u8 (&out)[BlockSize]) const;
+
+private:
+    u32 m_key[8];
+};
+
+// The AEAD construction from RFC 8439 section 2.8, which authenticates the ChaCha20 ciphertext with Poly1305.
+// The API mirrors GCM's: the tag is written to, or read from, a separate buffer.
+class ChaCha20Poly1305 final {
+public:
+    static constexpr size_t KeySize = ChaCha20::KeySize;
+    static constexpr size_t NonceSize = ChaCha20::NonceSize;
+    static constexpr size_t TagSize = 16;
+
+    explicit ChaCha20Poly1305(ReadonlyBytes key)
+        : m_cipher(key)
+    {
+    }
+
+#ifndef KERNEL
+    String class_name() const
+    {
+        return "ChaCha20-Poly1305";
+    }
+#endif
+
+    void encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag) const;
+    VerificationConsistency decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag) const;
+
+private:
+    void compute_tag(ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes ciphertext, u8 (&tag)[TagSize]) const;
+
+    ChaCha20 m_cipher;
+};
+
+}
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/ByteReader.h>
 #include <AK/OwnPtr.h>
 #include <AK/StringBuilder.h>
 #include <AK/StringView.h>
@@ -92,12 +93,16 @@ public:
         // Skip past block 0
         CTR<T>::increment(iv);
 
-        if (in.is_empty())
+        Authentication::GHashDigest auth_tag;
+        if (in.is_empty()) {
             CTR<T>::key_stream(out, iv);
-        else
-            CTR<T>::encrypt(in, out, iv);
+            auth_tag = m_ghash->process(aad, out);
+        } else {
+            m_ghash->update(aad);
+            crypt_and_authenticate(in, out, iv, Intent::Encryption);
+            auth_tag = m_ghash->digest(aad.size(), in.size());
+        }
 
-        auto auth_tag = m_ghash->process(aad, out);
         block0.apply_initialization_vector({ auth_tag.data, array_size(auth_tag.data) });
         block0.bytes().copy_to(tag);
     }
@@ -120,27 +125,77 @@ public:
         // Skip past block 0
         CTR<T>::increment(iv);
 
-        auto auth_tag = m_ghash->process(aad, in);
-        block0.apply_initialization_vector({ auth_tag.data, array_size(auth_tag.data) });
+        Authentication::GHashDigest auth_tag;
+        if (in.is_empty()) {
+            out = {};
+            auth_tag = m_ghash->process(aad, in);
+        } else {
+            m_ghash->update(aad);
+            crypt_and_authenticate(in, out, iv, Intent::Decryption);
+            auth_tag = m_ghash->digest(aad.size(), in.size());
+        }
 
-        auto test_consistency = [&] {
-            if (block0.block_size() != tag.size() || __builtin_memcmp(block0.bytes().data(), tag.data(), tag.size()) != 0)
-                return VerificationConsistency::Inconsistent;
+        block0.apply_initialization_vector({ auth_tag.data, array_size(auth_tag.data) });
 
-            return VerificationConsistency::Consistent;
-        };
         // FIXME: This block needs constant-time comparisons.
+        if (block0.block_size() != tag.size() || __builtin_memcmp(block0.bytes().data(), tag.data(), tag.size()) != 0)
+            return VerificationConsistency::Inconsistent;
 
-        if (in.is_empty()) {
-            out = {};
-            return test_consistency();
+        return VerificationConsistency::Consistent;
+    }
+
+private:
+    // The number of blocks that are encrypted and hashed per iteration. This lets the cipher work on several counter
+    // blocks at once, and the GHASH pick up the ciphertext while it's still in the cache.
+    static constexpr size_t blocks_per_iteration = 8;
+
+    void encrypt_blocks(ReadonlyBytes in, Bytes out)
+    {
+        if constexpr (requires(T& cipher) { cipher.encrypt_blocks(in, out); }) {
+            this->cipher().encrypt_blocks(in, out);
+        } else {
+            typename T::BlockType block;
+            for (size_t offset = 0; offset < in.size(); offset += block_size) {
+                block.overwrite(in.slice(offset, block_size));
+                this->cipher().encrypt_block(block, block);
+                block.bytes().copy_to(out.slice(offset));
+            }
         }
+    }
 
-        CTR<T>::encrypt(in, out, iv);
-        return test_consistency();
+    // Encrypts or decrypts the input in CTR mode, and feeds the ciphertext into the GHASH along the way.
+    void crypt_and_authenticate(ReadonlyBytes in, Bytes out, Bytes iv, Intent intent)
+    {
+        VERIFY(out.size() >= in.size());
+
+        u8 counter_blocks[blocks_per_iteration * block_size];
+        u8 key_stream[blocks_per_iteration * block_size];
+        for (size_t offset = 0; offset < in.size();) {
+            auto length = min(in.size() - offset, sizeof(key_stream));
+            auto blocks_length = ceil_div(length, block_size) * block_size;
+            for (size_t i = 0; i < blocks_length; i += block_size) {
+                iv.slice(0, block_size).copy_to({ counter_blocks + i, block_size });
+                CTR<T>::increment(iv);
+            }
+            encrypt_blocks({ counter_blocks, blocks_length }, { key_stream, blocks_length });
+
+            auto input = in.slice(offset, length);
+            auto output = out.slice(offset, length);
+            if (intent == Intent::Decryption)
+                m_ghash->update(input);
+
+            size_t i = 0;
+            for (; i + sizeof(u64) <= length; i += sizeof(u64))
+                ByteReader::store(output.offset(i), ByteReader::load64(input.offset(i)) ^ ByteReader::load64(key_stream + i));
+            for (; i < length; ++i)
+                output[i] = input[i] ^ key_stream[i];
+
+            if (intent == Intent::Encryption)
+                m_ghash->update(output);
+            offset += length;
+        }
     }
 
-private:
     static constexpr auto block_size = T::BlockType::BlockSizeInBits / 8;
     u8 m_auth_key_storage[block_size];
     Bytes m_auth_key { m_auth_key_storage, block_size };
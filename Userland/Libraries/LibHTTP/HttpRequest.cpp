@@ -163,6 +163,8 @@ Optional<HttpRequest> HttpRequest::from_raw_request(ReadonlyBytes raw_request)
     else
         return {};
 
+    // Anything other than HTTP/1.1 gets the more conservative HTTP/1.0 semantics.
+    request.m_version = protocol == "HTTP/1.1" ? Version::HTTP_1_1 : Version::HTTP_1_0;
     request.m_resource = URL::percent_decode(resource);
     request.m_headers = move(headers);
 
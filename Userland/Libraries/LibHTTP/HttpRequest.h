@@ -24,6 +24,11 @@ public:
         POST
     };
 
+    enum class Version {
+        HTTP_1_0,
+        HTTP_1_1,
+    };
+
     struct Header {
         String name;
         String value;
@@ -46,6 +51,8 @@ public:
     Method method() const { return m_method; }
     void set_method(Method method) { m_method = method; }
 
+    Version version() const { return m_version; }
+
     ByteBuffer const& body() const { return m_body; }
     void set_body(ByteBuffer&& body) { m_body = move(body); }
 
@@ -62,6 +69,7 @@ private:
     URL m_url;
     String m_resource;
     Method m_method { GET };
+    Version m_version { Version::HTTP_1_1 };
     Vector<Header> m_headers;
     ByteBuffer m_body;
 };
@@ -3475,13 +3475,13 @@ Completion ArrayExpression::execute(Interpreter& interpreter, GlobalObject& glob
 
             if (is<SpreadExpression>(*element)) {
                 (void)TRY(get_iterator_values(global_object, value, [&](Value iterator_value) -> Optional<Completion> {
-                    array->indexed_properties().put(index++, iterator_value, default_attributes);
+                    array->indexed_properties_put(index++, iterator_value, default_attributes);
                     return {};
                 }));
                 continue;
             }
         }
-        array->indexed_properties().put(index++, value, default_attributes);
+        array->indexed_properties_put(index++, value, default_attributes);
     }
 
     // 4. Return array.
@@ -3548,7 +3548,7 @@ Completion TaggedTemplateLiteral::execute(Interpreter& interpreter, GlobalObject
         // tag`${foo}`             -> "", foo, ""                -> tag(["", ""], foo)
         // tag`foo${bar}baz${qux}` -> "foo", bar, "baz", qux, "" -> tag(["foo", "baz", ""], bar, qux)
         if (i % 2 == 0) {
-            strings->indexed_properties().append(value);
+            strings->indexed_properties_append(value);
         } else {
             arguments.append(value);
         }
@@ -3557,7 +3557,7 @@ Completion TaggedTemplateLiteral::execute(Interpreter& interpreter, GlobalObject
     auto* raw_strings = MUST(Array::create(global_object, 0));
     for (auto& raw_string : m_template_literal->raw_strings()) {
         auto value = TRY(raw_string.execute(interpreter, global_object)).release_value();
-        raw_strings->indexed_properties().append(value);
+        raw_strings->indexed_properties_append(value);
     }
     strings->define_direct_property(vm.names.raw, raw_strings, 0);
     return call(global_object, tag, js_undefined(), move(arguments));
@@ -39,6 +39,25 @@ BasicBlock::~BasicBlock()
     munmap(m_buffer, m_buffer_capacity);
 }
 
+void BasicBlock::remove_instructions(Function<bool(Instruction const&)> const& should_remove)
+{
+    size_t new_size = 0;
+    size_t offset = 0;
+    while (offset < m_buffer_size) {
+        auto& instruction = *reinterpret_cast<Instruction*>(m_buffer + offset);
+        auto length = instruction.length();
+        if (should_remove(instruction)) {
+            Instruction::destroy(instruction);
+        } else {
+            if (new_size != offset)
+                memmove(m_buffer + new_size, m_buffer + offset, length);
+            new_size += length;
+        }
+        offset += length;
+    }
+    m_buffer_size = new_size;
+}
+
 void BasicBlock::seal()
 {
     // FIXME: mprotect the instruction stream as PROT_READ
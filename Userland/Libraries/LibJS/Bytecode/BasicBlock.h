@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Badge.h>
+#include <AK/Function.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/String.h>
 #include <LibJS/Forward.h>
@@ -36,6 +37,9 @@ public:
     bool can_grow(size_t additional_size) const { return m_buffer_size + additional_size <= m_buffer_capacity; }
     void grow(size_t additional_size);
 
+    // Destroys the instructions for which the callback returns true, and moves the remaining ones up to close the gaps.
+    void remove_instructions(Function<bool(Instruction const&)> const&);
+
     void terminate(Badge<Generator>) { m_is_terminated = true; }
     bool is_terminated() const { return m_is_terminated; }
 
@@ -5,9 +5,100 @@
  */
 
 #include <LibJS/Bytecode/Executable.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/Shape.h>
 
 namespace JS::Bytecode {
 
+Optional<Value> PropertyLookupCache::get(Object const& object) const
+{
+    if (!object.has_ordinary_property_access())
+        return {};
+    auto const& shape = object.shape();
+    for (auto const& entry : m_entries) {
+        if (entry.shape.ptr() != &shape)
+            continue;
+        auto const* holder = &object;
+        if (entry.is_in_prototype) {
+            holder = shape.prototype();
+            if (!holder->has_ordinary_property_access() || entry.prototype_shape.ptr() != &holder->shape())
+                continue;
+        }
+        // A data property may have been redefined as an accessor with the same attributes.
+        auto value = holder->get_direct(entry.property_offset);
+        if (value.is_accessor())
+            return {};
+        return value;
+    }
+    return {};
+}
+
+bool PropertyLookupCache::put(Object& object, Value value)
+{
+    if (!object.has_ordinary_property_access())
+        return false;
+    for (auto const& entry : m_entries) {
+        if (entry.shape.ptr() != &object.shape() || entry.is_in_prototype)
+            continue;
+        if (object.get_direct(entry.property_offset).is_accessor())
+            return false;
+        object.put_direct(entry.property_offset, value);
+        return true;
+    }
+    return false;
+}
+
+void PropertyLookupCache::update_for_get(Object const& object, FlyString const& property_name)
+{
+    if (!object.has_ordinary_property_access() || object.shape().is_unique())
+        return;
+    auto const& shape = object.shape();
+    if (auto metadata = shape.lookup(property_name); metadata.has_value()) {
+        if (!object.get_direct(metadata->offset).is_accessor())
+            add_entry(shape, nullptr, metadata->offset);
+        return;
+    }
+
+    auto const* prototype = shape.prototype();
+    if (!prototype || !prototype->has_ordinary_property_access() || prototype->shape().is_unique())
+        return;
+    auto metadata = prototype->shape().lookup(property_name);
+    if (metadata.has_value() && !prototype->get_direct(metadata->offset).is_accessor())
+        add_entry(shape, &prototype->shape(), metadata->offset);
+}
+
+void PropertyLookupCache::update_for_put(Object const& object, FlyString const& property_name)
+{
+    if (!object.has_ordinary_property_access() || object.shape().is_unique())
+        return;
+    auto metadata = object.shape().lookup(property_name);
+    if (!metadata.has_value() || !metadata->attributes.is_writable() || object.get_direct(metadata->offset).is_accessor())
+        return;
+    add_entry(object.shape(), nullptr, metadata->offset);
+}
+
+void PropertyLookupCache::add_entry(Shape const& shape, Shape const* prototype_shape, u32 property_offset)
+{
+    auto make_weak_ptr = [](Shape const* shape) {
+        return shape ? const_cast<Shape*>(shape)->make_weak_ptr<Shape>() : WeakPtr<Shape> {};
+    };
+
+    // Replace an outdated entry for the same shape first, then the oldest one.
+    Entry* entry = nullptr;
+    for (auto& candidate : m_entries) {
+        if (candidate.shape.ptr() == &shape)
+            entry = &candidate;
+    }
+    if (!entry) {
+        entry = &m_entries[m_next_entry_to_replace];
+        m_next_entry_to_replace = (m_next_entry_to_replace + 1) % entry_count;
+    }
+    entry->shape = make_weak_ptr(&shape);
+    entry->prototype_shape = make_weak_ptr(prototype_shape);
+    entry->is_in_prototype = prototype_shape != nullptr;
+    entry->property_offset = property_offset;
+}
+
 void Executable::dump() const
 {
     dbgln("\033[33;1mJS::Bytecode::Executable\033[0m ({})", name);
@@ -6,20 +6,57 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/FlyString.h>
 #include <AK/NonnullOwnPtrVector.h>
+#include <AK/Vector.h>
+#include <AK/WeakPtr.h>
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/IdentifierTable.h>
 #include <LibJS/Bytecode/StringTable.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Value.h>
 
 namespace JS::Bytecode {
 
+// A polymorphic inline cache for named property accesses. Each entry remembers where a property
+// lives for objects of one shape: either in the object's own storage, or in the storage of its
+// prototype if that has the given shape. As long as shapes aren't unique, any change to an object's
+// properties or prototype moves it to a different shape, so a matching shape is all that needs to
+// be checked. Unique shapes change in place and are never cached.
+class PropertyLookupCache {
+public:
+    Optional<Value> get(Object const&) const;
+    bool put(Object&, Value);
+
+    void update_for_get(Object const&, FlyString const& property_name);
+    void update_for_put(Object const&, FlyString const& property_name);
+
+private:
+    static constexpr size_t entry_count = 4;
+
+    struct Entry {
+        WeakPtr<Shape> shape;
+        WeakPtr<Shape> prototype_shape;
+        u32 property_offset { 0 };
+        // NOTE: The prototype's shape may be collected while the object's is still alive, so this can't be told from prototype_shape.
+        bool is_in_prototype { false };
+    };
+
+    void add_entry(Shape const& shape, Shape const* prototype_shape, u32 property_offset);
+
+    AK::Array<Entry, entry_count> m_entries;
+    u8 m_next_entry_to_replace { 0 };
+};
+
 struct Executable {
     FlyString name;
     NonnullOwnPtrVector<BasicBlock> basic_blocks;
     NonnullOwnPtr<StringTable> string_table;
     NonnullOwnPtr<IdentifierTable> identifier_table;
     size_t number_of_registers { 0 };
+    // NOTE: These are kept out of GetById and PutById, as instructions are moved around with memcpy().
+    Vector<PropertyLookupCache> mutable property_lookup_caches;
 
     String const& get_string(StringTableIndex index) const { return string_table->get(index); }
     FlyString const& get_identifier(IdentifierTableIndex index) const { return identifier_table->get(index); }
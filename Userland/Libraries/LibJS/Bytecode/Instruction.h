@@ -86,6 +86,8 @@ namespace JS::Bytecode {
 class Instruction {
 public:
     constexpr static bool IsTerminator = false;
+    constexpr static bool ReadsAccumulator = true;
+    constexpr static bool WritesAccumulator = true;
 
     enum class Type {
 #define __BYTECODE_OP(op) \
@@ -94,7 +96,15 @@ public:
 #undef __BYTECODE_OP
     };
 
+    enum class RegisterAccess {
+        Read,
+        Write,
+        ReadWrite,
+    };
+
     bool is_terminator() const;
+    bool reads_accumulator() const;
+    bool writes_accumulator() const;
     Type type() const { return m_type; }
     size_t length() const;
     String to_string(Bytecode::Executable const&) const;
@@ -102,6 +112,14 @@ public:
     void replace_references(BasicBlock const&, BasicBlock const&);
     static void destroy(Instruction&);
 
+    // Calls the callback with every register operand of the instruction and the way it is accessed.
+    // The accumulator is used implicitly by most instructions, and is not visited.
+    template<typename Callback>
+    void for_each_register_operand(Callback);
+
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback) { }
+
 protected:
     explicit Instruction(Type type)
         : m_type(type)
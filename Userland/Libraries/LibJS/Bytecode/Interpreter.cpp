@@ -225,6 +225,16 @@ Bytecode::PassManager& Interpreter::optimization_pipeline(Interpreter::Optimizat
         pm->add<Passes::MergeBlocks>();
         pm->add<Passes::GenerateCFG>();
         pm->add<Passes::PlaceBlocks>();
+        pm->add<Passes::Peephole>();
+        pm->add<Passes::GenerateCFG>();
+        pm->add<Passes::AnalyzeLiveness>();
+        pm->add<Passes::EliminateDeadCode>();
+        pm->add<Passes::Peephole>();
+        pm->add<Passes::AnalyzeLiveness>();
+        pm->add<Passes::EliminateDeadCode>();
+        pm->add<Passes::AnalyzeLiveness>();
+        pm->add<Passes::AllocateRegisters>();
+        pm->add<Passes::Peephole>();
     } else {
         VERIFY_NOT_REACHED();
     }
@@ -322,15 +322,33 @@ ThrowCompletionOr<void> SetVariable::execute_impl(Bytecode::Interpreter& interpr
 
 ThrowCompletionOr<void> GetById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
-    auto* object = TRY(interpreter.accumulator().to_object(interpreter.global_object()));
-    interpreter.accumulator() = TRY(object->get(interpreter.current_executable().get_identifier(m_property)));
+    auto& cache = interpreter.current_executable().property_lookup_caches[m_cache_index];
+    auto base = interpreter.accumulator();
+    if (base.is_object()) {
+        if (auto value = cache.get(base.as_object()); value.has_value()) {
+            interpreter.accumulator() = *value;
+            return {};
+        }
+    }
+
+    auto const& property_name = interpreter.current_executable().get_identifier(m_property);
+    auto* object = TRY(base.to_object(interpreter.global_object()));
+    interpreter.accumulator() = TRY(object->get(property_name));
+    cache.update_for_get(*object, property_name);
     return {};
 }
 
 ThrowCompletionOr<void> PutById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
-    auto* object = TRY(interpreter.reg(m_base).to_object(interpreter.global_object()));
-    TRY(object->set(interpreter.current_executable().get_identifier(m_property), interpreter.accumulator(), Object::ShouldThrowExceptions::Yes));
+    auto& cache = interpreter.current_executable().property_lookup_caches[m_cache_index];
+    auto base = interpreter.reg(m_base);
+    if (base.is_object() && cache.put(base.as_object(), interpreter.accumulator()))
+        return {};
+
+    auto const& property_name = interpreter.current_executable().get_identifier(m_property);
+    auto* object = TRY(base.to_object(interpreter.global_object()));
+    TRY(object->set(property_name, interpreter.accumulator(), Object::ShouldThrowExceptions::Yes));
+    cache.update_for_put(*object, property_name);
     return {};
 }
 
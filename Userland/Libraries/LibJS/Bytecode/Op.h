@@ -24,6 +24,8 @@ namespace JS::Bytecode::Op {
 
 class Load final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     explicit Load(Register src)
         : Instruction(Type::Load)
         , m_src(src)
@@ -34,12 +36,19 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback callback) { callback(m_src, RegisterAccess::Read); }
+
+    Register src() const { return m_src; }
+
 private:
     Register m_src;
 };
 
 class LoadImmediate final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     explicit LoadImmediate(Value value)
         : Instruction(Type::LoadImmediate)
         , m_value(value)
@@ -50,12 +59,16 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    Value value() const { return m_value; }
+
 private:
     Value m_value;
 };
 
 class Store final : public Instruction {
 public:
+    constexpr static bool WritesAccumulator = false;
+
     explicit Store(Register dst)
         : Instruction(Type::Store)
         , m_dst(dst)
@@ -66,6 +79,11 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback callback) { callback(m_dst, RegisterAccess::Write); }
+
+    Register dst() const { return m_dst; }
+
 private:
     Register m_dst;
 };
@@ -107,6 +125,14 @@ private:
         String to_string_impl(Bytecode::Executable const&) const;              \
         void replace_references_impl(BasicBlock const&, BasicBlock const&) { } \
                                                                                \
+        template<typename Callback>                                            \
+        void for_each_register_operand_impl(Callback callback)                 \
+        {                                                                      \
+            callback(m_lhs_reg, RegisterAccess::Read);                         \
+        }                                                                      \
+                                                                               \
+        Register lhs() const { return m_lhs_reg; }                             \
+                                                                               \
     private:                                                                   \
         Register m_lhs_reg;                                                    \
     };
@@ -139,6 +165,8 @@ JS_ENUMERATE_COMMON_UNARY_OPS(JS_DECLARE_COMMON_UNARY_OP)
 
 class NewString final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     explicit NewString(StringTableIndex string)
         : Instruction(Type::NewString)
         , m_string(string)
@@ -155,6 +183,8 @@ private:
 
 class NewObject final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     NewObject()
         : Instruction(Type::NewObject)
     {
@@ -167,6 +197,8 @@ public:
 
 class NewRegExp final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     NewRegExp(StringTableIndex source_index, StringTableIndex flags_index)
         : Instruction(Type::NewRegExp)
         , m_source_index(source_index)
@@ -186,6 +218,8 @@ private:
 // NOTE: This instruction is variable-width depending on the number of excluded names
 class CopyObjectExcludingProperties final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     CopyObjectExcludingProperties(Register from_object, Vector<Register> const& excluded_names)
         : Instruction(Type::CopyObjectExcludingProperties)
         , m_from_object(from_object)
@@ -201,6 +235,14 @@ public:
 
     size_t length_impl() const { return sizeof(*this) + sizeof(Register) * m_excluded_names_count; }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback callback)
+    {
+        callback(m_from_object, RegisterAccess::Read);
+        for (size_t i = 0; i < m_excluded_names_count; i++)
+            callback(m_excluded_names[i], RegisterAccess::Read);
+    }
+
 private:
     Register m_from_object;
     size_t m_excluded_names_count { 0 };
@@ -209,6 +251,8 @@ private:
 
 class NewBigInt final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     explicit NewBigInt(Crypto::SignedBigInteger bigint)
         : Instruction(Type::NewBigInt)
         , m_bigint(move(bigint))
@@ -226,6 +270,8 @@ private:
 // NOTE: This instruction is variable-width depending on the number of elements!
 class NewArray final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     NewArray()
         : Instruction(Type::NewArray)
         , m_element_count(0)
@@ -249,6 +295,13 @@ public:
         return sizeof(*this) + sizeof(Register) * m_element_count;
     }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback callback)
+    {
+        for (size_t i = 0; i < m_element_count; ++i)
+            callback(m_elements[i], RegisterAccess::Read);
+    }
+
 private:
     size_t m_element_count { 0 };
     Register m_elements[];
@@ -268,6 +321,8 @@ public:
 
 class ConcatString final : public Instruction {
 public:
+    constexpr static bool WritesAccumulator = false;
+
     explicit ConcatString(Register lhs)
         : Instruction(Type::ConcatString)
         , m_lhs(lhs)
@@ -278,6 +333,9 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback callback) { callback(m_lhs, RegisterAccess::ReadWrite); }
+
 private:
     Register m_lhs;
 };
@@ -289,6 +347,9 @@ enum class EnvironmentMode {
 
 class CreateEnvironment final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+    constexpr static bool WritesAccumulator = false;
+
     explicit CreateEnvironment(EnvironmentMode mode)
         : Instruction(Type::CreateEnvironment)
         , m_mode(mode)
@@ -305,6 +366,9 @@ private:
 
 class CreateVariable final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+    constexpr static bool WritesAccumulator = false;
+
     explicit CreateVariable(IdentifierTableIndex identifier, EnvironmentMode mode, bool is_immutable)
         : Instruction(Type::CreateVariable)
         , m_identifier(identifier)
@@ -325,6 +389,8 @@ private:
 
 class SetVariable final : public Instruction {
 public:
+    constexpr static bool WritesAccumulator = false;
+
     enum class InitializationMode {
         Initialize,
         Set,
@@ -350,6 +416,8 @@ private:
 
 class GetVariable final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     explicit GetVariable(IdentifierTableIndex identifier)
         : Instruction(Type::GetVariable)
         , m_identifier(identifier)
@@ -368,9 +436,10 @@ private:
 
 class GetById final : public Instruction {
 public:
-    explicit GetById(IdentifierTableIndex property)
+    GetById(IdentifierTableIndex property, u32 cache_index)
         : Instruction(Type::GetById)
         , m_property(property)
+        , m_cache_index(cache_index)
     {
     }
 
@@ -380,14 +449,18 @@ public:
 
 private:
     IdentifierTableIndex m_property;
+    u32 m_cache_index { 0 };
 };
 
 class PutById final : public Instruction {
 public:
-    explicit PutById(Register base, IdentifierTableIndex property)
+    constexpr static bool WritesAccumulator = false;
+
+    PutById(Register base, IdentifierTableIndex property, u32 cache_index)
         : Instruction(Type::PutById)
         , m_base(base)
         , m_property(property)
+        , m_cache_index(cache_index)
     {
     }
 
@@ -395,9 +468,13 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback callback) { callback(m_base, RegisterAccess::Read); }
+
 private:
     Register m_base;
     IdentifierTableIndex m_property;
+    u32 m_cache_index { 0 };
 };
 
 class GetByValue final : public Instruction {
@@ -412,12 +489,17 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback callback) { callback(m_base, RegisterAccess::Read); }
+
 private:
     Register m_base;
 };
 
 class PutByValue final : public Instruction {
 public:
+    constexpr static bool WritesAccumulator = false;
+
     PutByValue(Register base, Register property)
         : Instruction(Type::PutByValue)
         , m_base(base)
@@ -429,6 +511,13 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback callback)
+    {
+        callback(m_base, RegisterAccess::Read);
+        callback(m_property, RegisterAccess::Read);
+    }
+
 private:
     Register m_base;
     Register m_property;
@@ -437,6 +526,8 @@ private:
 class Jump : public Instruction {
 public:
     constexpr static bool IsTerminator = true;
+    constexpr static bool ReadsAccumulator = false;
+    constexpr static bool WritesAccumulator = false;
 
     explicit Jump(Type type, Optional<Label> taken_target = {}, Optional<Label> nontaken_target = {})
         : Instruction(type)
@@ -472,6 +563,8 @@ protected:
 
 class JumpConditional final : public Jump {
 public:
+    constexpr static bool ReadsAccumulator = true;
+
     explicit JumpConditional(Optional<Label> true_target = {}, Optional<Label> false_target = {})
         : Jump(Type::JumpConditional, move(true_target), move(false_target))
     {
@@ -483,6 +576,8 @@ public:
 
 class JumpNullish final : public Jump {
 public:
+    constexpr static bool ReadsAccumulator = true;
+
     explicit JumpNullish(Optional<Label> true_target = {}, Optional<Label> false_target = {})
         : Jump(Type::JumpNullish, move(true_target), move(false_target))
     {
@@ -494,6 +589,8 @@ public:
 
 class JumpUndefined final : public Jump {
 public:
+    constexpr static bool ReadsAccumulator = true;
+
     explicit JumpUndefined(Optional<Label> true_target = {}, Optional<Label> false_target = {})
         : Jump(Type::JumpUndefined, move(true_target), move(false_target))
     {
@@ -506,6 +603,8 @@ public:
 // NOTE: This instruction is variable-width depending on the number of arguments!
 class Call final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     enum class CallType {
         Call,
         Construct,
@@ -531,6 +630,15 @@ public:
         return sizeof(*this) + sizeof(Register) * m_argument_count;
     }
 
+    template<typename Callback>
+    void for_each_register_operand_impl(Callback callback)
+    {
+        callback(m_callee, RegisterAccess::Read);
+        callback(m_this_value, RegisterAccess::Read);
+        for (size_t i = 0; i < m_argument_count; ++i)
+            callback(m_arguments[i], RegisterAccess::Read);
+    }
+
 private:
     Register m_callee;
     Register m_this_value;
@@ -541,6 +649,8 @@ private:
 
 class NewClass final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     explicit NewClass(ClassExpression const& class_expression)
         : Instruction(Type::NewClass)
         , m_class_expression(class_expression)
@@ -557,6 +667,8 @@ private:
 
 class NewFunction final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     explicit NewFunction(FunctionNode const& function_node)
         : Instruction(Type::NewFunction)
         , m_function_node(function_node)
@@ -574,6 +686,7 @@ private:
 class Return final : public Instruction {
 public:
     constexpr static bool IsTerminator = true;
+    constexpr static bool WritesAccumulator = false;
 
     Return()
         : Instruction(Type::Return)
@@ -612,6 +725,7 @@ public:
 class Throw final : public Instruction {
 public:
     constexpr static bool IsTerminator = true;
+    constexpr static bool WritesAccumulator = false;
 
     Throw()
         : Instruction(Type::Throw)
@@ -626,6 +740,8 @@ public:
 class EnterUnwindContext final : public Instruction {
 public:
     constexpr static bool IsTerminator = true;
+    constexpr static bool ReadsAccumulator = false;
+    constexpr static bool WritesAccumulator = false;
 
     EnterUnwindContext(Label entry_point, Optional<Label> handler_target, Optional<Label> finalizer_target)
         : Instruction(Type::EnterUnwindContext)
@@ -651,6 +767,9 @@ private:
 
 class LeaveEnvironment final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+    constexpr static bool WritesAccumulator = false;
+
     LeaveEnvironment(EnvironmentMode mode)
         : Instruction(Type::LeaveEnvironment)
         , m_mode(mode)
@@ -667,6 +786,9 @@ private:
 
 class LeaveUnwindContext final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+    constexpr static bool WritesAccumulator = false;
+
     LeaveUnwindContext()
         : Instruction(Type::LeaveUnwindContext)
     {
@@ -679,6 +801,9 @@ public:
 
 class FinishUnwind final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+    constexpr static bool WritesAccumulator = false;
+
     FinishUnwind(Label next)
         : Instruction(Type::FinishUnwind)
         , m_next_target(move(next))
@@ -696,6 +821,8 @@ private:
 class ContinuePendingUnwind final : public Instruction {
 public:
     constexpr static bool IsTerminator = true;
+    constexpr static bool ReadsAccumulator = false;
+    constexpr static bool WritesAccumulator = false;
 
     explicit ContinuePendingUnwind(Label resume_target)
         : Instruction(Type::ContinuePendingUnwind)
@@ -716,6 +843,7 @@ private:
 class Yield final : public Instruction {
 public:
     constexpr static bool IsTerminator = true;
+    constexpr static bool WritesAccumulator = false;
 
     explicit Yield(Label continuation_label)
         : Instruction(Type::Yield)
@@ -740,6 +868,9 @@ private:
 
 class PushDeclarativeEnvironment final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+    constexpr static bool WritesAccumulator = false;
+
     explicit PushDeclarativeEnvironment(HashMap<u32, Variable> variables)
         : Instruction(Type::PushDeclarativeEnvironment)
         , m_variables(move(variables))
@@ -804,6 +935,8 @@ public:
 
 class ResolveThisBinding final : public Instruction {
 public:
+    constexpr static bool ReadsAccumulator = false;
+
     explicit ResolveThisBinding()
         : Instruction(Type::ResolveThisBinding)
     {
@@ -848,6 +981,22 @@ ALWAYS_INLINE void Instruction::replace_references(BasicBlock const& from, Basic
 #undef __BYTECODE_OP
 }
 
+template<typename Callback>
+ALWAYS_INLINE void Instruction::for_each_register_operand(Callback callback)
+{
+#define __BYTECODE_OP(op)       \
+    case Instruction::Type::op: \
+        return static_cast<Bytecode::Op::op&>(*this).for_each_register_operand_impl(move(callback));
+
+    switch (type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+#undef __BYTECODE_OP
+}
+
 ALWAYS_INLINE size_t Instruction::length() const
 {
     if (type() == Type::Call)
@@ -883,4 +1032,32 @@ ALWAYS_INLINE bool Instruction::is_terminator() const
 #undef __BYTECODE_OP
 }
 
+ALWAYS_INLINE bool Instruction::reads_accumulator() const
+{
+#define __BYTECODE_OP(op) \
+    case Type::op:        \
+        return Op::op::ReadsAccumulator;
+
+    switch (type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+#undef __BYTECODE_OP
+}
+
+ALWAYS_INLINE bool Instruction::writes_accumulator() const
+{
+#define __BYTECODE_OP(op) \
+    case Type::op:        \
+        return Op::op::WritesAccumulator;
+
+    switch (type()) {
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+    default:
+        VERIFY_NOT_REACHED();
+    }
+#undef __BYTECODE_OP
+}
+
 }
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/QuickSort.h>
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// The accumulator and the global object have fixed meanings, everything above them is a temporary.
+static bool is_allocatable(u32 index)
+{
+    return index > Register::global_object_index;
+}
+
+void AllocateRegisters::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    if (!executable.live_registers_at_exit.has_value()) {
+        finished();
+        return;
+    }
+    auto live_registers_at_exit = executable.live_registers_at_exit.release_value();
+
+    // Two registers interfere if one of them is written while the other one is live, as they can't share storage then.
+    HashMap<u32, HashTable<u32>> interferences;
+    // Pairs of registers that hold the same value after a "Load $x; Store $y" sequence. Giving them the same
+    // storage makes the Store redundant, so we try to do that.
+    HashMap<u32, HashTable<u32>> copies;
+
+    for (auto& block : executable.executable.basic_blocks) {
+        Vector<Instruction const*> instructions;
+        // For every Store that copies a register, the register being copied.
+        HashMap<Instruction const*, u32> copy_sources;
+        Optional<u32> register_in_accumulator;
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            auto& instruction = *it;
+            instructions.append(&instruction);
+            if (instruction.type() == Instruction::Type::Load) {
+                register_in_accumulator = static_cast<Op::Load const&>(instruction).src().index();
+            } else if (instruction.type() == Instruction::Type::Store) {
+                auto destination = static_cast<Op::Store const&>(instruction).dst().index();
+                if (register_in_accumulator.has_value() && is_allocatable(*register_in_accumulator) && is_allocatable(destination)) {
+                    copy_sources.set(&instruction, *register_in_accumulator);
+                    copies.ensure(destination).set(*register_in_accumulator);
+                    copies.ensure(*register_in_accumulator).set(destination);
+                }
+                register_in_accumulator = destination;
+            } else if (instruction.writes_accumulator()) {
+                register_in_accumulator = {};
+            } else {
+                AnalyzeLiveness::for_each_register_written(instruction, [&](u32 index) {
+                    if (register_in_accumulator == index)
+                        register_in_accumulator = {};
+                });
+            }
+        }
+
+        auto live_registers = live_registers_at_exit.get(&block).value_or({});
+        for (size_t i = instructions.size(); i > 0; --i) {
+            auto& instruction = *instructions[i - 1];
+            auto copy_source = copy_sources.get(&instruction);
+            AnalyzeLiveness::for_each_register_written(instruction, [&](u32 written_index) {
+                if (!is_allocatable(written_index))
+                    return;
+                interferences.ensure(written_index);
+                for (auto live_index : live_registers) {
+                    // A copy doesn't make the two registers interfere, since they hold the same value.
+                    if (live_index == written_index || copy_source == live_index || !is_allocatable(live_index))
+                        continue;
+                    interferences.ensure(written_index).set(live_index);
+                    interferences.ensure(live_index).set(written_index);
+                }
+            });
+            AnalyzeLiveness::for_each_register_written(instruction, [&](u32 index) {
+                live_registers.remove(index);
+            });
+            AnalyzeLiveness::for_each_register_read(instruction, [&](u32 index) {
+                live_registers.set(index);
+                if (is_allocatable(index))
+                    interferences.ensure(index);
+            });
+        }
+    }
+
+    // Greedily give each register the lowest index that isn't taken by any register it interferes with,
+    // preferring the index of a register it is copied from or to.
+    Vector<u32> registers;
+    for (auto& entry : interferences)
+        registers.append(entry.key);
+    quick_sort(registers);
+
+    HashMap<u32, u32> allocated_registers;
+    u32 number_of_registers = Register::global_object_index + 1;
+    for (auto index : registers) {
+        HashTable<u32> taken_registers;
+        for (auto interfering_index : interferences.find(index)->value) {
+            if (auto allocated_register = allocated_registers.get(interfering_index); allocated_register.has_value())
+                taken_registers.set(*allocated_register);
+        }
+
+        Optional<u32> allocated_register;
+        if (auto copied_registers = copies.find(index); copied_registers != copies.end()) {
+            for (auto copied_index : copied_registers->value) {
+                auto copied_register = allocated_registers.get(copied_index);
+                if (copied_register.has_value() && !taken_registers.contains(*copied_register)) {
+                    allocated_register = *copied_register;
+                    break;
+                }
+            }
+        }
+        if (!allocated_register.has_value()) {
+            allocated_register = Register::global_object_index + 1;
+            while (taken_registers.contains(*allocated_register))
+                ++*allocated_register;
+        }
+
+        allocated_registers.set(index, *allocated_register);
+        number_of_registers = max(number_of_registers, *allocated_register + 1);
+    }
+
+    for (auto& block : executable.executable.basic_blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            const_cast<Instruction&>(*it).for_each_register_operand([&](Register& reg, Instruction::RegisterAccess) {
+                if (is_allocatable(reg.index()))
+                    reg = Register(allocated_registers.get(reg.index()).value());
+            });
+        }
+    }
+
+    executable.executable.number_of_registers = number_of_registers;
+
+    finished();
+}
+
+}
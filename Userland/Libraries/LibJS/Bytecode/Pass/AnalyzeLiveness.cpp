@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+void AnalyzeLiveness::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    VERIFY(executable.cfg.has_value());
+    executable.live_registers_at_exit.clear();
+
+    auto& basic_blocks = executable.executable.basic_blocks;
+
+    // FIXME: Any instruction inside a try block may transfer control to its handler, which is not an edge in the CFG.
+    //        Until that is modelled, leave executables with unwind contexts alone.
+    for (auto& block : basic_blocks) {
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            if ((*it).type() == Instruction::Type::EnterUnwindContext) {
+                finished();
+                return;
+            }
+        }
+    }
+
+    // The registers each block reads before writing them, and the registers it writes.
+    HashMap<BasicBlock const*, HashTable<u32>> used_registers;
+    HashMap<BasicBlock const*, HashTable<u32>> defined_registers;
+    for (auto& block : basic_blocks) {
+        auto& used = used_registers.ensure(&block);
+        auto& defined = defined_registers.ensure(&block);
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            for_each_register_read(*it, [&](u32 index) {
+                if (index != Register::global_object_index && !defined.contains(index))
+                    used.set(index);
+            });
+            for_each_register_written(*it, [&](u32 index) {
+                defined.set(index);
+            });
+        }
+    }
+
+    HashMap<BasicBlock const*, HashTable<u32>> live_at_entry;
+    HashMap<BasicBlock const*, HashTable<u32>> live_at_exit;
+    for (auto& block : basic_blocks) {
+        live_at_entry.set(&block, {});
+        live_at_exit.set(&block, {});
+    }
+
+    // Liveness flows backwards, so visiting the blocks in reverse order usually gets us to the fixed point quickly.
+    // The sets only ever grow, so comparing their sizes is enough to tell whether anything changed.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = basic_blocks.size(); i > 0; --i) {
+            auto& block = basic_blocks[i - 1];
+            auto& live_out = live_at_exit.find(&block)->value;
+            if (auto successors = executable.cfg->find(&block); successors != executable.cfg->end()) {
+                for (auto* successor : successors->value) {
+                    for (auto index : live_at_entry.find(successor)->value)
+                        live_out.set(index);
+                }
+            }
+
+            auto& live_in = live_at_entry.find(&block)->value;
+            auto live_in_size = live_in.size();
+            for (auto index : used_registers.find(&block)->value)
+                live_in.set(index);
+            auto& defined = defined_registers.find(&block)->value;
+            for (auto index : live_out) {
+                if (!defined.contains(index))
+                    live_in.set(index);
+            }
+            if (live_in.size() != live_in_size)
+                changed = true;
+        }
+    }
+
+    executable.live_registers_at_exit = move(live_at_exit);
+
+    finished();
+}
+
+}
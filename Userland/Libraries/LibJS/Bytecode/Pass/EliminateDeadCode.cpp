@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// Instructions that can't throw and have no effect other than writing to a register.
+static bool is_free_of_side_effects(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+    case Instruction::Type::Load:
+    case Instruction::Type::LoadImmediate:
+    case Instruction::Type::Store:
+    case Instruction::Type::NewString:
+    case Instruction::Type::NewObject:
+    case Instruction::Type::NewBigInt:
+    case Instruction::Type::NewFunction:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void EliminateDeadCode::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    if (!executable.live_registers_at_exit.has_value()) {
+        finished();
+        return;
+    }
+    auto live_registers_at_exit = executable.live_registers_at_exit.release_value();
+
+    for (auto& block : executable.executable.basic_blocks) {
+        Vector<Instruction const*> instructions;
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it)
+            instructions.append(&*it);
+
+        auto live_registers = live_registers_at_exit.get(&block).value_or({});
+        HashTable<Instruction const*> dead_instructions;
+
+        for (size_t i = instructions.size(); i > 0; --i) {
+            auto& instruction = *instructions[i - 1];
+            if (is_free_of_side_effects(instruction)) {
+                bool is_result_used = false;
+                AnalyzeLiveness::for_each_register_written(instruction, [&](u32 index) {
+                    if (live_registers.contains(index))
+                        is_result_used = true;
+                });
+                if (!is_result_used) {
+                    dead_instructions.set(&instruction);
+                    continue;
+                }
+            }
+
+            AnalyzeLiveness::for_each_register_written(instruction, [&](u32 index) {
+                live_registers.remove(index);
+            });
+            AnalyzeLiveness::for_each_register_read(instruction, [&](u32 index) {
+                live_registers.set(index);
+            });
+        }
+
+        if (!dead_instructions.is_empty())
+            block.remove_instructions([&](auto& instruction) { return dead_instructions.contains(&instruction); });
+    }
+
+    finished();
+}
+
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+static Optional<Value> fold_binary_operation(Instruction::Type type, Value lhs, Value rhs)
+{
+    // NOTE: Only numbers are folded, since operations on them can't have side effects or throw.
+    if (!lhs.is_number() || !rhs.is_number())
+        return {};
+
+    switch (type) {
+    case Instruction::Type::Add:
+        return Value(lhs.as_double() + rhs.as_double());
+    case Instruction::Type::Sub:
+        return Value(lhs.as_double() - rhs.as_double());
+    case Instruction::Type::Mul:
+        return Value(lhs.as_double() * rhs.as_double());
+    case Instruction::Type::Div:
+        return Value(lhs.as_double() / rhs.as_double());
+    case Instruction::Type::LessThan:
+        return Value(lhs.as_double() < rhs.as_double());
+    case Instruction::Type::LessThanEquals:
+        return Value(lhs.as_double() <= rhs.as_double());
+    case Instruction::Type::GreaterThan:
+        return Value(lhs.as_double() > rhs.as_double());
+    case Instruction::Type::GreaterThanEquals:
+        return Value(lhs.as_double() >= rhs.as_double());
+    case Instruction::Type::LooselyEquals:
+    case Instruction::Type::StrictlyEquals:
+        return Value(lhs.as_double() == rhs.as_double());
+    case Instruction::Type::LooselyInequals:
+    case Instruction::Type::StrictlyInequals:
+        return Value(lhs.as_double() != rhs.as_double());
+    default:
+        break;
+    }
+
+    if (lhs.type() != Value::Type::Int32 || rhs.type() != Value::Type::Int32)
+        return {};
+
+    switch (type) {
+    case Instruction::Type::BitwiseAnd:
+        return Value(lhs.as_i32() & rhs.as_i32());
+    case Instruction::Type::BitwiseOr:
+        return Value(lhs.as_i32() | rhs.as_i32());
+    case Instruction::Type::BitwiseXor:
+        return Value(lhs.as_i32() ^ rhs.as_i32());
+    default:
+        return {};
+    }
+}
+
+static Optional<Value> fold_unary_operation(Instruction::Type type, Value value)
+{
+    switch (type) {
+    case Instruction::Type::Not:
+        if (value.is_number() || value.is_boolean() || value.is_nullish())
+            return Value(!value.to_boolean());
+        return {};
+    case Instruction::Type::UnaryPlus:
+        if (value.is_number())
+            return value;
+        return {};
+    case Instruction::Type::UnaryMinus:
+        if (value.is_number())
+            return value.is_nan() ? js_nan() : Value(-value.as_double());
+        return {};
+    case Instruction::Type::BitwiseNot:
+        if (value.type() == Value::Type::Int32)
+            return Value(~value.as_i32());
+        return {};
+    default:
+        return {};
+    }
+}
+
+static void replace_immediate(Instruction& instruction, Value value)
+{
+    VERIFY(instruction.type() == Instruction::Type::LoadImmediate);
+    Instruction::destroy(instruction);
+    new (&instruction) Op::LoadImmediate(value);
+}
+
+void Peephole::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    for (auto& block : executable.executable.basic_blocks) {
+        HashTable<Instruction const*> removed_instructions;
+        Vector<Instruction*> kept_instructions;
+        // A register that is known to hold the same value as the accumulator.
+        Optional<u32> register_in_accumulator;
+
+        for (InstructionStreamIterator it { block.instruction_stream() }; !it.at_end(); ++it) {
+            auto& instruction = const_cast<Instruction&>(*it);
+            auto remove_instruction = [&] { removed_instructions.set(&instruction); };
+
+            if (instruction.type() == Instruction::Type::Load || instruction.type() == Instruction::Type::Store) {
+                auto reg = instruction.type() == Instruction::Type::Load
+                    ? static_cast<Op::Load const&>(instruction).src()
+                    : static_cast<Op::Store const&>(instruction).dst();
+                // Loading a register into the accumulator, or storing the accumulator into a register, is redundant if they already hold the same value.
+                if (register_in_accumulator == reg.index()) {
+                    remove_instruction();
+                    continue;
+                }
+                kept_instructions.append(&instruction);
+                register_in_accumulator = reg.index();
+                continue;
+            }
+
+            auto previous_instruction = [&](size_t distance) -> Instruction* {
+                if (kept_instructions.size() < distance)
+                    return nullptr;
+                return kept_instructions[kept_instructions.size() - distance];
+            };
+            auto* previous = previous_instruction(1);
+
+            // LoadImmediate a; Store $x; LoadImmediate b; Add $x => LoadImmediate a; Store $x; LoadImmediate (a + b)
+            // The Store will usually turn out to be dead and be removed later on.
+            if (previous && previous->type() == Instruction::Type::LoadImmediate) {
+                auto* store = previous_instruction(2);
+                auto* lhs = previous_instruction(3);
+                Optional<Value> folded_value;
+                if (store && lhs && store->type() == Instruction::Type::Store && lhs->type() == Instruction::Type::LoadImmediate) {
+                    auto lhs_register = static_cast<Op::Store const&>(*store).dst();
+                    auto lhs_value = static_cast<Op::LoadImmediate const&>(*lhs).value();
+                    auto rhs_value = static_cast<Op::LoadImmediate const&>(*previous).value();
+                    switch (instruction.type()) {
+#define __BYTECODE_OP(OpTitleCase, ...)                                                             \
+    case Instruction::Type::OpTitleCase:                                                            \
+        if (static_cast<Op::OpTitleCase const&>(instruction).lhs().index() == lhs_register.index()) \
+            folded_value = fold_binary_operation(instruction.type(), lhs_value, rhs_value);         \
+        break;
+                        JS_ENUMERATE_COMMON_BINARY_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+                    default:
+                        break;
+                    }
+                }
+                if (!folded_value.has_value())
+                    folded_value = fold_unary_operation(instruction.type(), static_cast<Op::LoadImmediate const&>(*previous).value());
+
+                if (folded_value.has_value()) {
+                    replace_immediate(*previous, *folded_value);
+                    remove_instruction();
+                    continue;
+                }
+            }
+
+            kept_instructions.append(&instruction);
+            if (instruction.writes_accumulator()) {
+                register_in_accumulator = {};
+                continue;
+            }
+            AnalyzeLiveness::for_each_register_written(instruction, [&](u32 index) {
+                if (register_in_accumulator == index)
+                    register_in_accumulator = {};
+            });
+        }
+
+        if (!removed_instructions.is_empty())
+            block.remove_instructions([&](auto& instruction) { return removed_instructions.contains(&instruction); });
+    }
+
+    finished();
+}
+
+}
@@ -18,6 +18,8 @@ struct PassPipelineExecutable {
     Optional<HashMap<BasicBlock const*, HashTable<BasicBlock const*>>> cfg {};
     Optional<HashMap<BasicBlock const*, HashTable<BasicBlock const*>>> inverted_cfg {};
     Optional<HashTable<BasicBlock const*>> exported_blocks {};
+    // The registers that are live when leaving each block, with the accumulator counted as register 0.
+    Optional<HashMap<BasicBlock const*, HashTable<u32>>> live_registers_at_exit {};
 };
 
 class Pass {
@@ -121,6 +123,65 @@ private:
     virtual void perform(PassPipelineExecutable&) override;
 };
 
+class Peephole : public Pass {
+public:
+    Peephole() = default;
+    ~Peephole() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+class AnalyzeLiveness : public Pass {
+public:
+    AnalyzeLiveness() = default;
+    ~AnalyzeLiveness() override = default;
+
+    // Calls the callback with the index of every register the instruction reads, or writes, counting the accumulator as register 0.
+    template<typename Callback>
+    static void for_each_register_read(Instruction const& instruction, Callback callback)
+    {
+        if (instruction.reads_accumulator())
+            callback(Register::accumulator_index);
+        const_cast<Instruction&>(instruction).for_each_register_operand([&](Register& reg, Instruction::RegisterAccess access) {
+            if (access != Instruction::RegisterAccess::Write)
+                callback(reg.index());
+        });
+    }
+
+    template<typename Callback>
+    static void for_each_register_written(Instruction const& instruction, Callback callback)
+    {
+        if (instruction.writes_accumulator())
+            callback(Register::accumulator_index);
+        const_cast<Instruction&>(instruction).for_each_register_operand([&](Register& reg, Instruction::RegisterAccess access) {
+            if (access != Instruction::RegisterAccess::Read)
+                callback(reg.index());
+        });
+    }
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+class EliminateDeadCode : public Pass {
+public:
+    EliminateDeadCode() = default;
+    ~EliminateDeadCode() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+class AllocateRegisters : public Pass {
+public:
+    AllocateRegisters() = default;
+    ~AllocateRegisters() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
 class DumpCFG : public Pass {
 public:
     DumpCFG(FILE* file)
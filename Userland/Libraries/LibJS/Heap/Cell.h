@@ -9,6 +9,7 @@
 #include <AK/Format.h>
 #include <AK/Forward.h>
 #include <AK/Noncopyable.h>
+#include <AK/Platform.h>
 #include <LibJS/Forward.h>
 
 namespace JS {
@@ -24,6 +25,42 @@ public:
     bool is_marked() const { return m_mark; }
     void set_marked(bool b) { m_mark = b; }
 
+    // Cells that have survived a garbage collection are in the old generation, and are only
+    // looked at again by full collections (or when they are in the remembered set).
+    bool is_old() const { return m_old; }
+    void set_old(bool b) { m_old = b; }
+
+    bool is_remembered() const { return m_remembered; }
+    void set_remembered(bool b) { m_remembered = b; }
+
+    bool has_write_barriers() const { return m_has_write_barriers; }
+    void set_has_write_barriers(bool b) { m_has_write_barriers = b; }
+
+    // The write barrier: Classes that declare cell_has_write_barriers must call this after storing
+    // a pointer to another cell in an existing cell, so that young cells which are only reachable
+    // from old ones survive young generation collections, and so that incremental marking doesn't
+    // miss cells that are stored in cells it has already marked.
+    ALWAYS_INLINE void did_store_edge(Cell* cell)
+    {
+        if (!cell)
+            return;
+        if (m_old && !m_remembered && !cell->m_old)
+            remember();
+        // NOTE: Cells are only marked outside of a collection while incremental marking is in progress.
+        if (m_mark && !cell->m_mark)
+            shade(*cell);
+    }
+    void did_store_edge(Value);
+
+    // Like did_store_edge(), for when the stored cells aren't known.
+    ALWAYS_INLINE void did_store_unknown_edges()
+    {
+        if (m_old && !m_remembered)
+            remember();
+        if (m_mark)
+            revisit();
+    }
+
     enum class State {
         Live,
         Dead,
@@ -58,10 +95,25 @@ protected:
     Cell() { }
 
 private:
+    void remember();
+    void shade(Cell&);
+    void revisit();
+
     bool m_mark : 1 { false };
-    State m_state : 7 { State::Live };
+    bool m_old : 1 { false };
+    bool m_remembered : 1 { false };
+    bool m_has_write_barriers : 1 { false };
+    State m_state : 4 { State::Live };
 };
 
+// Cells of classes for which this is false are put in the remembered set for good once they are
+// old, which is always safe. It must only be specialized to true for classes whose every store of
+// a cell pointer after construction (including those made by their base classes) is followed by
+// a call to Cell::did_store_edge() or Cell::did_store_unknown_edges().
+// NOTE: This is deliberately not inherited, as subclasses usually have edges of their own.
+template<typename T>
+inline constexpr bool cell_has_write_barriers = false;
+
 }
 
 template<>
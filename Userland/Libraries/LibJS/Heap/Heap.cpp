@@ -67,19 +67,32 @@ ALWAYS_INLINE CellAllocator& Heap::allocator_for_size(size_t cell_size)
     VERIFY_NOT_REACHED();
 }
 
+static constexpr size_t allocations_between_incremental_marking_steps = 1000;
+static constexpr size_t cells_visited_per_incremental_marking_step = 10000;
+
 Cell* Heap::allocate_cell(size_t size)
 {
     if (should_collect_on_every_allocation()) {
         collect_garbage();
+    } else if (m_incremental_marking_in_progress) {
+        // Young generation collections are put on hold until marking is done, but marking has to
+        // keep ahead of the allocations for that to happen.
+        if (++m_allocations_since_last_marking_step > allocations_between_incremental_marking_steps)
+            perform_incremental_marking_step();
     } else if (m_allocations_since_last_gc > m_max_allocations_between_gc) {
         m_allocations_since_last_gc = 0;
-        collect_garbage();
+        if (m_promotions_since_last_full_gc > m_max_promotions_between_full_gc && !m_gc_deferrals)
+            start_incremental_marking();
+        else
+            collect_garbage(CollectionType::CollectYoungGeneration);
     } else {
         ++m_allocations_since_last_gc;
     }
 
     auto& allocator = allocator_for_size(size);
-    return allocator.allocate_cell(*this);
+    auto* cell = allocator.allocate_cell(*this);
+    m_young_cells.append(cell);
+    return cell;
 }
 
 void Heap::collect_garbage(CollectionType collection_type, bool print_report)
@@ -92,17 +105,35 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
     perf_event(PERF_EVENT_SIGNPOST, gc_perf_string_id, global_gc_counter++);
 #endif
 
+    auto collection_start_time = Time::now_monotonic();
     auto collection_measurement_timer = Core::ElapsedTimer::start_new();
-    if (collection_type == CollectionType::CollectGarbage) {
+
+    auto pause_type = collection_type == CollectionType::CollectYoungGeneration ? PauseType::YoungGenerationCollection : PauseType::FullCollection;
+    if (collection_type != CollectionType::CollectEverything) {
         if (m_gc_deferrals) {
-            m_should_gc_when_deferral_ends = true;
+            if (!m_collection_when_deferral_ends.has_value() || collection_type == CollectionType::CollectGarbage)
+                m_collection_when_deferral_ends = collection_type;
             return;
         }
-        HashTable<Cell*> roots;
-        gather_roots(roots);
-        mark_live_cells(roots);
+        if (m_incremental_marking_in_progress) {
+            // The full collection that follows will take care of the young generation as well.
+            if (collection_type == CollectionType::CollectYoungGeneration)
+                return;
+            finish_incremental_marking();
+            pause_type = PauseType::FinishIncrementalCollection;
+        } else {
+            HashTable<Cell*> roots;
+            gather_roots(roots);
+            mark_live_cells(roots, collection_type);
+        }
+    } else if (m_incremental_marking_in_progress) {
+        abandon_incremental_marking();
     }
-    sweep_dead_cells(print_report, collection_measurement_timer);
+    sweep_dead_cells(collection_type, print_report, collection_measurement_timer);
+
+    record_pause(pause_type, Time::now_monotonic() - collection_start_time);
+    if (print_report)
+        dump_pause_statistics();
 }
 
 void Heap::gather_roots(HashTable<Cell*>& roots)
@@ -171,36 +202,166 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
     }
 }
 
+// Marks the cells it visits and pushes them onto the mark stack, so that their edges are
+// visited later on by drain(), instead of recursing into them right away.
 class MarkingVisitor final : public Cell::Visitor {
 public:
-    MarkingVisitor() { }
+    MarkingVisitor(Vector<Cell*>& mark_stack, bool only_young_cells)
+        : m_mark_stack(mark_stack)
+        , m_only_young_cells(only_young_cells)
+    {
+    }
 
     virtual void visit_impl(Cell& cell) override
     {
         if (cell.is_marked())
             return;
+        if (m_only_young_cells && cell.is_old())
+            return;
         dbgln_if(HEAP_DEBUG, "  ! {}", &cell);
 
         cell.set_marked(true);
-        cell.visit_edges(*this);
+        m_mark_stack.append(&cell);
     }
+
+    // Returns whether the mark stack was emptied before the budget ran out.
+    bool drain(Optional<size_t> budget = {})
+    {
+        size_t visited_cells = 0;
+        while (!m_mark_stack.is_empty()) {
+            if (budget.has_value() && visited_cells++ >= *budget)
+                return false;
+            m_mark_stack.take_last()->visit_edges(*this);
+        }
+        return true;
+    }
+
+private:
+    Vector<Cell*>& m_mark_stack;
+    bool m_only_young_cells { false };
 };
 
-void Heap::mark_live_cells(const HashTable<Cell*>& roots)
+void Heap::mark_live_cells(const HashTable<Cell*>& roots, CollectionType collection_type)
 {
     dbgln_if(HEAP_DEBUG, "mark_live_cells:");
 
-    MarkingVisitor visitor;
+    MarkingVisitor visitor(m_mark_stack, collection_type == CollectionType::CollectYoungGeneration);
     for (auto* root : roots)
         visitor.visit(root);
 
+    if (collection_type == CollectionType::CollectYoungGeneration) {
+        // Old cells aren't traced through, so the ones that may point to young cells act as roots.
+        for (auto* cell : m_remembered_cells)
+            cell->visit_edges(visitor);
+        for (auto* cell : m_old_cells_without_write_barriers)
+            cell->visit_edges(visitor);
+    }
+
+    visitor.drain();
+
     for (auto& inverse_root : m_uprooted_cells)
         inverse_root->set_marked(false);
 
     m_uprooted_cells.clear();
 }
 
-void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measurement_timer)
+void Heap::start_incremental_marking()
+{
+    VERIFY(!m_incremental_marking_in_progress);
+    VERIFY(!m_collecting_garbage);
+    TemporaryChange change(m_collecting_garbage, true);
+
+    auto step_start_time = Time::now_monotonic();
+
+    dbgln_if(HEAP_DEBUG, "start_incremental_marking:");
+    m_incremental_marking_in_progress = true;
+    m_allocations_since_last_marking_step = 0;
+
+    HashTable<Cell*> roots;
+    gather_roots(roots);
+
+    MarkingVisitor visitor(m_mark_stack, false);
+    for (auto* root : roots)
+        visitor.visit(root);
+
+    record_pause(PauseType::IncrementalMarkingStep, Time::now_monotonic() - step_start_time);
+}
+
+void Heap::perform_incremental_marking_step()
+{
+    if (!m_incremental_marking_in_progress || m_collecting_garbage)
+        return;
+
+    m_allocations_since_last_marking_step = 0;
+
+    bool done = false;
+    {
+        TemporaryChange change(m_collecting_garbage, true);
+
+        auto step_start_time = Time::now_monotonic();
+
+        MarkingVisitor visitor(m_mark_stack, false);
+        done = visitor.drain(cells_visited_per_incremental_marking_step);
+
+        record_pause(PauseType::IncrementalMarkingStep, Time::now_monotonic() - step_start_time);
+    }
+
+    if (done)
+        collect_garbage();
+}
+
+void Heap::finish_incremental_marking()
+{
+    dbgln_if(HEAP_DEBUG, "finish_incremental_marking:");
+
+    MarkingVisitor visitor(m_mark_stack, false);
+
+    // Cells may have been allocated or become roots since marking started.
+    HashTable<Cell*> roots;
+    gather_roots(roots);
+    for (auto* root : roots)
+        visitor.visit(root);
+
+    // Stores into these cells didn't go through a write barrier, so any of their edges may be new.
+    for (auto* cell : m_cells_to_revisit)
+        cell->visit_edges(visitor);
+    for (auto* cell : m_old_cells_without_write_barriers) {
+        if (cell->is_marked())
+            cell->visit_edges(visitor);
+    }
+    for (auto* cell : m_young_cells) {
+        if (cell->is_marked() && !cell->has_write_barriers())
+            cell->visit_edges(visitor);
+    }
+
+    visitor.drain();
+
+    m_incremental_marking_in_progress = false;
+    m_cells_to_revisit.clear();
+
+    for (auto& inverse_root : m_uprooted_cells)
+        inverse_root->set_marked(false);
+
+    m_uprooted_cells.clear();
+}
+
+void Heap::abandon_incremental_marking()
+{
+    dbgln_if(HEAP_DEBUG, "abandon_incremental_marking:");
+
+    for_each_block([&](auto& block) {
+        block.template for_each_cell_in_state<Cell::State::Live>([](Cell* cell) {
+            cell->set_marked(false);
+        });
+        return IterationDecision::Continue;
+    });
+
+    m_incremental_marking_in_progress = false;
+    m_mark_stack.clear();
+    m_cells_to_revisit.clear();
+}
+
+void Heap::sweep_dead_cells(CollectionType collection_type, bool print_report, const Core::ElapsedTimer& measurement_timer)
 {
     dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
     Vector<HeapBlock*, 32> empty_blocks;
@@ -211,28 +372,66 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
     size_t collected_cell_bytes = 0;
     size_t live_cell_bytes = 0;
 
-    for_each_block([&](auto& block) {
-        bool block_has_live_cells = false;
-        bool block_was_full = block.is_full();
-        block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
-            if (!cell->is_marked()) {
-                dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
-                block.deallocate(cell);
-                ++collected_cells;
-                collected_cell_bytes += block.cell_size();
-            } else {
-                cell->set_marked(false);
-                block_has_live_cells = true;
-                ++live_cells;
-                live_cell_bytes += block.cell_size();
-            }
+    for (auto* cell : m_remembered_cells)
+        cell->set_remembered(false);
+    m_remembered_cells.clear_with_capacity();
+
+    // Returns whether the cell survived, in which case it is now in the old generation.
+    auto sweep_cell = [&](HeapBlock& block, Cell* cell) {
+        if (!cell->is_marked()) {
+            dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
+            block.deallocate(cell);
+            ++collected_cells;
+            collected_cell_bytes += block.cell_size();
+            return false;
+        }
+        cell->set_marked(false);
+        if (!cell->is_old()) {
+            cell->set_old(true);
+            ++m_promotions_since_last_full_gc;
+        }
+        if (!cell->has_write_barriers()) {
+            cell->set_remembered(true);
+            m_old_cells_without_write_barriers.append(cell);
+        } else {
+            // NOTE: A cell whose constructor allocated may have been promoted before it was known to have write barriers,
+            //       in which case it was treated like a cell without them until now.
+            cell->set_remembered(false);
+        }
+        ++live_cells;
+        live_cell_bytes += block.cell_size();
+        return true;
+    };
+
+    if (collection_type == CollectionType::CollectYoungGeneration) {
+        // Only young cells can have died, so we don't have to look at any other cells.
+        // NOTE: Blocks that become empty here are left to be reused by the allocator, and are only
+        //       given back by the next full collection. Finding them would mean visiting old cells.
+        for (auto* cell : m_young_cells) {
+            auto& block = *HeapBlock::from_cell(cell);
+            bool block_was_full = block.is_full();
+            if (!sweep_cell(block, cell) && block_was_full)
+                full_blocks_that_became_usable.append(&block);
+        }
+    } else {
+        m_old_cells_without_write_barriers.clear_with_capacity();
+        for_each_block([&](auto& block) {
+            bool block_has_live_cells = false;
+            bool block_was_full = block.is_full();
+            block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+                if (sweep_cell(block, cell))
+                    block_has_live_cells = true;
+            });
+            if (!block_has_live_cells)
+                empty_blocks.append(&block);
+            else if (block_was_full != block.is_full())
+                full_blocks_that_became_usable.append(&block);
+            return IterationDecision::Continue;
         });
-        if (!block_has_live_cells)
-            empty_blocks.append(&block);
-        else if (block_was_full != block.is_full())
-            full_blocks_that_became_usable.append(&block);
-        return IterationDecision::Continue;
-    });
+        m_promotions_since_last_full_gc = 0;
+        m_max_promotions_between_full_gc = max(m_max_allocations_between_gc, live_cells);
+    }
+    m_young_cells.clear_with_capacity();
 
     for (auto& weak_container : m_weak_containers)
         weak_container.remove_dead_cells({});
@@ -263,7 +462,7 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
             return IterationDecision::Continue;
         });
 
-        dbgln("Garbage collection report");
+        dbgln("Garbage collection report ({})", collection_type == CollectionType::CollectYoungGeneration ? "young generation" : "full");
         dbgln("=============================================");
         dbgln("     Time spent: {} ms", time_spent);
         dbgln("     Live cells: {} ({} bytes)", live_cells, live_cell_bytes);
@@ -321,9 +520,10 @@ void Heap::undefer_gc(Badge<DeferGC>)
     --m_gc_deferrals;
 
     if (!m_gc_deferrals) {
-        if (m_should_gc_when_deferral_ends)
-            collect_garbage();
-        m_should_gc_when_deferral_ends = false;
+        if (auto collection_type = m_collection_when_deferral_ends; collection_type.has_value()) {
+            m_collection_when_deferral_ends.clear();
+            collect_garbage(*collection_type);
+        }
     }
 }
 
@@ -332,4 +532,85 @@ void Heap::uproot_cell(Cell* cell)
     m_uprooted_cells.append(cell);
 }
 
+void Heap::remember_cell(Badge<Cell>, Cell& cell)
+{
+    VERIFY(cell.is_old());
+    VERIFY(!cell.is_remembered());
+    cell.set_remembered(true);
+    m_remembered_cells.append(&cell);
+}
+
+void Heap::shade_cell(Badge<Cell>, Cell& cell)
+{
+    if (!m_incremental_marking_in_progress)
+        return;
+    VERIFY(!cell.is_marked());
+    cell.set_marked(true);
+    m_mark_stack.append(&cell);
+}
+
+void Heap::revisit_cell(Badge<Cell>, Cell& cell)
+{
+    if (!m_incremental_marking_in_progress)
+        return;
+    m_cells_to_revisit.set(&cell);
+}
+
+void Heap::record_pause(PauseType type, Time duration)
+{
+    auto& statistics = m_pause_statistics[to_underlying(type)];
+    ++statistics.count;
+    statistics.total_duration += duration;
+    statistics.longest_duration = max(statistics.longest_duration, duration);
+}
+
+static StringView pause_type_name(Heap::PauseType type)
+{
+    switch (type) {
+    case Heap::PauseType::YoungGenerationCollection:
+        return "Young generation collection"sv;
+    case Heap::PauseType::FullCollection:
+        return "Full collection"sv;
+    case Heap::PauseType::IncrementalMarkingStep:
+        return "Incremental marking step"sv;
+    case Heap::PauseType::FinishIncrementalCollection:
+        return "Finish incremental collection"sv;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+void Heap::dump_pause_statistics() const
+{
+    dbgln("Garbage collection pauses");
+    dbgln("=============================================");
+    for (size_t i = 0; i < m_pause_statistics.size(); ++i) {
+        auto& statistics = m_pause_statistics[i];
+        if (!statistics.count)
+            continue;
+        dbgln("{}: {} pauses, {} us total, {} us average, {} us longest",
+            pause_type_name(static_cast<PauseType>(i)),
+            statistics.count,
+            statistics.total_duration.to_microseconds(),
+            statistics.total_duration.to_microseconds() / static_cast<i64>(statistics.count),
+            statistics.longest_duration.to_microseconds());
+    }
+    dbgln("=============================================");
+}
+
+void Cell::remember()
+{
+    heap().remember_cell({}, *this);
+}
+
+void Cell::shade(Cell& cell)
+{
+    heap().shade_cell({}, cell);
+}
+
+void Cell::revisit()
+{
+    heap().revisit_cell({}, *this);
+}
+
 }
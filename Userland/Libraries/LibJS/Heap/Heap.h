@@ -6,11 +6,15 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/Badge.h>
 #include <AK/HashTable.h>
 #include <AK/IntrusiveList.h>
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Time.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCore/Forward.h>
@@ -38,7 +42,9 @@ public:
     {
         auto* memory = allocate_cell(sizeof(T));
         new (memory) T(forward<Args>(args)...);
-        return static_cast<T*>(memory);
+        auto* cell = static_cast<T*>(memory);
+        did_construct_cell(cell);
+        return cell;
     }
 
     template<typename T, typename... Args>
@@ -47,17 +53,42 @@ public:
         auto* memory = allocate_cell(sizeof(T));
         new (memory) T(forward<Args>(args)...);
         auto* cell = static_cast<T*>(memory);
+        did_construct_cell(cell);
         cell->initialize(global_object);
         return cell;
     }
 
     enum class CollectionType {
         CollectGarbage,
+        CollectYoungGeneration,
         CollectEverything,
     };
 
     void collect_garbage(CollectionType = CollectionType::CollectGarbage, bool print_report = false);
 
+    // Full collections started by the allocator mark the heap incrementally, a little at a time,
+    // and only pause for the final marking and the sweep. Marking steps are taken every so many
+    // allocations, but embedders can also take them whenever they're idle.
+    bool is_incremental_marking_in_progress() const { return m_incremental_marking_in_progress; }
+    void perform_incremental_marking_step();
+
+    enum class PauseType {
+        YoungGenerationCollection,
+        FullCollection,
+        IncrementalMarkingStep,
+        FinishIncrementalCollection,
+        __Count,
+    };
+
+    struct PauseStatistics {
+        size_t count { 0 };
+        Time total_duration;
+        Time longest_duration;
+    };
+
+    PauseStatistics const& pause_statistics(PauseType type) const { return m_pause_statistics[to_underlying(type)]; }
+    void dump_pause_statistics() const;
+
     VM& vm() { return m_vm; }
 
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
@@ -79,13 +110,29 @@ public:
 
     void uproot_cell(Cell* cell);
 
+    void remember_cell(Badge<Cell>, Cell&);
+    void shade_cell(Badge<Cell>, Cell&);
+    void revisit_cell(Badge<Cell>, Cell&);
+
 private:
     Cell* allocate_cell(size_t);
 
+    template<typename T>
+    void did_construct_cell(T* cell)
+    {
+        if constexpr (IsBaseOf<Object, T>)
+            cell->set_has_ordinary_property_access({}, T::template has_ordinary_property_access_methods<T>);
+        cell->set_has_write_barriers(cell_has_write_barriers<T>);
+    }
+
     void gather_roots(HashTable<Cell*>&);
     void gather_conservative_roots(HashTable<Cell*>&);
-    void mark_live_cells(const HashTable<Cell*>& live_cells);
-    void sweep_dead_cells(bool print_report, const Core::ElapsedTimer&);
+    void mark_live_cells(const HashTable<Cell*>& live_cells, CollectionType);
+    void start_incremental_marking();
+    void finish_incremental_marking();
+    void abandon_incremental_marking();
+    void record_pause(PauseType, Time);
+    void sweep_dead_cells(CollectionType, bool print_report, const Core::ElapsedTimer&);
 
     CellAllocator& allocator_for_size(size_t);
 
@@ -101,6 +148,33 @@ private:
     size_t m_max_allocations_between_gc { 100000 };
     size_t m_allocations_since_last_gc { 0 };
 
+    // Every cell allocated since the last collection. These are the only cells that a young
+    // generation collection may free.
+    Vector<Cell*> m_young_cells;
+
+    // Old cells that may have had a young cell stored in them since the last collection.
+    Vector<Cell*> m_remembered_cells;
+
+    // Old cells of classes without write barriers, which are remembered until they die.
+    Vector<Cell*> m_old_cells_without_write_barriers;
+
+    // Once this many cells have been promoted since the last full collection, the next collection
+    // is a full one. This grows with the amount of memory that survived the last full collection.
+    size_t m_max_promotions_between_full_gc { 100000 };
+    size_t m_promotions_since_last_full_gc { 0 };
+
+    // Cells that have been marked, but whose edges haven't been visited yet.
+    Vector<Cell*> m_mark_stack;
+
+    bool m_incremental_marking_in_progress { false };
+    size_t m_allocations_since_last_marking_step { 0 };
+
+    // Cells whose edges have to be visited again when incremental marking finishes, because they
+    // may have changed without going through the write barrier.
+    HashTable<Cell*> m_cells_to_revisit;
+
+    AK::Array<PauseStatistics, to_underlying(PauseType::__Count)> m_pause_statistics;
+
     bool m_should_collect_on_every_allocation { false };
 
     VM& m_vm;
@@ -116,7 +190,7 @@ private:
     BlockAllocator m_block_allocator;
 
     size_t m_gc_deferrals { 0 };
-    bool m_should_gc_when_deferral_ends { false };
+    Optional<CollectionType> m_collection_when_deferral_ends;
 
     bool m_collecting_garbage { false };
 };
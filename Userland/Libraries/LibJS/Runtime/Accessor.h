@@ -26,10 +26,18 @@ public:
     }
 
     FunctionObject* getter() const { return m_getter; }
-    void set_getter(FunctionObject* getter) { m_getter = getter; }
+    void set_getter(FunctionObject* getter)
+    {
+        m_getter = getter;
+        did_store_edge(getter);
+    }
 
     FunctionObject* setter() const { return m_setter; }
-    void set_setter(FunctionObject* setter) { m_setter = setter; }
+    void set_setter(FunctionObject* setter)
+    {
+        m_setter = setter;
+        did_store_edge(setter);
+    }
 
     void visit_edges(Cell::Visitor& visitor) override
     {
@@ -44,4 +52,7 @@ private:
     FunctionObject* m_setter { nullptr };
 };
 
+template<>
+inline constexpr bool cell_has_write_barriers<Accessor> = true;
+
 }
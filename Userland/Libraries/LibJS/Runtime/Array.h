@@ -50,4 +50,7 @@ private:
     bool m_length_writable { true };
 };
 
+template<>
+inline constexpr bool cell_has_write_barriers<Array> = true;
+
 }
@@ -25,6 +25,9 @@ private:
     Crypto::SignedBigInteger m_big_integer;
 };
 
+template<>
+inline constexpr bool cell_has_write_barriers<BigInt> = true;
+
 BigInt* js_bigint(Heap&, Crypto::SignedBigInteger);
 BigInt* js_bigint(VM&, Crypto::SignedBigInteger);
 ThrowCompletionOr<BigInt*> number_to_bigint(GlobalObject&, Value);
@@ -434,7 +434,7 @@ ThrowCompletionOr<void> ECMAScriptFunctionObject::function_declaration_instantia
                 if (parameter.is_rest) {
                     auto* array = MUST(Array::create(global_object(), 0));
                     for (size_t rest_index = i; rest_index < execution_context_arguments.size(); ++rest_index)
-                        array->indexed_properties().append(execution_context_arguments[rest_index]);
+                        array->indexed_properties_append(execution_context_arguments[rest_index]);
                     argument_value = array;
                 } else if (i < execution_context_arguments.size() && !execution_context_arguments[i].is_undefined()) {
                     argument_value = execution_context_arguments[i];
@@ -497,6 +497,7 @@ ThrowCompletionOr<void> Object::private_field_add(PrivateName const& name, Value
     if (!m_private_elements)
         m_private_elements = make<Vector<PrivateElement>>();
     m_private_elements->empend(name, PrivateElement::Kind::Field, value);
+    did_store_edge(value);
     return {};
 }
 
@@ -508,7 +509,9 @@ ThrowCompletionOr<void> Object::private_method_or_accessor_add(PrivateElement el
         return vm().throw_completion<TypeError>(global_object(), ErrorType::PrivateFieldAlreadyDeclared, element.key.description);
     if (!m_private_elements)
         m_private_elements = make<Vector<PrivateElement>>();
+    auto value = element.value;
     m_private_elements->append(move(element));
+    did_store_edge(value);
     return {};
 }
 
@@ -542,6 +545,7 @@ ThrowCompletionOr<void> Object::private_set(PrivateName const& name, Value value
 
     if (entry->kind == PrivateElement::Kind::Field) {
         entry->value = value;
+        did_store_edge(value);
         return {};
     } else if (entry->kind == PrivateElement::Kind::Method) {
         return vm().throw_completion<TypeError>(global_object(), ErrorType::PrivateFieldSetMethod, name.description);
@@ -990,6 +994,7 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
     if (property_key.is_number()) {
         auto index = property_key.as_number();
         m_indexed_properties.put(index, value, attributes);
+        did_store_edge(value);
         return;
     }
 
@@ -1009,6 +1014,7 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
             set_shape(*m_shape->create_put_transition(property_key_string_or_symbol, attributes));
 
         m_storage.append(value);
+        did_store_edge(value);
         return;
     }
 
@@ -1020,6 +1026,7 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
     }
 
     m_storage[metadata->offset] = value;
+    did_store_edge(value);
 }
 
 void Object::storage_delete(PropertyKey const& property_key)
@@ -1047,7 +1054,7 @@ void Object::set_prototype(Object* new_prototype)
     if (shape.is_unique())
         shape.set_prototype_without_transition(new_prototype);
     else
-        m_shape = shape.create_prototype_transition(new_prototype);
+        set_shape(*shape.create_prototype_transition(new_prototype));
 }
 
 void Object::define_native_accessor(PropertyKey const& property_key, Function<ThrowCompletionOr<Value>(VM&, GlobalObject&)> getter, Function<ThrowCompletionOr<Value>(VM&, GlobalObject&)> setter, PropertyAttributes attribute)
@@ -1083,7 +1090,7 @@ void Object::ensure_shape_is_unique()
     if (shape().is_unique())
         return;
 
-    m_shape = m_shape->create_unique_clone();
+    set_shape(*m_shape->create_unique_clone());
 }
 
 // Simple side-effect free property lookup, following the prototype chain. Non-standard.
@@ -170,10 +170,30 @@ public:
     virtual void visit_edges(Cell::Visitor&) override;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value)
+    {
+        m_storage[index] = value;
+        did_store_edge(value);
+    }
 
     const IndexedProperties& indexed_properties() const { return m_indexed_properties; }
+    // NOTE: Values stored through this reference bypass the write barrier, use the helpers below to store them.
     IndexedProperties& indexed_properties() { return m_indexed_properties; }
-    void set_indexed_property_elements(Vector<Value>&& values) { m_indexed_properties = IndexedProperties(move(values)); }
+    void indexed_properties_put(u32 index, Value value, PropertyAttributes attributes = default_attributes)
+    {
+        m_indexed_properties.put(index, value, attributes);
+        did_store_edge(value);
+    }
+    void indexed_properties_append(Value value)
+    {
+        m_indexed_properties.append(value);
+        did_store_edge(value);
+    }
+    void set_indexed_property_elements(Vector<Value>&& values)
+    {
+        m_indexed_properties = IndexedProperties(move(values));
+        did_store_unknown_edges();
+    }
 
     Shape& shape() { return *m_shape; }
     Shape const& shape() const { return *m_shape; }
@@ -182,6 +202,22 @@ public:
 
     void ensure_shape_is_unique();
 
+    // Objects whose class doesn't override the internal methods involved in getting and setting
+    // properties store all of their named properties at the offsets given by their shape, which
+    // lets the bytecode interpreter cache property lookups on them.
+    template<typename T>
+    static constexpr bool has_ordinary_property_access_methods = requires {
+        // NOTE: Private overrides can't be named here, which makes this false just like other overrides.
+        requires IsSame<decltype(&T::internal_get_prototype_of), decltype(&Object::internal_get_prototype_of)>;
+        requires IsSame<decltype(&T::internal_get_own_property), decltype(&Object::internal_get_own_property)>;
+        requires IsSame<decltype(&T::internal_define_own_property), decltype(&Object::internal_define_own_property)>;
+        requires IsSame<decltype(&T::internal_get), decltype(&Object::internal_get)>;
+        requires IsSame<decltype(&T::internal_set), decltype(&Object::internal_set)>;
+    };
+
+    bool has_ordinary_property_access() const { return m_has_ordinary_property_access; }
+    void set_has_ordinary_property_access(Badge<Heap>, bool value) { m_has_ordinary_property_access = value; }
+
     template<typename T>
     bool fast_is() const = delete;
 
@@ -200,7 +236,13 @@ protected:
     bool m_has_parameter_map { false };
 
 private:
-    void set_shape(Shape& shape) { m_shape = &shape; }
+    bool m_has_ordinary_property_access { false };
+
+    void set_shape(Shape& shape)
+    {
+        m_shape = &shape;
+        did_store_edge(&shape);
+    }
 
     Object* prototype() { return shape().prototype(); }
     Object const* prototype() const { return shape().prototype(); }
@@ -211,4 +253,7 @@ private:
     OwnPtr<Vector<PrivateElement>> m_private_elements; // [[PrivateElements]]
 };
 
+template<>
+inline constexpr bool cell_has_write_barriers<Object> = true;
+
 }
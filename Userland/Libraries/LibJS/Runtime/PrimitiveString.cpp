@@ -5,6 +5,8 @@
  */
 
 #include <AK/CharacterTypes.h>
+#include <AK/StringBuilder.h>
+#include <AK/Utf8View.h>
 #include <AK/Utf16View.h>
 #include <LibJS/Runtime/AbstractOperations.h>
 #include <LibJS/Runtime/GlobalObject.h>
@@ -27,13 +29,40 @@ PrimitiveString::PrimitiveString(Utf16String string)
 {
 }
 
+PrimitiveString::PrimitiveString(PrimitiveString& lhs, PrimitiveString& rhs)
+    : m_is_rope(true)
+    , m_lhs(&lhs)
+    , m_rhs(&rhs)
+{
+}
+
 PrimitiveString::~PrimitiveString()
 {
     vm().string_cache().remove(m_utf8_string);
 }
 
+void PrimitiveString::visit_edges(Cell::Visitor& visitor)
+{
+    Cell::visit_edges(visitor);
+    if (m_is_rope) {
+        visitor.visit(m_lhs);
+        visitor.visit(m_rhs);
+    }
+}
+
+bool PrimitiveString::is_empty() const
+{
+    // NOTE: Ropes are never made out of empty strings.
+    if (m_is_rope)
+        return false;
+    if (m_has_utf16_string)
+        return m_utf16_string.is_empty();
+    return m_utf8_string.is_empty();
+}
+
 String const& PrimitiveString::string() const
 {
+    resolve_rope_if_needed();
     if (!m_has_utf8_string) {
         m_utf8_string = m_utf16_string.to_utf8();
         m_has_utf8_string = true;
@@ -43,6 +72,7 @@ String const& PrimitiveString::string() const
 
 Utf16String const& PrimitiveString::utf16_string() const
 {
+    resolve_rope_if_needed();
     if (!m_has_utf16_string) {
         m_utf16_string = Utf16String(m_utf8_string);
         m_has_utf16_string = true;
@@ -75,6 +105,105 @@ Optional<Value> PrimitiveString::get(GlobalObject& global_object, PropertyKey co
     return js_string(vm(), str.substring_view(index.as_index(), 1));
 }
 
+// If lhs ends with a high surrogate and rhs starts with a low surrogate, both encoded as UTF-8 on
+// their own, returns the code point they combine into.
+static Optional<u32> surrogate_pair_spanning(StringView lhs, StringView rhs)
+{
+    // Surrogates encoded as UTF-8 are 3 bytes.
+    if ((lhs.length() < 3) || (rhs.length() < 3))
+        return {};
+
+    auto lhs_leading_byte = static_cast<u8>(lhs[lhs.length() - 3]);
+    auto rhs_leading_byte = static_cast<u8>(rhs[0]);
+
+    if ((lhs_leading_byte & 0xf0) != 0xe0)
+        return {};
+    if ((rhs_leading_byte & 0xf0) != 0xe0)
+        return {};
+
+    auto high_surrogate = *Utf8View(lhs.substring_view(lhs.length() - 3)).begin();
+    auto low_surrogate = *Utf8View(rhs).begin();
+
+    if (!Utf16View::is_high_surrogate(high_surrogate) || !Utf16View::is_low_surrogate(low_surrogate))
+        return {};
+
+    return Utf16View::decode_surrogate_pair(high_surrogate, low_surrogate);
+}
+
+// https://tc39.es/ecma262/#string-concatenation
+void PrimitiveString::resolve_rope_if_needed() const
+{
+    if (!m_is_rope)
+        return;
+
+    // Collect the strings at the leaves of the rope, from left to right. Ropes can be very deep
+    // (think `s += x` in a loop), so we don't recurse.
+    Vector<PrimitiveString const*, 16> pieces;
+    Vector<PrimitiveString const*, 16> stack;
+    stack.append(m_rhs);
+    stack.append(m_lhs);
+    bool all_pieces_have_utf16_strings = true;
+    while (!stack.is_empty()) {
+        auto const* current = stack.take_last();
+        if (current->m_is_rope) {
+            stack.append(current->m_rhs);
+            stack.append(current->m_lhs);
+            continue;
+        }
+        if (!current->m_has_utf16_string)
+            all_pieces_have_utf16_strings = false;
+        pieces.append(current);
+    }
+
+    if (all_pieces_have_utf16_strings) {
+        // Surrogates can simply be put next to each other in UTF-16, so there's nothing to convert.
+        size_t length_in_code_units = 0;
+        for (auto const* piece : pieces)
+            length_in_code_units += piece->m_utf16_string.length_in_code_units();
+
+        Vector<u16, 1> combined;
+        combined.ensure_capacity(length_in_code_units);
+        for (auto const* piece : pieces)
+            combined.extend(piece->m_utf16_string.string());
+
+        m_utf16_string = Utf16String(move(combined));
+        m_has_utf16_string = true;
+    } else {
+        size_t length = 0;
+        for (auto const* piece : pieces)
+            length += piece->string().length();
+
+        StringBuilder builder(length);
+        bool skip_leading_low_surrogate = false;
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            auto piece = pieces[i]->string().view();
+            if (skip_leading_low_surrogate) {
+                piece = piece.substring_view(3);
+                skip_leading_low_surrogate = false;
+            }
+
+            // A surrogate pair that was split across two strings has to become a single code point again.
+            if (i + 1 < pieces.size()) {
+                if (auto code_point = surrogate_pair_spanning(piece, pieces[i + 1]->string()); code_point.has_value()) {
+                    builder.append(piece.substring_view(0, piece.length() - 3));
+                    builder.append_code_point(*code_point);
+                    skip_leading_low_surrogate = true;
+                    continue;
+                }
+            }
+
+            builder.append(piece);
+        }
+
+        m_utf8_string = builder.to_string();
+        m_has_utf8_string = true;
+    }
+
+    m_is_rope = false;
+    m_lhs = nullptr;
+    m_rhs = nullptr;
+}
+
 PrimitiveString* js_string(Heap& heap, Utf16View const& view)
 {
     return js_string(heap, Utf16String(view));
@@ -130,4 +259,13 @@ PrimitiveString* js_string(VM& vm, String string)
     return js_string(vm.heap(), move(string));
 }
 
+PrimitiveString* js_rope_string(VM& vm, PrimitiveString& lhs, PrimitiveString& rhs)
+{
+    if (lhs.is_empty())
+        return &rhs;
+    if (rhs.is_empty())
+        return &lhs;
+    return vm.heap().allocate_without_global_object<PrimitiveString>(lhs, rhs);
+}
+
 }
@@ -18,11 +18,14 @@ class PrimitiveString final : public Cell {
 public:
     explicit PrimitiveString(String);
     explicit PrimitiveString(Utf16String);
+    PrimitiveString(PrimitiveString&, PrimitiveString&);
     virtual ~PrimitiveString();
 
     PrimitiveString(PrimitiveString const&) = delete;
     PrimitiveString& operator=(PrimitiveString const&) = delete;
 
+    bool is_empty() const;
+
     String const& string() const;
     bool has_utf8_string() const { return m_has_utf8_string; }
 
@@ -34,6 +37,15 @@ public:
 
 private:
     virtual const char* class_name() const override { return "PrimitiveString"; }
+    virtual void visit_edges(Cell::Visitor&) override;
+
+    void resolve_rope_if_needed() const;
+
+    // A rope is the concatenation of two other strings, which is only put together once its
+    // contents are needed. This keeps repeated concatenation from copying the result every time.
+    mutable bool m_is_rope { false };
+    mutable PrimitiveString* m_lhs { nullptr };
+    mutable PrimitiveString* m_rhs { nullptr };
 
     mutable String m_utf8_string;
     mutable bool m_has_utf8_string { false };
@@ -42,6 +54,9 @@ private:
     mutable bool m_has_utf16_string { false };
 };
 
+template<>
+inline constexpr bool cell_has_write_barriers<PrimitiveString> = true;
+
 PrimitiveString* js_string(Heap&, Utf16View const&);
 PrimitiveString* js_string(VM&, Utf16View const&);
 
@@ -51,4 +66,6 @@ PrimitiveString* js_string(VM&, Utf16String);
 PrimitiveString* js_string(Heap&, String);
 PrimitiveString* js_string(VM&, String);
 
+PrimitiveString* js_rope_string(VM&, PrimitiveString&, PrimitiveString&);
+
 }
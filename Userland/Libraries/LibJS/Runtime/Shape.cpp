@@ -203,6 +203,8 @@ void Shape::add_property_to_unique_shape(const StringOrSymbol& property_key, Pro
     VERIFY(m_property_table);
     VERIFY(!m_property_table->contains(property_key));
     m_property_table->set(property_key, { static_cast<u32>(m_property_table->size()), attributes });
+    if (property_key.is_symbol())
+        did_store_edge(const_cast<Symbol*>(property_key.as_symbol()));
 
     VERIFY(m_property_count < NumericLimits<u32>::max());
     ++m_property_count;
@@ -218,6 +220,12 @@ void Shape::reconfigure_property_in_unique_shape(const StringOrSymbol& property_
     m_property_table->set(property_key, it->value);
 }
 
+void Shape::set_prototype_without_transition(Object* new_prototype)
+{
+    m_prototype = new_prototype;
+    did_store_edge(new_prototype);
+}
+
 void Shape::remove_property_from_unique_shape(const StringOrSymbol& property_key, size_t offset)
 {
     VERIFY(is_unique());
@@ -239,6 +247,8 @@ void Shape::add_property_without_transition(StringOrSymbol const& property_key,
         VERIFY(m_property_count < NumericLimits<u32>::max());
         ++m_property_count;
     }
+    if (property_key.is_symbol())
+        did_store_edge(const_cast<Symbol*>(property_key.as_symbol()));
 }
 
 FLATTEN void Shape::add_property_without_transition(PropertyKey const& property_key, PropertyAttributes attributes)
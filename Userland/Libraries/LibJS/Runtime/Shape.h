@@ -79,7 +79,7 @@ public:
 
     Vector<Property> property_table_ordered() const;
 
-    void set_prototype_without_transition(Object* new_prototype) { m_prototype = new_prototype; }
+    void set_prototype_without_transition(Object* new_prototype);
 
     void remove_property_from_unique_shape(const StringOrSymbol&, size_t offset);
     void add_property_to_unique_shape(const StringOrSymbol&, PropertyAttributes attributes);
@@ -110,6 +110,9 @@ private:
     bool m_unique : 1 { false };
 };
 
+template<>
+inline constexpr bool cell_has_write_barriers<Shape> = true;
+
 }
 
 template<>
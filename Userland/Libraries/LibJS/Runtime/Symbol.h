@@ -31,6 +31,9 @@ private:
     bool m_is_global;
 };
 
+template<>
+inline constexpr bool cell_has_write_barriers<Symbol> = true;
+
 Symbol* js_symbol(Heap&, Optional<String> description, bool is_global);
 Symbol* js_symbol(VM&, Optional<String> description, bool is_global);
 
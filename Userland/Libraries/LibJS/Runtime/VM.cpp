@@ -464,7 +464,7 @@ ThrowCompletionOr<void> VM::iterator_binding_initialization(BindingPattern const
                 }
 
                 // f. Perform ! CreateDataPropertyOrThrow(A, ! ToString(𝔽(n)), nextValue).
-                array->indexed_properties().append(next_value.value());
+                array->indexed_properties_append(next_value.value());
 
                 // g. Set n to n + 1.
             }
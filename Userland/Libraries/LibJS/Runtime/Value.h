@@ -401,6 +401,12 @@ inline void Cell::Visitor::visit(Value value)
         visit_impl(value.as_cell());
 }
 
+ALWAYS_INLINE void Cell::did_store_edge(Value value)
+{
+    if (value.is_cell())
+        did_store_edge(&value.as_cell());
+}
+
 ThrowCompletionOr<Value> greater_than(GlobalObject&, Value lhs, Value rhs);
 ThrowCompletionOr<Value> greater_than_equals(GlobalObject&, Value lhs, Value rhs);
 ThrowCompletionOr<Value> less_than(GlobalObject&, Value lhs, Value rhs);
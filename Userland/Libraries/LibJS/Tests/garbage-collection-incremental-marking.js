@@ -0,0 +1,25 @@
+test("cells stored while the heap is being marked incrementally survive", () => {
+    const holders = [];
+    for (let i = 0; i < 100; ++i) holders.push({});
+    const symbols = [];
+    for (let i = 0; i < 100; ++i) symbols.push(Symbol(`key${i}`));
+
+    gc();
+
+    // Keep enough cells alive to get them promoted and to start an incremental full collection,
+    // while storing young cells into old ones that may or may not have been marked yet.
+    let survivors = [];
+    for (let i = 0; i < 250000; ++i) {
+        survivors.push({ i });
+        if (i % 125000 === 0) survivors = [];
+        if (i % 10 !== 0) continue;
+
+        const holder = holders[(i / 10) % holders.length];
+        if (i % 20 === 0) holder[`property${i}`] = { i };
+        else holder[symbols[(i / 10) % symbols.length]] = { i };
+    }
+
+    for (let i = 0; i < 250000; i += 20) expect(holders[(i / 10) % holders.length][`property${i}`].i).toBe(i);
+    for (let i = 1; i < symbols.length; i += 2) expect(holders[i][symbols[i]].i % 20).toBe(10);
+    expect(survivors).toHaveLength(124999);
+});
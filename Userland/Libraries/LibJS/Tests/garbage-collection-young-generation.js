@@ -0,0 +1,61 @@
+// Enough allocations to trigger a young generation collection.
+const churn = () => {
+    let result;
+    for (let i = 0; i < 110000; ++i) result = { i };
+    return result;
+};
+
+test("young cells only referenced from old cells survive", () => {
+    const object = {};
+    const array = [];
+    const map = new Map();
+    const symbolKey = Symbol("key");
+    const manyProperties = {};
+    for (let i = 0; i < 150; ++i) manyProperties[`p${i}`] = i;
+
+    // Promote everything above to the old generation.
+    gc();
+
+    for (let i = 0; i < 100; ++i) {
+        object[`property${i}`] = { value: i };
+        array.push({ value: i });
+        map.set(i, { value: i });
+        if (i % 25 === 0) churn();
+    }
+    manyProperties[symbolKey] = { value: "symbol" };
+    Object.setPrototypeOf(object, { inherited: "yes" });
+    churn();
+
+    for (let i = 0; i < 100; ++i) {
+        expect(object[`property${i}`].value).toBe(i);
+        expect(array[i].value).toBe(i);
+        expect(map.get(i).value).toBe(i);
+    }
+    expect(manyProperties[symbolKey].value).toBe("symbol");
+    expect(object.inherited).toBe("yes");
+});
+
+test("accessors and private fields of old objects", () => {
+    class C {
+        #field;
+        setField(value) {
+            this.#field = value;
+        }
+        getField() {
+            return this.#field;
+        }
+    }
+    const instance = new C();
+    const object = {};
+    Object.defineProperty(object, "accessor", { get: () => 1, configurable: true });
+
+    gc();
+
+    instance.setField({ value: "private" });
+    const getter = () => "young getter";
+    Object.defineProperty(object, "accessor", { get: getter });
+    churn();
+
+    expect(instance.getField().value).toBe("private");
+    expect(object.accessor).toBe("young getter");
+});
@@ -0,0 +1,55 @@
+// Expressions made up of literals only are evaluated ahead of time by the bytecode optimizer,
+// so these make sure that gives the same results as evaluating them at runtime.
+test("arithmetic", () => {
+    expect(2 + 3 * 4).toBe(14);
+    expect((2 + 3) * 4).toBe(20);
+    expect(1 - 2 - 3).toBe(-4);
+    expect(7 / 2).toBe(3.5);
+    expect(1 / 0).toBe(Infinity);
+    expect(0 / 0).toBeNaN();
+    expect(2147483647 + 1).toBe(2147483648);
+    expect(-2147483648 - 1).toBe(-2147483649);
+    expect(0.1 + 0.2).toBe(0.30000000000000004);
+});
+
+test("negative zero", () => {
+    expect(-0).toBe(-0);
+    expect(0 * -1).toBe(-0);
+    expect(-0 + 0).toBe(0);
+    expect(1 / -0).toBe(-Infinity);
+});
+
+test("comparisons", () => {
+    expect(1 < 2).toBeTrue();
+    expect(2 <= 2).toBeTrue();
+    expect(3 > 4).toBeFalse();
+    expect(0 / 0 >= 0 / 0).toBeFalse();
+    expect(0 / 0 === 0 / 0).toBeFalse();
+    expect(0 / 0 !== 0 / 0).toBeTrue();
+    expect(0 === -0).toBeTrue();
+    expect(1 == 1.0).toBeTrue();
+    expect(1 != 2).toBeTrue();
+});
+
+test("bitwise and unary operators", () => {
+    expect(6 & 3).toBe(2);
+    expect(6 | 3).toBe(7);
+    expect(6 ^ 3).toBe(5);
+    expect(~5).toBe(-6);
+    expect(~-1).toBe(0);
+    expect(1.5 | 0).toBe(1);
+    expect(-(1 + 1)).toBe(-2);
+    expect(+(2 * 3)).toBe(6);
+    expect(!0).toBeTrue();
+    expect(!1).toBeFalse();
+    expect(!null).toBeTrue();
+    expect(!(0 / 0)).toBeTrue();
+});
+
+test("constants mixed with variables", () => {
+    let x = 5;
+    expect(x + 2 * 3).toBe(11);
+    expect((1 + 2) * x).toBe(15);
+    expect("a" + 1 + 2).toBe("a12");
+    expect(1 + 2 + "a").toBe("3a");
+});
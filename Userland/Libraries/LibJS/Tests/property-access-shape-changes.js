@@ -0,0 +1,126 @@
+// Each helper below is a single property access site, which sees objects of many different shapes.
+const getFoo = o => o.foo;
+const setFoo = (o, value) => {
+    "use strict";
+    o.foo = value;
+};
+
+describe("property access sites seeing different shapes", () => {
+    test("objects with different layouts", () => {
+        const objects = [{ foo: 1 }, { bar: 2, foo: 2 }, { baz: 3, bar: 3, foo: 3 }, { foo: 4, bar: 4 }, { x: 1, y: 2, foo: 5 }];
+        for (let i = 0; i < 3; ++i) {
+            objects.forEach((o, index) => {
+                expect(getFoo(o)).toBe(index + 1);
+                setFoo(o, index + 10);
+                expect(getFoo(o)).toBe(index + 10);
+                setFoo(o, index + 1);
+            });
+        }
+    });
+
+    test("property added after the first access", () => {
+        const o = {};
+        expect(getFoo(o)).toBeUndefined();
+        o.foo = 1;
+        expect(getFoo(o)).toBe(1);
+    });
+
+    test("deleted property", () => {
+        const o = { foo: 1, bar: 2 };
+        expect(getFoo(o)).toBe(1);
+        delete o.foo;
+        expect(getFoo(o)).toBeUndefined();
+        setFoo(o, 3);
+        expect(getFoo(o)).toBe(3);
+        expect(o.bar).toBe(2);
+    });
+
+    test("property on the prototype", () => {
+        const prototype = { foo: 1 };
+        const o = Object.create(prototype);
+        expect(getFoo(o)).toBe(1);
+        prototype.foo = 2;
+        expect(getFoo(o)).toBe(2);
+        o.foo = 3;
+        expect(getFoo(o)).toBe(3);
+        expect(prototype.foo).toBe(2);
+    });
+
+    test("prototype changed after the first access", () => {
+        const o = Object.create({ foo: 1 });
+        expect(getFoo(o)).toBe(1);
+        Object.setPrototypeOf(o, { foo: 2 });
+        expect(getFoo(o)).toBe(2);
+        Object.setPrototypeOf(o, null);
+        expect(getFoo(o)).toBeUndefined();
+    });
+
+    test("property shadowed on a prototype further up the chain", () => {
+        const grandparent = { foo: 1 };
+        const parent = Object.create(grandparent);
+        const o = Object.create(parent);
+        expect(getFoo(o)).toBe(1);
+        parent.foo = 2;
+        expect(getFoo(o)).toBe(2);
+    });
+
+    test("data property redefined as an accessor", () => {
+        const o = { foo: 1 };
+        expect(getFoo(o)).toBe(1);
+        let setterValue;
+        Object.defineProperty(o, "foo", {
+            get() {
+                return 2;
+            },
+            set(value) {
+                setterValue = value;
+            },
+        });
+        expect(getFoo(o)).toBe(2);
+        setFoo(o, 3);
+        expect(setterValue).toBe(3);
+        expect(getFoo(o)).toBe(2);
+    });
+
+    test("property made non-writable", () => {
+        const o = { foo: 1 };
+        setFoo(o, 2);
+        expect(getFoo(o)).toBe(2);
+        Object.freeze(o);
+        expect(() => {
+            setFoo(o, 3);
+        }).toThrow(TypeError);
+        expect(getFoo(o)).toBe(2);
+    });
+
+    test("exotic objects", () => {
+        const target = { foo: 1 };
+        const proxy = new Proxy(target, {
+            get(target, property) {
+                return property === "foo" ? 42 : target[property];
+            },
+        });
+        expect(getFoo(target)).toBe(1);
+        expect(getFoo(proxy)).toBe(42);
+
+        const array = [1, 2, 3];
+        array.foo = 1;
+        expect(getFoo(array)).toBe(1);
+        expect(array.length).toBe(3);
+        array.length = 1;
+        expect(array.length).toBe(1);
+
+        const string = new String("foo");
+        string.foo = 1;
+        expect(getFoo(string)).toBe(1);
+        expect(string.length).toBe(3);
+    });
+
+    test("primitive base values", () => {
+        const getLength = value => value.length;
+        expect(getLength("foo")).toBe(3);
+        expect(getLength([1, 2])).toBe(2);
+        expect(getLength({ length: 4 })).toBe(4);
+        expect(getLength("foobar")).toBe(6);
+    });
+});
@@ -28,3 +28,31 @@ test("adding strings with dangling surrogates", () => {
     expect("\ud834a" + "\udf06").toBe("\ud834a\udf06");
     expect("\ud834" + "a\udf06").toBe("\ud834a\udf06");
 });
+
+test("adding strings with dangling surrogates spread across several concatenations", () => {
+    let string = "a" + "\ud834";
+    string = string + "\udf06";
+    expect(string).toBe("a𝌆");
+    expect(string.length).toBe(3);
+
+    expect("\ud834" + ("\udf06" + "\ud834") + "\udf06").toBe("𝌆𝌆");
+    expect("\ud834" + "\udf06" + "\udf06").toBe("𝌆\udf06");
+    expect("\ud834" + ("\udf06" + "a")).toBe("𝌆a");
+});
+
+test("building strings by repeated concatenation", () => {
+    let string = "";
+    for (let i = 0; i < 10000; ++i) string += i % 10;
+    expect(string).toHaveLength(10000);
+    expect(string.substring(0, 12)).toBe("012345678901");
+    expect(string[9999]).toBe("9");
+
+    let prefix = "";
+    const prefixes = [];
+    for (let i = 0; i < 5; ++i) {
+        prefix += String.fromCharCode(0x61 + i);
+        prefixes.push(prefix);
+    }
+    expect(prefixes).toEqual(["a", "ab", "abc", "abcd", "abcde"]);
+    expect(prefixes[2] + prefixes[1]).toBe("abcab");
+});
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashTable.h>
+#include <LibRegex/RegexLazyDFA.h>
+
+namespace regex {
+
+bool LazyDFA::is_supported(ByteCode const& bytecode)
+{
+    MatchState state;
+    auto bytecode_size = bytecode.size();
+    while (state.instruction_position < bytecode_size) {
+        auto& opcode = bytecode.get_opcode(state);
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare:
+            for (auto& compare : static_cast<OpCode_Compare const&>(opcode).flat_compares()) {
+                // Strings and backreferences may consume more (or less) than a single character.
+                if (compare.type == CharacterCompareType::String || compare.type == CharacterCompareType::Reference)
+                    return false;
+            }
+            break;
+        case OpCodeId::Jump:
+        case OpCodeId::JumpNonEmpty:
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkStay:
+        case OpCodeId::Checkpoint:
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+            break;
+        default:
+            return false;
+        }
+        state.instruction_position += opcode.size();
+    }
+    return true;
+}
+
+bool LazyDFA::is_supported(MatchInput const& input)
+{
+    // FIXME: Support unicode views by feeding the DFA with code units instead of bytes.
+    if (input.view.unicode() || !input.view.is_string_view())
+        return false;
+
+    // These are checked by the matcher after the fact, and change what CheckBegin and CheckEnd mean.
+    if (input.regex_options.has_flag_set(AllFlags::MatchNotBeginOfLine) || input.regex_options.has_flag_set(AllFlags::MatchNotEndOfLine))
+        return false;
+
+    return !input.regex_options.has_flag_set(AllFlags::Internal_Stateful);
+}
+
+LazyDFA::State& LazyDFA::state_for_key(Vector<u32>&& key) const
+{
+    if (auto it = m_state_for_key.find(Span<u32 const> { key.data(), key.size() }); it != m_state_for_key.end())
+        return *it->value;
+
+    auto state = make<State>();
+    state->key = move(key);
+    auto& state_reference = *state;
+    m_states.append(move(state));
+    m_state_for_key.set(Span<u32 const> { state_reference.key.data(), state_reference.key.size() }, &state_reference);
+    return state_reference;
+}
+
+void LazyDFA::flush_cache() const
+{
+    m_state_for_key.clear();
+    m_states.clear();
+}
+
+// Follows every thread of the state until it either waits for a character to compare, or finishes matching.
+// The waiting threads are collected in priority order. Once a thread finishes, all threads with a lower priority
+// would only be visited by the backtracker if it failed, so they are dropped and the thread's group is returned.
+Optional<u32> LazyDFA::follow_epsilon_transitions(ByteCode const& bytecode, State const& state, Optional<u8> next_character, Vector<Thread>& waiting_threads) const
+{
+    auto considers_newlines = m_cached_options->has_flag_set(AllFlags::Multiline) && m_cached_options->has_flag_set(AllFlags::Internal_ConsiderNewline);
+    auto is_at_line_start = (state.flags() & AtStart) || (considers_newlines && (state.flags() & FollowsNewline));
+    auto is_at_line_end = !next_character.has_value() || (considers_newlines && *next_character == '\n');
+
+    auto bytecode_size = bytecode.size();
+    HashTable<u32> visited_instructions;
+    Vector<Thread> threads_to_visit;
+    for (size_t i = state.key.size(); i > 1; i -= 2)
+        threads_to_visit.append({ state.key[i - 2], state.key[i - 1] });
+
+    MatchState match_state;
+    while (!threads_to_visit.is_empty()) {
+        auto thread = threads_to_visit.take_last();
+        // A thread that reaches an instruction after a thread with a higher priority can't do any better than it.
+        if (visited_instructions.set(thread.instruction_position) != AK::HashSetResult::InsertedNewEntry)
+            continue;
+        if (thread.instruction_position >= bytecode_size)
+            return thread.group;
+
+        match_state.instruction_position = thread.instruction_position;
+        auto& opcode = bytecode.get_opcode(match_state);
+        size_t next_instruction = thread.instruction_position + opcode.size();
+
+        auto continue_at = [&](size_t instruction_position) {
+            threads_to_visit.append({ static_cast<u32>(instruction_position), thread.group });
+        };
+        auto fork = [&](size_t high_priority_position, size_t low_priority_position) {
+            continue_at(low_priority_position);
+            continue_at(high_priority_position);
+        };
+
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare:
+            waiting_threads.append(thread);
+            break;
+        case OpCodeId::CheckBegin:
+            if (is_at_line_start)
+                continue_at(next_instruction);
+            break;
+        case OpCodeId::CheckEnd:
+            if (is_at_line_end)
+                continue_at(next_instruction);
+            break;
+        case OpCodeId::Jump:
+            continue_at(next_instruction + static_cast<OpCode_Jump const&>(opcode).offset());
+            break;
+        case OpCodeId::ForkJump:
+            fork(next_instruction + static_cast<OpCode_ForkJump const&>(opcode).offset(), next_instruction);
+            break;
+        case OpCodeId::ForkStay:
+            fork(next_instruction, next_instruction + static_cast<OpCode_ForkStay const&>(opcode).offset());
+            break;
+        case OpCodeId::JumpNonEmpty: {
+            auto& jump = static_cast<OpCode_JumpNonEmpty const&>(opcode);
+            // If the checkpoint was passed at this position, the loop body didn't consume anything and isn't repeated.
+            if (visited_instructions.contains(next_instruction + jump.checkpoint())) {
+                continue_at(next_instruction);
+                break;
+            }
+            auto target = next_instruction + jump.offset();
+            switch (jump.form()) {
+            case OpCodeId::Jump:
+                continue_at(target);
+                break;
+            case OpCodeId::ForkJump:
+                fork(target, next_instruction);
+                break;
+            case OpCodeId::ForkStay:
+                fork(next_instruction, target);
+                break;
+            default:
+                VERIFY_NOT_REACHED();
+            }
+            break;
+        }
+        case OpCodeId::Checkpoint:
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+            // Capture groups are filled in by the backtracker once the bounds of the match are known.
+            continue_at(next_instruction);
+            break;
+        default:
+            VERIFY_NOT_REACHED();
+        }
+    }
+
+    return {};
+}
+
+NonnullOwnPtr<LazyDFA::Transition> LazyDFA::compute_transition(ByteCode const& bytecode, State const& state, u8 character) const
+{
+    auto transition = make<Transition>();
+    Vector<Thread> waiting_threads;
+    transition->accepting_group = follow_epsilon_transitions(bytecode, state, character, waiting_threads);
+
+    // Without unicode, a compare only ever looks at the current byte, so running it against just that byte
+    // gives the same result as running it against the input.
+    char compared_character = static_cast<char>(character);
+    MatchInput input;
+    input.view = StringView { &compared_character, 1 };
+    input.regex_options = *m_cached_options;
+
+    // Once a match was found, threads starting at later positions could only find a match that isn't leftmost.
+    bool is_injecting = (state.flags() & Injecting) && !transition->accepting_group.has_value();
+
+    Vector<u32> key;
+    key.append((character == '\n' ? FollowsNewline : 0u) | (is_injecting ? Injecting : 0u));
+    HashTable<u32> seen_instructions;
+    auto add_thread = [&](u32 instruction_position, u32 source_group) {
+        if (seen_instructions.set(instruction_position) != AK::HashSetResult::InsertedNewEntry)
+            return;
+        auto group = transition->group_sources.find_first_index(source_group);
+        if (!group.has_value()) {
+            group = transition->group_sources.size();
+            transition->group_sources.append(source_group);
+        }
+        key.append(instruction_position);
+        key.append(*group);
+    };
+
+    MatchState match_state;
+    for (auto& thread : waiting_threads) {
+        match_state.instruction_position = thread.instruction_position;
+        match_state.string_position = 0;
+        match_state.string_position_in_code_units = 0;
+        auto& opcode = bytecode.get_opcode(match_state);
+        auto opcode_size = opcode.size();
+        if (opcode.execute(input, match_state) == ExecutionResult::Continue && match_state.string_position == 1)
+            add_thread(thread.instruction_position + opcode_size, thread.group);
+    }
+    if (is_injecting)
+        add_thread(0, new_group);
+
+    transition->keeps_groups = true;
+    for (size_t i = 0; i < transition->group_sources.size(); ++i) {
+        if (transition->group_sources[i] != i)
+            transition->keeps_groups = false;
+    }
+    transition->next = &state_for_key(move(key));
+    return transition;
+}
+
+Optional<u32> LazyDFA::accepting_group_at_end(ByteCode const& bytecode, State& state) const
+{
+    if (!state.accepting_group_at_end.has_value()) {
+        Vector<Thread> waiting_threads;
+        state.accepting_group_at_end = follow_epsilon_transitions(bytecode, state, {}, waiting_threads);
+    }
+    return *state.accepting_group_at_end;
+}
+
+LazyDFA::Outcome LazyDFA::find(MatchInput const& input, size_t start_position, Mode mode, Match& match) const
+{
+    auto const& bytecode = m_bytecode;
+    VERIFY(is_supported(input));
+
+    // The options decide what compares and anchors do, so the states built for other options can't be reused.
+    if (!m_cached_options.has_value() || m_cached_options->value() != input.regex_options.value()) {
+        flush_cache();
+        m_cached_options = input.regex_options;
+    }
+
+    auto view = input.view.string_view();
+    u32 flags = mode == Mode::Search ? Injecting : 0u;
+    if (start_position == 0)
+        flags |= AtStart;
+    else if (view[start_position - 1] == '\n')
+        flags |= FollowsNewline;
+    auto* state = &state_for_key({ flags, 0, 0 });
+
+    // The position each group of threads started matching at.
+    Vector<size_t> group_starts { start_position };
+    Vector<size_t> next_group_starts;
+    Optional<Match> found_match;
+    size_t cache_flushes = 0;
+
+    for (auto position = start_position;; ++position) {
+        if (position == view.length()) {
+            if (auto group = accepting_group_at_end(bytecode, *state); group.has_value())
+                found_match = Match { group_starts[*group], position };
+            break;
+        }
+
+        auto character = static_cast<u8>(view[position]);
+        if (!state->transitions[character]) {
+            if (m_states.size() >= max_cached_states) {
+                // The pattern produces more states than we're willing to keep, so the backtracker is likely to do better.
+                if (++cache_flushes > max_cache_flushes)
+                    return Outcome::GaveUp;
+                auto key = state->key;
+                flush_cache();
+                state = &state_for_key(move(key));
+            }
+            state->transitions[character] = compute_transition(bytecode, *state, character);
+        }
+
+        auto& transition = *state->transitions[character];
+        if (transition.accepting_group.has_value())
+            found_match = Match { group_starts[*transition.accepting_group], position };
+        if (!transition.keeps_groups) {
+            next_group_starts.clear_with_capacity();
+            for (auto source_group : transition.group_sources)
+                next_group_starts.append(source_group == new_group ? position + 1 : group_starts[source_group]);
+            swap(group_starts, next_group_starts);
+        }
+
+        state = transition.next;
+        if (state->is_dead())
+            break;
+    }
+
+    if (!found_match.has_value())
+        return Outcome::NoMatch;
+
+    match = *found_match;
+    return Outcome::Matched;
+}
+
+}
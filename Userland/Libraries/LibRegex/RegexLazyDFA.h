@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "RegexByteCode.h"
+#include "RegexMatch.h"
+
+#include <AK/Array.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/NumericLimits.h>
+#include <AK/OwnPtr.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+// Runs bytecode that never needs to backtrack (i.e. has no backreferences, lookarounds or counted repetitions)
+// by simulating all of its threads at once, one input character at a time. The sets of threads that are seen
+// during matching become the states of a DFA, which is built lazily and cached across matches.
+// This keeps matching linear in the length of the input, whereas the backtracking matcher may be exponential.
+class LazyDFA {
+public:
+    // Whether the bytecode only uses operations that the DFA knows how to simulate.
+    static bool is_supported(ByteCode const&);
+
+    // The DFA keeps its own copy of the bytecode, as the optimizer goes on to rewrite the pattern's bytecode for the backtracker.
+    explicit LazyDFA(ByteCode bytecode)
+        : m_bytecode(move(bytecode))
+    {
+    }
+
+    enum class Mode {
+        Anchored, // Only look for a match starting at the given position.
+        Search,   // Look for the leftmost match starting at or after the given position.
+    };
+
+    enum class Outcome {
+        Matched,
+        NoMatch,
+        GaveUp, // The state cache kept overflowing, the caller should fall back to backtracking.
+    };
+
+    struct Match {
+        size_t start { 0 };
+        size_t end { 0 };
+    };
+
+    // Whether the input and the options it's matched with can be handled by the DFA.
+    static bool is_supported(MatchInput const&);
+
+    // Finds the match the backtracking matcher would find, without recording capture groups.
+    Outcome find(MatchInput const&, size_t start_position, Mode, Match&) const;
+
+private:
+    static constexpr size_t max_cached_states = 512;
+    static constexpr size_t max_cache_flushes = 8;
+    static constexpr u32 new_group = NumericLimits<u32>::max();
+
+    // The state is at the start of the input, for CheckBegin.
+    static constexpr u32 AtStart = 1 << 0;
+    // The previous character was a newline, for CheckBegin in multiline mode.
+    static constexpr u32 FollowsNewline = 1 << 1;
+    // A new thread is started at every position, as no match has been found yet.
+    static constexpr u32 Injecting = 1 << 2;
+
+    struct State;
+
+    struct Transition {
+        State* next { nullptr };
+        // The group of the thread that matched right before the character was consumed, if any.
+        Optional<u32> accepting_group;
+        // For every group of the next state, the group of this state it came from, or new_group.
+        Vector<u32> group_sources;
+        bool keeps_groups { false };
+    };
+
+    // A thread is identified by its instruction position, and belongs to the group of threads that started at
+    // the same position. Threads are ordered by priority, which is the order the backtracker would visit them in.
+    // The key holds the flags, followed by a (instruction position, group) pair for every thread.
+    struct State {
+        Vector<u32> key;
+        Array<OwnPtr<Transition>, 256> transitions;
+        Optional<Optional<u32>> accepting_group_at_end;
+
+        u32 flags() const { return key[0]; }
+        bool is_dead() const { return key.size() == 1 && !(flags() & Injecting); }
+    };
+
+    struct Thread {
+        u32 instruction_position;
+        u32 group;
+    };
+
+    State& state_for_key(Vector<u32>&& key) const;
+    void flush_cache() const;
+
+    Optional<u32> follow_epsilon_transitions(ByteCode const&, State const&, Optional<u8> next_character, Vector<Thread>& waiting_threads) const;
+    NonnullOwnPtr<Transition> compute_transition(ByteCode const&, State const&, u8 character) const;
+    Optional<u32> accepting_group_at_end(ByteCode const&, State&) const;
+
+    ByteCode m_bytecode;
+    mutable Optional<AllOptions> m_cached_options;
+    mutable NonnullOwnPtrVector<State> m_states;
+    mutable HashMap<Span<u32 const>, State*> m_state_for_key;
+};
+
+}
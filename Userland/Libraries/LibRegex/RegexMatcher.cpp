@@ -59,6 +59,7 @@ Regex<Parser>::Regex(Regex&& regex)
     : pattern_value(move(regex.pattern_value))
     , parser_result(move(regex.parser_result))
     , matcher(move(regex.matcher))
+    , dfa(move(regex.dfa))
     , start_offset(regex.start_offset)
 {
     if (matcher)
@@ -71,6 +72,7 @@ Regex<Parser>& Regex<Parser>::operator=(Regex&& regex)
     pattern_value = move(regex.pattern_value);
     parser_result = move(regex.parser_result);
     matcher = move(regex.matcher);
+    dfa = move(regex.dfa);
     if (matcher)
         matcher->reset_pattern({}, this);
     start_offset = regex.start_offset;
@@ -185,6 +187,10 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
 
     auto single_match_only = input.regex_options.has_flag_set(AllFlags::SingleMatch);
 
+    auto& parser_result = m_pattern->parser_result;
+    auto needs_capture_groups = (parser_result.capture_groups_count || parser_result.named_capture_groups_count) && !input.regex_options.has_flag_set(AllFlags::SkipSubExprResults);
+    auto dfa_mode = continue_search ? LazyDFA::Mode::Search : LazyDFA::Mode::Anchored;
+
     for (auto const& view : views) {
         if (lines_to_skip != 0) {
             ++input.line;
@@ -226,7 +232,23 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             }
         }
 
+        // The DFA finds where the next match is, so only that position has to be tried.
+        auto use_dfa = m_pattern->dfa && LazyDFA::is_supported(input);
         for (; view_index <= view_length; ++view_index) {
+            Optional<LazyDFA::Match> dfa_match;
+            if (use_dfa) {
+                LazyDFA::Match match;
+                auto outcome = m_pattern->dfa->find(input, view_index, dfa_mode, match);
+                if (outcome == LazyDFA::Outcome::NoMatch)
+                    break;
+                if (outcome == LazyDFA::Outcome::Matched) {
+                    view_index = match.start;
+                    dfa_match = match;
+                } else {
+                    use_dfa = false;
+                }
+            }
+
             if (view_index == view_length && input.regex_options.has_flag_set(AllFlags::Multiline))
                 break;
 
@@ -248,7 +270,16 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             state.instruction_position = 0;
             state.repetition_marks.clear();
 
-            auto success = execute(input, state, operations);
+            bool success;
+            if (dfa_match.has_value() && !needs_capture_groups) {
+                state.string_position = dfa_match->end;
+                state.string_position_in_code_units = dfa_match->end;
+                success = true;
+            } else {
+                // The backtracker is still needed to fill in the capture groups, but it only has to look at a single position.
+                success = execute(input, state, operations);
+            }
+
             if (success) {
                 succeeded = true;
 
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/CharacterTypes.h>
 #include <AK/QuickSort.h>
 #include <AK/RedBlackTree.h>
 #include <AK/Stack.h>
@@ -23,6 +24,12 @@ void Regex<Parser>::run_optimization_passes()
 {
     parser_result.bytecode.flatten();
 
+    // Patterns that never need to backtrack are matched by simulating all of their paths at once. The DFA works
+    // on the bytecode as parsed, while the rewrites below still speed up the backtracker, which is used for inputs
+    // the DFA can't handle, when it gives up, and to fill in capture groups.
+    if (parser_result.error == Error::NoError && LazyDFA::is_supported(parser_result.bytecode))
+        dfa = make<LazyDFA>(parser_result.bytecode);
+
     // Rewrite fork loops as atomic groups
     // e.g. a*b -> (ATOMIC a*)b
     attempt_rewrite_loops_as_atomic_groups(split_basic_blocks(parser_result.bytecode));
@@ -108,6 +115,38 @@ typename Regex<Parser>::BasicBlockList Regex<Parser>::split_basic_blocks(ByteCod
     return block_boundaries;
 }
 
+// Whether some character could be matched by both compares. This errs on the side of reporting an overlap.
+static bool has_overlap(CompareTypeAndValuePair const& lhs, CompareTypeAndValuePair const& rhs)
+{
+    // NOTE: Only the first character of a string can overlap with anything, and the compare may be case-insensitive.
+    auto as_range = [](CompareTypeAndValuePair const& compare) -> Optional<CharRange> {
+        switch (compare.type) {
+        case CharacterCompareType::Char:
+        case CharacterCompareType::String:
+            return CharRange { static_cast<u32>(compare.value), static_cast<u32>(compare.value) };
+        case CharacterCompareType::CharRange:
+            return CharRange { compare.value };
+        default:
+            // FIXME: Character classes, properties and inverted compares could be checked more precisely.
+            return {};
+        }
+    };
+
+    auto lhs_range = as_range(lhs);
+    auto rhs_range = as_range(rhs);
+    if (!lhs_range.has_value() || !rhs_range.has_value())
+        return true;
+
+    auto ranges_overlap = [](CharRange const& a, CharRange const& b) { return a.from <= b.to && b.from <= a.to; };
+    if (ranges_overlap(*lhs_range, *rhs_range))
+        return true;
+
+    auto contains_ascii_letter = [&](CharRange const& range) {
+        return ranges_overlap(range, { 'a', 'z' }) || ranges_overlap(range, { 'A', 'Z' });
+    };
+    return contains_ascii_letter(*lhs_range) && contains_ascii_letter(*rhs_range);
+}
+
 enum class AtomicRewritePreconditionResult {
     SatisfiedWithProperHeader,
     SatisfiedWithEmptyHeader,
@@ -180,13 +219,8 @@ static AtomicRewritePreconditionResult block_satisfies_atomic_rewrite_preconditi
                 return AtomicRewritePreconditionResult::NotSatisfied;
 
             for (auto& repeated_value : repeated_values) {
-                // FIXME: This is too naive!
-                if (any_of(repeated_value, [](auto& compare) { return compare.type == CharacterCompareType::AnyChar; }))
-                    return AtomicRewritePreconditionResult::NotSatisfied;
-
                 for (auto& repeated_compare : repeated_value) {
-                    // FIXME: This is too naive! it will miss _tons_ of cases since it doesn't check ranges!
-                    if (any_of(compares, [&](auto& compare) { return compare.type == repeated_compare.type && compare.value == repeated_compare.value; }))
+                    if (any_of(compares, [&](auto& compare) { return has_overlap(compare, repeated_compare); }))
                         return AtomicRewritePreconditionResult::NotSatisfied;
                 }
             }
@@ -71,18 +71,40 @@ private:
 
 class ColumnDefinition : public ASTNode {
 public:
-    ColumnDefinition(String name, NonnullRefPtr<TypeName> type_name)
+    ColumnDefinition(String name, NonnullRefPtr<TypeName> type_name, bool is_primary_key, Order primary_key_order)
         : m_name(move(name))
         , m_type_name(move(type_name))
+        , m_is_primary_key(is_primary_key)
+        , m_primary_key_order(primary_key_order)
     {
     }
 
     const String& name() const { return m_name; }
     const NonnullRefPtr<TypeName>& type_name() const { return m_type_name; }
+    bool is_primary_key() const { return m_is_primary_key; }
+    Order primary_key_order() const { return m_primary_key_order; }
 
 private:
     String m_name;
     NonnullRefPtr<TypeName> m_type_name;
+    bool m_is_primary_key;
+    Order m_primary_key_order;
+};
+
+class IndexedColumn : public ASTNode {
+public:
+    IndexedColumn(String column_name, Order order)
+        : m_column_name(move(column_name))
+        , m_order(order)
+    {
+    }
+
+    const String& column_name() const { return m_column_name; }
+    Order order() const { return m_order; }
+
+private:
+    String m_column_name;
+    Order m_order;
 };
 
 class CommonTableExpression : public ASTNode {
@@ -800,6 +822,36 @@ private:
     bool m_is_error_if_table_exists;
 };
 
+class CreateIndex : public Statement {
+public:
+    CreateIndex(String schema_name, String index_name, String table_name, NonnullRefPtrVector<IndexedColumn> indexed_columns, bool is_unique, bool is_error_if_index_exists)
+        : m_schema_name(move(schema_name))
+        , m_index_name(move(index_name))
+        , m_table_name(move(table_name))
+        , m_indexed_columns(move(indexed_columns))
+        , m_is_unique(is_unique)
+        , m_is_error_if_index_exists(is_error_if_index_exists)
+    {
+    }
+
+    const String& schema_name() const { return m_schema_name; }
+    const String& index_name() const { return m_index_name; }
+    const String& table_name() const { return m_table_name; }
+    const NonnullRefPtrVector<IndexedColumn>& indexed_columns() const { return m_indexed_columns; }
+    bool is_unique() const { return m_is_unique; }
+    bool is_error_if_index_exists() const { return m_is_error_if_index_exists; }
+
+    ResultOr<ResultSet> execute(ExecutionContext&) const override;
+
+private:
+    String m_schema_name;
+    String m_index_name;
+    String m_table_name;
+    NonnullRefPtrVector<IndexedColumn> m_indexed_columns;
+    bool m_is_unique;
+    bool m_is_error_if_index_exists;
+};
+
 class AlterTable : public Statement {
 public:
     const String& schema_name() const { return m_schema_name; }
@@ -1046,6 +1098,7 @@ public:
     const NonnullRefPtrVector<OrderingTerm>& ordering_term_list() const { return m_ordering_term_list; }
     const RefPtr<LimitClause>& limit_clause() const { return m_limit_clause; }
     ResultOr<ResultSet> execute(ExecutionContext&) const override;
+    ResultOr<Vector<String>> query_plan(ExecutionContext&) const;
 
 private:
     RefPtr<CommonTableExpressionList> m_common_table_expression_list;
@@ -1058,6 +1111,20 @@ private:
     RefPtr<LimitClause> m_limit_clause;
 };
 
+class Explain : public Statement {
+public:
+    explicit Explain(NonnullRefPtr<Select> select_statement)
+        : m_select_statement(move(select_statement))
+    {
+    }
+
+    const NonnullRefPtr<Select>& select_statement() const { return m_select_statement; }
+    ResultOr<ResultSet> execute(ExecutionContext&) const override;
+
+private:
+    NonnullRefPtr<Select> m_select_statement;
+};
+
 class DescribeTable : public Statement {
 public:
     DescribeTable(NonnullRefPtr<QualifiedTableName> qualified_table_name)
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
+
+namespace SQL::AST {
+
+ResultOr<ResultSet> CreateIndex::execute(ExecutionContext& context) const
+{
+    auto table_def = TRY(context.database->get_table(m_schema_name, m_table_name));
+    if (!table_def) {
+        auto schema_name = m_schema_name.is_empty() ? String("default"sv) : m_schema_name;
+        return Result { SQLCommand::Create, SQLErrorCode::TableDoesNotExist, String::formatted("{}.{}", schema_name, m_table_name) };
+    }
+
+    for (auto& index : table_def->indexes()) {
+        if (index.name() == m_index_name) {
+            if (m_is_error_if_index_exists)
+                return Result { SQLCommand::Create, SQLErrorCode::IndexExists, m_index_name };
+            return ResultSet { SQLCommand::Create };
+        }
+    }
+
+    auto index_def = IndexDef::construct(table_def.ptr(), m_index_name, m_is_unique);
+    for (auto& indexed_column : m_indexed_columns) {
+        ColumnDef const* column_def = nullptr;
+        for (auto& column : table_def->columns()) {
+            if (column.name() == indexed_column.column_name())
+                column_def = &column;
+        }
+        if (!column_def) {
+            index_def->remove_from_parent();
+            return Result { SQLCommand::Create, SQLErrorCode::ColumnDoesNotExist, indexed_column.column_name() };
+        }
+        index_def->append_column(column_def->name(), column_def->type(), indexed_column.order());
+    }
+
+    if (auto result = context.database->add_index(*index_def); result.is_error()) {
+        index_def->remove_from_parent();
+        if (result.error().is_errno())
+            return result.release_error();
+        // The index name was checked above, so the existing rows must have duplicate keys.
+        return Result { SQLCommand::Create, SQLErrorCode::UniqueConstraintViolated, m_index_name };
+    }
+
+    return ResultSet { SQLCommand::Create };
+}
+
+}
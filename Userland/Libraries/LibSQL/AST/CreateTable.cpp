@@ -6,6 +6,7 @@
 
 #include <LibSQL/AST/AST.h>
 #include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
 
 namespace SQL::AST {
 
@@ -25,6 +26,8 @@ ResultOr<ResultSet> CreateTable::execute(ExecutionContext& context) const
     }
 
     table_def = TableDef::construct(schema_def, m_table_name);
+    ColumnDefinition const* primary_key = nullptr;
+    SQLType primary_key_type;
 
     for (auto& column : m_columns) {
         SQLType type;
@@ -39,9 +42,24 @@ ResultOr<ResultSet> CreateTable::execute(ExecutionContext& context) const
             return Result { SQLCommand::Create, SQLErrorCode::InvalidType, column.type_name()->name() };
 
         table_def->append_column(column.name(), type);
+
+        if (column.is_primary_key()) {
+            if (primary_key)
+                return Result { SQLCommand::Create, SQLErrorCode::TooManyPrimaryKeys, m_table_name };
+            primary_key = &column;
+            primary_key_type = type;
+        }
     }
 
     TRY(context.database->add_table(*table_def));
+
+    if (primary_key) {
+        table_def = TRY(context.database->get_table(schema_name, m_table_name));
+        auto index_def = IndexDef::construct(table_def.ptr(), IndexDef::primary_key_index_name, true);
+        index_def->append_column(primary_key->name(), primary_key_type, primary_key->primary_key_order());
+        TRY(context.database->add_index(*index_def));
+    }
+
     return ResultSet { SQLCommand::Create };
 }
 
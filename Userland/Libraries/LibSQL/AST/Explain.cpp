@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/ResultSet.h>
+
+namespace SQL::AST {
+
+ResultOr<ResultSet> Explain::execute(ExecutionContext& context) const
+{
+    auto plan = TRY(m_select_statement->query_plan(context));
+
+    auto descriptor = adopt_ref(*new TupleDescriptor);
+    descriptor->append({ "", "", "detail", SQLType::Text, Order::Ascending });
+
+    ResultSet result { SQLCommand::Explain };
+    TRY(result.try_ensure_capacity(plan.size()));
+
+    for (auto& step : plan) {
+        Tuple tuple(descriptor);
+        tuple[0] = step;
+        result.insert_row(tuple, Tuple {});
+    }
+
+    return result;
+}
+
+}
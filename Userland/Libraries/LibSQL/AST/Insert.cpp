@@ -65,6 +65,9 @@ ResultOr<ResultSet> Insert::execute(ExecutionContext& context) const
             row[element_index] = values[ix];
         }
 
+        if (auto const* index = context.database->unique_index_violated_by(row))
+            return Result { SQLCommand::Insert, SQLErrorCode::UniqueConstraintViolated, index->name() };
+
         TRY(context.database->insert(row));
         result.insert_row(row, {});
     }
@@ -5,6 +5,7 @@
  */
 
 #include <AK/NumericLimits.h>
+#include <AK/TypeCasts.h>
 #include <LibSQL/AST/AST.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Meta.h>
@@ -12,14 +13,26 @@
 
 namespace SQL::AST {
 
-ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
-{
-    NonnullRefPtrVector<ResultColumn> columns;
+namespace {
 
-    auto const& result_column_list = this->result_column_list();
-    VERIFY(!result_column_list.is_empty());
+struct ColumnConstraint {
+    String column_name;
+    BinaryOperator op;
+    Value value;
+};
+
+struct TableAccess {
+    IndexDef const* index { nullptr };
+    IndexRange range;
+    Vector<String> constraint_descriptions;
+};
 
-    for (auto& table_descriptor : table_or_subquery_list()) {
+}
+
+static ResultOr<Vector<NonnullRefPtr<TableDef>>> resolve_tables(ExecutionContext& context, NonnullRefPtrVector<TableOrSubquery> const& table_or_subquery_list)
+{
+    Vector<NonnullRefPtr<TableDef>> tables;
+    for (auto& table_descriptor : table_or_subquery_list) {
         if (!table_descriptor.is_table())
             return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
 
@@ -27,6 +40,208 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
         if (!table_def)
             return Result { SQLCommand::Select, SQLErrorCode::TableDoesNotExist, table_descriptor.table_name() };
 
+        tables.append(table_def.release_nonnull());
+    }
+    return tables;
+}
+
+static void collect_conjuncts(Expression const& expression, Vector<Expression const*>& conjuncts)
+{
+    if (is<BinaryOperatorExpression>(expression)) {
+        auto const& binary_expression = static_cast<BinaryOperatorExpression const&>(expression);
+        if (binary_expression.type() == BinaryOperator::And) {
+            collect_conjuncts(binary_expression.lhs(), conjuncts);
+            collect_conjuncts(binary_expression.rhs(), conjuncts);
+            return;
+        }
+    }
+    conjuncts.append(&expression);
+}
+
+// Returns the column of the given table the expression refers to, provided that the
+// name can't refer to a column of any other table in the FROM clause.
+static ColumnDef const* resolve_column(ColumnNameExpression const& expression, TableDef const& table, Vector<NonnullRefPtr<TableDef>> const& tables)
+{
+    ColumnDef const* resolved_column = nullptr;
+    size_t matches = 0;
+    for (auto& candidate : tables) {
+        if (!expression.table_name().is_empty() && candidate->name() != expression.table_name())
+            continue;
+        for (auto& column : candidate->columns()) {
+            if (column.name() != expression.column_name())
+                continue;
+            ++matches;
+            if (candidate.ptr() == &table)
+                resolved_column = &column;
+        }
+    }
+    return matches == 1 ? resolved_column : nullptr;
+}
+
+static Optional<BinaryOperator> operator_with_column_on_the_left(BinaryOperator op, bool column_is_on_the_left)
+{
+    switch (op) {
+    case BinaryOperator::Equals:
+        return op;
+    case BinaryOperator::LessThan:
+        return column_is_on_the_left ? op : BinaryOperator::GreaterThan;
+    case BinaryOperator::LessThanEquals:
+        return column_is_on_the_left ? op : BinaryOperator::GreaterThanEquals;
+    case BinaryOperator::GreaterThan:
+        return column_is_on_the_left ? op : BinaryOperator::LessThan;
+    case BinaryOperator::GreaterThanEquals:
+        return column_is_on_the_left ? op : BinaryOperator::LessThanEquals;
+    default:
+        return {};
+    }
+}
+
+// The order of an index only agrees with the comparisons in the WHERE clause for
+// INTEGER and TEXT columns. If the constant is on the left hand side, its type decides
+// how the values are compared, so it has to compare the same way the column does.
+static bool can_use_index_for(SQLType column_type, Value const& constant, bool column_is_on_the_left)
+{
+    if (column_type != SQLType::Integer && column_type != SQLType::Text)
+        return false;
+    if (column_is_on_the_left)
+        return true;
+    if (column_type == SQLType::Text)
+        return constant.type() == SQLType::Text;
+    if (constant.type() != SQLType::Float)
+        return false;
+    auto as_double = constant.to_double().value();
+    return as_double >= NumericLimits<int>::min() && as_double <= NumericLimits<int>::max() && as_double == constant.to_int().value();
+}
+
+static ResultOr<Vector<ColumnConstraint>> collect_column_constraints(ExecutionContext& context, Expression const& where_clause, TableDef const& table, Vector<NonnullRefPtr<TableDef>> const& tables)
+{
+    Vector<Expression const*> conjuncts;
+    collect_conjuncts(where_clause, conjuncts);
+
+    auto is_constant = [](Expression const& expression) {
+        return is<NumericLiteral>(expression) || is<StringLiteral>(expression);
+    };
+
+    Vector<ColumnConstraint> constraints;
+    for (auto const* conjunct : conjuncts) {
+        if (!is<BinaryOperatorExpression>(*conjunct))
+            continue;
+        auto const& comparison = static_cast<BinaryOperatorExpression const&>(*conjunct);
+
+        bool column_is_on_the_left = is<ColumnNameExpression>(*comparison.lhs()) && is_constant(*comparison.rhs());
+        if (!column_is_on_the_left && !(is_constant(*comparison.lhs()) && is<ColumnNameExpression>(*comparison.rhs())))
+            continue;
+
+        auto op = operator_with_column_on_the_left(comparison.type(), column_is_on_the_left);
+        if (!op.has_value())
+            continue;
+
+        auto const& column_expression = static_cast<ColumnNameExpression const&>(column_is_on_the_left ? *comparison.lhs() : *comparison.rhs());
+        auto const* column = resolve_column(column_expression, table, tables);
+        if (!column)
+            continue;
+
+        auto constant = TRY((column_is_on_the_left ? comparison.rhs() : comparison.lhs())->evaluate(context));
+        if (!can_use_index_for(column->type(), constant, column_is_on_the_left))
+            continue;
+
+        constraints.append({ column->name(), op.value(), move(constant) });
+    }
+    return constraints;
+}
+
+// Picks the index that pins down the most leading key parts with equality constraints,
+// followed by an optional range on the next key part. The WHERE clause is still
+// evaluated for every row the index produces.
+static ResultOr<TableAccess> plan_table_access(ExecutionContext& context, RefPtr<Expression> const& where_clause, TableDef const& table, Vector<NonnullRefPtr<TableDef>> const& tables)
+{
+    TableAccess best_access;
+    if (!where_clause || table.indexes().is_empty())
+        return best_access;
+
+    auto constraints = TRY(collect_column_constraints(context, *where_clause, table, tables));
+    if (constraints.is_empty())
+        return best_access;
+
+    size_t best_score = 0;
+    for (auto& index : table.indexes()) {
+        TableAccess access;
+        access.index = &index;
+        size_t score = 0;
+
+        for (auto& part : index.key_definition()) {
+            auto equality = constraints.find_if([&](auto& constraint) {
+                return constraint.column_name == part.name() && constraint.op == BinaryOperator::Equals;
+            });
+            if (equality.is_end())
+                break;
+            access.range.equal_values.append(equality->value);
+            access.constraint_descriptions.append(String::formatted("{}=?", part.name()));
+            score += 2;
+        }
+
+        if (access.range.equal_values.size() < index.size()) {
+            auto const& part = index.key_definition()[access.range.equal_values.size()];
+            for (auto& constraint : constraints) {
+                if (constraint.column_name != part.name())
+                    continue;
+                auto is_lower_bound = constraint.op == BinaryOperator::GreaterThan || constraint.op == BinaryOperator::GreaterThanEquals;
+                auto is_upper_bound = constraint.op == BinaryOperator::LessThan || constraint.op == BinaryOperator::LessThanEquals;
+                auto inclusive = constraint.op == BinaryOperator::GreaterThanEquals || constraint.op == BinaryOperator::LessThanEquals;
+                if (is_lower_bound && !access.range.lower_bound.has_value())
+                    access.range.lower_bound = IndexBound { constraint.value, inclusive };
+                else if (is_upper_bound && !access.range.upper_bound.has_value())
+                    access.range.upper_bound = IndexBound { constraint.value, inclusive };
+                else
+                    continue;
+                access.constraint_descriptions.append(String::formatted("{}{}?", part.name(), BinaryOperator_name(constraint.op)));
+            }
+            if (access.range.lower_bound.has_value() || access.range.upper_bound.has_value())
+                score += 1;
+        }
+
+        if (score > best_score) {
+            best_score = score;
+            best_access = move(access);
+        }
+    }
+    return best_access;
+}
+
+static String describe_table_access(TableDef const& table, TableAccess const& access)
+{
+    auto table_name = String::formatted("{}.{}", table.parent()->name(), table.name());
+    if (!access.index)
+        return String::formatted("SCAN {}", table_name);
+
+    auto index_name = access.index->name() == IndexDef::primary_key_index_name
+        ? String("PRIMARY KEY"sv)
+        : String::formatted("INDEX {}", access.index->name());
+    return String::formatted("SEARCH {} USING {} ({})", table_name, index_name, String::join(" AND "sv, access.constraint_descriptions));
+}
+
+ResultOr<Vector<String>> Select::query_plan(ExecutionContext& context) const
+{
+    auto tables = TRY(resolve_tables(context, table_or_subquery_list()));
+
+    Vector<String> plan;
+    for (auto& table_def : tables) {
+        auto access = TRY(plan_table_access(context, where_clause(), *table_def, tables));
+        plan.append(describe_table_access(*table_def, access));
+    }
+    return plan;
+}
+
+ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
+{
+    NonnullRefPtrVector<ResultColumn> columns;
+
+    auto const& result_column_list = this->result_column_list();
+    VERIFY(!result_column_list.is_empty());
+
+    auto tables = TRY(resolve_tables(context, table_or_subquery_list()));
+
+    for (auto& table_def : tables) {
         if (result_column_list.size() == 1 && result_column_list[0].type() == ResultType::All) {
             for (auto& col : table_def->columns()) {
                 columns.append(
@@ -57,20 +272,20 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
     tuple.append(Value(SQLType::Boolean, true));
     rows.append(tuple);
 
-    for (auto& table_descriptor : table_or_subquery_list()) {
-        if (!table_descriptor.is_table())
-            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
-
-        auto table_def = TRY(context.database->get_table(table_descriptor.schema_name(), table_descriptor.table_name()));
+    for (auto& table_def : tables) {
         if (table_def->num_columns() == 0)
             continue;
 
         auto old_descriptor_size = descriptor->size();
         descriptor->extend(table_def->to_tuple_descriptor());
 
+        auto access = TRY(plan_table_access(context, where_clause(), *table_def, tables));
+        auto table_rows = access.index
+            ? TRY(context.database->select_range(*access.index, access.range))
+            : TRY(context.database->select_all(*table_def));
+
         while (!rows.is_empty() && (rows.first().size() == old_descriptor_size)) {
             auto cartesian_row = rows.take_first();
-            auto table_rows = TRY(context.database->select_all(*table_def));
 
             for (auto& table_row : table_rows) {
                 auto new_row = cartesian_row;
@@ -46,6 +46,9 @@ void BTree::initialize_root()
     } else {
         set_pointer(new_record_pointer());
         m_root = make<TreeNode>(*this, nullptr, pointer());
+        // Write the empty root right away, so the heap doesn't end up with a hole
+        // if the tree is only ever searched.
+        serializer().serialize_and_write(*m_root.ptr(), m_root->pointer());
         if (on_new_root)
             on_new_root();
     }
@@ -103,6 +106,33 @@ BTreeIterator BTree::find(Key const& key)
     return end();
 }
 
+BTreeIterator BTree::lower_bound(Function<bool(Key const&)> const& is_before)
+{
+    if (!m_root)
+        initialize_root();
+    VERIFY(m_root);
+
+    // Keys in non-leaf nodes are real keys, so the first key that is not before
+    // the bound may live in a node on the way down as well as in the leaf.
+    TreeNode* candidate = nullptr;
+    size_t candidate_index = 0;
+    for (auto node = m_root.ptr(); node;) {
+        size_t ix = 0;
+        while (ix < node->size() && is_before((*node)[ix]))
+            ix++;
+        if (ix < node->size()) {
+            candidate = node;
+            candidate_index = ix;
+        }
+        if (node->is_leaf())
+            break;
+        node = node->down_node(ix);
+    }
+    if (!candidate)
+        return end();
+    return BTreeIterator(candidate, (int)candidate_index);
+}
+
 void BTree::list_tree()
 {
     if (!m_root)
@@ -104,6 +104,11 @@ public:
     bool update_key_pointer(Key const&);
     Optional<u32> get(Key&);
     BTreeIterator find(Key const& key);
+
+    // Returns an iterator pointing at the first key for which is_before returns
+    // false. is_before must hold for a (possibly empty) prefix of the keys in
+    // sort order, and not hold for any key after that.
+    BTreeIterator lower_bound(Function<bool(Key const&)> const& is_before);
     BTreeIterator begin();
     static BTreeIterator end();
     void list_tree();
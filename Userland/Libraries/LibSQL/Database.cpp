@@ -6,6 +6,7 @@
  */
 
 #include <AK/Format.h>
+#include <AK/QuickSort.h>
 #include <AK/RefPtr.h>
 #include <AK/String.h>
 
@@ -42,6 +43,11 @@ ErrorOr<void> Database::open()
         m_heap->set_table_columns_root(m_table_columns->root());
     };
 
+    m_table_indexes = BTree::construct(m_serializer, IndexDef::index_def()->to_tuple_descriptor(), m_heap->table_indexes_root());
+    m_table_indexes->on_new_root = [&]() {
+        m_heap->set_table_indexes_root(m_table_indexes->root());
+    };
+
     m_open = true;
     auto default_schema = TRY(get_schema("default"));
     if (!default_schema) {
@@ -171,9 +177,150 @@ ErrorOr<RefPtr<TableDef>> Database::get_table(String const& schema, String const
          column_iterator++) {
         ret->append_column(*column_iterator);
     }
+    auto index_key = IndexDef::make_key(ret);
+    for (auto index_iterator = m_table_indexes->find(index_key);
+         !index_iterator.is_end() && ((*index_iterator)["table_hash"].to_u32().value() == hash);
+         index_iterator++) {
+        ret->append_index(*index_iterator);
+    }
     return RefPtr<TableDef>(ret);
 }
 
+ErrorOr<void> Database::add_index(IndexDef& index)
+{
+    VERIFY(is_open());
+    auto* table = dynamic_cast<TableDef*>(index.parent());
+    VERIFY(table);
+    VERIFY(m_table_cache.get(table->key().hash()).has_value());
+    for (auto& existing_index : table->indexes()) {
+        if (existing_index.name() == index.name()) {
+            warnln("Duplicate index name '{}'"sv, index.name());
+            return Error::from_string_literal("Duplicate index name"sv);
+        }
+    }
+
+    // The tree gets its root block when the first key is inserted, at which
+    // point on_new_root stores its pointer with the index definition.
+    index.set_pointer(0);
+
+    auto rows = TRY(select_all(*table));
+    Vector<Key> keys;
+    TRY(keys.try_ensure_capacity(rows.size()));
+    for (auto& row : rows)
+        keys.unchecked_append(make_index_key(index, row));
+
+    if (index.unique()) {
+        auto has_null_part = [](Key const& key) {
+            for (auto ix = 0u; ix < key.size(); ix++) {
+                if (key[ix].is_null())
+                    return true;
+            }
+            return false;
+        };
+        quick_sort(keys);
+        for (auto ix = 1u; ix < keys.size(); ix++) {
+            if (keys[ix - 1] == keys[ix] && !has_null_part(keys[ix])) {
+                warnln("Unique index '{}' can't be created on duplicate values"sv, index.name());
+                return Error::from_string_literal("Duplicate values in unique index"sv);
+            }
+        }
+    }
+
+    if (!m_table_indexes->insert(index.key())) {
+        warnln("Duplicate index name '{}'"sv, index.name());
+        return Error::from_string_literal("Duplicate index name"sv);
+    }
+    table->append_index(NonnullRefPtr<IndexDef>(index));
+
+    auto& tree = index_tree(index);
+    for (auto& key : keys)
+        VERIFY(tree.insert(key));
+    return {};
+}
+
+BTree& Database::index_tree(IndexDef const& index)
+{
+    if (auto tree = m_index_trees.get(&index); tree.has_value())
+        return *tree.value();
+
+    // Keys of non-unique indexes are made unique by appending the row pointer.
+    auto descriptor = index.to_tuple_descriptor();
+    if (!index.unique())
+        descriptor->append({ "", "", "$row", SQLType::Integer, Order::Ascending });
+
+    auto tree = BTree::construct(m_serializer, descriptor, index.pointer());
+    tree->on_new_root = [this, index = NonnullRefPtr<IndexDef>(const_cast<IndexDef&>(index)), &tree = *tree]() mutable {
+        index->set_pointer(tree.root());
+        VERIFY(m_table_indexes->update_key_pointer(index->key()));
+    };
+    m_index_trees.set(&index, tree);
+    return *tree;
+}
+
+Key Database::make_index_key(IndexDef const& index, Row const& row)
+{
+    Key key(index_tree(index).descriptor());
+    for (auto ix = 0u; ix < index.size(); ix++)
+        key[ix] = row[index.key_definition()[ix].name()];
+    if (!index.unique())
+        key[index.size()] = (int)row.pointer();
+    key.set_pointer(row.pointer());
+    return key;
+}
+
+static int compare_key_part(IndexDef const& index, Key const& key, size_t part, Value const& value)
+{
+    auto result = key[part].compare(value);
+    return index.key_definition()[part].sort_order() == Order::Descending ? -result : result;
+}
+
+// The first and last bound of the range in the sort order of the index, as opposed
+// to the natural order of the values.
+static bool is_range_reversed(IndexDef const& index, IndexRange const& range)
+{
+    auto part = range.equal_values.size();
+    return part < index.size() && index.key_definition()[part].sort_order() == Order::Descending;
+}
+
+static Optional<IndexBound> const& range_start(IndexDef const& index, IndexRange const& range)
+{
+    return is_range_reversed(index, range) ? range.upper_bound : range.lower_bound;
+}
+
+static Optional<IndexBound> const& range_stop(IndexDef const& index, IndexRange const& range)
+{
+    return is_range_reversed(index, range) ? range.lower_bound : range.upper_bound;
+}
+
+BTreeIterator Database::find_first_in_range(IndexDef const& index, IndexRange const& range)
+{
+    auto const& start = range_start(index, range);
+    return index_tree(index).lower_bound([&](Key const& key) {
+        for (auto ix = 0u; ix < range.equal_values.size(); ix++) {
+            auto result = compare_key_part(index, key, ix, range.equal_values[ix]);
+            if (result != 0)
+                return result < 0;
+        }
+        if (!start.has_value())
+            return false;
+        auto result = compare_key_part(index, key, range.equal_values.size(), start->value);
+        return result < 0 || (result == 0 && !start->inclusive);
+    });
+}
+
+bool Database::is_past_range(IndexDef const& index, IndexRange const& range, Key const& key)
+{
+    for (auto ix = 0u; ix < range.equal_values.size(); ix++) {
+        if (compare_key_part(index, key, ix, range.equal_values[ix]) != 0)
+            return true;
+    }
+    auto const& stop = range_stop(index, range);
+    if (!stop.has_value())
+        return false;
+    auto result = compare_key_part(index, key, range.equal_values.size(), stop->value);
+    return result > 0 || (result == 0 && !stop->inclusive);
+}
+
 ErrorOr<Vector<Row>> Database::select_all(TableDef const& table)
 {
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
@@ -184,6 +331,21 @@ ErrorOr<Vector<Row>> Database::select_all(TableDef const& table)
     return ret;
 }
 
+ErrorOr<Vector<Row>> Database::select_range(IndexDef const& index, IndexRange const& range)
+{
+    auto const* table = dynamic_cast<TableDef const*>(index.parent());
+    VERIFY(table);
+    VERIFY(m_table_cache.get(table->key().hash()).has_value());
+    VERIFY(range.equal_values.size() + ((range.lower_bound.has_value() || range.upper_bound.has_value()) ? 1 : 0) <= index.size());
+
+    Vector<Row> ret;
+    for (auto iterator = find_first_in_range(index, range); !iterator.is_end() && !is_past_range(index, range, *iterator); iterator++) {
+        auto pointer = (*iterator).pointer();
+        ret.append(m_serializer.deserialize_block<Row>(pointer, *table, pointer));
+    }
+    return ret;
+}
+
 ErrorOr<Vector<Row>> Database::match(TableDef const& table, Key const& key)
 {
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
@@ -200,16 +362,42 @@ ErrorOr<Vector<Row>> Database::match(TableDef const& table, Key const& key)
     return ret;
 }
 
+IndexDef const* Database::unique_index_violated_by(Row const& row)
+{
+    for (auto& index : row.table()->indexes()) {
+        if (!index.unique())
+            continue;
+        IndexRange range;
+        for (auto& part : index.key_definition()) {
+            // NULLs never compare equal to anything, so they don't violate the constraint.
+            if (row[part.name()].is_null())
+                break;
+            range.equal_values.append(row[part.name()]);
+        }
+        if (range.equal_values.size() < index.size())
+            continue;
+        auto iterator = find_first_in_range(index, range);
+        if (!iterator.is_end() && !is_past_range(index, range, *iterator))
+            return &index;
+    }
+    return nullptr;
+}
+
 ErrorOr<void> Database::insert(Row& row)
 {
     VERIFY(m_table_cache.get(row.table()->key().hash()).has_value());
-    // TODO Check constraints
+    // TODO Check other constraints
+    if (auto index = unique_index_violated_by(row)) {
+        warnln("Unique constraint on index '{}' violated"sv, index->name());
+        return Error::from_string_literal("Unique constraint violated"sv);
+    }
 
     row.set_pointer(m_heap->new_record_pointer());
     row.next_pointer(row.table()->pointer());
     TRY(update(row));
 
-    // TODO update indexes defined on table.
+    for (auto& index : row.table()->indexes())
+        VERIFY(index_tree(index).insert(make_index_key(index, row)));
 
     auto table_key = row.table()->key();
     table_key.set_pointer(row.pointer());
@@ -7,8 +7,11 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
 #include <AK/RefPtr.h>
 #include <AK/String.h>
+#include <AK/Vector.h>
 #include <LibCore/Object.h>
 #include <LibSQL/Forward.h>
 #include <LibSQL/Heap.h>
@@ -16,6 +19,23 @@
 
 namespace SQL {
 
+struct IndexBound {
+    Value value;
+    bool inclusive { true };
+};
+
+/**
+ * Describes the keys of an index that should be visited: the leading key parts
+ * are equal to the given values, and the key part after those is optionally
+ * restricted to a range. The bounds are in the natural order of the values,
+ * regardless of the sort order of the key part.
+ */
+struct IndexRange {
+    Vector<Value> equal_values;
+    Optional<IndexBound> lower_bound;
+    Optional<IndexBound> upper_bound;
+};
+
 /**
  * A Database object logically connects a Heap with the SQL data we want
  * to store in it. It has BTree pointers for B-Trees holding the definitions
@@ -39,23 +59,34 @@ public:
     static Key get_table_key(String const&, String const&);
     ErrorOr<RefPtr<TableDef>> get_table(String const&, String const&);
 
+    ErrorOr<void> add_index(IndexDef&);
+
     ErrorOr<Vector<Row>> select_all(TableDef const&);
+    ErrorOr<Vector<Row>> select_range(IndexDef const&, IndexRange const&);
     ErrorOr<Vector<Row>> match(TableDef const&, Key const&);
+    IndexDef const* unique_index_violated_by(Row const&);
     ErrorOr<void> insert(Row&);
     ErrorOr<void> update(Row&);
 
 private:
     explicit Database(String);
 
+    BTree& index_tree(IndexDef const&);
+    Key make_index_key(IndexDef const&, Row const&);
+    BTreeIterator find_first_in_range(IndexDef const&, IndexRange const&);
+    static bool is_past_range(IndexDef const&, IndexRange const&, Key const&);
+
     bool m_open { false };
     NonnullRefPtr<Heap> m_heap;
     Serializer m_serializer;
     RefPtr<BTree> m_schemas;
     RefPtr<BTree> m_tables;
     RefPtr<BTree> m_table_columns;
+    RefPtr<BTree> m_table_indexes;
 
     HashMap<u32, RefPtr<SchemaDef>> m_schema_cache;
     HashMap<u32, RefPtr<TableDef>> m_table_cache;
+    HashMap<IndexDef const*, NonnullRefPtr<BTree>> m_index_trees;
 };
 
 }
@@ -74,61 +74,108 @@ ErrorOr<ByteBuffer> Heap::read_block(u32 block)
     if (buffer_or_empty.has_value())
         return buffer_or_empty.release_value();
 
+    if (auto cached_block = m_cache.get(block); cached_block.has_value()) {
+        m_cache_lru_list.prepend(*cached_block.value());
+        return cached_block.value()->buffer;
+    }
+
     if (block >= m_next_block) {
         warnln("Heap({})::read_block({}): block # out of range (>= {})"sv, name(), block, m_next_block);
         return Error::from_string_literal("Heap()::read_block(): block # out of range"sv);
     }
+    auto ret = TRY(read_block_from_file(block));
+    dbgln_if(SQL_DEBUG, "{:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x}",
+        *ret.offset_pointer(0), *ret.offset_pointer(1),
+        *ret.offset_pointer(2), *ret.offset_pointer(3),
+        *ret.offset_pointer(4), *ret.offset_pointer(5),
+        *ret.offset_pointer(6), *ret.offset_pointer(7));
+    add_to_cache(block, ret);
+    return ret;
+}
+
+ErrorOr<ByteBuffer> Heap::read_block_from_file(u32 block)
+{
     dbgln_if(SQL_DEBUG, "Read heap block {}", block);
+
+    // The file only changes in flush(), which drops the mapping, so a mapping
+    // covering the block is always up to date.
+    auto offset = static_cast<size_t>(block) * BLOCKSIZE;
+    if (m_mapped_file.is_null() && block < m_end_of_file) {
+        auto mapped_file_or_error = Core::MappedFile::map(name());
+        if (mapped_file_or_error.is_error())
+            dbgln_if(SQL_DEBUG, "Heap({}): Could not map file: {}", name(), mapped_file_or_error.error());
+        else
+            m_mapped_file = mapped_file_or_error.release_value();
+    }
+    if (m_mapped_file && offset + BLOCKSIZE <= m_mapped_file->size())
+        return ByteBuffer::copy(m_mapped_file->bytes().slice(offset, BLOCKSIZE));
+
     TRY(seek_block(block));
     auto ret = m_file->read(BLOCKSIZE);
     if (ret.is_empty()) {
         warnln("Heap({})::read_block({}): Could not read block"sv, name(), block);
         return Error::from_string_literal("Heap()::read_block(): Could not read block"sv);
     }
-    dbgln_if(SQL_DEBUG, "{:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x}",
-        *ret.offset_pointer(0), *ret.offset_pointer(1),
-        *ret.offset_pointer(2), *ret.offset_pointer(3),
-        *ret.offset_pointer(4), *ret.offset_pointer(5),
-        *ret.offset_pointer(6), *ret.offset_pointer(7));
     return ret;
 }
 
-ErrorOr<void> Heap::write_block(u32 block, ByteBuffer& buffer)
+void Heap::add_to_cache(u32 block, ByteBuffer const& buffer)
+{
+    if (auto cached_block = m_cache.get(block); cached_block.has_value()) {
+        cached_block.value()->buffer = buffer;
+        m_cache_lru_list.prepend(*cached_block.value());
+        return;
+    }
+    if (m_cache.size() >= max_cached_blocks) {
+        auto* least_recently_used = m_cache_lru_list.take_last();
+        VERIFY(least_recently_used);
+        m_cache.remove(least_recently_used->block);
+    }
+    auto cached_block = make<CachedBlock>();
+    cached_block->block = block;
+    cached_block->buffer = buffer;
+    m_cache_lru_list.prepend(*cached_block);
+    m_cache.set(block, move(cached_block));
+}
+
+ErrorOr<void> Heap::write_blocks(Span<u32 const> blocks)
 {
+    VERIFY(!blocks.is_empty());
+    auto first_block = blocks[0];
     if (m_file.is_null()) {
-        warnln("Heap({})::write_block({}): Heap file not opened"sv, name(), block);
-        return Error::from_string_literal("Heap()::write_block(): Heap file not opened"sv);
+        warnln("Heap({})::write_blocks({}): Heap file not opened"sv, name(), first_block);
+        return Error::from_string_literal("Heap()::write_blocks(): Heap file not opened"sv);
     }
-    if (block > m_next_block) {
-        warnln("Heap({})::write_block({}): block # out of range (> {})"sv, name(), block, m_next_block);
-        return Error::from_string_literal("Heap()::write_block(): block # out of range"sv);
+    if (first_block > m_next_block) {
+        warnln("Heap({})::write_blocks({}): block # out of range (> {})"sv, name(), first_block, m_next_block);
+        return Error::from_string_literal("Heap()::write_blocks(): block # out of range"sv);
     }
-    TRY(seek_block(block));
-    dbgln_if(SQL_DEBUG, "Write heap block {} size {}", block, buffer.size());
-    if (buffer.size() > BLOCKSIZE) {
-        warnln("Heap({})::write_block({}): Oversized block ({} > {})"sv, name(), block, buffer.size(), BLOCKSIZE);
-        return Error::from_string_literal("Heap()::write_block(): Oversized block"sv);
+    TRY(seek_block(first_block));
+
+    auto buffer_or_error = ByteBuffer::create_zeroed(blocks.size() * BLOCKSIZE);
+    if (buffer_or_error.is_error()) {
+        warnln("Heap({})::write_blocks({}): Could not allocate buffer for {} blocks"sv, name(), first_block, blocks.size());
+        return Error::from_string_literal("Heap()::write_blocks(): Could not allocate buffer"sv);
     }
-    auto sz = buffer.size();
-    if (sz < BLOCKSIZE) {
-        if (buffer.try_resize(BLOCKSIZE).is_error()) {
-            warnln("Heap({})::write_block({}): Could not align block of size {} to {}"sv, name(), block, buffer.size(), BLOCKSIZE);
-            return Error::from_string_literal("Heap()::write_block(): Could not align block"sv);
+    auto buffer = buffer_or_error.release_value();
+    for (auto ix = 0u; ix < blocks.size(); ix++) {
+        VERIFY(blocks[ix] == first_block + ix);
+        auto& block_buffer = m_write_ahead_log.find(blocks[ix])->value;
+        dbgln_if(SQL_DEBUG, "Write heap block {} size {}", blocks[ix], block_buffer.size());
+        if (block_buffer.size() > BLOCKSIZE) {
+            warnln("Heap({})::write_blocks({}): Oversized block ({} > {})"sv, name(), blocks[ix], block_buffer.size(), BLOCKSIZE);
+            return Error::from_string_literal("Heap()::write_blocks(): Oversized block"sv);
         }
-        memset(buffer.offset_pointer((int)sz), 0, BLOCKSIZE - sz);
+        buffer.overwrite(ix * BLOCKSIZE, block_buffer.data(), block_buffer.size());
     }
-    dbgln_if(SQL_DEBUG, "{:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x} {:02x}",
-        *buffer.offset_pointer(0), *buffer.offset_pointer(1),
-        *buffer.offset_pointer(2), *buffer.offset_pointer(3),
-        *buffer.offset_pointer(4), *buffer.offset_pointer(5),
-        *buffer.offset_pointer(6), *buffer.offset_pointer(7));
-    if (m_file->write(buffer.data(), (int)buffer.size())) {
-        if (block == m_end_of_file)
-            m_end_of_file++;
-        return {};
+    if (!m_file->write(buffer.data(), (int)buffer.size())) {
+        warnln("Heap({})::write_blocks({}): Could not fully write {} blocks"sv, name(), first_block, blocks.size());
+        return Error::from_string_literal("Heap()::write_blocks(): Could not fully write blocks"sv);
     }
-    warnln("Heap({})::write_block({}): Could not full write block"sv, name(), block);
-    return Error::from_string_literal("Heap()::write_block(): Could not full write block"sv);
+    m_end_of_file = max(m_end_of_file, first_block + static_cast<u32>(blocks.size()));
+    for (auto ix = 0u; ix < blocks.size(); ix++)
+        add_to_cache(blocks[ix], buffer.slice(ix * BLOCKSIZE, BLOCKSIZE));
+    return {};
 }
 
 ErrorOr<void> Heap::seek_block(u32 block)
@@ -180,11 +227,17 @@ ErrorOr<void> Heap::flush()
         blocks.append(wal_entry.key);
     }
     quick_sort(blocks);
-    for (auto& block : blocks) {
-        auto buffer_it = m_write_ahead_log.find(block);
-        VERIFY(buffer_it != m_write_ahead_log.end());
-        dbgln_if(SQL_DEBUG, "Flushing block {} to {}", block, name());
-        TRY(write_block(block, buffer_it->value));
+
+    // Writes to the file don't necessarily show up in an existing mapping.
+    m_mapped_file = nullptr;
+
+    for (size_t run_start = 0; run_start < blocks.size();) {
+        auto run_end = run_start + 1;
+        while (run_end < blocks.size() && blocks[run_end] == blocks[run_end - 1] + 1)
+            run_end++;
+        dbgln_if(SQL_DEBUG, "Flushing blocks {}-{} to {}", blocks[run_start], blocks[run_end - 1], name());
+        TRY(write_blocks(blocks.span().slice(run_start, run_end - run_start)));
+        run_start = run_end;
     }
     m_write_ahead_log.clear();
     dbgln_if(SQL_DEBUG, "WAL flushed. Heap size = {}", size());
@@ -198,6 +251,7 @@ constexpr static int TABLES_ROOT_OFFSET = 20;
 constexpr static int TABLE_COLUMNS_ROOT_OFFSET = 24;
 constexpr static int FREE_LIST_OFFSET = 28;
 constexpr static int USER_VALUES_OFFSET = 32;
+constexpr static int TABLE_INDEXES_ROOT_OFFSET = 96;
 
 ErrorOr<void> Heap::read_zero_block()
 {
@@ -217,6 +271,8 @@ ErrorOr<void> Heap::read_zero_block()
     dbgln_if(SQL_DEBUG, "Tables root node: {}", m_tables_root);
     memcpy(&m_table_columns_root, buffer.offset_pointer(TABLE_COLUMNS_ROOT_OFFSET), sizeof(u32));
     dbgln_if(SQL_DEBUG, "Table columns root node: {}", m_table_columns_root);
+    memcpy(&m_table_indexes_root, buffer.offset_pointer(TABLE_INDEXES_ROOT_OFFSET), sizeof(u32));
+    dbgln_if(SQL_DEBUG, "Table indexes root node: {}", m_table_indexes_root);
     memcpy(&m_free_list, buffer.offset_pointer(FREE_LIST_OFFSET), sizeof(u32));
     dbgln_if(SQL_DEBUG, "Free list: {}", m_free_list);
     memcpy(m_user_values.data(), buffer.offset_pointer(USER_VALUES_OFFSET), m_user_values.size() * sizeof(u32));
@@ -235,6 +291,7 @@ void Heap::update_zero_block()
     dbgln_if(SQL_DEBUG, "Schemas root node: {}", m_schemas_root);
     dbgln_if(SQL_DEBUG, "Tables root node: {}", m_tables_root);
     dbgln_if(SQL_DEBUG, "Table Columns root node: {}", m_table_columns_root);
+    dbgln_if(SQL_DEBUG, "Table Indexes root node: {}", m_table_indexes_root);
     dbgln_if(SQL_DEBUG, "Free list: {}", m_free_list);
     for (auto ix = 0u; ix < m_user_values.size(); ix++) {
         if (m_user_values[ix]) {
@@ -242,16 +299,24 @@ void Heap::update_zero_block()
         }
     }
 
-    // FIXME: Handle an OOM failure here.
-    auto buffer = ByteBuffer::create_zeroed(BLOCKSIZE).release_value_but_fixme_should_propagate_errors();
-    buffer.overwrite(0, FILE_ID.characters_without_null_termination(), FILE_ID.length());
-    buffer.overwrite(VERSION_OFFSET, &m_version, sizeof(u32));
-    buffer.overwrite(SCHEMAS_ROOT_OFFSET, &m_schemas_root, sizeof(u32));
-    buffer.overwrite(TABLES_ROOT_OFFSET, &m_tables_root, sizeof(u32));
-    buffer.overwrite(TABLE_COLUMNS_ROOT_OFFSET, &m_table_columns_root, sizeof(u32));
-    buffer.overwrite(FREE_LIST_OFFSET, &m_free_list, sizeof(u32));
-    buffer.overwrite(USER_VALUES_OFFSET, m_user_values.data(), m_user_values.size() * sizeof(u32));
+    // The block is assembled on the stack, as GCC can't tell that the offsets
+    // below are past the inline capacity of a ByteBuffer.
+    Array<u8, BLOCKSIZE> block {};
+    auto overwrite = [&](size_t offset, void const* data, size_t size) {
+        VERIFY(offset + size <= block.size());
+        memcpy(block.data() + offset, data, size);
+    };
+    overwrite(0, FILE_ID.characters_without_null_termination(), FILE_ID.length());
+    overwrite(VERSION_OFFSET, &m_version, sizeof(u32));
+    overwrite(SCHEMAS_ROOT_OFFSET, &m_schemas_root, sizeof(u32));
+    overwrite(TABLES_ROOT_OFFSET, &m_tables_root, sizeof(u32));
+    overwrite(TABLE_COLUMNS_ROOT_OFFSET, &m_table_columns_root, sizeof(u32));
+    overwrite(FREE_LIST_OFFSET, &m_free_list, sizeof(u32));
+    overwrite(USER_VALUES_OFFSET, m_user_values.data(), m_user_values.size() * sizeof(u32));
+    overwrite(TABLE_INDEXES_ROOT_OFFSET, &m_table_indexes_root, sizeof(u32));
 
+    // FIXME: Handle an OOM failure here.
+    auto buffer = ByteBuffer::copy(block.span()).release_value_but_fixme_should_propagate_errors();
     add_to_wal(0, buffer);
 }
 
@@ -261,6 +326,7 @@ void Heap::initialize_zero_block()
     m_schemas_root = 0;
     m_tables_root = 0;
     m_table_columns_root = 0;
+    m_table_indexes_root = 0;
     m_next_block = 1;
     m_free_list = 0;
     for (auto& user : m_user_values) {
@@ -9,9 +9,12 @@
 #include <AK/Array.h>
 #include <AK/Debug.h>
 #include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
 #include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibCore/Object.h>
 
 namespace SQL {
@@ -28,6 +31,11 @@ constexpr static u32 BLOCKSIZE = 1024;
  * assumed that a single SQL database is backed by a single Heap.
  *
  * Currently only B-Trees and tuple stores are implemented.
+ *
+ * Blocks that are modified are kept in the write-ahead log until the next
+ * flush(), which writes them out in as few contiguous runs as possible.
+ * Blocks read from the file are kept in a bounded LRU cache, and are read
+ * through a memory mapping of the file when one can be established.
  */
 class Heap : public Core::Object {
     C_OBJECT(Heap);
@@ -65,6 +73,15 @@ public:
         m_table_columns_root = root;
         update_zero_block();
     }
+
+    u32 table_indexes_root() const { return m_table_indexes_root; }
+
+    void set_table_indexes_root(u32 root)
+    {
+        m_table_indexes_root = root;
+        update_zero_block();
+    }
+
     u32 version() const { return m_version; }
 
     u32 user_value(size_t index) const
@@ -93,11 +110,24 @@ public:
 
     ErrorOr<void> flush();
 
+    static constexpr size_t max_cached_blocks = 256;
+    size_t cached_blocks() const { return m_cache.size(); }
+
 private:
     explicit Heap(String);
 
-    ErrorOr<void> write_block(u32, ByteBuffer&);
+    struct CachedBlock {
+        u32 block { 0 };
+        ByteBuffer buffer;
+        IntrusiveListNode<CachedBlock> list_node;
+
+        using List = IntrusiveList<&CachedBlock::list_node>;
+    };
+
+    ErrorOr<ByteBuffer> read_block_from_file(u32);
+    ErrorOr<void> write_blocks(Span<u32 const> blocks);
     ErrorOr<void> seek_block(u32);
+    void add_to_cache(u32, ByteBuffer const&);
     ErrorOr<void> read_zero_block();
     void initialize_zero_block();
     void update_zero_block();
@@ -109,9 +139,13 @@ private:
     u32 m_schemas_root { 0 };
     u32 m_tables_root { 0 };
     u32 m_table_columns_root { 0 };
+    u32 m_table_indexes_root { 0 };
     u32 m_version { 0x00000001 };
     Array<u32, 16> m_user_values { 0 };
     HashMap<u32, ByteBuffer> m_write_ahead_log;
+    HashMap<u32, NonnullOwnPtr<CachedBlock>> m_cache;
+    CachedBlock::List m_cache_lru_list;
+    RefPtr<Core::MappedFile> m_mapped_file;
 };
 
 }
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/StringBuilder.h>
 #include <LibSQL/Key.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Type.h>
@@ -129,9 +130,33 @@ Key IndexDef::key() const
     key["table_hash"] = parent_relation()->key().hash();
     key["index_name"] = name();
     key["unique"] = unique() ? 1 : 0;
+    key["columns"] = encode_key_definition();
+    key.set_pointer(pointer());
     return key;
 }
 
+// The key parts are stored as a comma-separated list of table column numbers,
+// each followed by 'A' or 'D' for the sort order. For example "2A,0D".
+String IndexDef::encode_key_definition() const
+{
+    auto const* table = dynamic_cast<TableDef const*>(parent());
+    VERIFY(table);
+
+    StringBuilder builder;
+    for (auto& part : m_key_definition) {
+        Optional<size_t> column_number;
+        for (auto& column : table->columns()) {
+            if (column.name() == part.name())
+                column_number = column.column_number();
+        }
+        VERIFY(column_number.has_value());
+        if (!builder.is_empty())
+            builder.append(',');
+        builder.appendff("{}{}", column_number.value(), part.sort_order() == Order::Descending ? 'D' : 'A');
+    }
+    return builder.to_string();
+}
+
 Key IndexDef::make_key(TableDef const& table_def)
 {
     Key key(index_def());
@@ -146,6 +171,7 @@ NonnullRefPtr<IndexDef> IndexDef::index_def()
         s_index_def->append_column("table_hash", SQLType::Integer, Order::Ascending);
         s_index_def->append_column("index_name", SQLType::Text, Order::Ascending);
         s_index_def->append_column("unique", SQLType::Integer, Order::Ascending);
+        s_index_def->append_column("columns", SQLType::Text, Order::Ascending);
     }
     return s_index_def;
 }
@@ -188,6 +214,24 @@ void TableDef::append_column(Key const& column)
         (SQLType)((int)column["column_type"]));
 }
 
+void TableDef::append_index(NonnullRefPtr<IndexDef> index)
+{
+    VERIFY(index->parent() == this);
+    m_indexes.append(move(index));
+}
+
+void TableDef::append_index(Key const& index_key)
+{
+    auto index = IndexDef::construct(this, (String)index_key["index_name"], (int)index_key["unique"] != 0, index_key.pointer());
+    for (auto part : ((String)index_key["columns"]).split_view(',')) {
+        auto column_number = part.substring_view(0, part.length() - 1).to_uint();
+        VERIFY(column_number.has_value() && column_number.value() < m_columns.size());
+        auto& column = m_columns[column_number.value()];
+        index->append_column(column.name(), column.type(), part.ends_with('D') ? Order::Descending : Order::Ascending);
+    }
+    m_indexes.append(move(index));
+}
+
 Key TableDef::make_key(SchemaDef const& schema_def)
 {
     return TableDef::make_key(schema_def.key());
@@ -108,6 +108,8 @@ class IndexDef : public Relation {
     C_OBJECT(IndexDef);
 
 public:
+    static constexpr StringView primary_key_index_name = "$primary_key"sv;
+
     ~IndexDef() override = default;
 
     NonnullRefPtrVector<KeyPartDef> const& key_definition() const { return m_key_definition; }
@@ -123,6 +125,8 @@ private:
     IndexDef(TableDef*, String, bool unique = true, u32 pointer = 0);
     explicit IndexDef(String, bool unique = true, u32 pointer = 0);
 
+    String encode_key_definition() const;
+
     NonnullRefPtrVector<KeyPartDef> m_key_definition;
     bool m_unique { false };
 
@@ -136,6 +140,8 @@ public:
     Key key() const override;
     void append_column(String, SQLType);
     void append_column(Key const&);
+    void append_index(NonnullRefPtr<IndexDef>);
+    void append_index(Key const&);
     size_t num_columns() { return m_columns.size(); }
     size_t num_indexes() { return m_indexes.size(); }
     NonnullRefPtrVector<ColumnDef> const& columns() const { return m_columns; }
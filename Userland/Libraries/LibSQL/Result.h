@@ -18,6 +18,7 @@ namespace SQL {
     S(Create)                     \
     S(Delete)                     \
     S(Describe)                   \
+    S(Explain)                    \
     S(Insert)                     \
     S(Select)                     \
     S(Update)
@@ -55,6 +56,9 @@ constexpr char const* command_tag(SQLCommand command)
     S(ColumnDoesNotExist, "Column '{}' does not exist")                                  \
     S(AmbiguousColumnName, "Column name '{}' is ambiguous")                              \
     S(TableExists, "Table '{}' already exist")                                           \
+    S(IndexExists, "Index '{}' already exist")                                           \
+    S(TooManyPrimaryKeys, "Table '{}' has more than one primary key")                    \
+    S(UniqueConstraintViolated, "Unique constraint on index '{}' violated")              \
     S(InvalidType, "Invalid type '{}'")                                                  \
     S(InvalidDatabaseName, "Invalid database name '{}'")                                 \
     S(InvalidValueType, "Invalid type for attribute '{}'")                               \
@@ -346,7 +346,7 @@ void TreeNode::split()
     dump_if(SQL_DEBUG, "Split Left To WAL");
     tree().serializer().serialize_and_write(*this, pointer());
     new_node->dump_if(SQL_DEBUG, "Split Right to WAL");
-    tree().serializer().serialize_and_write(*new_node, pointer());
+    tree().serializer().serialize_and_write(*new_node, new_node->pointer());
 
     m_up->just_insert(median, new_node);
 }
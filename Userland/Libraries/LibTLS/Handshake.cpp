@@ -35,6 +35,23 @@ ByteBuffer TLSv12::build_hello()
     builder.append(version);
     builder.append(m_context.local_random, sizeof(m_context.local_random));
 
+    // Offer to resume the last session with this host, if we remember one.
+    if (m_context.options.session_cache && !m_context.extensions.SNI.is_null()) {
+        auto session = m_context.options.session_cache->find(m_context.extensions.SNI);
+        if (session.has_value() && m_context.options.usable_cipher_suites.contains_slow(session->cipher)) {
+            if (!session->ticket.is_empty()) {
+                // RFC 5077 section 3.4: If the server accepts the ticket, it echoes the session ID we send along with it.
+                fill_with_random(m_context.session_id, sizeof(m_context.session_id));
+                m_context.session_id_size = sizeof(m_context.session_id);
+            } else {
+                VERIFY(session->session_id.size() <= sizeof(m_context.session_id));
+                session->session_id.bytes().copy_to({ m_context.session_id, sizeof(m_context.session_id) });
+                m_context.session_id_size = session->session_id.size();
+            }
+            m_context.offered_session = session.release_value();
+        }
+    }
+
     builder.append(m_context.session_id_size);
     if (m_context.session_id_size)
         builder.append(m_context.session_id, m_context.session_id_size);
@@ -76,6 +93,14 @@ ByteBuffer TLSv12::build_hello()
     auto supported_ec_point_formats_length = m_context.options.supported_ec_point_formats.size();
     bool supports_elliptic_curves = elliptic_curves_length && supported_ec_point_formats_length;
 
+    // session_ticket: sent empty to ask for a ticket, or with the ticket of the session we'd like to resume.
+    bool supports_session_tickets = m_context.options.session_cache;
+    ReadonlyBytes session_ticket;
+    if (m_context.offered_session.has_value())
+        session_ticket = m_context.offered_session->ticket;
+    if (supports_session_tickets)
+        extension_length += 4 + session_ticket.size();
+
     // signature_algorithms: 2b extension ID, 2b extension length, 2b vector length, 2xN signatures and hashes
     extension_length += 2 + 2 + 2 + 2 * m_context.options.supported_signature_algorithms.size();
 
@@ -130,6 +155,13 @@ ByteBuffer TLSv12::build_hello()
             builder.append((u8)format);
     }
 
+    if (supports_session_tickets) {
+        // session_ticket extension
+        builder.append((u16)HandshakeExtension::SessionTicket);
+        builder.append((u16)session_ticket.size());
+        builder.append(session_ticket);
+    }
+
     if (alpn_length) {
         // TODO
         VERIFY_NOT_REACHED();
@@ -218,6 +250,20 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
 
     // TODO: Compare Hashes
     dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
+
+    if (m_context.is_resuming_session) {
+        // When resuming, the server finishes first, and we still have to send our own Finished.
+        write_packets = WritePacketStage::Finished;
+        return index + size;
+    }
+
+    finish_handshake();
+
+    return index + size;
+}
+
+void TLSv12::finish_handshake()
+{
     m_context.connection_status = ConnectionStatus::Established;
 
     if (m_handshake_timeout_timer) {
@@ -227,10 +273,37 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
         m_handshake_timeout_timer = nullptr;
     }
 
+    store_session();
+
     if (on_connected)
         on_connected();
+}
 
-    return index + size;
+ssize_t TLSv12::handle_new_session_ticket(ReadonlyBytes buffer)
+{
+    // RFC 5077 section 3.3: The ticket is opaque to us, we only send it back when resuming the session.
+    if (buffer.size() < 3)
+        return (i8)Error::NeedMoreData;
+
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+    if (size < 6)
+        return (i8)Error::BrokenPacket;
+
+    auto lifetime = AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.offset_pointer(3)));
+    u16 ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(7)));
+    if (size != 6u + ticket_length)
+        return (i8)Error::BrokenPacket;
+
+    // An empty ticket means the server changed its mind about issuing one.
+    auto ticket = ByteBuffer::copy(buffer.slice(9, ticket_length));
+    if (ticket.is_error())
+        return (i8)Error::OutOfMemory;
+    m_context.new_session_ticket = ticket.release_value();
+    m_context.new_session_ticket_lifetime_in_seconds = lifetime;
+
+    return size + 3;
 }
 
 ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
@@ -299,6 +372,21 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             dbgln("unsupported: DTLS");
             payload_res = (i8)Error::UnexpectedMessage;
             break;
+        case NewSessionTicket:
+            if (m_context.handshake_messages[11] >= 1) {
+                dbgln("unexpected new session ticket message");
+                payload_res = (i8)Error::UnexpectedMessage;
+                break;
+            }
+            ++m_context.handshake_messages[11];
+            dbgln_if(TLS_DEBUG, "new session ticket");
+            // We only ask for tickets if there's a cache to put them in.
+            if (m_context.connection_status == ConnectionStatus::KeyExchange && m_context.options.session_cache) {
+                payload_res = handle_new_session_ticket(buffer.slice(1, payload_size));
+            } else {
+                payload_res = (i8)Error::UnexpectedMessage;
+            }
+            break;
         case CertificateMessage:
             if (m_context.handshake_messages[4] >= 1) {
                 dbgln("unexpected certificate message");
@@ -553,7 +641,7 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 auto packet = build_handshake_finished();
                 write_packet(packet);
             }
-            m_context.connection_status = ConnectionStatus::Established;
+            finish_handshake();
             break;
         }
         payload_size++;
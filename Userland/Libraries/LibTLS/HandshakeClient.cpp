@@ -8,6 +8,7 @@
 #include <AK/Debug.h>
 #include <AK/Hex.h>
 #include <AK/Random.h>
+#include <LibCore/DateTime.h>
 #include <LibCrypto/ASN1/DER.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 #include <LibCrypto/Curves/X25519.h>
@@ -43,7 +44,8 @@ bool TLSv12::expand_key()
 
     size_t offset = 0;
     if (is_aead) {
-        iv_size = 4; // Explicit IV size.
+        // The AEAD nonce is 12 bytes long. iv_length() of them are sent with every record, the rest is the fixed IV.
+        iv_size = 12 - iv_size;
     } else {
         memcpy(m_context.crypto.local_mac, key + offset, mac_size);
         offset += mac_size;
@@ -98,6 +100,15 @@ bool TLSv12::expand_key()
         m_cipher_remote = Crypto::Cipher::AESCipher::GCMMode(ReadonlyBytes { server_key, key_size }, key_size * 8, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
         break;
     }
+    case CipherAlgorithm::CHACHA20_POLY1305: {
+        VERIFY(is_aead);
+        memcpy(m_context.crypto.local_aead_iv, client_iv, iv_size);
+        memcpy(m_context.crypto.remote_aead_iv, server_iv, iv_size);
+
+        m_cipher_local = Crypto::Cipher::ChaCha20Poly1305(ReadonlyBytes { client_key, key_size });
+        m_cipher_remote = Crypto::Cipher::ChaCha20Poly1305(ReadonlyBytes { server_key, key_size });
+        break;
+    }
     case CipherAlgorithm::AES_128_CCM:
         dbgln("Requested unimplemented AES CCM cipher");
         TODO();
@@ -153,6 +164,62 @@ bool TLSv12::compute_master_secret_from_pre_master_secret(size_t length)
     return true;
 }
 
+bool TLSv12::resume_session(Session const& session)
+{
+    if (session.cipher != m_context.cipher) {
+        dbgln("Server resumed a session with a different cipher suite");
+        return false;
+    }
+
+    auto master_key = ByteBuffer::copy(session.master_key);
+    if (master_key.is_error()) {
+        dbgln("Couldn't allocate enough space for the master key :(");
+        return false;
+    }
+    m_context.master_key = master_key.release_value();
+    m_context.is_resuming_session = true;
+
+    // The keys are derived from the old master secret and the new randoms, and the server changes cipher spec right away.
+    if (!expand_key())
+        return false;
+    m_context.connection_status = ConnectionStatus::KeyExchange;
+    return true;
+}
+
+void TLSv12::store_session()
+{
+    auto& cache = m_context.options.session_cache;
+    if (!cache || m_context.extensions.SNI.is_null())
+        return;
+
+    if (m_context.session_id_size == 0 && m_context.new_session_ticket.is_empty()) {
+        // The server doesn't let us resume this session, so any session we had with it is stale.
+        cache->remove(m_context.extensions.SNI);
+        return;
+    }
+
+    Session session;
+    session.cipher = m_context.cipher;
+    auto master_key = ByteBuffer::copy(m_context.master_key);
+    auto session_id = ByteBuffer::copy(m_context.session_id, m_context.session_id_size);
+    if (master_key.is_error() || session_id.is_error())
+        return;
+    session.master_key = master_key.release_value();
+    session.session_id = session_id.release_value();
+
+    if (!m_context.new_session_ticket.is_empty()) {
+        session.ticket = move(m_context.new_session_ticket);
+        if (m_context.new_session_ticket_lifetime_in_seconds != 0)
+            session.expiration_timestamp = Core::DateTime::now().timestamp() + m_context.new_session_ticket_lifetime_in_seconds;
+    } else if (m_context.is_resuming_session && m_context.offered_session.has_value()) {
+        // The server didn't renew the ticket, so the old one is still the one to use.
+        session.ticket = m_context.offered_session->ticket;
+        session.expiration_timestamp = m_context.offered_session->expiration_timestamp;
+    }
+
+    cache->set(m_context.extensions.SNI, move(session));
+}
+
 static bool wildcard_matches(StringView host, StringView subject)
 {
     if (host.matches(subject))
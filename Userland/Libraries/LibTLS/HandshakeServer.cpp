@@ -57,6 +57,12 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         return (i8)Error::NeedMoreData;
     }
 
+    // The server echoes the session ID we offered if it agrees to resume that session.
+    bool resumes_offered_session = m_context.offered_session.has_value()
+        && session_length != 0
+        && session_length == m_context.session_id_size
+        && memcmp(m_context.session_id, buffer.offset_pointer(res), session_length) == 0;
+
     if (session_length && session_length <= 32) {
         memcpy(m_context.session_id, buffer.offset_pointer(res), session_length);
         m_context.session_id_size = session_length;
@@ -173,6 +179,9 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
             print_buffer(buffer.slice(res, extension_length));
             res += extension_length;
             // FIXME: what are we supposed to do here?
+        } else if (extension_type == HandshakeExtension::SessionTicket) {
+            // The server will send us a ticket with NewSessionTicket, there's nothing to do until then.
+            res += extension_length;
         } else if (extension_type == HandshakeExtension::ECPointFormats) {
             // RFC8422 section 5.2: A server that selects an ECC cipher suite in response to a ClientHello message
             // including a Supported Point Formats Extension appends this extension (along with others) to its
@@ -189,6 +198,12 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         }
     }
 
+    if (resumes_offered_session) {
+        dbgln_if(TLS_DEBUG, "Resuming session");
+        if (!resume_session(*m_context.offered_session))
+            return (i8)Error::NotUnderstood;
+    }
+
     return res;
 }
 
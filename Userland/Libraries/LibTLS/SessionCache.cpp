@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/DateTime.h>
+#include <LibTLS/SessionCache.h>
+
+namespace TLS {
+
+Optional<Session> SessionCache::find(String const& host) const
+{
+    auto session = m_sessions.get(host);
+    if (!session.has_value() || session->expiration_timestamp <= Core::DateTime::now().timestamp())
+        return {};
+    return session;
+}
+
+void SessionCache::set(String const& host, Session session)
+{
+    auto now = Core::DateTime::now().timestamp();
+    if (session.expiration_timestamp == 0 || session.expiration_timestamp > now + max_session_lifetime_in_seconds)
+        session.expiration_timestamp = now + max_session_lifetime_in_seconds;
+
+    if (!m_sessions.contains(host) && m_sessions.size() >= max_sessions) {
+        m_sessions.remove_all_matching([&](auto&, auto& cached_session) { return cached_session.expiration_timestamp <= now; });
+        if (m_sessions.size() >= max_sessions) {
+            // Make room by forgetting the session that would have expired first.
+            auto oldest = m_sessions.begin();
+            for (auto it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+                if (it->value.expiration_timestamp < oldest->value.expiration_timestamp)
+                    oldest = it;
+            }
+            m_sessions.remove(oldest);
+        }
+    }
+
+    m_sessions.set(host, move(session));
+}
+
+void SessionCache::remove(String const& host)
+{
+    m_sessions.remove(host);
+}
+
+}
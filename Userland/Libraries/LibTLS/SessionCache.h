@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/String.h>
+#include <LibTLS/CipherSuite.h>
+#include <time.h>
+
+namespace TLS {
+
+// What's left of an earlier connection to a server, which lets the next connection to it skip the key exchange.
+// The server finds the session either by its ID (RFC 5246 section 7.4.1.2), or from the ticket it issued (RFC 5077).
+struct Session {
+    CipherSuite cipher { CipherSuite::Invalid };
+    ByteBuffer master_key;
+    ByteBuffer session_id;
+    ByteBuffer ticket;
+    time_t expiration_timestamp { 0 };
+};
+
+// Remembers the last session for every host, so that connections which share the cache can resume each other's sessions.
+class SessionCache : public RefCounted<SessionCache> {
+public:
+    static NonnullRefPtr<SessionCache> create() { return adopt_ref(*new SessionCache); }
+
+    // RFC 5246 section F.1.4 suggests an upper limit of 24 hours, we forget sessions well before that.
+    static constexpr time_t max_session_lifetime_in_seconds = 2 * 60 * 60;
+    static constexpr size_t max_sessions = 128;
+
+    Optional<Session> find(String const& host) const;
+    void set(String const& host, Session);
+    void remove(String const& host);
+
+private:
+    SessionCache() = default;
+
+    HashMap<String, Session> m_sessions;
+};
+
+}
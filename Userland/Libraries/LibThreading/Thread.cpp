@@ -34,16 +34,18 @@ void Threading::Thread::start()
         [](void* arg) -> void* {
             Thread* self = static_cast<Thread*>(arg);
             auto exit_code = self->m_action();
-            self->m_tid = 0;
+            // m_tid is left alone here, as join() still needs it to reap the thread once it has finished.
             return reinterpret_cast<void*>(exit_code);
         },
         static_cast<void*>(this));
 
     VERIFY(rc == 0);
+#ifndef AK_OS_MACOS
     if (!m_thread_name.is_empty()) {
         rc = pthread_setname_np(m_tid, m_thread_name.characters());
         VERIFY(rc == 0);
     }
+#endif
     dbgln("Started thread \"{}\", tid = {}", m_thread_name, m_tid);
 }
 
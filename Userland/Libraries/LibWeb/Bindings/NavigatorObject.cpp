@@ -21,7 +21,7 @@ void NavigatorObject::initialize(JS::GlobalObject& global_object)
 {
     auto& heap = this->heap();
     auto* languages = MUST(JS::Array::create(global_object, 0));
-    languages->indexed_properties().append(js_string(heap, "en-US"));
+    languages->indexed_properties_append(js_string(heap, "en-US"));
 
     // FIXME: All of these should be in Navigator's prototype and be native accessors
     u8 attr = JS::Attribute::Configurable | JS::Attribute::Writable | JS::Attribute::Enumerable;
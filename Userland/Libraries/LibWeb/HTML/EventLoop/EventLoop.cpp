@@ -203,8 +203,14 @@ void EventLoop::process()
 
     // FIXME:     2. If there are no tasks in the event loop's task queues and the WorkerGlobalScope object's closing flag is true, then destroy the event loop, aborting these steps, resuming the run a worker steps described in the Web workers section below.
 
+    // NOTE: Until we have idle periods (see step 12), we use the time between tasks to make progress on marking the
+    //       JS heap, so that less of it has to happen during allocations made by scripts.
+    auto& heap = vm().heap();
+    if (heap.is_incremental_marking_in_progress())
+        heap.perform_incremental_marking_step();
+
     // If there are tasks in the queue, schedule a new round of processing. :^)
-    if (m_task_queue.has_runnable_tasks() || !m_microtask_queue.is_empty())
+    if (m_task_queue.has_runnable_tasks() || !m_microtask_queue.is_empty() || heap.is_incremental_marking_in_progress())
         schedule();
 }
 
@@ -12,6 +12,7 @@ namespace RequestServer::ConnectionCache {
 
 HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<Core::Stream::TCPSocket>>>> g_tcp_connection_cache {};
 HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<TLS::TLSv12>>>> g_tls_connection_cache {};
+NonnullRefPtr<TLS::SessionCache> g_tls_session_cache = TLS::SessionCache::create();
 
 void request_did_finish(URL const& url, Core::Stream::Socket const* socket)
 {
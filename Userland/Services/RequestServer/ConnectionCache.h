@@ -95,6 +95,8 @@ namespace RequestServer::ConnectionCache {
 
 extern HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<Core::Stream::TCPSocket>>>> g_tcp_connection_cache;
 extern HashMap<ConnectionKey, NonnullOwnPtr<NonnullOwnPtrVector<Connection<TLS::TLSv12>>>> g_tls_connection_cache;
+// Shared by all TLS connections, so that a new connection to a host can resume the session of an earlier one.
+extern NonnullRefPtr<TLS::SessionCache> g_tls_session_cache;
 
 void request_did_finish(URL const&, Core::Stream::Socket const*);
 void dump_jobs();
@@ -132,6 +134,7 @@ ErrorOr<void> recreate_socket_if_needed(T& connection, URL const& url)
                     return connection.job_data.provide_client_certificates();
                 return {};
             });
+            options.set_session_cache(g_tls_session_cache);
             TRY(set_socket(TRY(SocketType::connect(url.host(), url.port_or_default(), move(options)))));
         } else {
             TRY(set_socket(TRY(SocketType::connect(url.host(), url.port_or_default()))));
@@ -152,7 +155,12 @@ decltype(auto) get_or_create_connection(auto& cache, URL const& url, auto& job)
     auto failed_to_find_a_socket = it.is_end();
     if (failed_to_find_a_socket && sockets_for_url.size() < ConnectionCache::MaxConcurrentConnectionsPerURL) {
         using ConnectionType = RemoveCVReference<decltype(cache.begin()->value->at(0))>;
-        auto connection_result = ConnectionType::SocketType::connect(url.host(), url.port_or_default());
+        auto connection_result = [&] {
+            if constexpr (IsSame<TLS::TLSv12, typename ConnectionType::SocketType>)
+                return ConnectionType::SocketType::connect(url.host(), url.port_or_default(), TLS::Options {}.set_session_cache(g_tls_session_cache));
+            else
+                return ConnectionType::SocketType::connect(url.host(), url.port_or_default());
+        }();
         if (connection_result.is_error()) {
             dbgln("ConnectionCache: Connection to {} failed: {}", url, connection_result.error());
             Core::deferred_invoke([&job] {
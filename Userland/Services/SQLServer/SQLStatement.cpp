@@ -112,6 +112,7 @@ bool SQLStatement::should_send_result_rows() const
 
     switch (m_result->command()) {
     case SQL::SQLCommand::Describe:
+    case SQL::SQLCommand::Explain:
     case SQL::SQLCommand::Select:
         return true;
     default:
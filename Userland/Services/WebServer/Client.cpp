@@ -8,95 +8,256 @@
 #include <AK/Base64.h>
 #include <AK/Debug.h>
 #include <AK/LexicalPath.h>
-#include <AK/MemoryStream.h>
 #include <AK/QuickSort.h>
 #include <AK/StringBuilder.h>
 #include <AK/URL.h>
 #include <LibCore/DateTime.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
-#include <LibCore/FileStream.h>
 #include <LibCore/MappedFile.h>
 #include <LibCore/MimeData.h>
+#include <LibCore/System.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibHTTP/HttpResponse.h>
 #include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
+#include <WebServer/FileCache.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace WebServer {
 
-Client::Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket> socket, Core::Object* parent)
-    : Core::Object(parent)
-    , m_socket(move(socket))
+// How long an idle persistent connection is kept open.
+static constexpr int keep_alive_timeout_ms = 10'000;
+// Requests whose headers don't fit into this many bytes are rejected.
+static constexpr size_t max_request_header_size = 64 * KiB;
+// We stop reading from the socket while this much input is waiting to be handled.
+static constexpr size_t max_input_buffer_size = 256 * KiB;
+// We stop handling pipelined requests while this many chunks of output wait to be written.
+static constexpr size_t max_pending_output_chunks = 32;
+
+Client::Client(int fd, FileCache& file_cache)
+    : m_fd(fd)
+    , m_file_cache(file_cache)
 {
 }
 
+Client::~Client()
+{
+    if (m_fd >= 0) {
+        m_notifier->close();
+        (void)Core::System::close(m_fd);
+    }
+}
+
+ReadonlyBytes Client::PendingOutput::remaining_bytes() const
+{
+    return data.visit(
+        [&](ByteBuffer const& buffer) { return buffer.bytes().slice(offset); },
+        [&](NonnullRefPtr<Core::MappedFile> const& file) { return file->bytes().slice(offset); });
+}
+
 void Client::die()
 {
-    m_socket->close();
-    deferred_invoke([this] { remove_from_parent(); });
+    if (m_fd < 0)
+        return;
+    m_idle_timer->stop();
+    m_notifier->close();
+    (void)Core::System::close(m_fd);
+    m_fd = -1;
+    m_pending_output.clear();
+    deferred_invoke([this] {
+        if (on_close)
+            on_close();
+    });
 }
 
 void Client::start()
 {
-    m_socket->on_ready_to_read = [this] {
-        StringBuilder builder;
+    m_notifier = Core::Notifier::construct(m_fd, Core::Notifier::Read, this);
+    m_notifier->on_ready_to_read = [this] {
+        read_from_socket();
+        pump();
+    };
+    m_notifier->on_ready_to_write = [this] {
+        pump();
+    };
+
+    m_idle_timer = Core::Timer::create_single_shot(keep_alive_timeout_ms, [this] { die(); }, this);
+    m_idle_timer->start();
+
+    auto flags_or_error = Core::System::fcntl(m_fd, F_GETFL);
+    if (!flags_or_error.is_error())
+        flags_or_error = Core::System::fcntl(m_fd, F_SETFL, flags_or_error.value() | O_NONBLOCK);
+    if (flags_or_error.is_error()) {
+        warnln("Failed to make the client socket non-blocking: {}", flags_or_error.error());
+        die();
+    }
+}
 
-        auto maybe_buffer = ByteBuffer::create_uninitialized(m_socket->buffer_size());
-        if (maybe_buffer.is_error()) {
-            warnln("Could not create buffer for client: {}", maybe_buffer.error());
+void Client::read_from_socket()
+{
+    m_idle_timer->restart();
+
+    u8 buffer[16 * KiB];
+    while (m_input_buffer.size() < max_input_buffer_size) {
+        auto nread_or_error = Core::System::read(m_fd, { buffer, sizeof(buffer) });
+        if (nread_or_error.is_error()) {
+            auto code = nread_or_error.error().code();
+            if (code == EAGAIN)
+                break;
+            if (code == EINTR)
+                continue;
+            warnln("Failed to read from the client: {}", nread_or_error.error());
             die();
             return;
         }
 
-        auto buffer = maybe_buffer.release_value();
-        for (;;) {
-            auto maybe_can_read = m_socket->can_read_without_blocking();
-            if (maybe_can_read.is_error()) {
-                warnln("Failed to get the blocking status for the socket: {}", maybe_can_read.error());
-                die();
-                return;
-            }
+        auto nread = static_cast<size_t>(nread_or_error.value());
+        if (nread == 0) {
+            m_received_eof = true;
+            break;
+        }
 
-            if (!maybe_can_read.value())
-                break;
+        if (auto result = m_input_buffer.try_append(buffer, nread); result.is_error()) {
+            warnln("Could not grow the buffer for the client: {}", result.error());
+            die();
+            return;
+        }
+    }
+}
 
-            auto maybe_nread = m_socket->read_until_any_of(buffer, Array { "\r"sv, "\n"sv, "\r\n"sv });
-            if (maybe_nread.is_error()) {
-                warnln("Failed to read a line from the request: {}", maybe_nread.error());
-                die();
-                return;
-            }
+void Client::pump()
+{
+    // Handling requests produces output, and writing it out may make room for handling more requests.
+    for (;;) {
+        handle_buffered_requests();
+        if (m_fd < 0)
+            return;
+        write_to_socket();
+        if (m_fd < 0)
+            return;
+        if (!m_pending_output.is_empty() || !m_handling_paused)
+            break;
+    }
 
-            if (m_socket->is_eof()) {
-                die();
-                break;
-            }
+    if (m_pending_output.is_empty() && (m_close_after_pending_output || m_received_eof)) {
+        die();
+        return;
+    }
+
+    unsigned event_mask = Core::Notifier::None;
+    if (!m_pending_output.is_empty())
+        event_mask |= Core::Notifier::Write;
+    if (!m_received_eof && !m_close_after_pending_output && !m_handling_paused && m_input_buffer.size() < max_input_buffer_size)
+        event_mask |= Core::Notifier::Read;
+    m_notifier->set_event_mask(event_mask);
+}
 
-            builder.append(StringView { buffer.data(), maybe_nread.value() });
-            builder.append("\r\n");
+void Client::handle_buffered_requests()
+{
+    m_handling_paused = false;
+
+    size_t offset = 0;
+    while (!m_close_after_pending_output) {
+        if (m_pending_output.size() >= max_pending_output_chunks) {
+            m_handling_paused = true;
+            break;
+        }
+
+        auto remaining_input = m_input_buffer.bytes().slice(offset);
+        auto end_of_headers = StringView { remaining_input }.find("\r\n\r\n"sv);
+        if (!end_of_headers.has_value()) {
+            if (remaining_input.size() > max_request_header_size) {
+                m_keep_alive = false;
+                if (auto result = send_error_response(431, {}, true); result.is_error())
+                    warnln("Failed to reject the request: {}", result.error());
+                m_close_after_pending_output = true;
+            }
+            break;
         }
 
-        auto request = builder.to_byte_buffer();
-        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", String::copy(request));
+        auto request_size = end_of_headers.value() + 4;
+        auto raw_request = remaining_input.trim(request_size);
+        offset += request_size;
 
-        auto maybe_did_handle = handle_request(request);
+        dbgln_if(WEBSERVER_DEBUG, "Got raw request: '{}'", String::copy(raw_request));
+
+        auto maybe_did_handle = handle_request(raw_request);
         if (maybe_did_handle.is_error()) {
             warnln("Failed to handle the request: {}", maybe_did_handle.error());
+            m_keep_alive = false;
         }
+        if (!m_keep_alive)
+            m_close_after_pending_output = true;
+    }
 
+    if (offset == 0)
+        return;
+
+    auto remaining_input_or_error = ByteBuffer::copy(m_input_buffer.bytes().slice(offset));
+    if (remaining_input_or_error.is_error()) {
+        warnln("Could not shrink the buffer for the client: {}", remaining_input_or_error.error());
         die();
-    };
+        return;
+    }
+    m_input_buffer = remaining_input_or_error.release_value();
+}
+
+void Client::write_to_socket()
+{
+    while (!m_pending_output.is_empty()) {
+        // Write out several responses, or a response's headers and its body, in one go.
+        Array<iovec, 16> iovecs;
+        size_t iovec_count = 0;
+        for (auto& output : m_pending_output) {
+            if (iovec_count == iovecs.size())
+                break;
+            auto bytes = output.remaining_bytes();
+            iovecs[iovec_count++] = { const_cast<u8*>(bytes.data()), bytes.size() };
+        }
+
+        auto rc = ::writev(m_fd, iovecs.data(), static_cast<int>(iovec_count));
+        if (rc < 0) {
+            if (errno == EAGAIN)
+                return;
+            if (errno == EINTR)
+                continue;
+            warnln("Failed to write to the client: {}", strerror(errno));
+            die();
+            return;
+        }
+
+        m_idle_timer->restart();
+
+        auto nwritten = static_cast<size_t>(rc);
+        size_t finished_outputs = 0;
+        for (auto& output : m_pending_output) {
+            auto remaining_size = output.remaining_bytes().size();
+            if (nwritten < remaining_size) {
+                output.offset += nwritten;
+                break;
+            }
+            nwritten -= remaining_size;
+            ++finished_outputs;
+        }
+        m_pending_output.remove(0, finished_outputs);
+    }
 }
 
 ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
 {
     auto request_or_error = HTTP::HttpRequest::from_raw_request(raw_request);
-    if (!request_or_error.has_value())
+    if (!request_or_error.has_value()) {
+        m_keep_alive = false;
+        TRY(send_error_response(400, {}, true));
         return false;
+    }
     auto& request = request_or_error.value();
 
     if constexpr (WEBSERVER_DEBUG) {
@@ -106,11 +267,25 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
         }
     }
 
-    if (request.method() != HTTP::HttpRequest::Method::GET) {
+    // HTTP/1.1 connections are persistent unless the client asks otherwise, HTTP/1.0 ones only if the client asks for it.
+    m_keep_alive = request.version() == HTTP::HttpRequest::Version::HTTP_1_1;
+    for (auto& header : request.headers()) {
+        if (header.name.equals_ignoring_case("Connection")) {
+            auto value = header.value.trim_whitespace();
+            if (value.equals_ignoring_case("close"))
+                m_keep_alive = false;
+            else if (value.equals_ignoring_case("keep-alive"))
+                m_keep_alive = true;
+        } else if (header.name.equals_ignoring_case("Content-Length") || header.name.equals_ignoring_case("Transfer-Encoding")) {
+            // We never read request bodies, so we couldn't tell where the next request starts.
+            m_keep_alive = false;
+        }
+    }
+
+    if (request.method() != HTTP::HttpRequest::Method::GET && request.method() != HTTP::HttpRequest::Method::HEAD) {
         TRY(send_error_response(501, request));
         return false;
     }
-
     // Check for credentials if they are required
     if (Configuration::the().credentials().has_value()) {
         bool has_authenticated = verify_credentials(request.headers());
@@ -151,80 +326,88 @@ ErrorOr<bool> Client::handle_request(ReadonlyBytes raw_request)
         real_path = index_html_path;
     }
 
-    auto file = Core::File::construct(real_path);
-    if (!file->open(Core::OpenMode::ReadOnly)) {
+    auto stat_or_error = Core::System::stat(real_path);
+    if (stat_or_error.is_error()) {
         TRY(send_error_response(404, request));
         return false;
     }
 
-    if (file->is_device()) {
+    if (!S_ISREG(stat_or_error.value().st_mode)) {
         TRY(send_error_response(403, request));
         return false;
     }
 
-    Core::InputFileStream stream { file };
+    auto file_or_error = m_file_cache.get(real_path, stat_or_error.value());
+    if (file_or_error.is_error()) {
+        TRY(send_error_response(404, request));
+        return false;
+    }
 
-    TRY(send_response(stream, request, Core::guess_mime_type_based_on_filename(real_path)));
+    TRY(send_response(request, Core::guess_mime_type_based_on_filename(real_path), file_or_error.release_value()));
     return true;
 }
 
-ErrorOr<void> Client::send_response(InputStream& response, HTTP::HttpRequest const& request, String const& content_type)
+static Vector<String> content_headers(String const& content_type)
+{
+    return {
+        "X-Frame-Options: SAMEORIGIN",
+        "X-Content-Type-Options: nosniff",
+        "Pragma: no-cache",
+        String::formatted("Content-Type: {}", content_type),
+    };
+}
+
+ErrorOr<void> Client::send_headers(unsigned code, Vector<String> const& headers, size_t content_length)
 {
     StringBuilder builder;
-    builder.append("HTTP/1.0 200 OK\r\n");
-    builder.append("Server: WebServer (SerenityOS)\r\n");
-    builder.append("X-Frame-Options: SAMEORIGIN\r\n");
-    builder.append("X-Content-Type-Options: nosniff\r\n");
-    builder.append("Pragma: no-cache\r\n");
-    builder.append("Content-Type: ");
-    builder.append(content_type);
-    builder.append("\r\n");
+    builder.appendff("HTTP/1.1 {} ", code);
+    builder.append(HTTP::HttpResponse::reason_phrase_for_code(code));
     builder.append("\r\n");
+    builder.append("Server: WebServer (SerenityOS)\r\n");
 
-    auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket->write(builder_contents));
-    log_response(200, request);
+    for (auto& header : headers) {
+        builder.append(header);
+        builder.append("\r\n");
+    }
+    builder.appendff("Content-Length: {}\r\n", content_length);
+    builder.append(m_keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    builder.append("\r\n");
 
-    char buffer[PAGE_SIZE];
-    do {
-        auto size = response.read({ buffer, sizeof(buffer) });
-        if (response.unreliable_eof() && size == 0)
-            break;
+    return queue_output(builder.to_byte_buffer());
+}
 
-        ReadonlyBytes write_buffer { buffer, size };
-        while (!write_buffer.is_empty()) {
-            auto nwritten = TRY(m_socket->write(write_buffer));
+ErrorOr<void> Client::queue_output(ByteBuffer buffer)
+{
+    if (buffer.is_empty())
+        return {};
+    TRY(m_pending_output.try_append({ move(buffer) }));
+    return {};
+}
 
-            if (nwritten == 0) {
-                dbgln("EEEEEE got 0 bytes written!");
-            }
+ErrorOr<void> Client::send_response(HTTP::HttpRequest const& request, String const& content_type, RefPtr<Core::MappedFile> file)
+{
+    TRY(send_headers(200, content_headers(content_type), file ? file->size() : 0));
+    // The file is written to the socket straight from its mapping.
+    if (file && request.method() != HTTP::HttpRequest::Method::HEAD)
+        TRY(m_pending_output.try_append({ file.release_nonnull() }));
 
-            write_buffer = write_buffer.slice(nwritten);
-        }
-    } while (true);
+    log_response(200, request);
+    return {};
+}
 
-    auto keep_alive = false;
-    if (auto it = request.headers().find_if([](auto& header) { return header.name.equals_ignoring_case("Connection"); }); !it.is_end()) {
-        if (it->value.trim_whitespace().equals_ignoring_case("keep-alive"))
-            keep_alive = true;
-    }
-    if (!keep_alive)
-        m_socket->close();
+ErrorOr<void> Client::send_response(HTTP::HttpRequest const& request, String const& content_type, ByteBuffer body)
+{
+    TRY(send_headers(200, content_headers(content_type), body.size()));
+    if (request.method() != HTTP::HttpRequest::Method::HEAD)
+        TRY(queue_output(move(body)));
 
+    log_response(200, request);
     return {};
 }
 
 ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest const& request)
 {
-    StringBuilder builder;
-    builder.append("HTTP/1.0 301 Moved Permanently\r\n");
-    builder.append("Location: ");
-    builder.append(redirect_path);
-    builder.append("\r\n");
-    builder.append("\r\n");
-
-    auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket->write(builder_contents));
+    TRY(send_headers(301, { String::formatted("Location: {}", redirect_path) }, 0));
 
     log_response(301, request);
     return {};
@@ -232,7 +415,7 @@ ErrorOr<void> Client::send_redirect(StringView redirect_path, HTTP::HttpRequest
 
 static String folder_image_data()
 {
-    static String cache;
+    thread_local String cache;
     if (cache.is_empty()) {
         auto file = Core::MappedFile::map("/res/icons/16x16/filetype-folder.png").release_value_but_fixme_should_propagate_errors();
         cache = encode_base64(file->bytes());
@@ -242,7 +425,7 @@ static String folder_image_data()
 
 static String file_image_data()
 {
-    static String cache;
+    thread_local String cache;
     if (cache.is_empty()) {
         auto file = Core::MappedFile::map("/res/icons/16x16/filetype-unknown.png").release_value_but_fixme_should_propagate_errors();
         cache = encode_base64(file->bytes());
@@ -324,35 +507,35 @@ ErrorOr<void> Client::handle_directory_listing(String const& requested_path, Str
     builder.append("</body>\n");
     builder.append("</html>\n");
 
-    auto response = builder.to_string();
-    InputMemoryStream stream { response.bytes() };
-    return send_response(stream, request, "text/html");
+    return send_response(request, "text/html", builder.to_byte_buffer());
 }
 
 ErrorOr<void> Client::send_error_response(unsigned code, HTTP::HttpRequest const& request, Vector<String> const& headers)
 {
-    auto reason_phrase = HTTP::HttpResponse::reason_phrase_for_code(code);
-    StringBuilder builder;
-    builder.appendff("HTTP/1.0 {} ", code);
-    builder.append(reason_phrase);
-    builder.append("\r\n");
+    TRY(send_error_response(code, headers, request.method() != HTTP::HttpRequest::Method::HEAD));
 
-    for (auto& header : headers) {
-        builder.append(header);
-        builder.append("\r\n");
-    }
-    builder.append("Content-Type: text/html; charset=UTF-8\r\n");
+    log_response(code, request);
+    return {};
+}
 
-    builder.append("\r\n");
-    builder.append("<!DOCTYPE html><html><body><h1>");
-    builder.appendff("{} ", code);
-    builder.append(reason_phrase);
-    builder.append("</h1></body></html>");
+ErrorOr<void> Client::send_error_response(unsigned code, Vector<String> const& headers, bool include_body)
+{
+    auto reason_phrase = HTTP::HttpResponse::reason_phrase_for_code(code);
 
-    auto builder_contents = builder.to_byte_buffer();
-    TRY(m_socket->write(builder_contents));
+    StringBuilder body_builder;
+    body_builder.append("<!DOCTYPE html><html><body><h1>");
+    body_builder.appendff("{} ", code);
+    body_builder.append(reason_phrase);
+    body_builder.append("</h1></body></html>");
+    auto body = body_builder.to_byte_buffer();
 
-    log_response(code, request);
+    Vector<String> all_headers;
+    TRY(all_headers.try_extend(headers));
+    TRY(all_headers.try_append("Content-Type: text/html; charset=UTF-8"));
+    TRY(send_headers(code, all_headers, body.size()));
+
+    if (include_body)
+        TRY(queue_output(move(body)));
     return {};
 }
 
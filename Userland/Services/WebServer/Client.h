@@ -6,32 +6,74 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
+#include <AK/Variant.h>
+#include <AK/Vector.h>
+#include <LibCore/MappedFile.h>
+#include <LibCore/Notifier.h>
 #include <LibCore/Object.h>
-#include <LibCore/Stream.h>
+#include <LibCore/Timer.h>
 #include <LibHTTP/Forward.h>
 #include <LibHTTP/HttpRequest.h>
 
 namespace WebServer {
 
+class FileCache;
+
+// A client connection, which may carry any number of (pipelined) requests. The socket is
+// non-blocking: requests are parsed from whatever has arrived so far, and responses are
+// queued and written out whenever the socket can take more data.
 class Client final : public Core::Object {
     C_OBJECT(Client);
 
 public:
+    virtual ~Client() override;
+
     void start();
 
+    Function<void()> on_close;
+
 private:
-    Client(NonnullOwnPtr<Core::Stream::BufferedTCPSocket>, Core::Object* parent);
+    Client(int fd, FileCache&);
+
+    void read_from_socket();
+    void write_to_socket();
+    void handle_buffered_requests();
+    void pump();
+    void die();
 
     ErrorOr<bool> handle_request(ReadonlyBytes);
-    ErrorOr<void> send_response(InputStream&, HTTP::HttpRequest const&, String const& content_type);
+    ErrorOr<void> send_response(HTTP::HttpRequest const&, String const& content_type, RefPtr<Core::MappedFile>);
+    ErrorOr<void> send_response(HTTP::HttpRequest const&, String const& content_type, ByteBuffer body);
     ErrorOr<void> send_redirect(StringView redirect, HTTP::HttpRequest const&);
     ErrorOr<void> send_error_response(unsigned code, HTTP::HttpRequest const&, Vector<String> const& headers = {});
-    void die();
+    ErrorOr<void> send_error_response(unsigned code, Vector<String> const& headers, bool include_body);
+    ErrorOr<void> send_headers(unsigned code, Vector<String> const& headers, size_t content_length);
+    ErrorOr<void> queue_output(ByteBuffer);
     void log_response(unsigned code, HTTP::HttpRequest const&);
     ErrorOr<void> handle_directory_listing(String const& requested_path, String const& real_path, HTTP::HttpRequest const&);
     bool verify_credentials(Vector<HTTP::HttpRequest::Header> const&);
 
-    NonnullOwnPtr<Core::Stream::BufferedTCPSocket> m_socket;
+    int m_fd { -1 };
+    RefPtr<Core::Notifier> m_notifier;
+    RefPtr<Core::Timer> m_idle_timer;
+    FileCache& m_file_cache;
+
+    ByteBuffer m_input_buffer;
+    bool m_received_eof { false };
+    bool m_handling_paused { false };
+
+    struct PendingOutput {
+        Variant<ByteBuffer, NonnullRefPtr<Core::MappedFile>> data;
+        size_t offset { 0 };
+
+        ReadonlyBytes remaining_bytes() const;
+    };
+    Vector<PendingOutput> m_pending_output;
+
+    // Whether the request currently being handled allows the connection to stay open.
+    bool m_keep_alive { false };
+    bool m_close_after_pending_output { false };
 };
 
 }
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <WebServer/FileCache.h>
+
+namespace WebServer {
+
+ErrorOr<RefPtr<Core::MappedFile>> FileCache::get(String const& path, struct stat const& st)
+{
+    // Empty files can't be mapped, and there's nothing to send for them anyway.
+    if (st.st_size == 0)
+        return RefPtr<Core::MappedFile> {};
+
+    if (auto it = m_entries.find(path); it != m_entries.end()) {
+        auto entry = it->value;
+        m_entries.remove(it);
+        if (entry.device == st.st_dev && entry.inode == st.st_ino && entry.size == st.st_size && entry.modification_time == st.st_mtime) {
+            // Move the entry to the back, so that the least recently used entries are evicted first.
+            m_entries.set(path, entry);
+            return RefPtr<Core::MappedFile> { entry.file };
+        }
+    }
+
+    auto file = TRY(Core::MappedFile::map(path));
+
+    if (m_entries.size() >= max_entries)
+        m_entries.remove(m_entries.begin());
+    m_entries.set(path, { file, st.st_dev, st.st_ino, st.st_size, st.st_mtime });
+
+    return RefPtr<Core::MappedFile> { move(file) };
+}
+
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/String.h>
+#include <LibCore/MappedFile.h>
+#include <sys/stat.h>
+
+namespace WebServer {
+
+// Keeps recently served files mapped into memory, so that responses can be written to the
+// socket straight from the mapping instead of being read into a buffer first. Entries are
+// checked against the file on disk on every lookup, so changed files are mapped again.
+//
+// NOTE: Mapped files aren't safe to share between threads, so each worker has its own cache.
+class FileCache {
+public:
+    // Returns the mapping of the file at the given path, or null if the file is empty.
+    ErrorOr<RefPtr<Core::MappedFile>> get(String const& path, struct stat const&);
+
+private:
+    static constexpr size_t max_entries = 256;
+
+    struct Entry {
+        NonnullRefPtr<Core::MappedFile> file;
+        dev_t device;
+        ino_t inode;
+        off_t size;
+        time_t modification_time;
+    };
+
+    OrderedHashMap<String, Entry> m_entries;
+};
+
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/EventLoop.h>
+#include <LibCore/Notifier.h>
+#include <LibCore/System.h>
+#include <WebServer/Worker.h>
+#include <fcntl.h>
+
+namespace WebServer {
+
+ErrorOr<NonnullOwnPtr<Worker>> Worker::try_create(size_t index)
+{
+    auto fds = TRY(Core::System::pipe2(O_CLOEXEC));
+    auto worker = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Worker(fds[0], fds[1])));
+    worker->m_thread = Threading::Thread::construct([worker = worker.ptr()] { return worker->run(); }, String::formatted("Worker {}", index));
+    worker->m_thread->start();
+    return worker;
+}
+
+Worker::Worker(int read_fd, int write_fd)
+    : m_read_fd(read_fd)
+    , m_write_fd(write_fd)
+{
+}
+
+ErrorOr<void> Worker::hand_off(int client_fd)
+{
+    // NOTE: Writes of less than PIPE_BUF bytes are atomic, so the worker always reads whole fds.
+    TRY(Core::System::write(m_write_fd, { &client_fd, sizeof(client_fd) }));
+    return {};
+}
+
+intptr_t Worker::run()
+{
+    Core::EventLoop event_loop;
+
+    auto notifier = Core::Notifier::construct(m_read_fd, Core::Notifier::Read);
+    notifier->on_ready_to_read = [this] {
+        accept_handed_off_clients();
+    };
+
+    return event_loop.exec();
+}
+
+void Worker::accept_handed_off_clients()
+{
+    int client_fds[64];
+    auto nread_or_error = Core::System::read(m_read_fd, { client_fds, sizeof(client_fds) });
+    if (nread_or_error.is_error()) {
+        warnln("Failed to receive clients from the main thread: {}", nread_or_error.error());
+        return;
+    }
+
+    auto nread = static_cast<size_t>(nread_or_error.value());
+    VERIFY(nread % sizeof(int) == 0);
+    for (size_t i = 0; i < nread / sizeof(int); ++i) {
+        auto client = Client::construct(client_fds[i], m_file_cache);
+        client->on_close = [this, client = client.ptr()] {
+            m_clients.remove(client);
+        };
+        m_clients.set(client.ptr(), client);
+        client->start();
+    }
+}
+
+}
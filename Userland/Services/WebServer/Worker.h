@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2022, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <LibThreading/Thread.h>
+#include <WebServer/Client.h>
+#include <WebServer/FileCache.h>
+
+namespace WebServer {
+
+// A worker runs its own event loop on a separate thread and serves all connections that the
+// main thread hands to it.
+class Worker {
+public:
+    static ErrorOr<NonnullOwnPtr<Worker>> try_create(size_t index);
+
+    // Called on the main thread to pass a newly accepted connection to this worker.
+    ErrorOr<void> hand_off(int client_fd);
+
+private:
+    Worker(int read_fd, int write_fd);
+
+    intptr_t run();
+    void accept_handed_off_clients();
+
+    int m_read_fd { -1 };
+    int m_write_fd { -1 };
+    RefPtr<Threading::Thread> m_thread;
+
+    // These are only ever touched on the worker thread.
+    HashMap<Client*, NonnullRefPtr<Client>> m_clients;
+    FileCache m_file_cache;
+};
+
+}
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/NonnullOwnPtrVector.h>
 #include <LibCore/ArgsParser.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/File.h>
@@ -13,8 +14,9 @@
 #include <LibCore/TCPServer.h>
 #include <LibHTTP/HttpRequest.h>
 #include <LibMain/Main.h>
-#include <WebServer/Client.h>
 #include <WebServer/Configuration.h>
+#include <WebServer/Worker.h>
+#include <signal.h>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -26,6 +28,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     String listen_address = default_listen_address;
     int port = default_port;
+    int worker_count = 4;
     String username;
     String password;
 
@@ -34,6 +37,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(port, "Port to listen on", "port", 'p', "port");
     args_parser.add_option(username, "HTTP basic authentication username", "user", 'U', "username");
     args_parser.add_option(password, "HTTP basic authentication password", "pass", 'P', "password");
+    args_parser.add_option(worker_count, "Number of worker threads serving connections", "threads", 'j', "count");
     args_parser.add_positional_argument(root_path, "Path to serve the contents of", "path", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
@@ -48,6 +52,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 1;
     }
 
+    if (worker_count <= 0) {
+        warnln("Invalid number of worker threads: {}", worker_count);
+        return 1;
+    }
+
     if (username.is_empty() != password.is_empty()) {
         warnln("Both username and password are required for HTTP basic authentication.");
         return 1;
@@ -60,7 +69,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         return 1;
     }
 
-    TRY(Core::System::pledge("stdio accept rpath inet unix"));
+    TRY(Core::System::pledge("stdio accept rpath inet unix thread"));
 
     WebServer::Configuration configuration(real_root_path);
 
@@ -69,8 +78,16 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
     Core::EventLoop loop;
 
+    // A client that goes away while we're writing to it shouldn't take the whole server down.
+    TRY(Core::System::signal(SIGPIPE, SIG_IGN));
+
+    NonnullOwnPtrVector<WebServer::Worker> workers;
+    for (int i = 0; i < worker_count; ++i)
+        workers.append(TRY(WebServer::Worker::try_create(i)));
+
     auto server = TRY(Core::TCPServer::try_create());
 
+    size_t next_worker = 0;
     server->on_ready_to_accept = [&] {
         auto maybe_client_socket = server->accept();
         if (maybe_client_socket.is_error()) {
@@ -78,16 +95,19 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
             return;
         }
 
-        auto maybe_buffered_socket = Core::Stream::BufferedTCPSocket::create(maybe_client_socket.release_value());
-        if (maybe_buffered_socket.is_error()) {
-            warnln("Could not obtain a buffered socket for the client: {}", maybe_buffered_socket.error());
+        auto maybe_client_fd = maybe_client_socket.value()->release_fd();
+        if (maybe_client_fd.is_error()) {
+            warnln("Failed to take over the client socket: {}", maybe_client_fd.error());
             return;
         }
 
-        // FIXME: Propagate errors
-        MUST(maybe_buffered_socket.value()->set_blocking(true));
-        auto client = WebServer::Client::construct(maybe_buffered_socket.release_value(), server);
-        client->start();
+        // Connections are spread over the workers round-robin, and each worker serves its connections until they are closed.
+        auto& worker = workers[next_worker];
+        next_worker = (next_worker + 1) % workers.size();
+        if (auto result = worker.hand_off(maybe_client_fd.value()); result.is_error()) {
+            warnln("Failed to hand the client to a worker: {}", result.error());
+            (void)Core::System::close(maybe_client_fd.value());
+        }
     };
 
     TRY(server->listen(ipv4_address.value(), port));
@@ -20,15 +20,17 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     Vector<StringView> source_paths;
     bool recurse = false;
     bool force = false;
+    unsigned thread_count = 1;
 
     Core::ArgsParser args_parser;
     args_parser.add_positional_argument(zip_path, "Zip file path", "zipfile", Core::ArgsParser::Required::Yes);
     args_parser.add_positional_argument(source_paths, "Input files to be archived", "files", Core::ArgsParser::Required::Yes);
     args_parser.add_option(recurse, "Travel the directory structure recursively", "recurse-paths", 'r');
     args_parser.add_option(force, "Overwrite existing zip file", "force", 'f');
+    args_parser.add_option(thread_count, "Compress each file on this many threads", "threads", 'j', "count");
     args_parser.parse(arguments);
 
-    TRY(Core::System::pledge("stdio rpath wpath cpath"));
+    TRY(Core::System::pledge("stdio rpath wpath cpath thread"));
 
     auto cwd = TRY(Core::System::getcwd());
     TRY(Core::System::unveil(LexicalPath::absolute_path(cwd, zip_path), "wc"));
@@ -65,7 +67,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         Archive::ZipMember member {};
         member.name = canonicalized_path;
 
-        auto deflate_buffer = Compress::DeflateCompressor::compress_all(file_buffer);
+        auto deflate_buffer = Compress::DeflateCompressor::compress_all(file_buffer, Compress::DeflateCompressor::CompressionLevel::GOOD, thread_count);
         if (deflate_buffer.has_value() && deflate_buffer.value().size() < file_buffer.size()) {
             member.compressed_data = deflate_buffer.value().bytes();
             member.compression_method = Archive::ZipCompressionMethod::Deflate;